@@ -0,0 +1,29 @@
+from contourpy.band import banded_filled, banded_lines
+
+from .bench_base import BenchBase
+from .util_bench import datasets
+
+
+class BenchBand(BenchBase):
+    # Single level of grids contoured in bands of rows, at increasing grid sizes to show that the
+    # time grows with the number of grid points as it does for a single contour generator.
+    params = (datasets(), [300, 1000, 3000], [256])
+    param_names = ("dataset", "n", "band_size")
+    timeout = 300
+
+    def setup(self, dataset, n, band_size):
+        self.skip_if_insufficient_memory(n)
+        self.set_xyz_and_levels(dataset, n, False)
+        self.level = self.levels[len(self.levels) // 2]
+        self.upper_level = self.levels[len(self.levels) // 2 + 2]
+
+    def time_banded_filled(self, dataset, n, band_size):
+        banded_filled(
+            self.z, [self.level, self.upper_level], x=self.x, y=self.y, band_size=band_size)
+
+    def time_banded_lines(self, dataset, n, band_size):
+        banded_lines(self.z, [self.level], x=self.x, y=self.y, band_size=band_size)
+
+    def peakmem_banded_filled(self, dataset, n, band_size):
+        banded_filled(
+            self.z, [self.level, self.upper_level], x=self.x, y=self.y, band_size=band_size)
@@ -1,3 +1,5 @@
+import os
+
 import numpy as np
 
 from contourpy.util.data import random, simple
@@ -16,3 +18,25 @@ class BenchBase:
             self.levels = np.arange(-1.0, 1.01, 0.1)
         else:
             raise NotImplementedError()
+
+    def set_z_stack(self, dataset, n, field_count):
+        # Stack of fields that evolve in time, as for the frames of an animation.  Each field of
+        # simple is perturbed by a small amount of noise, each field of random is independent.
+        self.set_xyz_and_levels(dataset, n, False)
+        rng = np.random.default_rng(2075)
+        if dataset == "random":
+            self.z_stack = rng.uniform(size=(field_count, n, n))
+        else:
+            self.z_stack = self.z + 0.01*rng.standard_normal((field_count, n, n))
+
+    def skip_if_insufficient_memory(self, n, field_count=1):
+        # x, y, the z fields and the grid cache of a (n, n) grid plus the working arrays of the
+        # synthetic data and the contours need about 48 bytes per point per field.  Raising
+        # NotImplementedError in setup makes asv skip the benchmark.
+        try:
+            available = os.sysconf("SC_PHYS_PAGES")*os.sysconf("SC_PAGE_SIZE")
+        except (AttributeError, OSError, ValueError):
+            return
+        if 48*n*n*(field_count + 1) > available:
+            raise NotImplementedError(
+                f"Insufficient memory for {field_count} field(s) of {n}x{n}")
@@ -0,0 +1,32 @@
+from contourpy.block import block_filled, block_lines, block_slices, merge_filled, merge_lines
+
+from .bench_base import BenchBase
+from .util_bench import datasets
+
+
+class BenchBlock(BenchBase):
+    # Merging the contours of a single level of grids divided into blocks, as contoured by the
+    # workers of a distributed computation.  The blocks are contoured in setup so that only the
+    # merge is timed.
+    params = (datasets(), [1000, 3000], [8, 16])
+    param_names = ("dataset", "n", "chunk_count")
+    timeout = 300
+
+    def setup(self, dataset, n, chunk_count):
+        self.skip_if_insufficient_memory(n)
+        self.set_xyz_and_levels(dataset, n, False)
+        level = self.levels[len(self.levels) // 2]
+        upper_level = self.levels[len(self.levels) // 2 + 2]
+        slices = block_slices(self.z.shape, chunk_count=chunk_count)
+        self.filled_blocks = [
+            block_filled(self.z[s], [level, upper_level], x=self.x[s], y=self.y[s], offset=offset)
+            for offset, s in slices]
+        self.lines_blocks = [
+            block_lines(self.z[s], [level], x=self.x[s], y=self.y[s], offset=offset)
+            for offset, s in slices]
+
+    def time_merge_filled(self, dataset, n, chunk_count):
+        merge_filled(self.filled_blocks)
+
+    def time_merge_lines(self, dataset, n, chunk_count):
+        merge_lines(self.lines_blocks)
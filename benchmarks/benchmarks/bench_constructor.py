@@ -0,0 +1,29 @@
+from contourpy import contour_generator
+
+from .bench_base import BenchBase
+from .util_bench import corner_masks, problem_sizes
+
+
+class BenchConstructor(BenchBase):
+    # Cost of creating a contour generator, mostly calculating the grid cache, without contouring.
+    params = (
+        ["mpl2005", "mpl2014", "serial", "threaded"], corner_masks(),
+        problem_sizes() + [3000, 10000])
+    param_names = ("name", "corner_mask", "n")
+    timeout = 300
+
+    def setup(self, name, corner_mask, n):
+        if name == "mpl2005" and corner_mask is True:
+            raise NotImplementedError("mpl2005 does not support corner_mask=True")
+        self.skip_if_insufficient_memory(n)
+        self.set_xyz_and_levels("simple", n, corner_mask != "no mask")
+        self.corner_mask = False if corner_mask == "no mask" else corner_mask
+        self.kwargs = dict(chunk_count=4) if name == "threaded" else {}
+
+    def time_constructor(self, name, corner_mask, n):
+        contour_generator(
+            self.x, self.y, self.z, name=name, corner_mask=self.corner_mask, **self.kwargs)
+
+    def peakmem_constructor(self, name, corner_mask, n):
+        contour_generator(
+            self.x, self.y, self.z, name=name, corner_mask=self.corner_mask, **self.kwargs)
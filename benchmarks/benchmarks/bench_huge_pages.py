@@ -0,0 +1,39 @@
+import numpy as np
+
+from contourpy import FillType, LineType, contour_generator, max_threads, set_huge_pages
+
+from .bench_base import BenchBase
+from .util_bench import datasets
+
+
+class BenchHugePages(BenchBase):
+    # Single level of large grids with the cache allocated with and without transparent huge
+    # pages.  Only Linux with transparent huge pages enabled shows any difference.
+    params = ([False, True], ["serial", "threaded"], datasets(), [1000, 3000, 10000])
+    param_names = ("huge_pages", "name", "dataset", "n")
+    timeout = 600
+
+    def setup(self, huge_pages, name, dataset, n):
+        self.skip_if_insufficient_memory(n)
+        self.set_xyz_and_levels(dataset, n, False)
+        set_huge_pages(huge_pages)
+        self.kwargs = dict(total_chunk_count=4*max_threads()) if name == "threaded" else {}
+        self.cont_gen = self._create(name)
+        self.level = self.levels[len(self.levels) // 2]
+
+    def teardown(self, huge_pages, name, dataset, n):
+        set_huge_pages(True)
+
+    def _create(self, name):
+        return contour_generator(
+            self.x, self.y, self.z, name=name, line_type=LineType.ChunkCombinedOffset,
+            fill_type=FillType.ChunkCombinedOffset, **self.kwargs)
+
+    def time_constructor_huge_pages(self, huge_pages, name, dataset, n):
+        self._create(name)
+
+    def time_filled_huge_pages(self, huge_pages, name, dataset, n):
+        self.cont_gen.filled(self.level, np.inf)
+
+    def time_lines_huge_pages(self, huge_pages, name, dataset, n):
+        self.cont_gen.lines(self.level)
@@ -0,0 +1,47 @@
+import numpy as np
+
+from contourpy import FillType, LineType, contour_generator, max_threads
+
+from .bench_base import BenchBase
+from .util_bench import datasets, large_problem_sizes
+
+
+class BenchLarge(BenchBase):
+    # Single level of grids larger than problem_sizes(), where the scaling limits of memory and
+    # threads are reached.  Skipped on machines without enough memory.
+    params = (["serial", "threaded"], datasets(), large_problem_sizes())
+    param_names = ("name", "dataset", "n")
+    timeout = 600
+
+    def setup(self, name, dataset, n):
+        self.skip_if_insufficient_memory(n)
+        self.set_xyz_and_levels(dataset, n, False)
+        kwargs = dict(total_chunk_count=4*max_threads()) if name == "threaded" else {}
+        self.cont_gen = contour_generator(
+            self.x, self.y, self.z, name=name, line_type=LineType.ChunkCombinedOffset,
+            fill_type=FillType.ChunkCombinedOffset, **kwargs)
+        self.level = self.levels[len(self.levels) // 2]
+
+    def time_filled_large(self, name, dataset, n):
+        self.cont_gen.filled(self.level, np.inf)
+
+    def time_lines_large(self, name, dataset, n):
+        self.cont_gen.lines(self.level)
+
+    def peakmem_filled_large(self, name, dataset, n):
+        self.cont_gen.filled(self.level, np.inf)
+
+    def peakmem_lines_large(self, name, dataset, n):
+        self.cont_gen.lines(self.level)
+
+    def track_filled_bytes_large(self, name, dataset, n):
+        return sum(array.nbytes for arrays in self.cont_gen.filled(self.level, np.inf)
+                   for array in arrays if array is not None)
+
+    track_filled_bytes_large.unit = "bytes"
+
+    def track_lines_points_large(self, name, dataset, n):
+        return sum(len(points) for points in self.cont_gen.lines(self.level)[0]
+                   if points is not None)
+
+    track_lines_points_large.unit = "points"
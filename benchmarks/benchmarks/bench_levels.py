@@ -0,0 +1,42 @@
+import numpy as np
+
+from contourpy import FillType, LineType, contour_generator
+
+from .bench_base import BenchBase
+from .util_bench import datasets, level_counts
+
+
+class BenchLevels(BenchBase):
+    # Sweep of many levels using the same contour generator, as used to draw a detailed contour
+    # plot.  Levels are spread evenly across the range of z, excluding its limits.
+    params = (["serial", "threaded"], datasets(), [1000, 3000], level_counts())
+    param_names = ("name", "dataset", "n", "level_count")
+    timeout = 300
+
+    def setup(self, name, dataset, n, level_count):
+        self.skip_if_insufficient_memory(n)
+        self.set_xyz_and_levels(dataset, n, False)
+        kwargs = dict(chunk_count=4) if name == "threaded" else {}
+        self.cont_gen = contour_generator(
+            self.x, self.y, self.z, name=name, line_type=LineType.ChunkCombinedOffset,
+            fill_type=FillType.ChunkCombinedOffset, **kwargs)
+        self.levels = np.linspace(self.z.min(), self.z.max(), level_count + 2)[1:-1]
+
+    def time_filled_levels(self, name, dataset, n, level_count):
+        for i in range(len(self.levels)-1):
+            self.cont_gen.filled(self.levels[i], self.levels[i+1])
+
+    def time_lines_levels(self, name, dataset, n, level_count):
+        for level in self.levels:
+            self.cont_gen.lines(level)
+
+    def peakmem_filled_levels(self, name, dataset, n, level_count):
+        # Results of all levels are kept, as when they are all drawn.
+        return [self.cont_gen.filled(self.levels[i], self.levels[i+1])
+                for i in range(len(self.levels)-1)]
+
+    def track_lines_points_levels(self, name, dataset, n, level_count):
+        return sum(len(points) for level in self.levels
+                   for points in self.cont_gen.lines(level)[0] if points is not None)
+
+    track_lines_points_levels.unit = "points"
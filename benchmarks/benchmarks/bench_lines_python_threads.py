@@ -0,0 +1,35 @@
+from concurrent.futures import ThreadPoolExecutor
+
+from contourpy import LineType, contour_generator
+
+from .bench_base import BenchBase
+from .util_bench import datasets, thread_counts
+
+
+class BenchLinesPythonThreads(BenchBase):
+    # Each Python thread contours its own generator, so on free-threaded Python the time should be
+    # independent of the number of Python threads.  Under the GIL only the serial algorithm runs
+    # in parallel, and only whilst it is not creating NumPy arrays.
+    params = (
+        ["serial", "mpl2014"], datasets(), [LineType.SeparateCode], [1000], thread_counts())
+    param_names = ("name", "dataset", "line_type", "n", "python_thread_count")
+
+    def setup(self, name, dataset, line_type, n, python_thread_count):
+        self.set_xyz_and_levels(dataset, n, False)
+        self.cont_gens = [
+            contour_generator(self.x, self.y, self.z, name=name, line_type=line_type)
+            for _ in range(python_thread_count)]
+        self.executor = ThreadPoolExecutor(max_workers=python_thread_count)
+
+    def teardown(self, name, dataset, line_type, n, python_thread_count):
+        self.executor.shutdown()
+
+    def _contour_all_levels(self, cont_gen):
+        for level in self.levels:
+            cont_gen.lines(level)
+
+    def time_lines_python_threads(self, name, dataset, line_type, n, python_thread_count):
+        futures = [
+            self.executor.submit(self._contour_all_levels, cont_gen) for cont_gen in self.cont_gens]
+        for future in futures:
+            future.result()
@@ -0,0 +1,38 @@
+import numpy as np
+
+from contourpy import FillType, LineType
+from contourpy.multi import multi_contour_generator
+
+from .bench_base import BenchBase
+from .util_bench import datasets, field_counts
+
+
+class BenchTimeSeries(BenchBase):
+    # Stack of z fields of a time series contoured together by a MultiContourGenerator.
+    params = (["serial", "threaded"], datasets(), [1000, 3000], field_counts())
+    param_names = ("name", "dataset", "n", "field_count")
+    timeout = 600
+
+    def setup(self, name, dataset, n, field_count):
+        self.skip_if_insufficient_memory(n, field_count)
+        self.set_z_stack(dataset, n, field_count)
+        kwargs = dict(chunk_count=4) if name == "threaded" else {}
+        self.multi_gen = multi_contour_generator(
+            self.x, self.y, self.z_stack, name=name, line_type=LineType.ChunkCombinedOffset,
+            fill_type=FillType.ChunkCombinedOffset, **kwargs)
+        self.level = self.levels[len(self.levels) // 2]
+
+    def time_multi_filled(self, name, dataset, n, field_count):
+        self.multi_gen.filled(self.level, np.inf)
+
+    def time_multi_lines(self, name, dataset, n, field_count):
+        self.multi_gen.lines(self.level)
+
+    def peakmem_multi_filled(self, name, dataset, n, field_count):
+        self.multi_gen.filled(self.level, np.inf)
+
+    def track_multi_filled_bytes(self, name, dataset, n, field_count):
+        return sum(array.nbytes for filled in self.multi_gen.filled(self.level, np.inf)
+                   for arrays in filled for array in arrays if array is not None)
+
+    track_multi_filled_bytes.unit = "bytes"
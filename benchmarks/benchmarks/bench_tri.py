@@ -0,0 +1,34 @@
+import numpy as np
+
+from contourpy import FillType, LineType
+from contourpy.tri import tri_contour_generator
+
+from .bench_base import BenchBase
+from .util_bench import datasets, problem_sizes, thread_counts
+
+
+class BenchTri(BenchBase):
+    params = (datasets(), problem_sizes(), [40], thread_counts())
+    param_names = ("dataset", "n", "chunk_count", "thread_count")
+
+    def setup(self, dataset, n, chunk_count, thread_count):
+        # Quad grid split into 2 triangles per quad.
+        self.set_xyz_and_levels(dataset, n, False)
+        self.x, self.y, self.z = self.x.ravel(), self.y.ravel(), self.z.ravel()
+        sw = (np.arange(n-1)[np.newaxis, :] + n*np.arange(n-1)[:, np.newaxis]).ravel()
+        self.triangles = np.concatenate([
+            np.stack([sw, sw+1, sw+n+1], axis=1), np.stack([sw, sw+n+1, sw+n], axis=1)])
+
+    def time_filled_tri(self, dataset, n, chunk_count, thread_count):
+        cont_gen = tri_contour_generator(
+            self.x, self.y, self.triangles, self.z, fill_type=FillType.ChunkCombinedOffset,
+            chunk_count=chunk_count, thread_count=thread_count)
+        for i in range(len(self.levels)-1):
+            cont_gen.filled(self.levels[i], self.levels[i+1])
+
+    def time_lines_tri(self, dataset, n, chunk_count, thread_count):
+        cont_gen = tri_contour_generator(
+            self.x, self.y, self.triangles, self.z, line_type=LineType.ChunkCombinedOffset,
+            chunk_count=chunk_count, thread_count=thread_count)
+        for level in self.levels:
+            cont_gen.lines(level)
@@ -0,0 +1,38 @@
+from contourpy import LineType, contour_generator
+from contourpy.multi import multi_contour_generator
+
+from .bench_base import BenchBase
+from .util_bench import datasets
+
+
+class BenchZSwap(BenchBase):
+    # Contouring a sequence of z fields on the same grid using a multi_contour_generator, which
+    # calculates the grid cache once and reuses it for every field, compared with creating a new
+    # contour generator for each field.  Both include the creation of the generators.
+    params = (["serial", "threaded"], datasets(), [1000, 3000], [10])
+    param_names = ("name", "dataset", "n", "field_count")
+    timeout = 300
+
+    def setup(self, name, dataset, n, field_count):
+        self.skip_if_insufficient_memory(n, field_count)
+        self.set_z_stack(dataset, n, field_count)
+        self.kwargs = dict(chunk_count=4) if name == "threaded" else {}
+        self.level = self.levels[len(self.levels) // 2]
+
+    def _z_swap(self, name):
+        multi_gen = multi_contour_generator(
+            self.x, self.y, self.z_stack, name=name, line_type=LineType.ChunkCombinedOffset,
+            **self.kwargs)
+        return multi_gen.lines(self.level)
+
+    def time_z_swap(self, name, dataset, n, field_count):
+        self._z_swap(name)
+
+    def time_z_new_generator(self, name, dataset, n, field_count):
+        for z in self.z_stack:
+            contour_generator(
+                self.x, self.y, z, name=name, line_type=LineType.ChunkCombinedOffset,
+                **self.kwargs).lines(self.level)
+
+    def peakmem_z_swap(self, name, dataset, n, field_count):
+        self._z_swap(name)
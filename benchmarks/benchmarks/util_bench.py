@@ -17,6 +17,18 @@ def fill_types():
     return list(FillType.__members__.values())
 
 
+def field_counts():
+    return [10, 50]
+
+
+def large_problem_sizes():
+    return [3000, 10000, 30000]
+
+
+def level_counts():
+    return [20, 50, 100]
+
+
 def line_types():
     return list(LineType.__members__.values())
 
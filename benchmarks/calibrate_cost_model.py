@@ -0,0 +1,121 @@
+# Calibrate the cost model used by contour_generator(name="auto") on this machine.
+#
+# Usage: python calibrate_cost_model.py [--output cost_model.json] [--repeats 5]
+#
+# Times the serial and threaded algorithms over a range of grid sizes, contour densities, chunk
+# counts and thread counts, fits the coefficients of the model in contourpy/cost.py and writes them
+# as JSON.  Set the environment variable CONTOURPY_COST_MODEL to the name of the output file to use
+# them instead of the defaults shipped with contourpy.
+
+import argparse
+import json
+from time import perf_counter
+
+import numpy as np
+
+from contourpy import FillType, LineType, contour_generator, max_threads
+from contourpy.cost import _default_coefficients
+from contourpy.util.data import random, simple
+
+
+def count_points(lines, filled):
+    return sum(len(points) for points in lines[0] if points is not None) + \
+        sum(len(points) for points in filled[0] if points is not None)
+
+
+def time_call(cont_gen, level, repeats):
+    # Mean time of lines() at level and filled() above it, and their number of points.
+    best = None
+    for _ in range(repeats):
+        start = perf_counter()
+        lines = cont_gen.lines(level)
+        filled = cont_gen.filled(level, np.inf)
+        elapsed = 0.5*(perf_counter() - start)
+        best = elapsed if best is None else min(best, elapsed)
+    return best, 0.5*count_points(lines, filled)
+
+
+def create(z, **kwargs):
+    return contour_generator(
+        z=z, line_type=LineType.ChunkCombinedOffset, fill_type=FillType.ChunkCombinedOffset,
+        **kwargs)
+
+
+def calibrate(repeats):
+    coefficients = dict(_default_coefficients)
+
+    # Fixed cost of a call, from a grid that is small enough for the other costs to be negligible.
+    coefficients["call"] = time_call(create(simple((3, 3))[2], name="serial"), 0.5, repeats)[0]
+
+    # Serial without chunks: time = call + quad*quads + point*points.
+    rows, times = [], []
+    for n in [100, 300, 1000, 2000]:
+        for dataset in [simple, random]:
+            z = dataset((n, n))[2]
+            cont_gen = create(z, name="serial")
+            for level in [0.25, 0.5]:
+                time, points = time_call(cont_gen, level, repeats)
+                rows.append([(n-1)**2, points])
+                times.append(time - coefficients["call"])
+    fit = np.linalg.lstsq(np.asarray(rows), np.asarray(times), rcond=None)[0]
+    coefficients.update(quad=fit[0], point=fit[1])
+
+    # Serial with chunks: extra time = chunk*chunks.
+    z = random((1000, 1000))[2]
+    base = time_call(create(z, name="serial"), 0.5, repeats)[0]
+    counts = [16, 64, 256, 1024]
+    extra = [time_call(create(z, name="serial", total_chunk_count=count), 0.5, repeats)[0] - base
+             for count in counts]
+    coefficients["chunk"] = float(np.dot(counts, extra) / np.dot(counts, counts))
+
+    # Threaded: fit efficiency by grid search and thread cost by least squares.
+    thread_counts = [n for n in [2, 4, 8, 16, 32] if n <= max_threads()]
+    if thread_counts:
+        cases = []
+        for n in [300, 1000, 2000]:
+            z = random((n, n))[2]
+            serial = time_call(create(z, name="serial"), 0.5, repeats)[0]
+            work = serial - coefficients["call"]
+            for threads in thread_counts:
+                chunks = 4*threads
+                cont_gen = create(
+                    z, name="threaded", total_chunk_count=chunks, thread_count=threads)
+                time = time_call(cont_gen, 0.5, repeats)[0] - coefficients["call"]
+                cases.append((work, threads, chunks, time))
+
+        best = None
+        for efficiency in np.arange(0.3, 1.001, 0.05):
+            residual = []
+            for work, threads, chunks, time in cases:
+                speedup = 1.0 + (threads - 1)*efficiency
+                predicted = (work + coefficients["chunk"]*chunks) / speedup + 0.5*work / chunks
+                residual.append((time - predicted, threads - 1))
+            residual = np.asarray(residual)
+            thread = max(np.dot(residual[:, 0], residual[:, 1]) / np.dot(residual[:, 1],
+                                                                          residual[:, 1]), 0.0)
+            error = np.sum((residual[:, 0] - thread*residual[:, 1])**2)
+            if best is None or error < best[0]:
+                best = (error, efficiency, thread)
+        coefficients.update(efficiency=best[1], thread=best[2])
+
+    # Negative coefficients from noisy timings would make the model nonsensical.
+    return {key: max(float(value), 0.0) for key, value in coefficients.items()}
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Calibrate the cost model of name=\"auto\"")
+    parser.add_argument("--output", help="JSON file to write, default is to print the coefficients")
+    parser.add_argument("--repeats", type=int, default=5, help="repeats of each timing")
+    args = parser.parse_args()
+
+    coefficients = calibrate(args.repeats)
+    text = json.dumps(coefficients, indent=1)
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(text + "\n")
+    else:
+        print(text)
+
+
+if __name__ == "__main__":
+    main()
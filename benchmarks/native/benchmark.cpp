@@ -0,0 +1,536 @@
+// Native benchmark of the contouring kernels of the core library, free of the overhead of Python,
+// pybind11 and NumPy.  A generator derived from BaseContourGenerator, like SerialContourGenerator,
+// times each stage of the algorithm separately on synthetic data:
+//   init_cache_grid               grid-invariant bits of the cache, once per generator
+//   init_cache_levels_and_starts  z-levels and start locations of each chunk, stage 1 of a call
+//   march_chunk_pass0             counting the points and lines of each chunk
+//   march_chunk_pass1             creating and writing the points and offsets of each chunk
+//   export                        converting each chunk's arrays to the line or fill type
+//   Converter::*                  the conversion functions alone, on arrays of the same sizes
+// Stage 1 of every chunk is completed before stage 2 starts, so that the two are timed
+// separately.  With more than one thread each stage's chunks are shared between the threads, and
+// the times of each phase are summed over the threads.
+//
+// Run with --help for the options.  Results are written to stdout as JSON, or as CSV with
+// --format csv, with the min, median and mean times in seconds of each phase over the repeats.
+
+#include "base_impl.h"
+#include "buffer_output.h"
+#include "converter.h"
+#include "executor.h"
+#include "util.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+static double seconds_since(Clock::time_point start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Times in seconds and counts of the phases of the calls since the last reset.
+struct Phases
+{
+    Phases()
+        : init_cache_levels_and_starts(0.0), pass0(0.0), pass1(0.0), export_(0.0), points(0),
+          lines(0), holes(0)
+    {}
+
+    void add(const Phases& other)
+    {
+        init_cache_levels_and_starts += other.init_cache_levels_and_starts;
+        pass0 += other.pass0;
+        pass1 += other.pass1;
+        export_ += other.export_;
+        points += other.points;
+        lines += other.lines;
+        holes += other.holes;
+    }
+
+    double init_cache_levels_and_starts, pass0, pass1, export_;
+    count_t points, lines, holes;
+};
+
+// Phases of the chunks traced by the current thread, and the time that its current pass started.
+static thread_local Phases* thread_phases = nullptr;
+static thread_local Clock::time_point pass_start;
+
+class BenchmarkContourGenerator : public BaseContourGenerator<BenchmarkContourGenerator>
+{
+public:
+    BenchmarkContourGenerator(
+        const double* x, const double* y, const double* z, const bool* mask, index_t nx,
+        index_t ny, bool corner_mask, LineType line_type, FillType fill_type,
+        index_t x_chunk_size, index_t y_chunk_size, index_t n_threads)
+        : BaseContourGenerator(x, y, z, mask, nx, ny, corner_mask, line_type, fill_type, false,
+                               ZInterp::Linear, x_chunk_size, y_chunk_size),
+          _n_threads(std::max<index_t>(std::min(n_threads, get_n_chunks()), 1)),
+          _phases(new Phases())
+    {}
+
+    Phases& get_phases()
+    {
+        return *_phases;
+    }
+
+    index_t get_thread_count() const
+    {
+        return _n_threads;
+    }
+
+    // Recalculate the grid-invariant bits of the cache, returning the time taken.
+    double time_init_cache_grid(const bool* mask)
+    {
+        auto start = Clock::now();
+        init_cache_grid(mask);
+        return seconds_since(start);
+    }
+
+private:
+    friend class BaseContourGenerator<BenchmarkContourGenerator>;
+
+    // Construct a per-call context of generator, which records its phases in the generator's.
+    explicit BenchmarkContourGenerator(const BenchmarkContourGenerator* generator)
+        : BaseContourGenerator(generator),
+          _n_threads(generator->_n_threads),
+          _phases(generator->_phases)
+    {}
+
+    void march(Output& output)
+    {
+        auto n_chunks = get_n_chunks();
+        std::mutex mutex;
+
+        for (int stage = 1; stage <= 2; ++stage) {
+            index_t next_chunk = 0;
+            auto task = [&]() {
+                Phases phases;
+                thread_phases = &phases;
+                ChunkLocal local;
+                while (true) {
+                    index_t chunk;
+                    {
+                        std::lock_guard<std::mutex> guard(mutex);
+                        if (next_chunk < n_chunks)
+                            chunk = next_chunk++;
+                        else
+                            break;
+                    }
+
+                    get_chunk_limits(chunk, local);
+                    pass_start = Clock::now();
+                    if (stage == 1) {
+                        init_cache_levels_and_starts(&local);
+                        phases.init_cache_levels_and_starts += seconds_since(pass_start);
+                    }
+                    else {
+                        march_chunk(local, output);
+                        phases.export_ += seconds_since(pass_start);
+                    }
+                    local.clear();
+                }
+
+                thread_phases = nullptr;
+                std::lock_guard<std::mutex> guard(mutex);
+                _phases->add(phases);
+            };
+
+            if (_n_threads == 1)
+                task();
+            else
+                Executor::get_default()->run(_n_threads, task);
+        }
+    }
+
+    // Multiple fields are not benchmarked, but explicit instantiation needs this.
+    void march_fields(
+        const std::vector<BenchmarkContourGenerator*>& fields, Output* const* outputs)
+    {
+        for (std::size_t field = 0; field < fields.size(); ++field)
+            fields[field]->march(*outputs[field]);
+    }
+
+    // Time since the previous pass finished is that of this pass, and the remainder of the chunk
+    // after pass 1 is the export.
+    void pass_finished(const ChunkLocal& local)
+    {
+        auto now = Clock::now();
+        double elapsed = std::chrono::duration<double>(now - pass_start).count();
+        if (local.pass == 0) {
+            thread_phases->pass0 += elapsed;
+            thread_phases->points += local.total_point_count;
+            thread_phases->lines += local.line_count;
+            thread_phases->holes += local.hole_count;
+        }
+        else
+            thread_phases->pass1 += elapsed;
+        pass_start = now;
+    }
+
+    const index_t _n_threads;
+    std::shared_ptr<Phases> _phases;
+};
+
+// Explicit instantiation as in the library's generators.
+template class BaseContourGenerator<BenchmarkContourGenerator>;
+
+struct Options
+{
+    Options()
+        : nx(1000), ny(1000), dataset("simple"), mask(false), corner_mask(false),
+          filled(true), line_type(LineType::ChunkCombinedOffset),
+          fill_type(FillType::ChunkCombinedOffsetOffset), x_chunk_size(0), y_chunk_size(0),
+          n_threads(1), repeats(5), csv(false)
+    {}
+
+    index_t nx, ny;
+    std::string dataset;
+    bool mask, corner_mask, filled;
+    LineType line_type;
+    FillType fill_type;
+    index_t x_chunk_size, y_chunk_size, n_threads;
+    int repeats;
+    bool csv;
+    std::string trace;  // Filename to write Chrome trace of last call to, if any.
+};
+
+// Synthetic data in the style of contourpy.util.data: x and y are the point indices, z is either a
+// sum of gaussians or uniform random values, and the levels are those of the asv benchmarks.
+struct Data
+{
+    std::vector<double> x, y, z, levels;
+    std::vector<char> mask;  // std::vector<bool> has no data().
+};
+
+static Data create_data(const Options& options)
+{
+    auto nx = options.nx, ny = options.ny, n = nx*ny;
+    Data data;
+    data.x.resize(n);
+    data.y.resize(n);
+    data.z.resize(n);
+    if (options.mask)
+        data.mask.resize(n);
+
+    std::mt19937_64 rng(2187);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    const double amp[5] = {1.0, -1.0, 0.8, -0.9, 0.7};
+    const double mid[5][2] = {{0.4, 0.2}, {0.3, 0.8}, {0.9, 0.75}, {0.7, 0.3}, {0.05, 0.7}};
+    const double width[5] = {0.4, 0.2, 0.2, 0.2, 0.1};
+
+    for (index_t j = 0, point = 0; j < ny; ++j) {
+        for (index_t i = 0; i < nx; ++i, ++point) {
+            data.x[point] = static_cast<double>(i);
+            data.y[point] = static_cast<double>(j);
+            double xs = i / (nx - 1.0), ys = j / (ny - 1.0);
+
+            if (options.dataset == "random") {
+                data.z[point] = uniform(rng);
+                continue;
+            }
+
+            double z = 0.0;
+            for (int k = 0; k < 5; ++k) {
+                double dx = xs - mid[k][0], dy = ys - mid[k][1];
+                z += amp[k]*std::exp(-(dx*dx + dy*dy) / (width[k]*width[k]));
+            }
+            data.z[point] = z;
+            if (options.mask) {
+                double dx = xs - 0.2, dy = ys - 0.45;
+                data.mask[point] = ((xs - 1.0)*(xs - 1.0)/0.2 + ys*ys/0.1 < 1.0 ||
+                                    dx*dx/0.02 + dy*dy/0.08 < 1.0);
+            }
+        }
+    }
+
+    if (options.dataset == "random" && options.mask) {
+        for (auto& masked : data.mask)
+            masked = (uniform(rng) < 0.05);
+    }
+
+    double lowest = (options.dataset == "random") ? 0.0 : -1.0;
+    for (double level = lowest; level < 1.01; level += 0.1)
+        data.levels.push_back(level);
+    return data;
+}
+
+struct Result
+{
+    std::string phase;
+    std::vector<double> times;  // Of each repeat.
+};
+
+// Time the Converter functions on arrays of point_count points in line_count closed lines.
+static void time_converter(
+    count_t point_count, count_t line_count, int repeats, std::vector<Result>& results)
+{
+    line_count = std::max<count_t>(std::min(line_count, point_count / 2), 1);
+    point_count = std::max<count_t>(point_count, 2*line_count);
+
+    std::vector<offset_t> offsets(line_count + 1);
+    for (count_t line = 0; line <= line_count; ++line)
+        offsets[line] = static_cast<offset_t>(line*point_count/line_count);
+
+    // Each line is a closed loop around a unit circle.
+    std::vector<double> points(2*point_count);
+    for (count_t line = 0; line < line_count; ++line) {
+        count_t n = offsets[line+1] - offsets[line];
+        for (count_t k = 0; k < n; ++k) {
+            double angle = (k == n-1) ? 0.0 : 6.283185307179586*k/(n-1);
+            points[2*(offsets[line] + k)] = std::cos(angle) + line;
+            points[2*(offsets[line] + k) + 1] = std::sin(angle);
+        }
+    }
+
+    std::vector<double> points_out(2*point_count);
+    std::vector<uint8_t> codes(point_count);
+    std::vector<offset_t> offsets_out(line_count + 1);
+
+    Result convert_points{"Converter::convert_points", {}};
+    Result convert_offsets{"Converter::convert_offsets", {}};
+    Result convert_codes{"Converter::convert_codes", {}};
+    Result check_closed{"Converter::convert_codes_check_closed", {}};
+    for (int repeat = 0; repeat < repeats; ++repeat) {
+        auto start = Clock::now();
+        Converter::convert_points(point_count, points.data(), points_out.data());
+        convert_points.times.push_back(seconds_since(start));
+
+        start = Clock::now();
+        Converter::convert_offsets(line_count + 1, offsets.data(), 0, offsets_out.data());
+        convert_offsets.times.push_back(seconds_since(start));
+
+        start = Clock::now();
+        Converter::convert_codes(point_count, line_count + 1, offsets.data(), 0, codes.data());
+        convert_codes.times.push_back(seconds_since(start));
+
+        start = Clock::now();
+        Converter::convert_codes_check_closed(
+            point_count, line_count + 1, offsets.data(), points.data(), codes.data());
+        check_closed.times.push_back(seconds_since(start));
+    }
+
+    results.push_back(convert_points);
+    results.push_back(convert_offsets);
+    results.push_back(convert_codes);
+    results.push_back(check_closed);
+}
+
+static void print_help()
+{
+    std::cout <<
+        "Usage: contourpy_benchmark [options]\n"
+        "  --size N or NXxNY      grid size, default 1000\n"
+        "  --dataset NAME         simple or random, default simple\n"
+        "  --mask                 mask the data, as in the asv benchmarks\n"
+        "  --corner-mask          use corner_mask with --mask\n"
+        "  --lines                contour lines rather than filled contours\n"
+        "  --line-type N          LineType value, default 104 (ChunkCombinedOffset)\n"
+        "  --fill-type N          FillType value, default 206 (ChunkCombinedOffsetOffset)\n"
+        "  --chunk-size N or XxY  chunk size, default 0 for a single chunk\n"
+        "  --threads N            threads, 0 for the maximum, default 1\n"
+        "  --repeats N            repeats of each measurement, default 5\n"
+        "  --format FORMAT        json or csv, default json\n"
+        "  --trace FILE           write a Chrome trace of the last call to FILE\n";
+}
+
+// Parse "N" or "NXxNY" into a pair of sizes.
+static bool parse_size(const char* arg, index_t& x, index_t& y)
+{
+    char* end;
+    x = y = std::strtol(arg, &end, 10);
+    if (*end == 'x')
+        y = std::strtol(end + 1, &end, 10);
+    return *end == '\0' && x >= 0 && y >= 0;
+}
+
+static bool parse_args(int argc, char** argv, Options& options)
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const char* value = (i+1 < argc) ? argv[i+1] : nullptr;
+        bool ok = true;
+
+        if (arg == "--mask")
+            options.mask = true;
+        else if (arg == "--corner-mask")
+            options.corner_mask = true;
+        else if (arg == "--lines")
+            options.filled = false;
+        else if (arg == "--help") {
+            print_help();
+            std::exit(0);
+        }
+        else if (value == nullptr)
+            ok = false;
+        else {
+            ++i;
+            if (arg == "--size")
+                ok = parse_size(value, options.nx, options.ny) && options.nx > 1 && options.ny > 1;
+            else if (arg == "--dataset") {
+                options.dataset = value;
+                ok = (options.dataset == "simple" || options.dataset == "random");
+            }
+            else if (arg == "--line-type") {
+                options.line_type = static_cast<LineType>(std::atoi(value));
+                ok = BenchmarkContourGenerator::supports_line_type(options.line_type);
+            }
+            else if (arg == "--fill-type") {
+                options.fill_type = static_cast<FillType>(std::atoi(value));
+                ok = BenchmarkContourGenerator::supports_fill_type(options.fill_type);
+            }
+            else if (arg == "--chunk-size")
+                ok = parse_size(value, options.x_chunk_size, options.y_chunk_size);
+            else if (arg == "--threads")
+                ok = (options.n_threads = std::atoi(value)) >= 0;
+            else if (arg == "--repeats")
+                ok = (options.repeats = std::atoi(value)) > 0;
+            else if (arg == "--trace")
+                options.trace = value;
+            else if (arg == "--format") {
+                options.csv = (std::strcmp(value, "csv") == 0);
+                ok = options.csv || std::strcmp(value, "json") == 0;
+            }
+            else
+                ok = false;
+        }
+
+        if (!ok) {
+            std::cerr << "Invalid argument " << arg << "\n";
+            return false;
+        }
+    }
+
+    if (options.n_threads == 0)
+        options.n_threads = std::max<index_t>(Util::get_max_threads(), 1);
+    return true;
+}
+
+static void stats(std::vector<double> times, double& min, double& median, double& mean)
+{
+    std::sort(times.begin(), times.end());
+    auto n = times.size();
+    min = times[0];
+    median = (n % 2 == 1) ? times[n/2] : 0.5*(times[n/2 - 1] + times[n/2]);
+    mean = 0.0;
+    for (auto time : times)
+        mean += time;
+    mean /= n;
+}
+
+static void write_results(
+    const Options& options, index_t n_threads, const Data& data, const Phases& counts,
+    const std::vector<Result>& results)
+{
+    double min, median, mean;
+    char buffer[256];
+
+    if (options.csv) {
+        std::cout << "phase,min,median,mean\n";
+        for (auto& result : results) {
+            stats(result.times, min, median, mean);
+            std::snprintf(buffer, sizeof(buffer), "%s,%.9g,%.9g,%.9g\n", result.phase.c_str(),
+                          min, median, mean);
+            std::cout << buffer;
+        }
+        return;
+    }
+
+    std::cout
+        << "{\n  \"config\": {\"nx\": " << options.nx << ", \"ny\": " << options.ny
+        << ", \"dataset\": \"" << options.dataset << "\", \"mask\": "
+        << (options.mask ? "true" : "false") << ", \"corner_mask\": "
+        << (options.corner_mask ? "true" : "false") << ", \"filled\": "
+        << (options.filled ? "true" : "false") << ", \"line_type\": "
+        << static_cast<int>(options.line_type) << ", \"fill_type\": "
+        << static_cast<int>(options.fill_type) << ", \"x_chunk_size\": " << options.x_chunk_size
+        << ", \"y_chunk_size\": " << options.y_chunk_size << ", \"threads\": " << n_threads
+        << ", \"levels\": " << data.levels.size() << ", \"repeats\": " << options.repeats
+        << "},\n  \"counts\": {\"points\": " << counts.points << ", \"lines\": " << counts.lines
+        << ", \"holes\": " << counts.holes << "},\n  \"phases\": [\n";
+
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        stats(results[i].times, min, median, mean);
+        std::snprintf(
+            buffer, sizeof(buffer),
+            "    {\"phase\": \"%s\", \"min\": %.9g, \"median\": %.9g, \"mean\": %.9g}%s\n",
+            results[i].phase.c_str(), min, median, mean,
+            i+1 < results.size() ? "," : "");
+        std::cout << buffer;
+    }
+    std::cout << "  ]\n}\n";
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parse_args(argc, argv, options))
+        return 1;
+
+    auto data = create_data(options);
+    auto mask = options.mask ? reinterpret_cast<const bool*>(data.mask.data()) : nullptr;
+
+    try {
+        BenchmarkContourGenerator generator(
+            data.x.data(), data.y.data(), data.z.data(), mask, options.nx, options.ny,
+            options.corner_mask, options.line_type, options.fill_type, options.x_chunk_size,
+            options.y_chunk_size, options.n_threads);
+        generator.set_collect_stats(!options.trace.empty());
+
+        Result init_cache_grid{"init_cache_grid", {}};
+        Result init_cache_levels_and_starts{"init_cache_levels_and_starts", {}};
+        Result pass0{"march_chunk_pass0", {}}, pass1{"march_chunk_pass1", {}};
+        Result export_{"export", {}}, call{"total", {}};
+        Phases counts;
+
+        // Each repeat contours all of the levels, or each pair of consecutive levels if filled.
+        for (int repeat = 0; repeat < options.repeats; ++repeat) {
+            init_cache_grid.times.push_back(generator.time_init_cache_grid(mask));
+
+            auto& phases = generator.get_phases();
+            phases = Phases();
+            BufferOutput output;
+            auto start = Clock::now();
+            for (std::size_t i = 0; i < data.levels.size(); ++i) {
+                if (!options.filled)
+                    generator.lines(data.levels[i], output);
+                else if (i > 0)
+                    generator.filled(data.levels[i-1], data.levels[i], output);
+            }
+            call.times.push_back(seconds_since(start));
+
+            init_cache_levels_and_starts.times.push_back(phases.init_cache_levels_and_starts);
+            pass0.times.push_back(phases.pass0);
+            pass1.times.push_back(phases.pass1);
+            export_.times.push_back(phases.export_);
+            counts = phases;
+        }
+
+        std::vector<Result> results = {
+            init_cache_grid, init_cache_levels_and_starts, pass0, pass1, export_, call};
+        time_converter(counts.points, counts.lines, options.repeats, results);
+        write_results(options, generator.get_thread_count(), data, counts, results);
+
+        if (!options.trace.empty()) {
+            std::ofstream trace(options.trace);
+            generator.get_last_call_stats()->write_chrome_trace(trace);
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
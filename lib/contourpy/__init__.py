@@ -2,16 +2,28 @@ import numpy as np
 
 from ._contourpy import (
     ContourGenerator, FillType, LineType, Mpl2005ContourGenerator, Mpl2014ContourGenerator,
-    SerialContourGenerator, ThreadedContourGenerator, ZInterp, max_threads,
+    SerialContourGenerator, ThreadedContourGenerator, TriContourGenerator, ZInterp, get_huge_pages,
+    max_threads, set_executor, set_huge_pages,
 )
 from ._version import __version__
 from .chunk import calc_chunk_sizes
+from .cost import choose_algorithm
 from .enum_util import as_fill_type, as_line_type, as_z_interp
+from .shared import attach_generator, share_generator
+from .state import load_generator, save_generator
+from .tune import auto_tune as _auto_tune
 
 __all__ = [
     "__version__",
+    "attach_generator",
     "contour_generator",
+    "get_huge_pages",
+    "load_generator",
     "max_threads",
+    "save_generator",
+    "set_executor",
+    "set_huge_pages",
+    "share_generator",
     "FillType",
     "LineType",
     "ContourGenerator",
@@ -19,6 +31,7 @@ __all__ = [
     "Mpl2014ContourGenerator",
     "SerialContourGenerator",
     "ThreadedContourGenerator",
+    "TriContourGenerator",
     "ZInterp",
 ]
 
@@ -47,7 +60,8 @@ def _remove_z_mask(z):
 
 def contour_generator(x=None, y=None, z=None, *, name="serial", corner_mask=None, line_type=None,
                       fill_type=None, chunk_size=None, chunk_count=None, total_chunk_count=None,
-                      quad_as_tri=False, z_interp=ZInterp.Linear, thread_count=0):
+                      quad_as_tri=False, z_interp=ZInterp.Linear, thread_count=0,
+                      auto_tune=False):
     """Create and return a contour generator object.
 
     The class and properties of the contour generator are determined by the function arguments,
@@ -63,8 +77,9 @@ def contour_generator(x=None, y=None, z=None, *, name="serial", corner_mask=None
         z (array-like of shape (ny, nx), may be a masked array): The 2D gridded values to calculate
             the contours of.  May be a masked array, and any invalid values (``np.inf`` or
             ``np.nan``) will also be masked out.
-        name (str): Algorithm name, one of ``"serial"``, ``"threaded"``, ``"mpl2005"`` or
-            ``"mpl2014"``, default ``"serial"``.
+        name (str): Algorithm name, one of ``"serial"``, ``"threaded"``, ``"mpl2005"``,
+            ``"mpl2014"`` or ``"auto"``, default ``"serial"``.  ``"auto"`` chooses between
+            ``"serial"`` and ``"threaded"`` and the chunk layout using a cost model.
         corner_mask (bool, optional): Enable/disable corner masking, which only has an effect if
             ``z`` is a masked array. If ``False``, any quad touching a masked point is masked out.
             If ``True``, only the triangular corners of quads nearest these points are always masked
@@ -91,20 +106,21 @@ def contour_generator(x=None, y=None, z=None, *, name="serial", corner_mask=None
             intersect the edges of quads and the ``z`` values of the central points of quads,
             default ``ZInterp.Linear``.
         thread_count (int): Number of threads to use for contour calculation, default 0. Threads can
-            only be used with an algorithm ``name`` that supports threads (currently only
-            ``name="threaded"``) and there must be at least the same number of chunks as threads.
-            If ``thread_count=0`` and ``name="threaded"`` then it uses the maximum number of threads
-            as determined by the C++11 call ``std::thread::hardware_concurrency()``.
+            only be used with an algorithm ``name`` that supports threads (``name="threaded"`` or
+            ``name="mpl2005"``) and there must be at least the same number of chunks as threads.
+            If ``thread_count=0`` and the algorithm supports threads then it uses the maximum number
+            of threads as determined by the C++11 call ``std::thread::hardware_concurrency()``.
+        auto_tune (bool): Choose the chunk sizes, and the thread count if ``thread_count=0`` and the
+            algorithm supports threads, by timing trial marches of ``z``, default ``False``. The
+            choice is cached on disk for the grid shape, CPU model and other options so that later
+            generators of the same shape are created without repeating the trials.
 
     Return:
         :class:`~contourpy._contourpy.ContourGenerator`.
 
     Note:
         A maximum of one of ``chunk_size``, ``chunk_count`` and ``total_chunk_count`` may be
-        specified.
-
-    Warning:
-        The ``name="mpl2005"`` algorithm does not implement chunking for contour lines.
+        specified, and none of them if ``auto_tune=True``.
     """
     x = np.asarray(x, dtype=np.float64)
     y = np.asarray(y, dtype=np.float64)
@@ -146,10 +162,24 @@ def contour_generator(x=None, y=None, z=None, *, name="serial", corner_mask=None
         raise ValueError("If mask is set it must be a 2D array with the same shape as z")
 
     # Check arguments: name.
+    if name == "auto":
+        name, y_chunk_size, x_chunk_size, auto_thread_count = choose_algorithm(
+            z, mask, chunk_size=chunk_size, chunk_count=chunk_count,
+            total_chunk_count=total_chunk_count, thread_count=thread_count)
+        if not auto_tune:
+            chunk_size = (y_chunk_size, x_chunk_size)
+            chunk_count = total_chunk_count = None
+            thread_count = auto_thread_count
+
     if name not in _class_lookup:
         raise ValueError(f"Unrecognised contour generator name: {name}")
 
     # Check arguments: chunk_size, chunk_count and total_chunk_count.
+    if auto_tune and (
+            chunk_size is not None or chunk_count is not None or total_chunk_count is not None):
+        raise ValueError(
+            "chunk_size, chunk_count and total_chunk_count cannot be set if auto_tune=True")
+
     y_chunk_size, x_chunk_size = calc_chunk_sizes(
         chunk_size, chunk_count, total_chunk_count, ny, nx)
 
@@ -200,14 +230,12 @@ def contour_generator(x=None, y=None, z=None, *, name="serial", corner_mask=None
     # Prepare args and kwargs for contour generator constructor.
     args = [x, y, z, mask]
     kwargs = {
+        "line_type": line_type,
+        "fill_type": fill_type,
         "x_chunk_size": x_chunk_size,
         "y_chunk_size": y_chunk_size,
     }
 
-    if name not in ("mpl2005", "mpl2014"):
-        kwargs["line_type"] = line_type
-        kwargs["fill_type"] = fill_type
-
     if cls.supports_corner_mask():
         kwargs["corner_mask"] = corner_mask
 
@@ -220,6 +248,16 @@ def contour_generator(x=None, y=None, z=None, *, name="serial", corner_mask=None
     if cls.supports_threads():
         kwargs["thread_count"] = thread_count
 
+    if auto_tune:
+        y_chunk_size, x_chunk_size, tuned_thread_count = _auto_tune(
+            cls, x, y, z, mask, kwargs.get("thread_count", 0),
+            {key: value for key, value in kwargs.items()
+             if key not in ("x_chunk_size", "y_chunk_size", "thread_count")})
+        kwargs["x_chunk_size"] = x_chunk_size
+        kwargs["y_chunk_size"] = y_chunk_size
+        if cls.supports_threads():
+            kwargs["thread_count"] = tuned_thread_count
+
     # Create contour generator.
     cont_gen = cls(*args, **kwargs)
 
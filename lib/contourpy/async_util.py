@@ -0,0 +1,40 @@
+from concurrent.futures import ThreadPoolExecutor
+import os
+import threading
+
+from ._contourpy import max_threads
+
+_executor = None
+_executor_lock = threading.Lock()
+
+
+def _reset_executor():
+    # A child process created by fork() does not have the threads of the parent's executor.
+    global _executor
+    _executor = None
+
+
+if hasattr(os, "register_at_fork"):
+    os.register_at_fork(after_in_child=_reset_executor)
+
+
+def submit_async(func, *args):
+    """Call a function on a background thread.
+
+    Used to implement the ``lines_async`` and ``filled_async`` methods of ContourGenerators. The
+    background threads are shared by all ContourGenerators and are created when first needed.
+
+    Args:
+        func (callable): Function to call.
+        args: Positional arguments to pass to ``func``.
+
+    Return:
+        concurrent.futures.Future: Future for the result of the function call.
+    """
+    global _executor
+    with _executor_lock:
+        if _executor is None:
+            _executor = ThreadPoolExecutor(
+                max_workers=max(max_threads(), 1), thread_name_prefix="contourpy")
+        executor = _executor
+    return executor.submit(func, *args)
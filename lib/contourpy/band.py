@@ -0,0 +1,129 @@
+import numpy as np
+
+from ._contourpy import FillType, LineType
+from .block import block_filled, block_lines, merge_filled, merge_lines
+from .enum_util import as_fill_type, as_line_type
+
+
+def _read_rows(array, j0, j1, nx, axis):
+    # Read rows j0 to j1 inclusive of a 2D array-like or callable, or of a 1D array of x (axis=1)
+    # or y (axis=0) coordinates.
+    if callable(array):
+        return array(j0, j1+1)
+    elif np.ndim(array) == 1:
+        if axis == 1:
+            return np.broadcast_to(np.asarray(array, dtype=np.float64), (j1+1-j0, nx))
+        else:
+            y = np.asarray(array[j0:j1+1], dtype=np.float64)
+            return np.broadcast_to(y[:, np.newaxis], (j1+1-j0, nx))
+    else:
+        return array[j0:j1+1]
+
+
+def _bands(z, x, y, shape, band_size, kwargs):
+    # Yield the global offset and the x, y and z rows of each band, neighbouring bands overlap by
+    # one row.
+    for key in ("chunk_size", "chunk_count", "total_chunk_count"):
+        if key in kwargs:
+            raise ValueError(f"{key} cannot be used with bands")
+    if band_size < 1:
+        raise ValueError("band_size must be a positive integer")
+
+    if shape is None:
+        if callable(z):
+            raise ValueError("shape must be specified if z is a callable")
+        shape = z.shape
+    ny, nx = shape
+    if x is None:
+        x = np.arange(nx, dtype=np.float64)
+    if y is None:
+        y = np.arange(ny, dtype=np.float64)
+
+    for j0 in range(0, ny-1, band_size):
+        j1 = min(j0 + band_size, ny-1)
+        yield ((j0, 0), _read_rows(x, j0, j1, nx, 1), _read_rows(y, j0, j1, nx, 0),
+               _read_rows(z, j0, j1, nx, None))
+
+
+def banded_lines(z, levels, *, x=None, y=None, shape=None, band_size=256, line_type=None,
+                 **kwargs):
+    """Calculate contour lines of a grid that is processed in bands of rows.
+
+    Only one band of ``band_size`` rows of ``x``, ``y`` and ``z`` is read at a time, and only the
+    contour generator for that band exists at any one time, so memory use is proportional to
+    ``nx*band_size`` rather than ``nx*ny`` plus the size of the returned contour lines.  This allows
+    contouring of grids that are too large to fit in memory, such as NumPy memory-mapped arrays.
+    Neighbouring bands overlap by one row and contour lines that cross between bands are joined.
+
+    Args:
+        z (array-like of shape (ny, nx) or callable): The 2D gridded values to calculate the
+            contours of.  Either an object that supports slicing of rows such as a
+            ``numpy.memmap``, or a callable ``z(start, stop)`` that returns rows ``start`` to
+            ``stop-1`` inclusive as an array of shape ``(stop-start, nx)``.  Invalid values
+            (``np.inf`` or ``np.nan``) and masked values are masked out.
+        levels (sequence of float): z-levels to calculate contours at.
+        x (array-like of shape (ny, nx) or (nx,) or callable, optional): The x-coordinates of the
+            ``z`` values, in the same format as ``z`` or 1D.  If not specified are assumed to be
+            ``np.arange(nx)``.
+        y (array-like of shape (ny, nx) or (ny,) or callable, optional): The y-coordinates of the
+            ``z`` values, in the same format as ``z`` or 1D.  If not specified are assumed to be
+            ``np.arange(ny)``.
+        shape (tuple(int, int), optional): Shape ``(ny, nx)`` of the grid, only required if ``z``
+            is a callable.
+        band_size (int): Number of rows of quads in each band, default 256.
+        line_type (LineType, optional): ``LineType.Separate`` or ``LineType.SeparateCode``, default
+            ``LineType.Separate``.
+        kwargs: Other keyword arguments passed to :func:`~contourpy.contour_generator` for each
+            band, which may be any of ``name``, ``corner_mask``, ``quad_as_tri`` and ``z_interp``.
+
+    Return:
+        list: Contour lines at each level in the format specified by ``line_type``.
+    """
+    line_type = LineType.Separate if line_type is None else as_line_type(line_type)
+    if line_type not in (LineType.Separate, LineType.SeparateCode):
+        raise ValueError(f"banded_lines does not support line_type {line_type}")
+
+    # Each band is contoured as a block of the grid, only the lines that end on a row shared with
+    # another band are joined.
+    blocks = [block_lines(band_z, levels, x=band_x, y=band_y, offset=offset, **kwargs)
+              for offset, band_x, band_y, band_z in _bands(z, x, y, shape, band_size, kwargs)]
+    return merge_lines(blocks, line_type)
+
+
+def banded_filled(z, levels, *, x=None, y=None, shape=None, band_size=256, fill_type=None,
+                  **kwargs):
+    """Calculate filled contours of a grid that is processed in bands of rows.
+
+    This is the filled contour equivalent of :func:`~contourpy.band.banded_lines`.  Filled contour
+    polygons that cross between bands are merged.
+
+    Args:
+        z (array-like of shape (ny, nx) or callable): The 2D gridded values, as for
+            :func:`~contourpy.band.banded_lines`.
+        levels (sequence of float): z-levels, filled contours are calculated between each pair of
+            consecutive levels.
+        x (array-like of shape (ny, nx) or (nx,) or callable, optional): The x-coordinates of the
+            ``z`` values.
+        y (array-like of shape (ny, nx) or (ny,) or callable, optional): The y-coordinates of the
+            ``z`` values.
+        shape (tuple(int, int), optional): Shape ``(ny, nx)`` of the grid, only required if ``z``
+            is a callable.
+        band_size (int): Number of rows of quads in each band, default 256.
+        fill_type (FillType, optional): ``FillType.OuterCode`` or ``FillType.OuterOffset``, default
+            ``FillType.OuterOffset``.
+        kwargs: Other keyword arguments passed to :func:`~contourpy.contour_generator` for each
+            band, which may be any of ``name``, ``corner_mask``, ``quad_as_tri`` and ``z_interp``.
+
+    Return:
+        list: Filled contours between each pair of consecutive levels in the format specified by
+        ``fill_type``.
+    """
+    fill_type = FillType.OuterOffset if fill_type is None else as_fill_type(fill_type)
+    if fill_type not in (FillType.OuterCode, FillType.OuterOffset):
+        raise ValueError(f"banded_filled does not support fill_type {fill_type}")
+
+    # Each band is contoured as a block of the grid, only the polygons with points on a row shared
+    # with another band are merged.
+    blocks = [block_filled(band_z, levels, x=band_x, y=band_y, offset=offset, **kwargs)
+              for offset, band_x, band_y, band_z in _bands(z, x, y, shape, band_size, kwargs)]
+    return merge_filled(blocks, fill_type)
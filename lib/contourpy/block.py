@@ -0,0 +1,318 @@
+from typing import NamedTuple
+
+import numpy as np
+
+from . import contour_generator
+from ._contourpy import FillType, LineType
+from .chunk import calc_chunk_sizes
+from .enum_util import as_fill_type, as_line_type
+from .stitch import (
+    _format_filled, _format_lines, _line_ends, _split_polygons, stitch_filled, stitch_lines,
+)
+
+
+class BlockContours(NamedTuple):
+    """Contours of one block of a larger grid, as returned by :func:`~contourpy.block.block_lines`
+    and :func:`~contourpy.block.block_filled`.
+
+    Attributes:
+        offset (tuple(int, int)): Global ``(j, i)`` index of the first point of the block.
+        shape (tuple(int, int)): Shape ``(ny, nx)`` of the block, including the halo.
+        levels (tuple of float): Levels that were contoured.
+        contours (list): Contour lines at each level, or filled contour polygons between each pair
+            of consecutive levels.  Each line is an array of shape (npoints, 2), and each polygon
+            is a list of such arrays of which the first is the outer boundary and any others are
+            holes.
+        crossings (list of arrays): Boundary crossing descriptors at each level, or between each
+            pair of consecutive levels.  Each row describes a point on the boundary of the block.
+            For contour lines the columns are the line index, ``0`` for the start or ``1`` for the
+            end of the line, ``0`` if the point is on a row or ``1`` if it is on a column of the
+            global grid, and the global index of that row or column.  For filled contours the
+            columns are the same except that the second is the index of the point in the outer
+            boundary of the polygon.
+    """
+    offset: tuple
+    shape: tuple
+    levels: tuple
+    contours: list
+    crossings: list
+
+
+def block_slices(shape, *, chunk_size=None, chunk_count=None, total_chunk_count=None):
+    """Divide a grid into blocks that can be contoured independently.
+
+    The blocks are the same as the chunks of a contour generator created with the same chunk
+    arguments.  Each block includes a one-point halo along its north and east sides that is the
+    first row or column of its neighbour, so that together the blocks contain every quad of the
+    grid exactly once.
+
+    Args:
+        shape (tuple(int, int)): Shape ``(ny, nx)`` of the grid.
+        chunk_size (int or tuple(int, int), optional): Block size in (y, x) directions in quads.
+        chunk_count (int or tuple(int, int), optional): Block count in (y, x) directions.
+        total_chunk_count (int, optional): Total number of blocks.
+
+    Return:
+        list of tuples: ``(offset, slices)`` of each block, where ``offset`` is the global
+        ``(j, i)`` index of the first point of the block and ``slices`` is a tuple of two slices
+        that extracts the block, including its halo, from the 2D ``z``, ``x`` and ``y`` arrays.
+    """
+    ny, nx = shape
+    y_chunk_size, x_chunk_size = calc_chunk_sizes(
+        chunk_size, chunk_count, total_chunk_count, ny, nx)
+    if y_chunk_size == 0:
+        y_chunk_size = ny-1
+    if x_chunk_size == 0:
+        x_chunk_size = nx-1
+
+    ret = []
+    for j0 in range(0, ny-1, y_chunk_size):
+        j1 = min(j0 + y_chunk_size, ny-1)
+        for i0 in range(0, nx-1, x_chunk_size):
+            i1 = min(i0 + x_chunk_size, nx-1)
+            ret.append(((j0, i0), (slice(j0, j1+1), slice(i0, i1+1))))
+    return ret
+
+
+def _block_generator(z, x, y, offset, kwargs):
+    for key in ("chunk_size", "chunk_count", "total_chunk_count"):
+        if key in kwargs:
+            raise ValueError(f"{key} cannot be used with blocks")
+    ny, nx = np.shape(z)
+    if x is None:
+        x = np.arange(offset[1], offset[1] + nx, dtype=np.float64)
+    if y is None:
+        y = np.arange(offset[0], offset[0] + ny, dtype=np.float64)
+    cont_gen = contour_generator(x, y, z, **kwargs)
+    x = np.asarray(x, dtype=np.float64)
+    y = np.asarray(y, dtype=np.float64)
+    if x.ndim == 1:
+        x, y = np.meshgrid(x, y)
+    return cont_gen, x, y
+
+
+def _boundary_crossings(points, x, y, offset, rtol=1e-10):
+    # Find which of the points lie on the boundary of the block.  Returns an array with a row for
+    # each point and side of the block that it lies on, with columns of point index, row (0) or
+    # column (1), and global index of that row or column.
+    j0, i0 = offset
+    ny, nx = x.shape
+    sides = (
+        (x[0], y[0], 0, j0), (x[-1], y[-1], 0, j0+ny-1),
+        (x[:, 0], y[:, 0], 1, i0), (x[:, -1], y[:, -1], 1, i0+nx-1))
+    tol = max(rtol*max(np.abs(x).max(), np.abs(y).max()), np.finfo(np.float64).tiny)
+
+    ret = []
+    for side_x, side_y, orientation, index in sides:
+        # Candidate points are those within the bounding box of the side.
+        candidates = np.flatnonzero(
+            (points[:, 0] >= side_x.min() - tol) & (points[:, 0] <= side_x.max() + tol) &
+            (points[:, 1] >= side_y.min() - tol) & (points[:, 1] <= side_y.max() + tol))
+        if len(candidates) == 0:
+            continue
+        # Sorted along the side, so that each group of candidates is only compared with the
+        # segments of the side that are near it.
+        axis = 0 if np.ptp(side_x) >= np.ptp(side_y) else 1
+        candidates = candidates[np.argsort(points[candidates, axis], kind="stable")]
+        ax, ay = side_x[:-1], side_y[:-1]
+        ex, ey = side_x[1:] - ax, side_y[1:] - ay
+        length2 = ex*ex + ey*ey
+        length2[length2 == 0.0] = 1.0
+        segment_min = np.minimum(side_x[:-1], side_x[1:]), np.minimum(side_y[:-1], side_y[1:])
+        segment_max = np.maximum(side_x[:-1], side_x[1:]), np.maximum(side_y[:-1], side_y[1:])
+        for group in np.array_split(candidates, max(1, len(candidates) // 64)):
+            group_x, group_y = points[group, 0], points[group, 1]
+            near = np.flatnonzero(
+                (segment_max[0] >= group_x.min() - tol) & (segment_min[0] <= group_x.max() + tol) &
+                (segment_max[1] >= group_y.min() - tol) & (segment_min[1] <= group_y.max() + tol))
+            if len(near) == 0:
+                continue
+            dx = group_x[:, np.newaxis] - ax[near]
+            dy = group_y[:, np.newaxis] - ay[near]
+            t = np.clip((dx*ex[near] + dy*ey[near]) / length2[near], 0.0, 1.0)
+            distance = np.hypot(dx - t*ex[near], dy - t*ey[near])
+            on_side = group[np.min(distance, axis=1) <= tol]
+            ret.append(np.column_stack((
+                on_side, np.full_like(on_side, orientation), np.full_like(on_side, index))))
+    return np.concatenate(ret).astype(np.int64) if ret else np.empty((0, 3), dtype=np.int64)
+
+
+def block_lines(z, levels, *, x=None, y=None, offset=(0, 0), **kwargs):
+    """Calculate contour lines of one block of a larger grid.
+
+    This is intended for distributed execution, for example using ``dask``, in which each block
+    of the grid is contoured by a different worker and the results are combined using
+    :func:`~contourpy.block.merge_lines`.  Neighbouring blocks must share their common row or
+    column of points, which :func:`~contourpy.block.block_slices` arranges by giving each block a
+    one-point halo along its north and east sides.
+
+    Args:
+        z (array-like of shape (ny, nx)): z-values of the block including its halo.  May be a
+            masked array.
+        levels (sequence of float): z-levels to calculate contours at.
+        x (array-like of shape (ny, nx) or (nx,), optional): The x-coordinates of the block.  If
+            not specified are assumed to be the global column indices.
+        y (array-like of shape (ny, nx) or (ny,), optional): The y-coordinates of the block.  If
+            not specified are assumed to be the global row indices.
+        offset (tuple(int, int)): Global ``(j, i)`` index of the first point of the block.
+        kwargs: Other keyword arguments passed to :func:`~contourpy.contour_generator`, which may
+            be any of ``name``, ``corner_mask``, ``quad_as_tri`` and ``z_interp``.
+
+    Return:
+        BlockContours: Contour lines of the block and the points where they end on the boundary
+        of the block.
+    """
+    # LineType.SeparateCode is supported by all algorithms.
+    kwargs["line_type"] = LineType.SeparateCode
+    cont_gen, x, y = _block_generator(z, x, y, offset, kwargs)
+
+    contours = []
+    crossings = []
+    for level in levels:
+        lines = cont_gen.lines(level)[0]
+        # Lines of zero length are included as they may be where a line of a neighbouring block
+        # crosses the boundary at a grid point.
+        starts, ends, zero_length = _line_ends(lines)
+        open_lines = np.flatnonzero(np.any(starts != ends, axis=1) | zero_length)
+        end_points = np.concatenate((starts[open_lines], ends[open_lines]))
+        level_crossings = _boundary_crossings(end_points, x, y, offset)
+        point = level_crossings[:, 0]
+        level_crossings = np.column_stack((
+            np.tile(open_lines, 2)[point], np.repeat([0, 1], len(open_lines))[point],
+            level_crossings[:, 1:]))
+        contours.append(lines)
+        crossings.append(level_crossings)
+
+    return BlockContours(tuple(offset), np.shape(z), tuple(levels), contours, crossings)
+
+
+def block_filled(z, levels, *, x=None, y=None, offset=(0, 0), **kwargs):
+    """Calculate filled contours of one block of a larger grid.
+
+    This is the filled contour equivalent of :func:`~contourpy.block.block_lines`, and the results
+    are combined using :func:`~contourpy.block.merge_filled`.
+
+    Args:
+        z (array-like of shape (ny, nx)): z-values of the block including its halo.  May be a
+            masked array.
+        levels (sequence of float): z-levels, filled contours are calculated between each pair of
+            consecutive levels.
+        x (array-like of shape (ny, nx) or (nx,), optional): The x-coordinates of the block.
+        y (array-like of shape (ny, nx) or (ny,), optional): The y-coordinates of the block.
+        offset (tuple(int, int)): Global ``(j, i)`` index of the first point of the block.
+        kwargs: Other keyword arguments passed to :func:`~contourpy.contour_generator`, which may
+            be any of ``name``, ``corner_mask``, ``quad_as_tri`` and ``z_interp``.
+
+    Return:
+        BlockContours: Filled contour polygons of the block and the points of their outer
+        boundaries that are on the boundary of the block.
+    """
+    # FillType.OuterCode is supported by all algorithms.
+    kwargs["fill_type"] = FillType.OuterCode
+    cont_gen, x, y = _block_generator(z, x, y, offset, kwargs)
+
+    contours = []
+    crossings = []
+    for lower_level, upper_level in zip(levels[:-1], levels[1:]):
+        polygons = _split_polygons(*cont_gen.filled(lower_level, upper_level))
+        outer_points = [polygon[0][:-1] for polygon in polygons]
+        counts = [len(points) for points in outer_points]
+        points = np.concatenate(outer_points) if outer_points else np.empty((0, 2))
+        level_crossings = _boundary_crossings(points, x, y, offset)
+        point = level_crossings[:, 0]
+        polygon = np.repeat(np.arange(len(polygons)), counts)[point]
+        offsets = np.concatenate(([0], np.cumsum(counts, dtype=np.int64)))
+        level_crossings = np.column_stack((
+            polygon, point - offsets[polygon], level_crossings[:, 1:]))
+        contours.append(polygons)
+        crossings.append(np.unique(level_crossings, axis=0))
+
+    return BlockContours(tuple(offset), np.shape(z), tuple(levels), contours, crossings)
+
+
+def _merge(blocks, stitch, seam_points=False):
+    # Stitch together the contours of all blocks that cross boundaries shared with another block,
+    # the others are returned unchanged.  If seam_points is True the second column of crossings,
+    # the index of the point of each outer boundary on a shared boundary, is passed to stitch too.
+    if not blocks:
+        return []
+    levels = blocks[0].levels
+    if any(block.levels != levels for block in blocks):
+        raise ValueError("All blocks must have been contoured at the same levels")
+
+    # Rows and columns of the global grid that are shared by blocks, excluding its boundary.
+    ny = max(block.offset[0] + block.shape[0] for block in blocks)
+    nx = max(block.offset[1] + block.shape[1] for block in blocks)
+    shared = [set(), set()]
+    for block in blocks:
+        (j0, i0), (block_ny, block_nx) = block.offset, block.shape
+        shared[0].update((j0, j0 + block_ny - 1))
+        shared[1].update((i0, i0 + block_nx - 1))
+    shared[0] = list(shared[0] - {0, ny-1})
+    shared[1] = list(shared[1] - {0, nx-1})
+
+    ret = []
+    for k in range(len(blocks[0].contours)):
+        merged = []
+        boundary = []
+        seams = []
+        for block in blocks:
+            # Orientation and index are the last two columns of both line and filled crossings.
+            crossings = block.crossings[k]
+            on_shared = \
+                ((crossings[:, -2] == 0) & np.isin(crossings[:, -1], shared[0])) | \
+                ((crossings[:, -2] == 1) & np.isin(crossings[:, -1], shared[1]))
+            crossings = crossings[on_shared]
+            crossings = crossings[np.argsort(crossings[:, 0], kind="stable")]
+            crossing, first = np.unique(crossings[:, 0], return_index=True)
+            boundary.append([block.contours[k][i] for i in crossing])
+            if seam_points:
+                seams.append(np.split(crossings[:, 1], first[1:]))
+            crossing = set(crossing.tolist())
+            merged.extend(contour for i, contour in enumerate(block.contours[k])
+                          if i not in crossing)
+        merged.extend(stitch(boundary, seams) if seam_points else stitch(boundary))
+        ret.append(merged)
+    return ret
+
+
+def merge_lines(blocks, line_type=None):
+    """Merge the contour lines of blocks of a grid into contour lines of the whole grid.
+
+    Lines that end on the shared boundary of two blocks are joined, other lines are unchanged.
+
+    Args:
+        blocks (sequence of BlockContours): Results of :func:`~contourpy.block.block_lines` for
+            all blocks of the grid.
+        line_type (LineType, optional): ``LineType.Separate`` or ``LineType.SeparateCode``, default
+            ``LineType.Separate``.
+
+    Return:
+        list: Contour lines at each level in the format specified by ``line_type``.
+    """
+    line_type = LineType.Separate if line_type is None else as_line_type(line_type)
+    if line_type not in (LineType.Separate, LineType.SeparateCode):
+        raise ValueError(f"merge_lines does not support line_type {line_type}")
+    return [_format_lines(lines, line_type) for lines in _merge(blocks, stitch_lines)]
+
+
+def merge_filled(blocks, fill_type=None):
+    """Merge the filled contours of blocks of a grid into filled contours of the whole grid.
+
+    Polygons that cross the shared boundary of two blocks are merged, other polygons are unchanged.
+
+    Args:
+        blocks (sequence of BlockContours): Results of :func:`~contourpy.block.block_filled` for
+            all blocks of the grid.
+        fill_type (FillType, optional): ``FillType.OuterCode`` or ``FillType.OuterOffset``, default
+            ``FillType.OuterOffset``.
+
+    Return:
+        list: Filled contours between each pair of consecutive levels in the format specified by
+        ``fill_type``.
+    """
+    fill_type = FillType.OuterOffset if fill_type is None else as_fill_type(fill_type)
+    if fill_type not in (FillType.OuterCode, FillType.OuterOffset):
+        raise ValueError(f"merge_filled does not support fill_type {fill_type}")
+    return [_format_filled(polygons, fill_type)
+            for polygons in _merge(blocks, stitch_filled, seam_points=True)]
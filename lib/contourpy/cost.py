@@ -0,0 +1,184 @@
+import json
+import math
+import os
+
+import numpy as np
+
+from ._contourpy import max_threads
+from .chunk import calc_chunk_sizes
+
+# Coefficients of the cost model in seconds, the medians of five runs of
+# benchmarks/calibrate_cost_model.py --repeats 9 on a single core Intel Xeon (x86_64, Linux).
+# Thread and efficiency cannot be calibrated on one core so are typical multicore values.
+#   call: fixed cost of each call of lines() or filled().
+#   quad: cost of each quad of the grid per call, mostly stage 1 looking for starts.
+#   point: cost of each point of the returned contours.
+#   chunk: cost of each chunk per call.
+#   thread: cost of waking and synchronising each extra thread per call.
+#   efficiency: fraction of linear speedup achieved by each extra thread.
+_default_coefficients = dict(
+    call=1.5e-6,
+    quad=4.3e-9,
+    point=5.2e-8,
+    chunk=6.1e-6,
+    thread=2.5e-5,
+    efficiency=0.8,
+)
+
+# Maximum number of rows and of columns of z sampled to estimate the density of the contours.
+_max_sample = 128
+
+# Numbers of chunks per thread considered for the threaded algorithm.
+_chunks_per_thread = (1, 2, 4, 8)
+
+
+def get_cost_model():
+    """Return the coefficients of the cost model used by ``contour_generator(name="auto")``.
+
+    These are read from the JSON file named by the ``CONTOURPY_COST_MODEL`` environment variable if
+    it is set, as written by ``benchmarks/calibrate_cost_model.py``, otherwise defaults shipped with
+    ``contourpy`` are used.  Coefficients missing from the file take their default values.
+
+    Return:
+        dict: Coefficients ``call``, ``quad``, ``point``, ``chunk`` and ``thread`` in seconds, and
+        the parallel ``efficiency``.
+    """
+    coefficients = dict(_default_coefficients)
+    path = os.environ.get("CONTOURPY_COST_MODEL")
+    if path:
+        with open(path) as f:
+            calibrated = json.load(f)
+        coefficients.update(
+            (key, float(value)) for key, value in calibrated.items() if key in coefficients)
+    return coefficients
+
+
+def estimate_points(z, mask, level_count):
+    """Estimate the number of contour points per level by sampling ``z``.
+
+    Up to 128 evenly spaced rows and columns of ``z`` are sampled at full resolution.  The number
+    of their quad edges crossed by each of ``level_count`` levels spread evenly across the range of
+    ``z`` is scaled up to the whole grid, which is unbiased for both smooth and noisy ``z``.
+
+    Args:
+        z (array of shape (ny, nx)): Values to contour.
+        mask (array of bool or None): Mask of ``z``.
+        level_count (int): Number of levels.
+
+    Return:
+        float: Estimated mean number of points of the contours at each level.
+    """
+    ny, nx = z.shape
+    y_stride = max(math.ceil(ny / _max_sample), 1)
+    x_stride = max(math.ceil(nx / _max_sample), 1)
+    rows = z[::y_stride, :]
+    columns = z[:, ::x_stride].T
+    if mask is not None:
+        rows = np.where(mask[::y_stride, :], np.nan, rows)
+        columns = np.where(mask[:, ::x_stride].T, np.nan, columns)
+
+    with np.errstate(invalid="ignore"):
+        zmin = min(np.nanmin(rows), np.nanmin(columns))
+        zmax = max(np.nanmax(rows), np.nanmax(columns))
+    if not zmin < zmax:
+        return 0.0
+
+    def crossings(lines, level):
+        # Edges with a NaN at either end compare False and so are not counted.
+        above = lines > level
+        below = lines <= level
+        return np.count_nonzero(above[:, 1:] & below[:, :-1]) + \
+            np.count_nonzero(below[:, 1:] & above[:, :-1])
+
+    points = 0.0
+    for level in np.linspace(zmin, zmax, level_count + 2)[1:-1]:
+        points += (crossings(rows, level)*ny / len(rows) +
+                   crossings(columns, level)*nx / len(columns))
+    return points / level_count
+
+
+def estimate_times(ny, nx, points, level_count, thread_count, chunk_count, coefficients):
+    """Estimate the time to contour ``level_count`` levels using the cost model.
+
+    Args:
+        ny (int): Number of grid points in y-direction.
+        nx (int): Number of grid points in x-direction.
+        points (float): Number of points per level, as estimated by :func:`estimate_points`.
+        level_count (int): Number of levels.
+        thread_count (int): Number of threads.
+        chunk_count (int): Total number of chunks.
+        coefficients (dict): Cost model, as returned by :func:`get_cost_model`.
+
+    Return:
+        float: Estimated time in seconds.
+    """
+    c = coefficients
+    work = c["quad"]*(ny-1)*(nx-1) + c["point"]*points
+    threads = min(thread_count, chunk_count)
+    if threads > 1:
+        # Chunks are shared out dynamically, so on average threads wait for half a chunk at the end.
+        speedup = 1.0 + (threads - 1)*c["efficiency"]
+        per_call = (work + c["chunk"]*chunk_count) / speedup + 0.5*work / chunk_count + \
+            c["thread"]*(threads - 1)
+    else:
+        per_call = work + c["chunk"]*chunk_count
+    return level_count*(c["call"] + per_call)
+
+
+def choose_algorithm(z, mask, *, chunk_size=None, chunk_count=None, total_chunk_count=None,
+                     thread_count=0, level_count=10):
+    """Choose between the ``serial`` and ``threaded`` algorithms and a chunk layout.
+
+    The time to contour ``level_count`` levels is estimated using the cost model for ``serial``
+    without chunks and for ``threaded`` with 1, 2, 4 or 8 chunks per thread and powers of 2 up to
+    the available threads, and the fastest is returned.  If any of ``chunk_size``, ``chunk_count``
+    or ``total_chunk_count`` are specified then that chunk layout is used for both algorithms.
+
+    Args:
+        z (array of shape (ny, nx)): Values to contour.
+        mask (array of bool or None): Mask of ``z``.
+        chunk_size, chunk_count, total_chunk_count: Optional chunk layout, as passed to
+            :func:`~contourpy.contour_generator`.
+        thread_count (int): Maximum number of threads, or 0 for :func:`~contourpy.max_threads`.  No
+            more than :func:`~contourpy.max_threads` are used.
+        level_count (int): Number of levels expected to be contoured, default 10.
+
+    Return:
+        tuple(str, int, int, int): ``(name, y_chunk_size, x_chunk_size, thread_count)``.
+    """
+    ny, nx = z.shape
+    coefficients = get_cost_model()
+    points = estimate_points(z, mask, level_count)
+    max_chunk_count = (ny-1)*(nx-1)
+    available = max(max_threads(), 1)
+    if thread_count > 0:
+        available = min(thread_count, available)
+
+    if chunk_size is None and chunk_count is None and total_chunk_count is None:
+        layouts = [(1, 1)]  # (thread count, total chunk count)
+        threads = 2
+        while threads < 2*available:
+            threads = min(threads, available)
+            layouts += [(threads, min(threads*k, max_chunk_count)) for k in _chunks_per_thread]
+            threads *= 2
+    else:
+        y_chunk_size, x_chunk_size = calc_chunk_sizes(
+            chunk_size, chunk_count, total_chunk_count, ny, nx)
+        y_chunk_count = math.ceil((ny-1) / y_chunk_size) if y_chunk_size > 0 else 1
+        x_chunk_count = math.ceil((nx-1) / x_chunk_size) if x_chunk_size > 0 else 1
+        n_chunks = y_chunk_count*x_chunk_count
+        layouts = [(1, n_chunks), (min(available, n_chunks), n_chunks)]
+
+    best = None
+    for threads, n_chunks in layouts:
+        time = estimate_times(ny, nx, points, level_count, threads, n_chunks, coefficients)
+        if best is None or time < best[0]:
+            best = (time, threads, n_chunks)
+    _, threads, n_chunks = best
+
+    if chunk_size is None and chunk_count is None and total_chunk_count is None:
+        y_chunk_size, x_chunk_size = calc_chunk_sizes(None, None, n_chunks, ny, nx)
+    if threads > 1:
+        return "threaded", y_chunk_size, x_chunk_size, threads
+    else:
+        return "serial", y_chunk_size, x_chunk_size, 1
@@ -0,0 +1,88 @@
+import numpy as np
+
+from . import contour_generator
+
+
+class MultiContourGenerator:
+    """Contour generator for a stack of ``z`` fields that share the same grid.
+
+    Created using :func:`~contourpy.multi.multi_contour_generator`. Each call calculates the
+    contours of all of the fields, returning a list containing the result of each field in the
+    format determined by the ``line_type`` or ``fill_type``.
+    """
+
+    def __init__(self, cont_gen, z):
+        self._cont_gen = cont_gen
+        self._z = z
+
+    @property
+    def contour_generator(self):
+        """Return the :class:`~contourpy.ContourGenerator` of the first field, whose grid is shared
+        by all of the fields and whose properties such as ``line_type`` apply to all of them."""
+        return self._cont_gen
+
+    @property
+    def field_count(self):
+        """Return the number of fields."""
+        return self._z.shape[0]
+
+    def filled(self, lower_level, upper_level):
+        """Calculate and return filled contours of each field between two levels.
+
+        Args:
+            lower_level (float): Lower z-level of the filled contours.
+            upper_level (float): Upper z-level of the filled contours.
+
+        Return:
+            list: Filled contours of each field.
+        """
+        return self._cont_gen._filled_fields(self._z, lower_level, upper_level)
+
+    def lines(self, level):
+        """Calculate and return contour lines of each field at a particular level.
+
+        Args:
+            level (float): z-level to calculate contours at.
+
+        Return:
+            list: Contour lines of each field.
+        """
+        return self._cont_gen._lines_fields(self._z, level)
+
+
+def multi_contour_generator(x=None, y=None, z=None, *, name="serial", **kwargs):
+    """Create and return a contour generator for a stack of ``z`` fields on the same grid.
+
+    This is more efficient than using a separate contour generator for each field as the grid
+    cache is calculated once and shared by all of the fields, and the fields are contoured together
+    chunk by chunk so that the grid of each chunk is reused by every field whilst it is in the CPU
+    cache.
+
+    Args:
+        x (array-like of shape (ny, nx) or (nx,), optional): The x-coordinates of the ``z`` values,
+            as for :func:`~contourpy.contour_generator`.
+        y (array-like of shape (ny, nx) or (ny,), optional): The y-coordinates of the ``z`` values,
+            as for :func:`~contourpy.contour_generator`.
+        z (array-like of shape (n_fields, ny, nx), may be a masked array): The stack of 2D gridded
+            values to calculate the contours of. A point that is masked or invalid in any field is
+            masked out in all of them.
+        name (str): Algorithm name, either ``"serial"`` or ``"threaded"``, default ``"serial"``.
+        kwargs: Other keyword arguments passed to :func:`~contourpy.contour_generator`.
+
+    Return:
+        :class:`~contourpy.multi.MultiContourGenerator`.
+    """
+    if name not in ("serial", "threaded"):
+        raise ValueError(f"{name} contour generator does not support multiple fields")
+
+    z = np.ma.asarray(z, dtype=np.float64)
+    if z.ndim != 3:
+        raise TypeError(f"Input z must be 3D, not {z.ndim}D")
+    if z.shape[0] < 1:
+        raise ValueError("Input z must contain at least one field")
+
+    mask = np.ma.getmaskarray(np.ma.masked_invalid(z, copy=False)).any(axis=0)
+    z = np.ascontiguousarray(np.ma.getdata(z))
+
+    cont_gen = contour_generator(x, y, np.ma.array(z[0], mask=mask), name=name, **kwargs)
+    return MultiContourGenerator(cont_gen, z)
@@ -0,0 +1,55 @@
+from .state import _classes, _get_state, _read_state, _state_nbytes, _write_state
+
+
+def share_generator(cont_gen, name=None):
+    """Copy the immutable state of a contour generator into a new block of shared memory.
+
+    The immutable state comprises the ``x``, ``y``, ``z`` and ``mask`` arrays, the precalculated
+    grid cache and the options such as chunk sizes, ``line_type``, ``fill_type`` and
+    ``collect_stats``. Other processes can then use :func:`~contourpy.attach_generator` to create an
+    identical contour generator that uses the shared memory rather than its own copy of the state.
+
+    Args:
+        cont_gen (SerialContourGenerator or ThreadedContourGenerator): Contour generator to share.
+        name (str, optional): Name of the shared memory block. If not specified a unique name is
+            generated.
+
+    Return:
+        ``multiprocessing.shared_memory.SharedMemory`` containing the state. The caller is
+        responsible for calling its ``close()`` and ``unlink()`` methods when it is no longer
+        needed.
+    """
+    if type(cont_gen) not in _classes:
+        raise TypeError(f"Cannot share contour generator of type {type(cont_gen).__name__}")
+
+    from multiprocessing.shared_memory import SharedMemory  # Python >= 3.8
+
+    arrays = _get_state(cont_gen)
+    ny, nx = arrays[2].shape
+    shm = SharedMemory(name=name, create=True, size=_state_nbytes(ny, nx, len(arrays) == 5))
+    try:
+        _write_state(cont_gen, arrays, shm.buf)
+    except BaseException:
+        shm.unlink()
+        raise
+    return shm
+
+
+def attach_generator(name):
+    """Create a contour generator from the state in a block of shared memory.
+
+    The state must have been written by :func:`~contourpy.share_generator`. The returned contour
+    generator uses the shared memory directly and does not write to it; only the per-call state
+    used whilst contouring is private to this process.
+
+    Args:
+        name (str): Name of the shared memory block.
+
+    Return:
+        Tuple of the contour generator and the ``multiprocessing.shared_memory.SharedMemory`` it
+        uses. The shared memory must not be closed until the contour generator has been deleted.
+    """
+    from multiprocessing.shared_memory import SharedMemory  # Python >= 3.8
+
+    shm = SharedMemory(name=name)
+    return _read_state(shm.buf), shm
@@ -0,0 +1,129 @@
+import numpy as np
+
+from ._contourpy import (
+    FillType, LineType, SerialContourGenerator, ThreadedContourGenerator, ZInterp,
+)
+
+# Layout of the state of a contour generator in a buffer:
+#   header of _header_count int64 values, then x, y and z as float64, grid cache as uint32 and, if
+#   the generator has a mask, the mask as bool, each of shape (ny, nx).
+_magic = int.from_bytes(b"CONTOURP", "little")
+_version = 1
+_header_count = 16
+_classes = [SerialContourGenerator, ThreadedContourGenerator]
+
+
+def _state_nbytes(ny, nx, has_mask):
+    return 8*_header_count + (3*8 + 4 + (1 if has_mask else 0))*ny*nx
+
+
+def _get_state(cont_gen):
+    # Return the arrays of the state of a contour generator, excluding the mask if it has none.
+    x, y, z, grid_cache = cont_gen._get_grid()
+    mask = cont_gen._get_mask()
+    return (x, y, z, grid_cache) if mask is None else (x, y, z, grid_cache, mask)
+
+
+def _write_state(cont_gen, arrays, buffer):
+    ny, nx = arrays[2].shape
+    y_chunk_size, x_chunk_size = cont_gen.chunk_size
+
+    header = np.ndarray((_header_count,), dtype=np.int64, buffer=buffer)
+    header[:] = (
+        _magic, _version, _classes.index(type(cont_gen)), ny, nx, y_chunk_size, x_chunk_size,
+        cont_gen.corner_mask, int(cont_gen.line_type), int(cont_gen.fill_type),
+        cont_gen.quad_as_tri, int(cont_gen.z_interp), cont_gen.thread_count, len(arrays) == 5,
+        cont_gen.collect_stats, cont_gen.perf_counters)
+
+    offset = header.nbytes
+    for array in arrays:
+        np.ndarray(array.shape, dtype=array.dtype, buffer=buffer, offset=offset)[:] = array
+        offset += array.nbytes
+
+
+def _read_state(buffer):
+    # The grid cache is checked by the contour generator, other arrays are not.
+    if len(buffer) < 8*_header_count:
+        raise ValueError("Buffer does not contain a contour generator")
+    header = np.frombuffer(buffer, dtype=np.int64, count=_header_count)
+    if header[0] != _magic:
+        raise ValueError("Buffer does not contain a contour generator")
+    if header[1] != _version:
+        raise ValueError(f"Unsupported contour generator format version {header[1]}")
+
+    (cls_index, ny, nx, y_chunk_size, x_chunk_size, corner_mask, line_type, fill_type, quad_as_tri,
+     z_interp, thread_count, has_mask, collect_stats, perf_counters) = header[2:].tolist()
+    if not 0 <= cls_index < len(_classes) or ny < 2 or nx < 2 or has_mask not in (0, 1):
+        raise ValueError("Buffer contains an invalid contour generator header")
+    # Shared memory may be larger than requested, so a longer buffer is valid.
+    if len(buffer) < _state_nbytes(ny, nx, has_mask):
+        raise ValueError(
+            f"Buffer of {len(buffer)} bytes is too short for a contour generator of shape "
+            f"({ny}, {nx})")
+
+    dtypes = [np.float64, np.float64, np.float64, np.uint32]
+    if has_mask:
+        dtypes.append(np.bool_)
+    arrays = []
+    offset = header.nbytes
+    for dtype in dtypes:
+        array = np.frombuffer(buffer, dtype=dtype, count=ny*nx, offset=offset).reshape(ny, nx)
+        array.flags.writeable = False
+        arrays.append(array)
+        offset += array.nbytes
+    x, y, z, grid_cache = arrays[:4]
+    mask = arrays[4] if has_mask else None
+
+    cls = _classes[cls_index]
+    kwargs = dict(
+        corner_mask=bool(corner_mask), line_type=LineType(line_type), fill_type=FillType(fill_type),
+        quad_as_tri=bool(quad_as_tri), z_interp=ZInterp(z_interp), x_chunk_size=x_chunk_size,
+        y_chunk_size=y_chunk_size, grid_cache=grid_cache)
+    if cls is ThreadedContourGenerator:
+        kwargs["thread_count"] = thread_count
+    cont_gen = cls(x, y, z, mask, **kwargs)
+    cont_gen.collect_stats = bool(collect_stats)
+    cont_gen.perf_counters = bool(perf_counters)
+    return cont_gen
+
+
+def save_generator(cont_gen, filename):
+    """Save a contour generator to a binary file.
+
+    The file contains the ``x``, ``y``, ``z`` and ``mask`` arrays, the precalculated grid cache and
+    the options such as chunk sizes, ``line_type``, ``fill_type`` and ``collect_stats``, so that
+    :func:`~contourpy.load_generator` does not have to repeat any of the calculations performed
+    when the contour generator was created.
+
+    Args:
+        cont_gen (SerialContourGenerator or ThreadedContourGenerator): Contour generator to save.
+        filename (str or path-like): Name of file to write.
+    """
+    if type(cont_gen) not in _classes:
+        raise TypeError(f"Cannot save contour generator of type {type(cont_gen).__name__}")
+
+    arrays = _get_state(cont_gen)
+    ny, nx = arrays[2].shape
+    buffer = bytearray(_state_nbytes(ny, nx, len(arrays) == 5))
+    _write_state(cont_gen, arrays, buffer)
+    with open(filename, "wb") as f:
+        f.write(buffer)
+
+
+def load_generator(filename, *, mmap=True):
+    """Load a contour generator from a binary file written by :func:`~contourpy.save_generator`.
+
+    Args:
+        filename (str or path-like): Name of file to read.
+        mmap (bool): Whether to memory-map the file, default ``True``. If ``True`` the contour
+            generator reads its arrays directly from the file, which is shared by all processes
+            that load the same file. If ``False`` the file is read into memory.
+
+    Return:
+        Contour generator of the same class and options as the one that was saved.
+    """
+    if mmap:
+        buffer = np.memmap(filename, dtype=np.uint8, mode="r")
+    else:
+        buffer = np.fromfile(filename, dtype=np.uint8)
+    return _read_state(buffer)
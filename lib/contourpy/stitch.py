@@ -0,0 +1,426 @@
+import numpy as np
+
+from ._contourpy import FillType, LineType
+
+
+def _point_ids(points, rtol=1e-10):
+    # Identify points that are equal to within a small tolerance, as the same point on the boundary
+    # between two blocks may be calculated in each block with slightly different rounding errors.
+    # Returns, for each point, the index of the first point that it is identified with.
+    n = len(points)
+    labels = np.arange(n)
+    if n == 0:
+        return labels
+    cell = max(2.0*rtol*np.abs(points).max(), np.finfo(np.float64).tiny)
+    keys = [np.floor(points/cell + shift).astype(np.int64)
+            for shift in ((0.0, 0.0), (0.5, 0.0), (0.0, 0.5), (0.5, 0.5))]
+    groups = []
+    for key in keys:
+        # Group number of each point, points in the same cell are in the same group.
+        order = np.lexsort((key[:, 1], key[:, 0]))
+        new_group = np.any(np.diff(key[order], axis=0) != 0, axis=1)
+        group = np.empty(n, dtype=np.int64)
+        group[order] = np.concatenate(([0], np.cumsum(new_group)))
+        groups.append(group)
+    while True:
+        previous = labels
+        for group in groups:
+            group_min = np.full(group.max() + 1, n)
+            np.minimum.at(group_min, group, labels)
+            labels = group_min[group]
+        if np.array_equal(labels, previous):
+            return labels
+
+
+def _line_ends(lines):
+    # Start and end points of lines, and whether each line has zero length as all of its points are
+    # the same.  Lines must have at least one point.
+    counts = np.fromiter(map(len, lines), dtype=np.int64, count=len(lines))
+    if len(lines) == 0:
+        return np.empty((0, 2)), np.empty((0, 2)), np.empty(0, dtype=bool)
+    offsets = np.concatenate(([0], np.cumsum(counts)))
+    points = np.concatenate(lines)
+    starts = points[offsets[:-1]]
+    ends = points[offsets[1:] - 1]
+    spread = np.abs(points - np.repeat(starts, counts, axis=0)).max(axis=1)
+    zero_length = np.maximum.reduceat(spread, offsets[:-1]) == 0.0
+    return starts, ends, zero_length
+
+
+def stitch_lines(block_lines):
+    """Join contour lines of neighbouring blocks of the same grid that end on a shared boundary.
+
+    A contour line that crosses the boundary between two blocks is calculated as one line that
+    ends on the boundary in one block and another that starts at the same point in the
+    other block.  These are joined end-to-start, and a line that returns to the block it started
+    in through one or more other blocks becomes a closed line loop.  Only lines of different blocks
+    are joined.
+
+    Args:
+        block_lines (sequence of sequences of arrays of shape (npoints, 2)): Contour lines of each
+            block, in ``LineType.Separate`` format, all at the same level.
+
+    Return:
+        list of arrays of shape (npoints, 2): Contour lines in ``LineType.Separate`` format. Closed
+        line loops have the same start and end point.
+    """
+    lines = []
+    blocks = []
+    for block, block_line_list in enumerate(block_lines):
+        for line in block_line_list:
+            lines.append(line)
+            blocks.append(block)
+
+    # Open lines and the ids of their start and end points.  A crossing that is exactly on a grid
+    # point shared by two blocks may give a degenerate line of zero length in one of them, which
+    # is identified by its single point.
+    starts, ends, zero_length = _line_ends(lines)
+    open_lines = np.flatnonzero(np.any(starts != ends, axis=1)).tolist()
+    if not open_lines:
+        return list(lines)
+    degenerate = np.flatnonzero(zero_length).tolist()
+    end_points = np.concatenate((starts[open_lines], ends[open_lines], starts[degenerate]))
+    ids = _point_ids(end_points)
+    n_open = len(open_lines)
+    start_ids = dict(zip(open_lines, ids[:n_open].tolist()))
+    end_ids = dict(zip(open_lines, ids[n_open:2*n_open].tolist()))
+
+    # Degenerate lines at the end of an open line are dropped, and the open lines of other blocks
+    # that meet at their point may be joined through it.
+    end_id_set = set(ids[:2*n_open].tolist())
+    bridges = {}
+    dropped = set()
+    for i, point_id in zip(degenerate, ids[2*n_open:].tolist()):
+        if point_id in end_id_set:
+            bridges.setdefault(point_id, set()).add(blocks[i])
+            dropped.add(i)
+
+    # Open lines keyed by the id of their start point.
+    starts = {}
+    for i in open_lines:
+        starts.setdefault(start_ids[i], []).append(i)
+
+    # Line that follows each open line, if any.
+    following = {}
+    preceded = set()
+    for i in open_lines:
+        point_id = end_ids[i]
+        bridged = any(block != blocks[i] for block in bridges.get(point_id, ()))
+        for j in starts.get(point_id, ()):
+            if (blocks[j] != blocks[i] or bridged) and j != i and j not in preceded:
+                following[i] = j
+                preceded.add(j)
+                break
+
+    if not following and not dropped:
+        return list(lines)
+
+    ret = []
+    visited = set()
+
+    def join(first):
+        parts = [lines[first]]
+        visited.add(first)
+        i = following.get(first)
+        while i is not None and i not in visited:
+            parts.append(lines[i][1:])
+            visited.add(i)
+            i = following.get(i)
+        line = np.concatenate(parts)
+        if i == first:
+            line[-1] = line[0]  # Closed line loop.
+        return line
+
+    visited.update(dropped)
+
+    # Chains that start with a line that is not preceded by another.
+    for i in range(len(lines)):
+        if i not in preceded and i not in visited:
+            ret.append(join(i))
+
+    # Remaining lines form closed loops.
+    for i in range(len(lines)):
+        if i not in visited:
+            ret.append(join(i))
+
+    return ret
+
+
+def _signed_area(ring):
+    x = ring[:, 0]
+    y = ring[:, 1]
+    return 0.5*(np.dot(x[:-1], y[1:]) - np.dot(x[1:], y[:-1]))
+
+
+def _point_in_ring(point, ring):
+    # Even-odd rule ray casting in the +x direction.
+    x0, y0 = ring[:-1, 0], ring[:-1, 1]
+    x1, y1 = ring[1:, 0], ring[1:, 1]
+    crosses = (y0 > point[1]) != (y1 > point[1])
+    with np.errstate(divide="ignore", invalid="ignore"):
+        x_cross = x0 + (point[1] - y0)*(x1 - x0)/(y1 - y0)
+    return np.count_nonzero(crosses & (point[0] < x_cross)) % 2 == 1
+
+
+def _interior_point(ring, outer_points):
+    # Return a point of a ring that is not a point of an outer boundary, as a hole may touch its
+    # outer boundary at a point that is exactly at a level.  Falls back to the midpoint of the
+    # first edge if all of its points are shared.
+    for point in ring[:-1]:
+        if tuple(point) not in outer_points:
+            return point
+    return 0.5*(ring[0] + ring[1])
+
+
+def _shared_points(polygons, blocks):
+    # Indices of the points of the outer boundary of each polygon that are also points of an outer
+    # boundary of another block.  These are the only points that can be on the boundaries between
+    # blocks, as holes cannot touch them.
+    outer_points = [polygon[0][:-1] for polygon in polygons]
+    counts = [len(points) for points in outer_points]
+    offsets = np.concatenate(([0], np.cumsum(counts)))
+    point_ids = _point_ids(np.concatenate(outer_points))
+    point_blocks = np.repeat(blocks, counts)
+    id_blocks = np.unique(np.stack((point_ids, point_blocks), axis=1), axis=0)
+    shared = np.isin(point_ids, np.flatnonzero(np.bincount(id_blocks[:, 0]) > 1))
+    return [np.flatnonzero(shared[offsets[i]:offsets[i+1]]) for i in range(len(polygons))]
+
+
+def _find(parents, i):
+    # Root of i in a union-find forest, compressing the path to it.
+    root = i
+    while parents[root] != root:
+        root = parents[root]
+    while parents[i] != root:
+        parents[i], i = root, parents[i]
+    return root
+
+
+def stitch_filled(block_polygons, seam_points=None):
+    """Merge filled contour polygons of neighbouring blocks of the same grid.
+
+    A filled contour polygon that crosses the boundary between two blocks is calculated as one
+    polygon in each block, both of which have an outer boundary that runs along the shared
+    boundary in opposite directions.  These shared edges are removed and the remaining edges are
+    joined to form the outer boundaries and holes of the merged polygons.
+
+    Only the points of outer boundaries that are on a shared boundary are compared between blocks,
+    and the runs of points between them are joined as a whole, so the time taken is proportional
+    to the number of points rather than quadratic in it.  Holes are assigned to merged polygons by
+    tracking which of the original polygons each ring is formed from, so point in polygon tests are
+    only needed where polygons touch at a single point.
+
+    Args:
+        block_polygons (sequence of sequences of polygons): Filled contour polygons of each block,
+            all between the same pair of levels.  Each polygon is a sequence of arrays of shape
+            (npoints, 2), the first is the outer boundary and any others are holes.  Each array
+            has the same start and end point.
+        seam_points (sequence of sequences of arrays of int, optional): Indices of the points of
+            the outer boundary of each polygon that are on a boundary shared with another block,
+            as calculated by :func:`~contourpy.block.block_filled`.  If not specified they are
+            found by comparing all points of the outer boundaries.
+
+    Return:
+        list of polygons: Merged filled contour polygons in the same format as the input.
+    """
+    polygons = []
+    blocks = []
+    seams = []
+    for block, block_polygon_list in enumerate(block_polygons):
+        for k, polygon in enumerate(block_polygon_list):
+            polygons.append(polygon)
+            blocks.append(block)
+            if seam_points is not None:
+                seams.append(np.unique(np.asarray(seam_points[block][k], dtype=np.int64)))
+
+    if not polygons:
+        return []
+    if seam_points is None:
+        seams = _shared_points(polygons, blocks)
+
+    involved = [i for i, seam in enumerate(seams) if len(seam) > 0]
+    if not involved:
+        return list(polygons)
+    involved_set = set(involved)
+    ret = [polygon for i, polygon in enumerate(polygons) if i not in involved_set]
+
+    # Identify the seam points of all involved outer boundaries, representing each by the first
+    # point that it is identified with.
+    seam_xy = np.concatenate([polygons[i][0][seams[i]] for i in involved])
+    seam_ids = _point_ids(seam_xy)
+    seam_offsets = np.concatenate(([0], np.cumsum([len(seams[i]) for i in involved])))
+
+    # Cut each outer boundary at its seam points into runs from one seam point to the next, the
+    # last of which wraps around to the first.  A run of a single edge between seam points may be
+    # traversed in the opposite direction by another block, in which case both are removed.
+    counts = np.diff(seam_offsets)
+    run_polygons = np.repeat(involved, counts)
+    positions = np.concatenate([seams[i] for i in involved])
+    following = np.arange(1, len(positions) + 1)
+    following[seam_offsets[1:] - 1] = seam_offsets[:-1]
+    ring_lengths = np.repeat([len(polygons[i][0]) - 1 for i in involved], counts)
+    lengths = (positions[following] - positions) % ring_lengths
+    lengths[lengths == 0] = ring_lengths[lengths == 0]  # Single seam point.
+    starts = seam_ids
+    ends = seam_ids[following]
+
+    # Single edge runs keyed by start and end ids, and the range of blocks that they are in.
+    single = np.flatnonzero(lengths == 1)
+    single_blocks = np.asarray(blocks)[run_polygons[single]]
+    edges = starts[single]*len(seam_xy) + ends[single]
+    reverse_edges = ends[single]*len(seam_xy) + starts[single]
+    unique_edges, inverse = np.unique(edges, return_inverse=True)
+    min_block = np.full(len(unique_edges), np.iinfo(np.int64).max)
+    max_block = np.full(len(unique_edges), -1)
+    np.minimum.at(min_block, inverse, single_blocks)
+    np.maximum.at(max_block, inverse, single_blocks)
+    reverse = np.minimum(np.searchsorted(unique_edges, reverse_edges), max(len(unique_edges)-1, 0))
+    shared = (unique_edges[reverse] == reverse_edges) & (
+        (min_block[reverse] != single_blocks) | (max_block[reverse] != single_blocks))
+    keep = np.ones(len(positions), dtype=bool)
+    keep[single[shared | (starts[single] == ends[single])]] = False
+
+    runs = list(zip(run_polygons.tolist(), positions.tolist(), lengths.tolist(),
+                    starts.tolist(), ends.tolist()))
+    out_runs = {}
+    for r in np.flatnonzero(keep).tolist():
+        out_runs.setdefault(runs[r][3], []).append(r)
+
+    # Join runs into rings.  A ring that passes through the same point more than once, where
+    # separate polygons touch at a single point, is split into separate rings there.
+    ring_runs = []
+    for first in list(out_runs):
+        if first not in out_runs:
+            continue
+        path = [first]
+        path_runs = []
+        path_index = {first: 0}
+        while path:
+            point = path[-1]
+            point_runs = out_runs.get(point)
+            if not point_runs:
+                break  # Should not occur as each point has the same number of runs in and out.
+            r = point_runs.pop()
+            if not point_runs:
+                del out_runs[point]
+            end = runs[r][4]
+            path_runs.append(r)
+            if end in path_index:
+                index = path_index[end]
+                ring_runs.append(path_runs[index:])
+                for ring_point in path[index+1:]:
+                    del path_index[ring_point]
+                del path[index+1:]
+                del path_runs[index:]
+                if index == 0 and end not in out_runs:
+                    path = []
+            else:
+                path_index[end] = len(path)
+                path.append(end)
+
+    def run_points(r):
+        # Points of a run excluding its end point, with its start point replaced by that of the
+        # seam point it is identified with.
+        i, position, length, start, _ = runs[r]
+        ring = polygons[i][0]
+        n = len(ring) - 1
+        if position + length <= n:
+            points = ring[position:position+length].copy()
+        else:
+            points = np.concatenate((ring[position:n], ring[:position+length-n]))
+        points[0] = seam_xy[start]
+        return points
+
+    # Outer boundaries all have the same orientation.  Take it from the largest, as an outer
+    # boundary that only touches grid points that are exactly at a level may have zero area.
+    outer_areas = [_signed_area(polygons[i][0]) for i in involved]
+    outer_sign = np.sign(outer_areas[np.argmax(np.abs(outer_areas))])
+    zero_area = 1e-12*np.max(np.abs(outer_areas))
+
+    # The runs of each ring are of polygons that are all part of the same merged polygon, as are
+    # the holes of those polygons.
+    parents = {i: i for i in involved}
+    rings = []
+    for ring_run_list in ring_runs:
+        points = [run_points(r) for r in ring_run_list]
+        ring = np.concatenate(points + [points[0][:1]])
+        area = _signed_area(ring)
+        if abs(area) <= zero_area:
+            continue  # Degenerate ring along a shared boundary, or of points at a level.
+        polygon = runs[ring_run_list[0]][0]
+        for r in ring_run_list[1:]:
+            parents[_find(parents, runs[r][0])] = _find(parents, polygon)
+        rings.append((ring, np.sign(area) == outer_sign, polygon))
+
+    components = {}
+    for ring, is_outer, polygon in rings:
+        outers, holes = components.setdefault(_find(parents, polygon), ([], []))
+        (outers if is_outer else holes).append(ring)
+    for i in involved:
+        if len(polygons[i]) > 1:
+            components.setdefault(_find(parents, i), ([], []))[1].extend(polygons[i][1:])
+
+    merged = {key: [[outer] for outer in outers] for key, (outers, _) in components.items()}
+    all_merged = [polygon for component in merged.values() for polygon in component]
+
+    # Holes of a merged polygon that touches another only at points may be in a component with
+    # more than one outer boundary, these are assigned to the smallest that contains them.
+    for key, (outers, holes) in components.items():
+        if len(outers) == 1:
+            merged[key][0].extend(holes)
+            continue
+        candidates = merged[key] or all_merged
+        if not candidates:
+            continue
+        areas = [abs(_signed_area(polygon[0])) for polygon in candidates]
+        outer_points = set(map(tuple, np.concatenate([polygon[0] for polygon in candidates])))
+        for hole in holes:
+            point = _interior_point(hole, outer_points)
+            parent = None
+            for j, polygon in enumerate(candidates):
+                outer = polygon[0]
+                if ((parent is None or areas[j] < areas[parent]) and
+                        np.all(point >= outer.min(axis=0)) and
+                        np.all(point <= outer.max(axis=0)) and _point_in_ring(point, outer)):
+                    parent = j
+            if parent is not None:
+                candidates[parent].append(hole)
+
+    ret.extend(all_merged)
+    return ret
+
+
+def _split_polygons(points, codes):
+    # Split filled contours in FillType.OuterCode format into a list of polygons, each of which is
+    # a list of rings.
+    polygons = []
+    for pts, cds in zip(points, codes):
+        starts = np.flatnonzero(cds == 1).tolist()
+        polygons.append([pts[start:end] for start, end in zip(starts, starts[1:] + [len(pts)])])
+    return polygons
+
+
+def _line_codes(line):
+    # Matplotlib path codes: MOVETO, LINETO and CLOSEPOLY if closed.
+    codes = np.full(len(line), 2, dtype=np.uint8)
+    codes[0] = 1
+    if len(line) > 2 and np.array_equal(line[0], line[-1]):
+        codes[-1] = 79
+    return codes
+
+
+def _format_lines(lines, line_type):
+    # Contour lines in LineType.Separate or LineType.SeparateCode format.
+    if line_type == LineType.SeparateCode:
+        return lines, [_line_codes(line) for line in lines]
+    return lines
+
+
+def _format_filled(polygons, fill_type):
+    # Filled contours in FillType.OuterCode or FillType.OuterOffset format.
+    points = [np.concatenate(polygon) for polygon in polygons]
+    if fill_type == FillType.OuterCode:
+        return points, [np.concatenate([_line_codes(ring) for ring in polygon])
+                        for polygon in polygons]
+    return points, [np.cumsum([0] + [len(ring) for ring in polygon], dtype=np.uint32)
+                    for polygon in polygons]
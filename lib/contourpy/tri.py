@@ -0,0 +1,74 @@
+import numpy as np
+
+from ._contourpy import TriContourGenerator, ZInterp
+from .enum_util import as_fill_type, as_line_type, as_z_interp
+
+
+def tri_contour_generator(x, y, triangles, z, *, mask=None, line_type=None, fill_type=None,
+                          chunk_count=None, z_interp=ZInterp.Linear, thread_count=1):
+    """Create and return a contour generator for an unstructured triangular mesh.
+
+    Contours are calculated using the same algorithm as Matplotlib's ``tricontour`` and returned in
+    the same formats as the contour generators of quad grids.
+
+    Args:
+        x (array-like of shape (n_points,)): The x-coordinates of the points of the mesh.
+        y (array-like of shape (n_points,)): The y-coordinates of the points of the mesh.
+        triangles (array-like of shape (n_triangles, 3)): Indices of the 3 points of each triangle,
+            in either order. Triangles may share edges but must not overlap.
+        z (array-like of shape (n_points,), may be a masked array): The values to calculate the
+            contours of. Triangles that contain a masked or invalid (``np.inf`` or ``np.nan``)
+            point are masked out.
+        mask (array-like of bool of shape (n_triangles,), optional): Triangles to mask out.
+        line_type (LineType, optional): The format of contour line data returned from calls to
+            :meth:`~contourpy.TriContourGenerator.lines`, default ``LineType.Separate``.
+        fill_type (FillType, optional): The format of filled contour data returned from calls to
+            :meth:`~contourpy.TriContourGenerator.filled`, default ``FillType.OuterOffset``.
+        chunk_count (int, optional): Number of chunks that the triangles are divided into, which
+            are spatially compact groups of triangles. Defaults to one chunk per thread.
+        z_interp (ZInterp): How to interpolate ``z`` values when determining where contour lines
+            intersect the edges of triangles, default ``ZInterp.Linear``.
+        thread_count (int): Number of threads to use for contour calculation, default 1. If 0 it
+            uses the maximum number of threads. There are never more threads than chunks.
+
+    Return:
+        :class:`~contourpy.TriContourGenerator`.
+    """
+    x = np.ascontiguousarray(x, dtype=np.float64)
+    y = np.ascontiguousarray(y, dtype=np.float64)
+    triangles = np.ascontiguousarray(triangles, dtype=np.intp)
+    z = np.ma.masked_invalid(np.ma.asarray(z, dtype=np.float64), copy=False)
+
+    if z.ndim != 1:
+        raise TypeError(f"Input z must be 1D, not {z.ndim}D")
+    if x.shape != z.shape or y.shape != z.shape:
+        raise TypeError(f"Shapes of x {x.shape} and y {y.shape} must match z {z.shape}")
+    if triangles.ndim != 2 or triangles.shape[1] != 3:
+        raise TypeError(f"triangles must have shape (n_triangles, 3), not {triangles.shape}")
+    if triangles.size > 0 and (triangles.min() < 0 or triangles.max() >= len(z)):
+        raise ValueError(f"triangles must contain indices in the range 0 to {len(z)-1}")
+
+    if mask is None:
+        mask = np.zeros(len(triangles), dtype=bool)
+    else:
+        mask = np.asarray(mask, dtype=bool)
+        if mask.shape != (len(triangles),):
+            raise ValueError("If mask is set it must be a 1D array with the same length as "
+                             "triangles")
+    if np.ma.is_masked(z):
+        mask = mask | np.ma.getmaskarray(z)[triangles].any(axis=1)
+    z = np.ascontiguousarray(np.ma.getdata(z))
+
+    line_type = (TriContourGenerator.default_line_type if line_type is None
+                 else as_line_type(line_type))
+    fill_type = (TriContourGenerator.default_fill_type if fill_type is None
+                 else as_fill_type(fill_type))
+    z_interp = ZInterp.Linear if z_interp is None else as_z_interp(z_interp)
+
+    if chunk_count is None:
+        chunk_count = 0
+
+    return TriContourGenerator(
+        x, y, triangles, z, mask if mask.any() else None, line_type=line_type,
+        fill_type=fill_type, z_interp=z_interp, chunk_count=chunk_count,
+        thread_count=thread_count)
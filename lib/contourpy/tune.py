@@ -0,0 +1,200 @@
+import json
+import os
+import platform
+import tempfile
+import time
+
+import numpy as np
+
+from ._contourpy import max_threads
+from ._version import __version__
+from .chunk import calc_chunk_sizes
+
+# Number of times each trial is repeated, the fastest of which is used.
+_repeats = 2
+# Maximum number of chunks per thread of the trials.
+_max_chunks_per_thread = 8
+
+
+def _cpu_model():
+    try:
+        with open("/proc/cpuinfo") as f:
+            for line in f:
+                if line.startswith("model name"):
+                    return line.split(":", 1)[1].strip()
+    except OSError:
+        pass
+    return platform.processor() or platform.machine()
+
+
+def _trial_levels(z, mask):
+    if mask is not None:
+        z = z[~mask]
+    if z.size == 0:
+        return None
+    zmin, zmax = float(np.min(z)), float(np.max(z))
+    if not zmin < zmax:
+        return None
+    return np.linspace(zmin, zmax, 7)[1:-1]
+
+
+def _trials(cls, ny, nx, thread_count):
+    # Yields (total_chunk_count, thread_count) of each trial.
+    if thread_count == 0 and cls.supports_threads():
+        n = max_threads()
+        thread_counts = [1 << i for i in range(n.bit_length()) if (1 << i) < n] + [n]
+    else:
+        thread_counts = [max(thread_count, 1)]
+
+    # There cannot be more threads than chunks, so a grid with few quads uses fewer threads.
+    max_chunk_count = (ny-1)*(nx-1)
+    thread_counts = dict.fromkeys(min(threads, max_chunk_count) for threads in thread_counts)
+    for threads in thread_counts:
+        chunk_counts = [threads*(1 << i) for i in range(_max_chunks_per_thread.bit_length())]
+        if threads == 1:
+            chunk_counts.insert(0, 1)
+        for chunk_count in dict.fromkeys(chunk_counts):
+            if chunk_count <= max_chunk_count:
+                yield chunk_count, threads
+
+
+def _time_trial(cont_gen, levels):
+    best = None
+    for _ in range(_repeats):
+        start = time.perf_counter()
+        for i, level in enumerate(levels):
+            cont_gen.lines(level)
+            if i > 0:
+                cont_gen.filled(levels[i-1], level)
+        elapsed = time.perf_counter() - start
+        best = elapsed if best is None else min(best, elapsed)
+    return best
+
+
+def get_tune_cache_path():
+    """Return the path of the file that caches the results of auto-tuning.
+
+    This is the ``CONTOURPY_TUNE_CACHE`` environment variable if it is set, otherwise the file
+    ``contourpy/tune.json`` in the user's cache directory.
+
+    Return:
+        str: Path of the cache file, which may not exist yet.
+    """
+    path = os.environ.get("CONTOURPY_TUNE_CACHE")
+    if path:
+        return path
+    if os.name == "nt":
+        cache_dir = os.environ.get("LOCALAPPDATA") or os.path.expanduser("~")
+    elif platform.system() == "Darwin":
+        cache_dir = os.path.expanduser("~/Library/Caches")
+    else:
+        cache_dir = os.environ.get("XDG_CACHE_HOME") or os.path.expanduser("~/.cache")
+    return os.path.join(cache_dir, "contourpy", "tune.json")
+
+
+def clear_tune_cache():
+    """Remove the file that caches the results of auto-tuning, if it exists."""
+    try:
+        os.remove(get_tune_cache_path())
+    except FileNotFoundError:
+        pass
+
+
+def _read_cache(path):
+    try:
+        with open(path) as f:
+            cache = json.load(f)
+    except (OSError, ValueError):
+        return {}
+    return cache if isinstance(cache, dict) else {}
+
+
+def _write_cache(path, cache):
+    # Write to a temporary file that is then renamed, so that concurrent processes never read a
+    # partially written file.  Failure to write is ignored as the cache is only an optimisation.
+    try:
+        directory = os.path.dirname(path) or "."
+        os.makedirs(directory, exist_ok=True)
+        fd, tmp_path = tempfile.mkstemp(dir=directory, suffix=".tmp")
+        try:
+            with os.fdopen(fd, "w") as f:
+                json.dump(cache, f, indent=1, sort_keys=True)
+            os.replace(tmp_path, path)
+        except BaseException:
+            os.remove(tmp_path)
+            raise
+    except OSError:
+        pass
+
+
+def tune_key(cls, ny, nx, thread_count, kwargs, has_mask):
+    """Return the key of a set of options in the auto-tuning cache.
+
+    Args:
+        cls (type): Contour generator class.
+        ny (int): Number of grid points in y-direction.
+        nx (int): Number of grid points in x-direction.
+        thread_count (int): Requested number of threads, 0 to tune it.
+        kwargs (dict): Contour generator options other than chunk sizes and thread count.
+        has_mask (bool): Whether ``z`` is masked.
+
+    Return:
+        str: Key that identifies the grid shape, CPU model and options.
+    """
+    options = ",".join(f"{key}={kwargs[key]}" for key in sorted(kwargs))
+    return (
+        f"{__version__}|{_cpu_model()}|{max_threads()}|{cls.__name__}|{ny}x{nx}|"
+        f"threads={thread_count}|mask={has_mask}|{options}")
+
+
+def auto_tune(cls, x, y, z, mask, thread_count, kwargs, cache=True):
+    """Choose the chunk sizes and thread count of a contour generator by timing trial marches.
+
+    Each trial creates a contour generator with a different total number of chunks and number of
+    threads, and times the calculation of lines at 5 levels spread evenly across the range of
+    ``z`` and of the filled contours between them.  The fastest trial is chosen.
+
+    Args:
+        cls (type): Contour generator class, which must support chunking.
+        x, y, z (arrays of shape (ny, nx)): Grid coordinates and values.
+        mask (array of bool or None): Mask of ``z``.
+        thread_count (int): Number of threads, or 0 to tune it if ``cls`` supports threads.
+        kwargs (dict): Other keyword arguments of the ``cls`` constructor, excluding the chunk sizes
+            and thread count.
+        cache (bool): Whether to read and write the choice in the file returned by
+            :func:`~contourpy.tune.get_tune_cache_path`, default ``True``.
+
+    Return:
+        tuple(int, int, int): ``(y_chunk_size, x_chunk_size, thread_count)``.
+    """
+    ny, nx = z.shape
+    key = tune_key(cls, ny, nx, thread_count, kwargs, mask is not None)
+    path = get_tune_cache_path() if cache else None
+    if path is not None:
+        entry = _read_cache(path).get(key)
+        if isinstance(entry, list) and len(entry) == 3:
+            return tuple(int(value) for value in entry)
+
+    levels = _trial_levels(z, mask)
+    best = None
+    if levels is None:
+        # Nothing to contour, so no meaningful trials.
+        best = (0, 0, max(thread_count, 1))
+    else:
+        best_time = None
+        for chunk_count, threads in _trials(cls, ny, nx, thread_count):
+            y_chunk_size, x_chunk_size = calc_chunk_sizes(None, None, chunk_count, ny, nx)
+            trial_kwargs = dict(kwargs, x_chunk_size=x_chunk_size, y_chunk_size=y_chunk_size)
+            if cls.supports_threads():
+                trial_kwargs["thread_count"] = threads
+            elapsed = _time_trial(cls(x, y, z, mask, **trial_kwargs), levels)
+            if best_time is None or elapsed < best_time:
+                best_time = elapsed
+                best = (y_chunk_size, x_chunk_size, threads)
+
+    if path is not None:
+        # Reread in case another process has written to the cache whilst the trials ran.
+        tuned = _read_cache(path)
+        tuned[key] = list(best)
+        _write_cache(path, tuned)
+    return best
@@ -50,16 +50,23 @@ ParallelCompile(default=0, needs_recompile=naive_recompile).install()
 _contourpy = Pybind11Extension(
     "contourpy._contourpy",
     sources=[
+        "src/call_stats.cpp",
         "src/chunk_local.cpp",
         "src/converter.cpp",
+        "src/executor.cpp",
         "src/fill_type.cpp",
         "src/line_type.cpp",
         "src/mpl2005_original.cpp",
         "src/mpl2005.cpp",
         "src/mpl2014.cpp",
         "src/outer_or_hole.cpp",
+        "src/python_executor.cpp",
+        "src/python_generator.cpp",
+        "src/python_output.cpp",
         "src/serial.cpp",
+        "src/thread_pool.cpp",
         "src/threaded.cpp",
+        "src/tri.cpp",
         "src/util.cpp",
         "src/wrap.cpp",
         "src/z_interp.cpp",
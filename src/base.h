@@ -10,12 +10,19 @@
 #ifndef CONTOURPY_BASE_H
 #define CONTOURPY_BASE_H
 
+#include "call_stats.h"
 #include "chunk_local.h"
 #include "contour_generator.h"
 #include "fill_type.h"
 #include "line_type.h"
 #include "outer_or_hole.h"
+#include "output.h"
 #include "z_interp.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <utility>
 #include <vector>
 
 template <typename Derived>
@@ -27,20 +34,57 @@ public:
     static FillType default_fill_type();
     static LineType default_line_type();
 
-    py::tuple get_chunk_count() const;  // Return (y_chunk_count, x_chunk_count)
-    py::tuple get_chunk_size() const;   // Return (y_chunk_size, x_chunk_size)
+    // Return (y_chunk_count, x_chunk_count)
+    std::pair<index_t, index_t> get_chunk_count() const;
+    // Return (y_chunk_size, x_chunk_size)
+    std::pair<index_t, index_t> get_chunk_size() const;
+
+    // Whether calls collect CallStats, see set_collect_stats().
+    bool get_collect_stats() const;
 
     bool get_corner_mask() const;
 
     FillType get_fill_type() const;
+
+    // Return the grid cache which, together with x, y, z and the other properties, is all that is
+    // needed to construct an identical generator.  It has the same shape as z.
+    const uint32_t* get_grid_cache() const;
+
+    // Return the stats of the most recent call that collected them, or nullptr if there are none.
+    std::shared_ptr<const CallStats> get_last_call_stats() const;
+
     LineType get_line_type() const;
 
+    index_t get_nx() const;
+    index_t get_ny() const;
+
+    // Whether calls that collect stats also collect hardware performance counters.
+    bool get_perf_counters() const;
+
     bool get_quad_as_tri() const;
 
     ZInterp get_z_interp() const;
 
-    py::sequence filled(double lower_level, double upper_level);
-    py::sequence lines(double level);
+    // Calculate contours and write them to output.
+    void filled(double lower_level, double upper_level, Output& output);
+    void lines(double level, Output& output);
+
+    // Calculate contours of n_fields z fields that share the grid (x, y, mask and grid cache) of
+    // this generator, writing each to the corresponding outputs.  zs contains pointers to arrays of
+    // the same shape as z.  The fields are marched together chunk by chunk so that each chunk's
+    // grid is reused by all of the fields whilst it is still in the CPU cache.
+    void filled_fields(
+        double lower_level, double upper_level, const double* const* zs, index_t n_fields,
+        Output* const* outputs);
+    void lines_fields(
+        double level, const double* const* zs, index_t n_fields, Output* const* outputs);
+
+    // Set whether subsequent calls collect CallStats, which is disabled by default.
+    void set_collect_stats(bool collect_stats);
+
+    // Set whether calls that collect stats also collect the hardware performance counters of each
+    // stage, throwing std::runtime_error if they are not available.
+    void set_perf_counters(bool perf_counters);
 
     static bool supports_fill_type(FillType fill_type);
     static bool supports_line_type(LineType line_type);
@@ -48,10 +92,16 @@ public:
     void write_cache() const;  // For debug purposes only.
 
 protected:
+    // x, y, z and the optional mask are C-contiguous arrays of shape (ny, nx) that must outlive
+    // the generator, as must grid_cache if specified.
     BaseContourGenerator(
-        const CoordinateArray& x, const CoordinateArray& y, const CoordinateArray& z,
-        const MaskArray& mask, bool corner_mask, LineType line_type, FillType fill_type,
-        bool quad_as_tri, ZInterp z_interp, index_t x_chunk_size, index_t y_chunk_size);
+        const double* x, const double* y, const double* z, const bool* mask, index_t nx,
+        index_t ny, bool corner_mask, LineType line_type, FillType fill_type, bool quad_as_tri,
+        ZInterp z_interp, index_t x_chunk_size, index_t y_chunk_size,
+        const uint32_t* grid_cache = nullptr);
+
+    // Construct a per-call context of generator, see acquire_context().
+    explicit BaseContourGenerator(const BaseContourGenerator* generator);
 
     typedef uint32_t CacheItem;
     typedef CacheItem ZLevel;
@@ -83,6 +133,12 @@ protected:
         bool is_upper, on_boundary;
     };
 
+    // Return a per-call context to contour in, reusing one from a previous call if available.  A
+    // context is an instance of Derived that shares the grid (x, y, z and the grid-invariant bits
+    // of the cache) of this generator, but owns its own cache and other per-call variables.  This
+    // allows multiple concurrent calls on the same generator, each using a different context.
+    std::unique_ptr<Derived> acquire_context();
+
     // Calculate and return z at middle of quad.
     double calc_middle_z(index_t quad) const;
 
@@ -94,13 +150,28 @@ protected:
     void closed_line_wrapper(
         const Location& start_location, OuterOrHole outer_or_hole, ChunkLocal& local);
 
+    // If a grid cache supplied to the constructor contains other than grid bits, or its boundary
+    // bits are not those of its quads and the chunk sizes, throw invalid argument error.
+    void check_cache_grid() const;
+
     // If point/line/hole counts not consistent, throw runtime error.
     void check_consistent_counts(const ChunkLocal& local) const;
 
-    // Write points and offsets/codes to output numpy arrays.
-    void export_filled(ChunkLocal& local, std::vector<py::list>& return_lists);
+    // If z_interp is Log and any z that is not masked is not positive, throw invalid argument
+    // error.  z is the generator's z or that of another field on the same grid.
+    void check_z(const double* z) const;
+
+    // Return the number of start flags set in the chunk's quads.
+    count_t count_starts(const ChunkLocal& local) const;
 
-    void export_lines(ChunkLocal& local, std::vector<py::list>& return_lists);
+    // Return the number of quads that the next pass of march_chunk() visits, as limited by the
+    // NO_STARTS_IN_ROW and NO_MORE_STARTS flags.
+    count_t count_visited_quads(const ChunkLocal& local) const;
+
+    // Write points and offsets/codes to output arrays.
+    void export_filled(ChunkLocal& local, Output& output);
+
+    void export_lines(ChunkLocal& local, Output& output);
 
     index_t find_look_S(index_t look_N_quad) const;
 
@@ -136,7 +207,9 @@ protected:
     double get_point_y(index_t point) const;
     double get_point_z(index_t point) const;
 
-    void init_cache_grid(const MaskArray& mask);
+    void init_cache_grid(const bool* mask);
+
+    void init_output(Output& output) const;
 
     // Either for a single chunk, or the whole domain (all chunks) if local == nullptr.
     void init_cache_levels_and_starts(const ChunkLocal* local = nullptr);
@@ -159,12 +232,49 @@ protected:
 
     void line(const Location& start_location, ChunkLocal& local);
 
-    void march_chunk(ChunkLocal& local, std::vector<py::list>& return_lists);
+    void march_chunk(ChunkLocal& local, Output& output);
+
+    // Implementations of filled() and lines() that are called on a per-call context.
+    void march_filled(double lower_level, double upper_level, Output& output);
+    void march_lines(double level, Output& output);
 
-    py::sequence march_wrapper();
+    // Implementation of filled_fields() and lines_fields(), called on the generator.  Acquires a
+    // per-call context for each field and passes them to Derived::march_fields().
+    void march_fields_wrapper(
+        bool filled, double lower_level, double upper_level, const double* const* zs,
+        index_t n_fields, Output* const* outputs);
+
+    void march_wrapper(Output& output);
+
+    // Call march(outputs) that contours using contexts, one per output.  If collecting stats the
+    // outputs are wrapped to time locking them, and the stats are stored for get_last_call_stats().
+    template <typename March>
+    void march_with_stats(
+        const std::vector<Derived*>& contexts, Output* const* outputs, March march);
 
     void move_to_next_boundary_edge(index_t& quad, index_t& forward, index_t& left) const;
 
+    // Called at the end of each pass of march_chunk(), before pass 0 creates the arrays that
+    // pass 1 writes to.  Empty so that it is optimised away, but a Derived class may define its
+    // own to observe the passes.
+    void pass_finished(const ChunkLocal& local);
+
+    // Add the stats of a chunk that has been traced starting at time trace_begin and exported
+    // starting at time export_begin.
+    void record_chunk_stats(
+        const ChunkLocal& local, const StatsMark& trace_begin, const StatsMark& export_begin);
+
+    // Add the stats of init_cache_levels_and_starts() of a chunk, or of the whole domain if local
+    // is nullptr, that started at time init_begin.
+    void record_init_stats(const ChunkLocal* local, const StatsMark& init_begin);
+
+    // Set the current contouring operation of a per-call context.
+    void prepare_filled(double lower_level, double upper_level);
+    void prepare_lines(double level);
+
+    // Return a per-call context for reuse by later calls.
+    void release_context(std::unique_ptr<Derived> context);
+
     void set_look_flags(index_t hole_start_quad);
 
     void write_cache_quad(index_t quad) const;
@@ -173,10 +283,10 @@ protected:
 
 
 private:
-    const CoordinateArray _x, _y, _z;
-    const double* _xptr;                   // For quick access to _x.data().
+    const double* _xptr;                   // Not owned.
     const double* _yptr;
     const double* _zptr;
+    const bool* _maskptr;                  // Not owned, nullptr if no mask.
     const index_t _nx, _ny;                // Number of points in each direction.
     const index_t _n;                      // Total number of points (and quads).
     const index_t _x_chunk_size, _y_chunk_size;
@@ -188,20 +298,33 @@ private:
     const bool _quad_as_tri;
     const ZInterp _z_interp;
 
+    // In a generator this only contains the grid-invariant bits, in a per-call context it also
+    // contains the z-levels and flags of the current contouring operation.
     CacheItem* _cache;
+    const bool _cache_external;  // Whether _cache was supplied to constructor and is not owned.
+
+    // Per-call contexts that are not currently in use.
+    std::vector<std::unique_ptr<Derived>> _contexts;
+    mutable std::mutex _contexts_mutex;
 
-    // Current contouring operation.
+    // Current contouring operation, only used in per-call contexts.
     bool _filled;
     double _lower_level, _upper_level;
 
     // Current contouring operation, based on return type and filled or lines.
     bool _identify_holes;
-    bool _output_chunked;             // Implies empty chunks will have py::none().
-    bool _direct_points;              // Whether points array is written direct to Python.
-    bool _direct_line_offsets;        // Whether line offsets array is written direct to Python.
-    bool _direct_outer_offsets;       // Whether outer offsets array is written direct to Python.
+    bool _output_chunked;             // Implies empty chunks will be set empty in Output.
+    bool _direct_points;              // Whether points array is written direct to Output.
+    bool _direct_line_offsets;        // Whether line offsets array is written direct to Output.
+    bool _direct_outer_offsets;       // Whether outer offsets array is written direct to Output.
     bool _outer_offsets_into_points;  // Otherwise into line offsets.  Only used if _identify_holes.
     unsigned int _return_list_count;
+
+    // Stats of calls.  _stats is only set in per-call contexts whilst they are collecting.
+    std::atomic<bool> _collect_stats, _perf_counters;
+    std::shared_ptr<const CallStats> _last_call_stats;
+    mutable std::mutex _stats_mutex;
+    CallStats* _stats;
 };
 
 #endif // CONTOURPY_BASE_H
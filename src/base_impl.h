@@ -3,7 +3,11 @@
 
 #include "base.h"
 #include "converter.h"
+#include "util.h"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <stdexcept>
 
 
 // Point indices from current quad index.
@@ -88,17 +92,15 @@
 
 template <typename Derived>
 BaseContourGenerator<Derived>::BaseContourGenerator(
-    const CoordinateArray& x, const CoordinateArray& y, const CoordinateArray& z,
-    const MaskArray& mask, bool corner_mask, LineType line_type, FillType fill_type,
-    bool quad_as_tri, ZInterp z_interp, index_t x_chunk_size, index_t y_chunk_size)
-    : _x(x),
-      _y(y),
-      _z(z),
-      _xptr(_x.data()),
-      _yptr(_y.data()),
-      _zptr(_z.data()),
-      _nx(_z.ndim() > 1 ? _z.shape(1) : 0),
-      _ny(_z.ndim() > 0 ? _z.shape(0) : 0),
+    const double* x, const double* y, const double* z, const bool* mask, index_t nx,
+    index_t ny, bool corner_mask, LineType line_type, FillType fill_type, bool quad_as_tri,
+    ZInterp z_interp, index_t x_chunk_size, index_t y_chunk_size, const uint32_t* grid_cache)
+    : _xptr(x),
+      _yptr(y),
+      _zptr(z),
+      _maskptr(mask),
+      _nx(nx),
+      _ny(ny),
       _n(_nx*_ny),
       _x_chunk_size(x_chunk_size > 0 ? std::min(x_chunk_size, _nx-1) : _nx-1),
       _y_chunk_size(y_chunk_size > 0 ? std::min(y_chunk_size, _ny-1) : _ny-1),
@@ -110,7 +112,8 @@ BaseContourGenerator<Derived>::BaseContourGenerator(
       _fill_type(fill_type),
       _quad_as_tri(quad_as_tri),
       _z_interp(z_interp),
-      _cache(new CacheItem[_n]),
+      _cache(const_cast<CacheItem*>(grid_cache)),
+      _cache_external(grid_cache != nullptr),
       _filled(false),
       _lower_level(0.0),
       _upper_level(0.0),
@@ -120,27 +123,14 @@ BaseContourGenerator<Derived>::BaseContourGenerator(
       _direct_line_offsets(false),
       _direct_outer_offsets(false),
       _outer_offsets_into_points(false),
-      _return_list_count(0)
+      _return_list_count(0),
+      _collect_stats(false),
+      _perf_counters(false),
+      _stats(nullptr)
 {
-    if (_x.ndim() != 2 || _y.ndim() != 2 || _z.ndim() != 2)
-        throw std::invalid_argument("x, y and z must all be 2D arrays");
-
-    if (_x.shape(1) != _nx || _x.shape(0) != _ny ||
-        _y.shape(1) != _nx || _y.shape(0) != _ny)
-        throw std::invalid_argument("x, y and z arrays must have the same shape");
-
     if (_nx < 2 || _ny < 2)
         throw std::invalid_argument("x, y and z must all be at least 2x2 arrays");
 
-    if (mask.ndim() != 0) {  // ndim == 0 if mask is not set, which is valid.
-        if (mask.ndim() != 2)
-            throw std::invalid_argument("mask array must be a 2D array");
-
-        if (mask.shape(1) != _nx || mask.shape(0) != _ny)
-            throw std::invalid_argument(
-                "If mask is set it must be a 2D array with the same shape as z");
-    }
-
     if (!supports_line_type(line_type))
         throw std::invalid_argument("Unsupported LineType");
 
@@ -150,21 +140,81 @@ BaseContourGenerator<Derived>::BaseContourGenerator(
     if (x_chunk_size < 0 || y_chunk_size < 0)
         throw std::invalid_argument("chunk_sizes cannot be negative");
 
-    if (_z_interp == ZInterp::Log) {
-        const bool* mask_ptr = (mask.ndim() == 0 ? nullptr : mask.data());
-        for (index_t point = 0; point < _n; ++point) {
-            if ( (mask_ptr == nullptr || !mask_ptr[point]) && _zptr[point] <= 0.0)
-                throw std::invalid_argument("z values must be positive if using ZInterp.Log");
-        }
+    if (grid_cache != nullptr) {
+        // Grid cache calculated by another generator with the same grid, mask and chunk sizes,
+        // which has already checked z.  It is never written to so may be read-only or shared
+        // between processes.  It must have the same shape as z, and is checked as it may have
+        // been read from a file.
+        check_cache_grid();
+        return;
     }
 
+    check_z(_zptr);
+
+    // Allocated after all checks as the destructor is not called if the constructor throws.
+    _cache = static_cast<CacheItem*>(Util::allocate_large(_n*sizeof(CacheItem)));
     init_cache_grid(mask);
 }
 
+template <typename Derived>
+BaseContourGenerator<Derived>::BaseContourGenerator(const BaseContourGenerator* generator)
+    : _xptr(generator->_xptr),
+      _yptr(generator->_yptr),
+      _zptr(generator->_zptr),
+      _maskptr(generator->_maskptr),
+      _nx(generator->_nx),
+      _ny(generator->_ny),
+      _n(generator->_n),
+      _x_chunk_size(generator->_x_chunk_size),
+      _y_chunk_size(generator->_y_chunk_size),
+      _nx_chunks(generator->_nx_chunks),
+      _ny_chunks(generator->_ny_chunks),
+      _n_chunks(generator->_n_chunks),
+      _corner_mask(generator->_corner_mask),
+      _line_type(generator->_line_type),
+      _fill_type(generator->_fill_type),
+      _quad_as_tri(generator->_quad_as_tri),
+      _z_interp(generator->_z_interp),
+      _cache(static_cast<CacheItem*>(Util::allocate_large(_n*sizeof(CacheItem)))),
+      _cache_external(false),
+      _filled(false),
+      _lower_level(0.0),
+      _upper_level(0.0),
+      _identify_holes(false),
+      _output_chunked(false),
+      _direct_points(false),
+      _direct_line_offsets(false),
+      _direct_outer_offsets(false),
+      _outer_offsets_into_points(false),
+      _return_list_count(0),
+      _collect_stats(false),
+      _perf_counters(false),
+      _stats(nullptr)
+{
+    // Generator's cache only contains grid-invariant bits.
+    std::copy(generator->_cache, generator->_cache + _n, _cache);
+}
+
 template <typename Derived>
 BaseContourGenerator<Derived>::~BaseContourGenerator()
 {
-    delete [] _cache;
+    if (!_cache_external)
+        Util::free_large(_cache);
+}
+
+template <typename Derived>
+std::unique_ptr<Derived> BaseContourGenerator<Derived>::acquire_context()
+{
+    {
+        std::lock_guard<std::mutex> guard(_contexts_mutex);
+        if (!_contexts.empty()) {
+            auto context = std::move(_contexts.back());
+            _contexts.pop_back();
+            return context;
+        }
+    }
+
+    return std::unique_ptr<Derived>(new Derived(static_cast<const Derived*>(this)));
 }
 
 template <typename Derived>
@@ -235,6 +285,46 @@ void BaseContourGenerator<Derived>::closed_line(
         local.hole_count++;
 }
 
+template <typename Derived>
+void BaseContourGenerator<Derived>::check_cache_grid() const
+{
+    // Boundaries are calculated from the existing quads and corners as in init_cache_grid, which
+    // is the same whether or not there is a mask.
+    const CacheItem grid_bits = MASK_BOUNDARY_E | MASK_BOUNDARY_N | MASK_EXISTS_ANY;
+    index_t i, j, quad;
+    for (j = 0, quad = 0; j < _ny; ++j) {
+        bool j_chunk_boundary = j % _y_chunk_size == 0;
+
+        for (i = 0; i < _nx; ++i, ++quad) {
+            bool i_chunk_boundary = i % _x_chunk_size == 0;
+            CacheItem exists = EXISTS_ANY(quad);
+
+            bool valid = (_cache[quad] & ~grid_bits) == 0;
+            if (exists != 0) {
+                // Quads are to the SW of their point, and at most one corner of a quad exists.
+                valid = valid && i > 0 && j > 0 && (exists & (exists - 1)) == 0 &&
+                    (_corner_mask || exists == MASK_EXISTS_QUAD);
+            }
+
+            bool exists_E_edge = EXISTS_E_EDGE(quad);
+            bool E_exists_W_edge = (i < _nx-1 && EXISTS_W_EDGE(quad+1));
+            bool exists_N_edge = EXISTS_N_EDGE(quad);
+            bool N_exists_S_edge = (j < _ny-1 && EXISTS_S_EDGE(quad+_nx));
+            bool boundary_E = exists_E_edge != E_exists_W_edge ||
+                (i_chunk_boundary && exists_E_edge && E_exists_W_edge);
+            bool boundary_N = exists_N_edge != N_exists_S_edge ||
+                (j_chunk_boundary && exists_N_edge && N_exists_S_edge);
+
+            if (!valid || boundary_E != (BOUNDARY_E(quad) != 0) ||
+                boundary_N != (BOUNDARY_N(quad) != 0)) {
+                throw std::invalid_argument(
+                    "grid_cache is not consistent with the grid and chunk sizes at point (" +
+                    std::to_string(j) + ", " + std::to_string(i) + ")");
+            }
+        }
+    }
+}
+
 template <typename Derived>
 void BaseContourGenerator<Derived>::check_consistent_counts(const ChunkLocal& local) const
 {
@@ -293,6 +383,17 @@ void BaseContourGenerator<Derived>::check_consistent_counts(const ChunkLocal& lo
     }
 }
 
+template <typename Derived>
+void BaseContourGenerator<Derived>::check_z(const double* z) const
+{
+    if (_z_interp == ZInterp::Log) {
+        for (index_t point = 0; point < _n; ++point) {
+            if ( (_maskptr == nullptr || !_maskptr[point]) && z[point] <= 0.0)
+                throw std::invalid_argument("z values must be positive if using ZInterp.Log");
+        }
+    }
+}
+
 template <typename Derived>
 void BaseContourGenerator<Derived>::closed_line_wrapper(
     const Location& start_location, OuterOrHole outer_or_hole, ChunkLocal& local)
@@ -308,7 +409,7 @@ void BaseContourGenerator<Derived>::closed_line_wrapper(
 
         closed_line(start_location, outer_or_hole, local);
 
-        for (py::size_t i = 0; i < local.look_up_quads.size(); ++i) {
+        for (std::size_t i = 0; i < local.look_up_quads.size(); ++i) {
             // Note that the collection can increase in size during this loop.
             index_t quad = local.look_up_quads[i];
 
@@ -331,6 +432,33 @@ void BaseContourGenerator<Derived>::closed_line_wrapper(
     }
 }
 
+template <typename Derived>
+count_t BaseContourGenerator<Derived>::count_starts(const ChunkLocal& local) const
+{
+    count_t starts = 0;
+    for (index_t j = local.jstart; j <= local.jend; ++j) {
+        for (index_t quad = local.istart + j*_nx; quad <= local.iend + j*_nx; ++quad) {
+            for (auto bits = _cache[quad] & MASK_ANY_START; bits != 0; bits &= bits - 1)
+                ++starts;
+        }
+    }
+    return starts;
+}
+
+template <typename Derived>
+count_t BaseContourGenerator<Derived>::count_visited_quads(const ChunkLocal& local) const
+{
+    count_t rows = 0;
+    for (index_t j = local.jstart; j <= local.jend; ++j) {
+        index_t quad = local.istart + j*_nx;
+        if (NO_MORE_STARTS(quad))
+            break;
+        if (!NO_STARTS_IN_ROW(quad))
+            ++rows;
+    }
+    return rows*(local.iend - local.istart + 1);
+}
+
 template <typename Derived>
 FillType BaseContourGenerator<Derived>::default_fill_type()
 {
@@ -348,8 +476,7 @@ LineType BaseContourGenerator<Derived>::default_line_type()
 }
 
 template <typename Derived>
-void BaseContourGenerator<Derived>::export_filled(
-    ChunkLocal& local, std::vector<py::list>& return_lists)
+void BaseContourGenerator<Derived>::export_filled(ChunkLocal& local, Output& output)
 {
     assert(local.total_point_count > 0);
 
@@ -360,7 +487,7 @@ void BaseContourGenerator<Derived>::export_filled(
             assert(!_direct_points && !_direct_line_offsets);
             auto outer_count = local.line_count - local.hole_count;
 
-            typename Derived::Lock lock(static_cast<Derived&>(*this));
+            std::lock_guard<Output> lock(output);
 
             for (decltype(outer_count) i = 0; i < outer_count; ++i) {
                 auto outer_start = local.outer_offsets.start[i];
@@ -370,17 +497,19 @@ void BaseContourGenerator<Derived>::export_filled(
                 auto point_count = point_end - point_start;
                 assert(point_count > 2);
 
-                return_lists[0].append(Converter::convert_points(
-                    point_count, local.points.start + 2*point_start));
+                Converter::convert_points(
+                    point_count, local.points.start + 2*point_start,
+                    output.append_points(point_count));
 
+                auto cut_count = outer_end - outer_start + 1;
                 if (_fill_type == FillType::OuterCode)
-                    return_lists[1].append(Converter::convert_codes(
-                        point_count, outer_end - outer_start + 1,
-                        local.line_offsets.start + outer_start, point_start));
+                    Converter::convert_codes(
+                        point_count, cut_count, local.line_offsets.start + outer_start,
+                        point_start, output.append_codes(point_count));
                 else
-                    return_lists[1].append(Converter::convert_offsets(
-                        outer_end - outer_start + 1, local.line_offsets.start + outer_start,
-                        point_start));
+                    Converter::convert_offsets(
+                        cut_count, local.line_offsets.start + outer_start, point_start,
+                        output.append_offsets(cut_count));
             }
             break;
         }
@@ -388,13 +517,13 @@ void BaseContourGenerator<Derived>::export_filled(
         case FillType::ChunkCombinedCodeOffset: {
             assert(_direct_points && !_direct_line_offsets);
 
-            typename Derived::Lock lock(static_cast<Derived&>(*this));
+            std::lock_guard<Output> lock(output);
 
-            // return_lists[0][local_chunk] already contains combined points.
-            // If ChunkCombinedCodeOffset. return_lists[2][local.chunk] already contains outer
-            //    offsets.
-            return_lists[1][local.chunk] = Converter::convert_codes(
-                local.total_point_count, local.line_count + 1, local.line_offsets.start);
+            // Output list 0 already contains combined points for local.chunk.
+            // If ChunkCombinedCodeOffset, list 2 already contains outer offsets.
+            Converter::convert_codes(
+                local.total_point_count, local.line_count + 1, local.line_offsets.start, 0,
+                output.set_codes(local.chunk, local.total_point_count));
             break;
         }
         case FillType::ChunkCombinedOffset:
@@ -403,17 +532,15 @@ void BaseContourGenerator<Derived>::export_filled(
             if (_fill_type == FillType::ChunkCombinedOffsetOffset) {
                 assert(_direct_outer_offsets);
             }
-            // return_lists[0][local_chunk] already contains combined points.
-            // return_lists[1][local.chunk] already contains line offsets.
-            // If ChunkCombinedOffsetOffset, return_lists[2][local.chunk] already contains
-            //      outer offsets.
+            // Output list 0 already contains combined points for local.chunk.
+            // Output list 1 already contains line offsets.
+            // If ChunkCombinedOffsetOffset, list 2 already contains outer offsets.
             break;
     }
 }
 
 template <typename Derived>
-void BaseContourGenerator<Derived>::export_lines(
-    ChunkLocal& local, std::vector<py::list>& return_lists)
+void BaseContourGenerator<Derived>::export_lines(ChunkLocal& local, Output& output)
 {
     assert(local.total_point_count > 0);
 
@@ -423,7 +550,7 @@ void BaseContourGenerator<Derived>::export_lines(
         case LineType::SeparateCode: {
             assert(!_direct_points && !_direct_line_offsets);
 
-            typename Derived::Lock lock(static_cast<Derived&>(*this));
+            std::lock_guard<Output> lock(output);
 
             for (decltype(local.line_count) i = 0; i < local.line_count; ++i) {
                 auto point_start = local.line_offsets.start[i];
@@ -431,58 +558,60 @@ void BaseContourGenerator<Derived>::export_lines(
                 auto point_count = point_end - point_start;
                 assert(point_count > 1);
 
-                return_lists[0].append(Converter::convert_points(
-                    point_count, local.points.start + 2*point_start));
+                Converter::convert_points(
+                    point_count, local.points.start + 2*point_start,
+                    output.append_points(point_count));
 
                 if (_line_type == LineType::SeparateCode)
-                    return_lists[1].append(
-                        Converter::convert_codes_check_closed_single(
-                            point_count, local.points.start + 2*point_start));
+                    Converter::convert_codes_check_closed_single(
+                        point_count, local.points.start + 2*point_start,
+                        output.append_codes(point_count));
             }
             break;
         }
         case LineType::ChunkCombinedCode: {
             assert(_direct_points && !_direct_line_offsets);
 
-            typename Derived::Lock lock(static_cast<Derived&>(*this));
+            std::lock_guard<Output> lock(output);
 
-            // return_lists[0][local.chunk] already contains points.
-            return_lists[1][local.chunk] = Converter::convert_codes_check_closed(
+            // Output list 0 already contains points for local.chunk.
+            Converter::convert_codes_check_closed(
                 local.total_point_count, local.line_count + 1, local.line_offsets.start,
-                local.points.start);
+                local.points.start, output.set_codes(local.chunk, local.total_point_count));
             break;
         }
         case LineType::ChunkCombinedOffset:
             assert(_direct_points && _direct_line_offsets);
-            // return_lists[0][local.chunk] already contains points.
-            // return_lists[1][local.chunk] already contains line offsets.
+            // Output list 0 already contains points for local.chunk.
+            // Output list 1 already contains line offsets.
             break;
     }
 }
 
 template <typename Derived>
-py::sequence BaseContourGenerator<Derived>::filled(double lower_level, double upper_level)
+void BaseContourGenerator<Derived>::filled(
+    double lower_level, double upper_level, Output& output)
 {
     if (lower_level > upper_level)
         throw std::invalid_argument("upper and lower levels are the wrong way round");
 
-    _filled = true;
-    _lower_level = lower_level;
-    _upper_level = upper_level;
+    auto context = acquire_context();
+    Output* outputs[] = {&output};
+    march_with_stats({context.get()}, outputs, [&](Output* const* marched) {
+        context->march_filled(lower_level, upper_level, *marched[0]);
+    });
+    release_context(std::move(context));
+}
 
-    _identify_holes = !(_fill_type == FillType::ChunkCombinedCode ||
-                        _fill_type == FillType::ChunkCombinedOffset);
-    _output_chunked = !(_fill_type == FillType::OuterCode || _fill_type == FillType::OuterOffset);
-    _direct_points = _output_chunked;
-    _direct_line_offsets = (_fill_type == FillType::ChunkCombinedOffset||
-                            _fill_type == FillType::ChunkCombinedOffsetOffset);
-    _direct_outer_offsets = (_fill_type == FillType::ChunkCombinedCodeOffset ||
-                             _fill_type == FillType::ChunkCombinedOffsetOffset);
-    _outer_offsets_into_points = (_fill_type == FillType::ChunkCombinedCodeOffset);
-    _return_list_count = (_fill_type == FillType::ChunkCombinedCodeOffset ||
-                          _fill_type == FillType::ChunkCombinedOffsetOffset) ? 3 : 2;
+template <typename Derived>
+void BaseContourGenerator<Derived>::filled_fields(
+    double lower_level, double upper_level, const double* const* zs, index_t n_fields,
+    Output* const* outputs)
+{
+    if (lower_level > upper_level)
+        throw std::invalid_argument("upper and lower levels are the wrong way round");
 
-    return static_cast<Derived*>(this)->march_wrapper();
+    march_fields_wrapper(true, lower_level, upper_level, zs, n_fields, outputs);
 }
 
 template <typename Derived>
@@ -1017,9 +1146,9 @@ index_t BaseContourGenerator<Derived>::get_boundary_start_point(const Location&
 }
 
 template <typename Derived>
-py::tuple BaseContourGenerator<Derived>::get_chunk_count() const
+std::pair<index_t, index_t> BaseContourGenerator<Derived>::get_chunk_count() const
 {
-    return py::make_tuple(_ny_chunks, _nx_chunks);
+    return std::make_pair(_ny_chunks, _nx_chunks);
 }
 
 template <typename Derived>
@@ -1040,9 +1169,15 @@ void BaseContourGenerator<Derived>::get_chunk_limits(index_t chunk, ChunkLocal&
 }
 
 template <typename Derived>
-py::tuple BaseContourGenerator<Derived>::get_chunk_size() const
+std::pair<index_t, index_t> BaseContourGenerator<Derived>::get_chunk_size() const
 {
-    return py::make_tuple(_y_chunk_size, _x_chunk_size);
+    return std::make_pair(_y_chunk_size, _x_chunk_size);
+}
+
+template <typename Derived>
+bool BaseContourGenerator<Derived>::get_collect_stats() const
+{
+    return _collect_stats;
 }
 
 template <typename Derived>
@@ -1057,6 +1192,19 @@ FillType BaseContourGenerator<Derived>::get_fill_type() const
     return _fill_type;
 }
 
+template <typename Derived>
+const uint32_t* BaseContourGenerator<Derived>::get_grid_cache() const
+{
+    return _cache;
+}
+
+template <typename Derived>
+std::shared_ptr<const CallStats> BaseContourGenerator<Derived>::get_last_call_stats() const
+{
+    std::lock_guard<std::mutex> guard(_stats_mutex);
+    return _last_call_stats;
+}
+
 template <typename Derived>
 index_t BaseContourGenerator<Derived>::get_interior_start_left_point(
     const Location& location, bool& start_corner_diagonal) const
@@ -1149,6 +1297,24 @@ index_t BaseContourGenerator<Derived>::get_n_chunks() const
     return _n_chunks;
 }
 
+template <typename Derived>
+index_t BaseContourGenerator<Derived>::get_nx() const
+{
+    return _nx;
+}
+
+template <typename Derived>
+index_t BaseContourGenerator<Derived>::get_ny() const
+{
+    return _ny;
+}
+
+template <typename Derived>
+bool BaseContourGenerator<Derived>::get_perf_counters() const
+{
+    return _perf_counters;
+}
+
 template <typename Derived>
 void BaseContourGenerator<Derived>::get_point_xy(index_t point, double*& points) const
 {
@@ -1191,10 +1357,10 @@ ZInterp BaseContourGenerator<Derived>::get_z_interp() const
 }
 
 template <typename Derived>
-void BaseContourGenerator<Derived>::init_cache_grid(const MaskArray& mask)
+void BaseContourGenerator<Derived>::init_cache_grid(const bool* mask)
 {
     index_t i, j, quad;
-    if (mask.ndim() == 0) {
+    if (mask == nullptr) {
         // No mask, easy to calculate quad existence and boundaries together.
         for (j = 0, quad = 0; j < _ny; ++j) {
             for (i = 0; i < _nx; ++i, ++quad) {
@@ -1214,7 +1380,7 @@ void BaseContourGenerator<Derived>::init_cache_grid(const MaskArray& mask)
     else {
         // Could maybe speed this up and just have a single pass.
         // Care would be needed with lookback of course.
-        const bool* mask_ptr = mask.data();
+        const bool* mask_ptr = mask;
 
         // Have mask so use two stages.
         // Stage 1, determine if quads/corners exist.
@@ -1301,6 +1467,10 @@ void BaseContourGenerator<Derived>::init_cache_levels_and_starts(const ChunkLoca
     // cache items already set and so must temporarily calculate those z-levels rather than reading
     // the cache.
 
+    StatsMark init_begin;
+    if (_stats != nullptr)
+        init_begin = _stats->mark();
+
     constexpr CacheItem keep_mask = (MASK_EXISTS_ANY | MASK_BOUNDARY_N | MASK_BOUNDARY_E);
 
     index_t istart, iend, jstart, jend;  // Loop indices.
@@ -1941,6 +2111,20 @@ void BaseContourGenerator<Derived>::init_cache_levels_and_starts(const ChunkLoca
 
     if (j_final_start < jend)
         _cache[chunk_istart + (j_final_start+1)*_nx] |= MASK_NO_MORE_STARTS;
+
+    if (_stats != nullptr)
+        record_init_stats(local, init_begin);
+}
+
+template <typename Derived>
+void BaseContourGenerator<Derived>::init_output(Output& output) const
+{
+    index_t list_len = _n_chunks;
+    if ((_filled && (_fill_type == FillType::OuterCode|| _fill_type == FillType::OuterOffset)) ||
+        (!_filled && (_line_type == LineType::Separate || _line_type == LineType::SeparateCode)))
+        list_len = 0;
+
+    output.init(_return_list_count, list_len);
 }
 
 template <typename Derived>
@@ -2025,29 +2209,38 @@ void BaseContourGenerator<Derived>::line(const Location& start_location, ChunkLo
 }
 
 template <typename Derived>
-py::sequence BaseContourGenerator<Derived>::lines(double level)
+void BaseContourGenerator<Derived>::lines(double level, Output& output)
 {
-    _filled = false;
-    _lower_level = _upper_level = level;
-
-    _identify_holes = false;
-    _output_chunked = !(_line_type == LineType::Separate || _line_type == LineType::SeparateCode);
-    _direct_points = _output_chunked;
-    _direct_line_offsets = (_line_type == LineType::ChunkCombinedOffset);
-    _direct_outer_offsets = false;
-    _outer_offsets_into_points = false;
-    _return_list_count = (_line_type == LineType::Separate) ? 1 : 2;
+    auto context = acquire_context();
+    Output* outputs[] = {&output};
+    march_with_stats({context.get()}, outputs, [&](Output* const* marched) {
+        context->march_lines(level, *marched[0]);
+    });
+    release_context(std::move(context));
+}
 
-    return static_cast<Derived*>(this)->march_wrapper();
+template <typename Derived>
+void BaseContourGenerator<Derived>::lines_fields(
+    double level, const double* const* zs, index_t n_fields, Output* const* outputs)
+{
+    march_fields_wrapper(false, level, level, zs, n_fields, outputs);
 }
 
 template <typename Derived>
-void BaseContourGenerator<Derived>::march_chunk(
-    ChunkLocal& local, std::vector<py::list>& return_lists)
+void BaseContourGenerator<Derived>::march_chunk(ChunkLocal& local, Output& output)
 {
+    StatsMark trace_begin;
+    if (_stats != nullptr) {
+        _stats->chunks[local.chunk].starts += count_starts(local);
+        trace_begin = _stats->mark();
+    }
+
     for (local.pass = 0; local.pass < 2; ++local.pass) {
         bool ignore_holes = (_identify_holes && local.pass == 1);
 
+        if (_stats != nullptr)
+            _stats->chunks[local.chunk].quads += count_visited_quads(local);
+
         index_t j_final_start = local.jstart;
         for (index_t j = local.jstart; j <= local.jend; ++j) {
             index_t quad = local.istart + j*_nx;
@@ -2167,6 +2360,8 @@ void BaseContourGenerator<Derived>::march_chunk(
         if (j_final_start < local.jend)
             _cache[local.istart + (j_final_start+1)*_nx] |= MASK_NO_MORE_STARTS;
 
+        static_cast<Derived*>(this)->pass_finished(local);
+
         if (local.pass == 0) {
             if (local.total_point_count == 0) {
                 local.points.clear();
@@ -2176,24 +2371,24 @@ void BaseContourGenerator<Derived>::march_chunk(
             }
 
             // Create arrays for points, line_offsets and optionally outer_offsets.  Arrays may be
-            // either C++ vectors or Python NumPy arrays.  Want to group creation of the latter as
-            // threaded code needs to lock creation of these to limit access to a single thread.
+            // either C++ vectors or arrays of the Output.  Want to group creation of the latter as
+            // threaded code needs to lock the Output to limit access to a single thread.
             if (_direct_points || _direct_line_offsets || _direct_outer_offsets) {
-                typename Derived::Lock lock(static_cast<Derived&>(*this));
+                std::lock_guard<Output> lock(output);
 
-                // Strictly speaking adding the NumPy arrays to return_lists does not need to be
-                // within the lock.
                 if (_direct_points) {
-                    return_lists[0][local.chunk] =
-                        local.points.create_python(local.total_point_count, 2);
+                    local.points.create_direct(
+                        output.set_points(local.chunk, local.total_point_count),
+                        2*local.total_point_count);
                 }
                 if (_direct_line_offsets) {
-                    return_lists[1][local.chunk] =
-                        local.line_offsets.create_python(local.line_count + 1);
+                    auto count = local.line_count + 1;
+                    local.line_offsets.create_direct(output.set_offsets(local.chunk, count), count);
                 }
                 if (_direct_outer_offsets) {
-                    return_lists[2][local.chunk] =
-                        local.outer_offsets.create_python(local.line_count - local.hole_count + 1);
+                    auto count = local.line_count - local.hole_count + 1;
+                    local.outer_offsets.create_direct(
+                        output.set_outer_offsets(local.chunk, count), count);
                 }
             }
 
@@ -2232,46 +2427,122 @@ void BaseContourGenerator<Derived>::march_chunk(
     // Throw exception if the two passes returned different number of points, lines, etc.
     check_consistent_counts(local);
 
+    StatsMark export_begin;
+    if (_stats != nullptr)
+        export_begin = _stats->mark();
+
     if (local.total_point_count == 0) {
         if (_output_chunked) {
-            typename Derived::Lock lock(static_cast<Derived&>(*this));
-            for (auto& list : return_lists)
-                list[local.chunk] = py::none();
+            std::lock_guard<Output> lock(output);
+            output.set_empty(local.chunk);
         }
     }
     else if (_filled)
-        export_filled(local, return_lists);
+        export_filled(local, output);
     else
-        export_lines(local, return_lists);
+        export_lines(local, output);
+
+    if (_stats != nullptr)
+        record_chunk_stats(local, trace_begin, export_begin);
 }
 
 template <typename Derived>
-py::sequence BaseContourGenerator<Derived>::march_wrapper()
+void BaseContourGenerator<Derived>::march_fields_wrapper(
+    bool filled, double lower_level, double upper_level, const double* const* zs,
+    index_t n_fields, Output* const* outputs)
 {
-    index_t list_len = _n_chunks;
-    if ((_filled && (_fill_type == FillType::OuterCode|| _fill_type == FillType::OuterOffset)) ||
-        (!_filled && (_line_type == LineType::Separate || _line_type == LineType::SeparateCode)))
-        list_len = 0;
+    if (n_fields < 1)
+        return;
+
+    // Checked here so that all front ends reject invalid fields before any are contoured.
+    for (index_t field = 0; field < n_fields; ++field)
+        check_z(zs[field]);
+
+    // Each field is contoured in its own per-call context that reads its z instead of the
+    // generator's z.  The contexts are returned for reuse only if contouring succeeds.
+    std::vector<std::unique_ptr<Derived>> owned;
+    std::vector<Derived*> fields;
+    owned.reserve(n_fields);
+    fields.reserve(n_fields);
+    for (index_t field = 0; field < n_fields; ++field) {
+        owned.push_back(acquire_context());
+        auto context = owned.back().get();
+        context->_zptr = zs[field];
+        if (filled)
+            context->prepare_filled(lower_level, upper_level);
+        else
+            context->prepare_lines(lower_level);
+        context->init_output(*outputs[field]);
+        fields.push_back(context);
+    }
 
-    // Prepare lists to return to python.
-    std::vector<py::list> return_lists;
-    return_lists.reserve(_return_list_count);
-    for (decltype(_return_list_count) i = 0; i < _return_list_count; ++i)
-        return_lists.emplace_back(list_len);
+    // The first context's chunk variables are used to coordinate marching of all of the fields.
+    march_with_stats(fields, outputs, [&](Output* const* marched) {
+        fields[0]->march_fields(fields, marched);
+    });
 
-    static_cast<Derived*>(this)->march(return_lists);
+    for (auto& context : owned) {
+        context->_zptr = _zptr;
+        release_context(std::move(context));
+    }
+}
 
-    // Return to python objects.
-    if (_return_list_count == 1) {
-        assert(!_filled && _line_type == LineType::Separate);
-        return return_lists[0];
+template <typename Derived>
+void BaseContourGenerator<Derived>::march_filled(
+    double lower_level, double upper_level, Output& output)
+{
+    prepare_filled(lower_level, upper_level);
+    march_wrapper(output);
+}
+
+template <typename Derived>
+void BaseContourGenerator<Derived>::march_lines(double level, Output& output)
+{
+    prepare_lines(level);
+    march_wrapper(output);
+}
+
+template <typename Derived>
+void BaseContourGenerator<Derived>::march_wrapper(Output& output)
+{
+    init_output(output);
+    static_cast<Derived*>(this)->march(output);
+}
+
+template <typename Derived>
+template <typename March>
+void BaseContourGenerator<Derived>::march_with_stats(
+    const std::vector<Derived*>& contexts, Output* const* outputs, March march)
+{
+    if (!_collect_stats) {
+        march(outputs);
+        return;
     }
-    else if (_return_list_count == 2)
-        return py::make_tuple(return_lists[0], return_lists[1]);
-    else {
-        assert(_return_list_count == 3);
-        return py::make_tuple(return_lists[0], return_lists[1], return_lists[2]);
+
+    std::shared_ptr<CallStats> stats(new CallStats(_n_chunks, _perf_counters));
+
+    std::vector<std::unique_ptr<StatsOutput>> stats_outputs;
+    std::vector<Output*> pointers;
+    for (std::size_t i = 0; i < contexts.size(); ++i) {
+        stats_outputs.emplace_back(new StatsOutput(*outputs[i], *stats));
+        pointers.push_back(stats_outputs.back().get());
     }
+
+    // Contexts are only reused if march succeeds, so they are not left pointing at stats.
+    for (auto context : contexts)
+        context->_stats = stats.get();
+
+    march(pointers.data());
+
+    for (auto context : contexts)
+        context->_stats = nullptr;
+
+    stats->finish();
+    for (auto& stats_output : stats_outputs)
+        stats->lock_wait_time += stats_output->lock_wait_time;
+
+    std::lock_guard<std::mutex> guard(_stats_mutex);
+    _last_call_stats = stats;
 }
 
 template <typename Derived>
@@ -2424,6 +2695,115 @@ void BaseContourGenerator<Derived>::move_to_next_boundary_edge(
     }
 }
 
+template <typename Derived>
+void BaseContourGenerator<Derived>::pass_finished(const ChunkLocal& /* local */)
+{}
+
+template <typename Derived>
+void BaseContourGenerator<Derived>::prepare_filled(double lower_level, double upper_level)
+{
+    _filled = true;
+    _lower_level = lower_level;
+    _upper_level = upper_level;
+
+    _identify_holes = !(_fill_type == FillType::ChunkCombinedCode ||
+                        _fill_type == FillType::ChunkCombinedOffset);
+    _output_chunked = !(_fill_type == FillType::OuterCode || _fill_type == FillType::OuterOffset);
+    _direct_points = _output_chunked;
+    _direct_line_offsets = (_fill_type == FillType::ChunkCombinedOffset||
+                            _fill_type == FillType::ChunkCombinedOffsetOffset);
+    _direct_outer_offsets = (_fill_type == FillType::ChunkCombinedCodeOffset ||
+                             _fill_type == FillType::ChunkCombinedOffsetOffset);
+    _outer_offsets_into_points = (_fill_type == FillType::ChunkCombinedCodeOffset);
+    _return_list_count = (_fill_type == FillType::ChunkCombinedCodeOffset ||
+                          _fill_type == FillType::ChunkCombinedOffsetOffset) ? 3 : 2;
+}
+
+template <typename Derived>
+void BaseContourGenerator<Derived>::prepare_lines(double level)
+{
+    _filled = false;
+    _lower_level = _upper_level = level;
+
+    _identify_holes = false;
+    _output_chunked = !(_line_type == LineType::Separate || _line_type == LineType::SeparateCode);
+    _direct_points = _output_chunked;
+    _direct_line_offsets = (_line_type == LineType::ChunkCombinedOffset);
+    _direct_outer_offsets = false;
+    _outer_offsets_into_points = false;
+    _return_list_count = (_line_type == LineType::Separate) ? 1 : 2;
+}
+
+template <typename Derived>
+void BaseContourGenerator<Derived>::record_chunk_stats(
+    const ChunkLocal& local, const StatsMark& trace_begin, const StatsMark& export_begin)
+{
+    auto export_end = _stats->mark();
+    auto& stats = _stats->chunks[local.chunk];
+    if (stats.export_end == 0.0)  // First field of chunk.
+        stats.trace_begin = trace_begin.time;
+    stats.export_begin = export_begin.time;
+    stats.export_end = export_end.time;
+    stats.trace_time += export_begin.time - trace_begin.time;
+    stats.export_time += export_end.time - export_begin.time;
+    _stats->add_event("trace", local.chunk, trace_begin.time, export_begin.time);
+    _stats->add_event("export", local.chunk, export_begin.time, export_end.time);
+    _stats->add_counts(_stats->trace_counts, trace_begin, export_begin);
+    _stats->add_counts(_stats->export_counts, export_begin, export_end);
+
+    auto point_count = local.total_point_count;
+    auto outer_count = local.line_count - local.hole_count;
+    stats.points += point_count;
+    stats.lines += local.line_count;
+    stats.holes += local.hole_count;
+
+    // Arrays written by pass 1, their copies if not written directly to the Output, and codes.
+    if (point_count == 0)
+        return;
+    std::size_t bytes = 2*point_count*sizeof(double) + (local.line_count + 1)*sizeof(offset_t);
+    if (_identify_holes)
+        bytes += (outer_count + 1)*sizeof(offset_t);
+    if (!_direct_points)
+        bytes += 2*point_count*sizeof(double);
+    bool codes = _filled ?
+        (_fill_type == FillType::OuterCode || _fill_type == FillType::ChunkCombinedCode ||
+         _fill_type == FillType::ChunkCombinedCodeOffset) :
+        (_line_type == LineType::SeparateCode || _line_type == LineType::ChunkCombinedCode);
+    if (codes)
+        bytes += point_count*sizeof(uint8_t);
+    else if (_filled && _fill_type == FillType::OuterOffset)
+        bytes += (local.line_count + outer_count)*sizeof(offset_t);
+    stats.bytes += bytes;
+}
+
+template <typename Derived>
+void BaseContourGenerator<Derived>::record_init_stats(
+    const ChunkLocal* local, const StatsMark& init_begin)
+{
+    auto init_end = _stats->mark();
+    _stats->add_event(
+        "init", local == nullptr ? -1 : local->chunk, init_begin.time, init_end.time);
+    _stats->add_counts(_stats->init_counts, init_begin, init_end);
+    if (local == nullptr) {
+        _stats->domain_init_begin = init_begin.time;
+        _stats->domain_init_end = init_end.time;
+    }
+    else {
+        auto& stats = _stats->chunks[local->chunk];
+        if (stats.init_end == 0.0)  // First field of chunk.
+            stats.init_begin = init_begin.time;
+        stats.init_end = init_end.time;
+        stats.init_time += init_end.time - init_begin.time;
+    }
+}
+
+template <typename Derived>
+void BaseContourGenerator<Derived>::release_context(std::unique_ptr<Derived> context)
+{
+    std::lock_guard<std::mutex> guard(_contexts_mutex);
+    _contexts.push_back(std::move(context));
+}
+
 template <typename Derived>
 void BaseContourGenerator<Derived>::set_look_flags(index_t hole_start_quad)
 {
@@ -2454,6 +2834,20 @@ void BaseContourGenerator<Derived>::set_look_flags(index_t hole_start_quad)
     }
 }
 
+template <typename Derived>
+void BaseContourGenerator<Derived>::set_collect_stats(bool collect_stats)
+{
+    _collect_stats = collect_stats;
+}
+
+template <typename Derived>
+void BaseContourGenerator<Derived>::set_perf_counters(bool perf_counters)
+{
+    if (perf_counters)
+        PerfCounts::check_available();
+    _perf_counters = perf_counters;
+}
+
 template <typename Derived>
 bool BaseContourGenerator<Derived>::supports_fill_type(FillType fill_type)
 {
@@ -2487,6 +2881,15 @@ bool BaseContourGenerator<Derived>::supports_line_type(LineType line_type)
 template <typename Derived>
 void BaseContourGenerator<Derived>::write_cache() const
 {
+    // Write the cache of the most recently finished call, if any, as it contains more information.
+    {
+        std::lock_guard<std::mutex> guard(_contexts_mutex);
+        if (!_contexts.empty()) {
+            _contexts.back()->write_cache();
+            return;
+        }
+    }
+
     std::cout << "---------- Cache ----------" << std::endl;
     index_t ny = _n / _nx;
     for (index_t j = ny-1; j >= 0; --j) {
@@ -0,0 +1,88 @@
+#include "buffer_output.h"
+
+BufferOutput::BufferOutput()
+    : list_count(0)
+{}
+
+double* BufferOutput::append_points(count_t point_count)
+{
+    points.emplace_back(2*point_count);
+    return points.back().data();
+}
+
+uint8_t* BufferOutput::append_codes(count_t count)
+{
+    codes.emplace_back(count);
+    return codes.back().data();
+}
+
+offset_t* BufferOutput::append_offsets(count_t count)
+{
+    offsets.emplace_back(count);
+    return offsets.back().data();
+}
+
+void BufferOutput::init(unsigned int list_count_, index_t list_len)
+{
+    list_count = list_count_;
+    points.clear();
+    codes.clear();
+    offsets.clear();
+    outer_offsets.clear();
+
+    // List 1 may contain either codes or offsets so both are sized, the unused one stays empty.
+    if (list_len > 0) {
+        points.resize(list_len);
+        if (list_count > 1) {
+            codes.resize(list_len);
+            offsets.resize(list_len);
+        }
+        if (list_count > 2)
+            outer_offsets.resize(list_len);
+    }
+}
+
+void BufferOutput::lock()
+{
+    _mutex.lock();
+}
+
+uint8_t* BufferOutput::set_codes(index_t chunk, count_t count)
+{
+    codes[chunk].resize(count);
+    return codes[chunk].data();
+}
+
+void BufferOutput::set_empty(index_t chunk)
+{
+    points[chunk].clear();
+    if (!codes.empty())
+        codes[chunk].clear();
+    if (!offsets.empty())
+        offsets[chunk].clear();
+    if (!outer_offsets.empty())
+        outer_offsets[chunk].clear();
+}
+
+offset_t* BufferOutput::set_offsets(index_t chunk, count_t count)
+{
+    offsets[chunk].resize(count);
+    return offsets[chunk].data();
+}
+
+offset_t* BufferOutput::set_outer_offsets(index_t chunk, count_t count)
+{
+    outer_offsets[chunk].resize(count);
+    return outer_offsets[chunk].data();
+}
+
+double* BufferOutput::set_points(index_t chunk, count_t point_count)
+{
+    points[chunk].resize(2*point_count);
+    return points[chunk].data();
+}
+
+void BufferOutput::unlock()
+{
+    _mutex.unlock();
+}
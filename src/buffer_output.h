@@ -0,0 +1,41 @@
+#ifndef CONTOURPY_BUFFER_OUTPUT_H
+#define CONTOURPY_BUFFER_OUTPUT_H
+
+#include "output.h"
+#include <mutex>
+#include <vector>
+
+// Output that stores arrays in C++ vectors, for use without Python.  An empty chunk is stored as
+// empty vectors.
+class BufferOutput : public Output
+{
+public:
+    BufferOutput();
+
+    void init(unsigned int list_count, index_t list_len) override;
+
+    void lock() override;
+    void unlock() override;
+
+    double* append_points(count_t point_count) override;
+    uint8_t* append_codes(count_t count) override;
+    offset_t* append_offsets(count_t count) override;
+
+    double* set_points(index_t chunk, count_t point_count) override;
+    uint8_t* set_codes(index_t chunk, count_t count) override;
+    offset_t* set_offsets(index_t chunk, count_t count) override;
+    offset_t* set_outer_offsets(index_t chunk, count_t count) override;
+
+    void set_empty(index_t chunk) override;
+
+    unsigned int list_count;                         // Number of lists, 1 to 3.
+    std::vector<std::vector<double>> points;         // List 0, interleaved x and y.
+    std::vector<std::vector<uint8_t>> codes;         // List 1 if codes.
+    std::vector<std::vector<offset_t>> offsets;      // List 1 if offsets.
+    std::vector<std::vector<offset_t>> outer_offsets;  // List 2.
+
+private:
+    std::mutex _mutex;
+};
+
+#endif // CONTOURPY_BUFFER_OUTPUT_H
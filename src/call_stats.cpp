@@ -0,0 +1,296 @@
+#include "call_stats.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Group of hardware counters of a single thread, led by the cycles counter.  Opened the first time
+// that a thread reads them and closed when it exits.
+class ThreadCounters
+{
+public:
+    ThreadCounters()
+        : _error(-1)
+    {
+        std::fill(_fds, _fds + n_counters, -1);
+    }
+
+    ~ThreadCounters()
+    {
+        for (auto fd : _fds) {
+            if (fd >= 0)
+                close(fd);
+        }
+    }
+
+    // Return 0 on success, otherwise errno of the failure.
+    int open()
+    {
+        if (_error >= 0)
+            return _error;
+
+        const uint64_t configs[n_counters] = {
+            PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES,
+            PERF_COUNT_HW_BRANCH_MISSES};
+
+        _error = 0;
+        for (int i = 0; i < n_counters && _error == 0; ++i) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof(attr);
+            attr.config = configs[i];
+            attr.read_format = PERF_FORMAT_GROUP;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            _fds[i] = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, _fds[0], 0));
+            if (_fds[i] < 0)
+                _error = errno;
+        }
+        return _error;
+    }
+
+    bool read(uint64_t* values)
+    {
+        if (open() != 0)
+            return false;
+
+        uint64_t buffer[1 + n_counters];  // Number of counters followed by their values.
+        if (::read(_fds[0], buffer, sizeof(buffer)) != sizeof(buffer))
+            return false;
+
+        std::copy(buffer + 1, buffer + 1 + n_counters, values);
+        return true;
+    }
+
+private:
+    static constexpr int n_counters = 4;
+    int _fds[n_counters];
+    int _error;  // -1 if not opened yet.
+};
+
+static thread_local ThreadCounters thread_counters;
+#endif // __linux__
+
+
+PerfCounts::PerfCounts()
+    : cycles(0), instructions(0), cache_misses(0), branch_misses(0)
+{}
+
+void PerfCounts::add(const PerfCounts& begin, const PerfCounts& end)
+{
+    cycles += end.cycles - begin.cycles;
+    instructions += end.instructions - begin.instructions;
+    cache_misses += end.cache_misses - begin.cache_misses;
+    branch_misses += end.branch_misses - begin.branch_misses;
+}
+
+void PerfCounts::check_available()
+{
+#ifdef __linux__
+    auto error = thread_counters.open();
+    if (error != 0)
+        throw std::runtime_error(
+            std::string("Hardware performance counters are not available: ") +
+            std::strerror(error));
+#else
+    throw std::runtime_error("Hardware performance counters are only available on Linux");
+#endif
+}
+
+PerfCounts PerfCounts::read()
+{
+    PerfCounts counts;
+#ifdef __linux__
+    uint64_t values[4];
+    if (thread_counters.read(values)) {
+        counts.cycles = values[0];
+        counts.instructions = values[1];
+        counts.cache_misses = values[2];
+        counts.branch_misses = values[3];
+    }
+#endif
+    return counts;
+}
+
+
+ChunkStats::ChunkStats()
+    : init_begin(0.0), init_end(0.0), trace_begin(0.0), export_begin(0.0), export_end(0.0),
+      init_time(0.0), trace_time(0.0), export_time(0.0), quads(0), starts(0), points(0),
+      lines(0), holes(0), bytes(0)
+{}
+
+CallStats::CallStats()
+    : CallStats(0, false)
+{}
+
+CallStats::CallStats(index_t n_chunks, bool perf_counters_)
+    : total_time(0.0), init_time(0.0), trace_time(0.0), export_time(0.0), lock_wait_time(0.0),
+      domain_init_begin(0.0), domain_init_end(0.0), chunks(n_chunks),
+      perf_counters(perf_counters_), _start(Clock::now()), _threads(1, std::this_thread::get_id())
+{}
+
+void CallStats::add_counts(PerfCounts& total, const StatsMark& begin, const StatsMark& end)
+{
+    if (perf_counters) {
+        std::lock_guard<std::mutex> guard(_events_mutex);
+        total.add(begin.counts, end.counts);
+    }
+}
+
+void CallStats::add_event(const char* name, index_t chunk, double begin, double end)
+{
+    auto thread_id = std::this_thread::get_id();
+
+    std::lock_guard<std::mutex> guard(_events_mutex);
+    auto it = std::find(_threads.begin(), _threads.end(), thread_id);
+    int thread = static_cast<int>(it - _threads.begin());
+    if (it == _threads.end())
+        _threads.push_back(thread_id);
+    events.push_back({name, chunk, thread, begin, end});
+}
+
+double CallStats::elapsed() const
+{
+    return std::chrono::duration<double>(Clock::now() - _start).count();
+}
+
+void CallStats::finish()
+{
+    total_time = elapsed();
+
+    // Stage wall times are from the first chunk to start to the last chunk to finish.
+    const double inf = std::numeric_limits<double>::infinity();
+    double init_begin = inf, init_end = -inf, trace_begin = inf, trace_end = -inf;
+    if (domain_init_end > 0.0) {
+        init_begin = domain_init_begin;
+        init_end = domain_init_end;
+    }
+
+    export_time = 0.0;
+    for (auto& chunk : chunks) {
+        if (chunk.init_end > 0.0) {
+            init_begin = std::min(init_begin, chunk.init_begin);
+            init_end = std::max(init_end, chunk.init_end);
+        }
+        if (chunk.export_end > 0.0) {
+            trace_begin = std::min(trace_begin, chunk.trace_begin);
+            trace_end = std::max(trace_end, chunk.export_end);
+        }
+        export_time += chunk.export_time;
+    }
+
+    init_time = (init_end > init_begin) ? init_end - init_begin : 0.0;
+    trace_time = (trace_end > trace_begin) ? trace_end - trace_begin : 0.0;
+}
+
+StatsMark CallStats::mark() const
+{
+    StatsMark mark;
+    if (perf_counters)
+        mark.counts = PerfCounts::read();
+    mark.time = elapsed();
+    return mark;
+}
+
+void CallStats::write_chrome_trace(std::ostream& os) const
+{
+    // Times in microseconds.  Each event is a complete event (ph X) of process 1.
+    char buffer[200];
+    os << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    for (std::size_t thread = 0; thread < _threads.size(); ++thread) {
+        std::snprintf(buffer, sizeof(buffer),
+                      "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, "
+                      "\"args\": {\"name\": \"%s %d\"}},\n", static_cast<int>(thread),
+                      thread == 0 ? "caller" : "worker", static_cast<int>(thread));
+        os << buffer;
+    }
+
+    std::snprintf(buffer, sizeof(buffer),
+                  "{\"name\": \"call\", \"ph\": \"X\", \"pid\": 1, \"tid\": 0, "
+                  "\"ts\": 0.0, \"dur\": %.3f}", 1e6*total_time);
+    os << buffer;
+
+    for (auto& event : events) {
+        std::snprintf(buffer, sizeof(buffer),
+                      ",\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, "
+                      "\"ts\": %.3f, \"dur\": %.3f, \"args\": {\"chunk\": %td}}",
+                      event.name, event.thread, 1e6*event.begin, 1e6*(event.end - event.begin),
+                      event.chunk);
+        os << buffer;
+    }
+    os << "\n]}\n";
+}
+
+
+StatsOutput::StatsOutput(Output& output, CallStats& stats)
+    : lock_wait_time(0.0), _output(output), _stats(stats)
+{}
+
+double* StatsOutput::append_points(count_t point_count)
+{
+    return _output.append_points(point_count);
+}
+
+uint8_t* StatsOutput::append_codes(count_t count)
+{
+    return _output.append_codes(count);
+}
+
+offset_t* StatsOutput::append_offsets(count_t count)
+{
+    return _output.append_offsets(count);
+}
+
+void StatsOutput::init(unsigned int list_count, index_t list_len)
+{
+    _output.init(list_count, list_len);
+}
+
+void StatsOutput::lock()
+{
+    auto begin = _stats.elapsed();
+    _output.lock();
+    auto end = _stats.elapsed();
+    lock_wait_time += end - begin;
+    _stats.add_event("lock_wait", -1, begin, end);
+}
+
+uint8_t* StatsOutput::set_codes(index_t chunk, count_t count)
+{
+    return _output.set_codes(chunk, count);
+}
+
+void StatsOutput::set_empty(index_t chunk)
+{
+    _output.set_empty(chunk);
+}
+
+offset_t* StatsOutput::set_offsets(index_t chunk, count_t count)
+{
+    return _output.set_offsets(chunk, count);
+}
+
+offset_t* StatsOutput::set_outer_offsets(index_t chunk, count_t count)
+{
+    return _output.set_outer_offsets(chunk, count);
+}
+
+double* StatsOutput::set_points(index_t chunk, count_t point_count)
+{
+    return _output.set_points(chunk, point_count);
+}
+
+void StatsOutput::unlock()
+{
+    _output.unlock();
+}
@@ -0,0 +1,146 @@
+// CallStats class holds the timings and counts of a single call of a contour generator derived
+// from BaseContourGenerator, which are collected if enabled by set_collect_stats().  Collection is
+// checked once per chunk and stage rather than in the loops over quads, and nothing is timed or
+// counted at all whilst it is disabled.  It also records a timeline of the events of each thread,
+// which can be written in the Chrome trace format to be viewed in Perfetto or chrome://tracing,
+// and optionally the hardware performance counters of each stage (Linux only).
+
+#ifndef CONTOURPY_CALL_STATS_H
+#define CONTOURPY_CALL_STATS_H
+
+#include "output.h"
+#include <chrono>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+// Values of the hardware performance counters of a thread, read using perf_event_open on Linux.
+struct PerfCounts
+{
+    PerfCounts();
+
+    // Add the counts between begin and end.
+    void add(const PerfCounts& begin, const PerfCounts& end);
+
+    // Throw std::runtime_error if the counters cannot be read by the calling thread.
+    static void check_available();
+
+    // Return the counters of the calling thread, which are opened when it first calls this.  All
+    // are zero if they are not available.
+    static PerfCounts read();
+
+    uint64_t cycles, instructions, cache_misses, branch_misses;
+};
+
+// Time since the start of a call and, if collecting them, counters of the current thread.
+struct StatsMark
+{
+    StatsMark()
+        : time(0.0)
+    {}
+
+    double time;
+    PerfCounts counts;
+};
+
+// Times are in seconds.  begin and end times are relative to the start of the call, and are those
+// of the first and last fields if a chunk is contoured for multiple fields.  Durations and counts
+// are summed over all fields.
+struct ChunkStats
+{
+    ChunkStats();
+
+    double init_begin, init_end;      // Stage 1: cache z-levels and starts of chunk.
+    double trace_begin, export_begin, export_end;  // Stage 2: trace then export.
+    double init_time, trace_time, export_time;
+    count_t quads;                    // Quads visited whilst looking for starts, in both passes.
+    count_t starts;                   // Start flags set in stage 1.
+    count_t points, lines, holes;
+    std::size_t bytes;                // Allocated for the points, offsets and codes arrays.
+};
+
+// Event of a thread, with times in seconds relative to the start of the call.
+struct TraceEvent
+{
+    const char* name;  // "init", "trace", "export" or "lock_wait".
+    index_t chunk;     // -1 if not of a particular chunk.
+    int thread;        // Index of thread in order of first event, the calling thread is 0.
+    double begin, end;
+};
+
+class CallStats
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    CallStats();
+    CallStats(index_t n_chunks, bool perf_counters);
+
+    // Add the counts between begin and end to total, may be called by multiple threads.
+    void add_counts(PerfCounts& total, const StatsMark& begin, const StatsMark& end);
+
+    // Add event of the current thread, may be called by multiple threads.
+    void add_event(const char* name, index_t chunk, double begin, double end);
+
+    // Return seconds since the start of the call.
+    double elapsed() const;
+
+    // Calculate the stage and total times at the end of the call.
+    void finish();
+
+    // Return the current time and, if collecting them, counters.
+    StatsMark mark() const;
+
+    // Write the events in the Chrome trace JSON format, with the whole call as an event of the
+    // calling thread that encloses all of its other events.
+    void write_chrome_trace(std::ostream& os) const;
+
+    double total_time;               // Wall time of the whole call.
+    double init_time, trace_time;    // Wall time of stages 1 and 2.
+    double export_time;              // Summed over all chunks.
+    double lock_wait_time;           // Waiting for Outputs to be unlocked by other threads.
+    double domain_init_begin, domain_init_end;  // Stage 1 if it is not done chunk by chunk.
+    std::vector<ChunkStats> chunks;
+    std::vector<TraceEvent> events;  // In the order that they were added.
+
+    // Hardware counters of each stage summed over all threads, only if perf_counters.
+    const bool perf_counters;
+    PerfCounts init_counts, trace_counts, export_counts;
+
+private:
+    Clock::time_point _start;
+    std::vector<std::thread::id> _threads;  // Of events.
+    std::mutex _events_mutex;               // Locks access to events, _threads and counts.
+};
+
+// Output that forwards to another Output, timing how long is spent waiting to lock it.
+class StatsOutput : public Output
+{
+public:
+    StatsOutput(Output& output, CallStats& stats);
+
+    void init(unsigned int list_count, index_t list_len) override;
+
+    void lock() override;
+    void unlock() override;
+
+    double* append_points(count_t point_count) override;
+    uint8_t* append_codes(count_t count) override;
+    offset_t* append_offsets(count_t count) override;
+
+    double* set_points(index_t chunk, count_t point_count) override;
+    uint8_t* set_codes(index_t chunk, count_t count) override;
+    offset_t* set_offsets(index_t chunk, count_t count) override;
+    offset_t* set_outer_offsets(index_t chunk, count_t count) override;
+
+    void set_empty(index_t chunk) override;
+
+    double lock_wait_time;  // Only modified whilst locked.
+
+private:
+    Output& _output;
+    CallStats& _stats;
+};
+
+#endif // CONTOURPY_CALL_STATS_H
@@ -0,0 +1,472 @@
+#include "buffer_output.h"
+#include "contourpy.h"
+#include "mpl2005.h"
+#include "mpl2014.h"
+#include "serial.h"
+#include "threaded.h"
+#include "tri.h"
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+static thread_local std::string last_error;
+
+// Generator of any algorithm, using the same functions to contour.
+struct contourpy_generator
+{
+    virtual ~contourpy_generator() = default;
+
+    virtual std::pair<index_t, index_t> chunk_count() const = 0;
+    virtual void filled(double lower_level, double upper_level, Output& output) = 0;
+    virtual void lines(double level, Output& output) = 0;
+
+    virtual void filled_fields(
+        double /* lower_level */, double /* upper_level */, const double* const* /* zs */,
+        index_t /* n_fields */, Output* const* /* outputs */)
+    {
+        throw std::invalid_argument("Algorithm does not support multiple fields");
+    }
+
+    virtual void lines_fields(
+        double /* level */, const double* const* /* zs */, index_t /* n_fields */,
+        Output* const* /* outputs */)
+    {
+        throw std::invalid_argument("Algorithm does not support multiple fields");
+    }
+
+    virtual void filled_levels(
+        const double* /* levels */, index_t /* n_levels */, Output* const* /* outputs */)
+    {
+        throw std::invalid_argument("Algorithm does not support multiple levels");
+    }
+
+    virtual void lines_levels(
+        const double* /* levels */, index_t /* n_levels */, Output* const* /* outputs */)
+    {
+        throw std::invalid_argument("Algorithm does not support multiple levels");
+    }
+};
+
+template <typename Generator>
+struct GeneratorImpl : public contourpy_generator
+{
+    template <typename... Args>
+    explicit GeneratorImpl(Args... args)
+        : generator(args...)
+    {}
+
+    std::pair<index_t, index_t> chunk_count() const override
+    {
+        return generator.get_chunk_count();
+    }
+
+    void filled(double lower_level, double upper_level, Output& output) override
+    {
+        generator.filled(lower_level, upper_level, output);
+    }
+
+    void lines(double level, Output& output) override
+    {
+        generator.lines(level, output);
+    }
+
+    Generator generator;
+};
+
+// Generator of an algorithm that can contour multiple fields at once.
+template <typename Generator>
+struct FieldsGeneratorImpl : public GeneratorImpl<Generator>
+{
+    template <typename... Args>
+    explicit FieldsGeneratorImpl(Args... args)
+        : GeneratorImpl<Generator>(args...)
+    {}
+
+    void filled_fields(
+        double lower_level, double upper_level, const double* const* zs, index_t n_fields,
+        Output* const* outputs) override
+    {
+        this->generator.filled_fields(lower_level, upper_level, zs, n_fields, outputs);
+    }
+
+    void lines_fields(
+        double level, const double* const* zs, index_t n_fields, Output* const* outputs) override
+    {
+        this->generator.lines_fields(level, zs, n_fields, outputs);
+    }
+};
+
+// Generator of an algorithm that can contour multiple levels at once.
+template <typename Generator>
+struct LevelsGeneratorImpl : public GeneratorImpl<Generator>
+{
+    template <typename... Args>
+    explicit LevelsGeneratorImpl(Args... args)
+        : GeneratorImpl<Generator>(args...)
+    {}
+
+    void filled_levels(const double* levels, index_t n_levels, Output* const* outputs) override
+    {
+        this->generator.filled_levels(levels, n_levels, outputs);
+    }
+
+    void lines_levels(const double* levels, index_t n_levels, Output* const* outputs) override
+    {
+        this->generator.lines_levels(levels, n_levels, outputs);
+    }
+};
+
+// Generator of a triangular mesh, whose chunks are not arranged in a grid.
+struct TriGeneratorImpl : public contourpy_generator
+{
+    template <typename... Args>
+    explicit TriGeneratorImpl(Args... args)
+        : generator(args...)
+    {}
+
+    std::pair<index_t, index_t> chunk_count() const override
+    {
+        return {1, generator.get_chunk_count()};
+    }
+
+    void filled(double lower_level, double upper_level, Output& output) override
+    {
+        generator.filled(lower_level, upper_level, output);
+    }
+
+    void lines(double level, Output& output) override
+    {
+        generator.lines(level, output);
+    }
+
+    TriContourGenerator generator;
+};
+
+struct contourpy_result
+{
+    BufferOutput output;
+};
+
+// Call func, returning its result or on error storing the message and returning failed.
+template <typename Func, typename Result>
+static Result call(Func func, Result failed)
+{
+    try {
+        last_error.clear();
+        return func();
+    }
+    catch (const std::exception& e) {
+        last_error = e.what();
+    }
+    catch (...) {
+        last_error = "Unknown error";
+    }
+    return failed;
+}
+
+// Return array index of a list of BufferOutput and its size divided by divisor.
+template <typename T>
+static const T* get_array(
+    const contourpy_result* result, std::vector<std::vector<T>> BufferOutput::* member,
+    size_t index, size_t* count, size_t divisor = 1)
+{
+    return call([&]() -> const T* {
+        if (result == nullptr)
+            throw std::invalid_argument("result is NULL");
+        if (index >= result->output.points.size())
+            throw std::out_of_range("array index out of range");
+
+        const auto& list = result->output.*member;
+        *count = 0;
+        if (index >= list.size() || list[index].empty())
+            return nullptr;
+        *count = list[index].size() / divisor;
+        return list[index].data();
+    }, static_cast<const T*>(nullptr));
+}
+
+static contourpy_result* march(contourpy_generator* generator, bool filled, double lower_level,
+                               double upper_level)
+{
+    return call([&]() {
+        if (generator == nullptr)
+            throw std::invalid_argument("generator is NULL");
+
+        std::unique_ptr<contourpy_result> result(new contourpy_result);
+        if (filled)
+            generator->filled(lower_level, upper_level, result->output);
+        else
+            generator->lines(lower_level, result->output);
+        return result.release();
+    }, static_cast<contourpy_result*>(nullptr));
+}
+
+static int march_fields(
+    contourpy_generator* generator, bool filled, double lower_level, double upper_level,
+    const double* const* zs, size_t n_fields, contourpy_result** results)
+{
+    return call([&]() {
+        if (generator == nullptr)
+            throw std::invalid_argument("generator is NULL");
+        if (n_fields > 0 && (zs == nullptr || results == nullptr))
+            throw std::invalid_argument("zs and results must not be NULL");
+
+        std::vector<std::unique_ptr<contourpy_result>> owned(n_fields);
+        std::vector<Output*> outputs(n_fields);
+        for (size_t field = 0; field < n_fields; ++field) {
+            if (zs[field] == nullptr)
+                throw std::invalid_argument("zs must not contain NULL");
+            owned[field].reset(new contourpy_result);
+            outputs[field] = &owned[field]->output;
+        }
+
+        auto n = static_cast<index_t>(n_fields);
+        if (filled)
+            generator->filled_fields(lower_level, upper_level, zs, n, outputs.data());
+        else
+            generator->lines_fields(lower_level, zs, n, outputs.data());
+
+        for (size_t field = 0; field < n_fields; ++field)
+            results[field] = owned[field].release();
+        return 0;
+    }, -1);
+}
+
+static int march_levels(
+    contourpy_generator* generator, bool filled, const double* levels, size_t n_levels,
+    contourpy_result** results)
+{
+    return call([&]() {
+        if (generator == nullptr)
+            throw std::invalid_argument("generator is NULL");
+
+        size_t n_results = filled ? (n_levels > 0 ? n_levels - 1 : 0) : n_levels;
+        if (n_results > 0 && (levels == nullptr || results == nullptr))
+            throw std::invalid_argument("levels and results must not be NULL");
+
+        std::vector<std::unique_ptr<contourpy_result>> owned(n_results);
+        std::vector<Output*> outputs(n_results);
+        for (size_t i = 0; i < n_results; ++i) {
+            owned[i].reset(new contourpy_result);
+            outputs[i] = &owned[i]->output;
+        }
+
+        auto n = static_cast<index_t>(n_results > 0 ? n_levels : 0);
+        if (filled)
+            generator->filled_levels(levels, n, outputs.data());
+        else
+            generator->lines_levels(levels, n, outputs.data());
+
+        for (size_t i = 0; i < n_results; ++i)
+            results[i] = owned[i].release();
+        return 0;
+    }, -1);
+}
+
+extern "C" {
+
+contourpy_result* contourpy_filled(
+    contourpy_generator* generator, double lower_level, double upper_level)
+{
+    return march(generator, true, lower_level, upper_level);
+}
+
+int contourpy_filled_fields(
+    contourpy_generator* generator, double lower_level, double upper_level,
+    const double* const* zs, size_t n_fields, contourpy_result** results)
+{
+    return march_fields(generator, true, lower_level, upper_level, zs, n_fields, results);
+}
+
+int contourpy_filled_levels(
+    contourpy_generator* generator, const double* levels, size_t n_levels,
+    contourpy_result** results)
+{
+    return march_levels(generator, true, levels, n_levels, results);
+}
+
+int contourpy_generator_chunk_count(
+    const contourpy_generator* generator, ptrdiff_t* y_chunk_count, ptrdiff_t* x_chunk_count)
+{
+    return call([&]() {
+        if (generator == nullptr)
+            throw std::invalid_argument("generator is NULL");
+
+        auto chunk_count = generator->chunk_count();
+        *y_chunk_count = chunk_count.first;
+        *x_chunk_count = chunk_count.second;
+        return 0;
+    }, -1);
+}
+
+contourpy_generator* contourpy_generator_create(
+    const double* x, const double* y, const double* z, const bool* mask, ptrdiff_t nx,
+    ptrdiff_t ny, const contourpy_options* options)
+{
+    return call([&]() -> contourpy_generator* {
+        if (x == nullptr || y == nullptr || z == nullptr)
+            throw std::invalid_argument("x, y and z must not be NULL");
+
+        contourpy_options defaults;
+        if (options == nullptr) {
+            contourpy_options_init(&defaults);
+            options = &defaults;
+        }
+
+        auto line_type = static_cast<LineType>(options->line_type);
+        auto fill_type = static_cast<FillType>(options->fill_type);
+        auto z_interp = static_cast<ZInterp>(options->z_interp);
+        if (z_interp != ZInterp::Linear && z_interp != ZInterp::Log)
+            throw std::invalid_argument("Unsupported ZInterp");
+
+        switch (options->algorithm) {
+            case CONTOURPY_SERIAL:
+                return new FieldsGeneratorImpl<SerialContourGenerator>(
+                    x, y, z, mask, nx, ny, options->corner_mask, line_type, fill_type,
+                    options->quad_as_tri, z_interp, options->x_chunk_size,
+                    options->y_chunk_size);
+            case CONTOURPY_THREADED:
+                return new FieldsGeneratorImpl<ThreadedContourGenerator>(
+                    x, y, z, mask, nx, ny, options->corner_mask, line_type, fill_type,
+                    options->quad_as_tri, z_interp, options->x_chunk_size,
+                    options->y_chunk_size, options->thread_count);
+            case CONTOURPY_MPL2014:
+                if (options->quad_as_tri || z_interp != ZInterp::Linear)
+                    throw std::invalid_argument("mpl2014 does not support quad_as_tri or z_interp");
+                return new GeneratorImpl<mpl2014::Mpl2014ContourGenerator>(
+                    x, y, z, mask, nx, ny, options->corner_mask, line_type, fill_type,
+                    options->x_chunk_size, options->y_chunk_size);
+            case CONTOURPY_MPL2005:
+                if (options->quad_as_tri || z_interp != ZInterp::Linear)
+                    throw std::invalid_argument("mpl2005 does not support quad_as_tri or z_interp");
+                return new LevelsGeneratorImpl<Mpl2005ContourGenerator>(
+                    x, y, z, mask, nx, ny, line_type, fill_type, options->x_chunk_size,
+                    options->y_chunk_size, options->thread_count);
+            default:
+                throw std::invalid_argument("Unsupported algorithm");
+        }
+    }, static_cast<contourpy_generator*>(nullptr));
+}
+
+void contourpy_generator_destroy(contourpy_generator* generator)
+{
+    delete generator;
+}
+
+const char* contourpy_last_error(void)
+{
+    return last_error.c_str();
+}
+
+contourpy_result* contourpy_lines(contourpy_generator* generator, double level)
+{
+    return march(generator, false, level, level);
+}
+
+int contourpy_lines_fields(
+    contourpy_generator* generator, double level, const double* const* zs, size_t n_fields,
+    contourpy_result** results)
+{
+    return march_fields(generator, false, level, level, zs, n_fields, results);
+}
+
+int contourpy_lines_levels(
+    contourpy_generator* generator, const double* levels, size_t n_levels,
+    contourpy_result** results)
+{
+    return march_levels(generator, false, levels, n_levels, results);
+}
+
+void contourpy_options_init(contourpy_options* options)
+{
+    options->algorithm = CONTOURPY_SERIAL;
+    options->corner_mask = true;
+    options->line_type = static_cast<int>(SerialContourGenerator::default_line_type());
+    options->fill_type = static_cast<int>(SerialContourGenerator::default_fill_type());
+    options->quad_as_tri = false;
+    options->z_interp = static_cast<int>(ZInterp::Linear);
+    options->x_chunk_size = 0;
+    options->y_chunk_size = 0;
+    options->thread_count = 0;
+}
+
+size_t contourpy_result_array_count(const contourpy_result* result)
+{
+    return result == nullptr ? 0 : result->output.points.size();
+}
+
+const uint8_t* contourpy_result_codes(
+    const contourpy_result* result, size_t index, size_t* count)
+{
+    return get_array(result, &BufferOutput::codes, index, count);
+}
+
+void contourpy_result_destroy(contourpy_result* result)
+{
+    delete result;
+}
+
+int contourpy_result_list_count(const contourpy_result* result)
+{
+    return result == nullptr ? 0 : static_cast<int>(result->output.list_count);
+}
+
+const uint32_t* contourpy_result_offsets(
+    const contourpy_result* result, size_t index, size_t* count)
+{
+    return get_array(result, &BufferOutput::offsets, index, count);
+}
+
+const uint32_t* contourpy_result_outer_offsets(
+    const contourpy_result* result, size_t index, size_t* count)
+{
+    return get_array(result, &BufferOutput::outer_offsets, index, count);
+}
+
+const double* contourpy_result_points(
+    const contourpy_result* result, size_t index, size_t* point_count)
+{
+    return get_array(result, &BufferOutput::points, index, point_count, 2);
+}
+
+contourpy_generator* contourpy_tri_generator_create(
+    const double* x, const double* y, ptrdiff_t n_points, const ptrdiff_t* triangles,
+    ptrdiff_t n_triangles, const double* z, const bool* mask, ptrdiff_t chunk_count,
+    const contourpy_options* options)
+{
+    return call([&]() -> contourpy_generator* {
+        if (x == nullptr || y == nullptr || z == nullptr || triangles == nullptr)
+            throw std::invalid_argument("x, y, z and triangles must not be NULL");
+
+        contourpy_options defaults;
+        if (options == nullptr) {
+            contourpy_options_init(&defaults);
+            options = &defaults;
+        }
+
+        auto z_interp = static_cast<ZInterp>(options->z_interp);
+        if (z_interp != ZInterp::Linear && z_interp != ZInterp::Log)
+            throw std::invalid_argument("Unsupported ZInterp");
+
+        index_t thread_count;
+        switch (options->algorithm) {
+            case CONTOURPY_SERIAL:
+                thread_count = 1;
+                break;
+            case CONTOURPY_THREADED:
+                thread_count = options->thread_count;
+                break;
+            default:
+                throw std::invalid_argument("Unsupported algorithm for triangular mesh");
+        }
+
+        return new TriGeneratorImpl(
+            x, y, n_points, triangles, n_triangles, z, mask,
+            static_cast<LineType>(options->line_type), static_cast<FillType>(options->fill_type),
+            z_interp, chunk_count, thread_count);
+    }, static_cast<contourpy_generator*>(nullptr));
+}
+
+} // extern "C"
@@ -2,6 +2,7 @@
 #define CONTOURPY_CONTOUR_GENERATOR_H
 
 #include "common.h"
+#include <mutex>
 
 class ContourGenerator
 {
@@ -14,6 +15,16 @@ public:
 
 protected:
     ContourGenerator() = default;
+
+    // Lock to serialise calls of generators that store per-call state.  Python callers must not
+    // hold the GIL whilst waiting here so that they cannot block the thread that holds the lock.
+    std::unique_lock<std::mutex> lock_call()
+    {
+        return std::unique_lock<std::mutex>(_call_mutex);
+    }
+
+private:
+    std::mutex _call_mutex;
 };
 
 #endif // CONTOURPY_CONTOUR_GENERATOR_H
@@ -0,0 +1,131 @@
+/* C API of the contourpy core library, for use without Python.
+ *
+ * A generator is created from C-contiguous arrays x, y and z of shape (ny, nx) and an optional
+ * boolean mask of the same shape, none of which are copied so they must outlive the generator.
+ * Each call of contourpy_lines() or contourpy_filled() returns a result containing up to 3 lists of
+ * arrays in the format determined by the line_type or fill_type, which are the same as for the
+ * Python API:
+ *   list 0: points, arrays of interleaved x and y coordinates.
+ *   list 1: codes (Matplotlib kind codes) or offsets into points.
+ *   list 2: outer offsets.
+ * For the ChunkCombined types there is one array per chunk in each list, and the arrays of empty
+ * chunks have a size of zero.
+ *
+ * Functions that can fail return NULL or -1 and the error message is available from
+ * contourpy_last_error() in the same thread.  A generator may be used by multiple threads at the
+ * same time, except for the mpl2005 and mpl2014 algorithms which serialise calls.
+ */
+
+#ifndef CONTOURPY_H
+#define CONTOURPY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct contourpy_generator contourpy_generator;
+typedef struct contourpy_result contourpy_result;
+
+typedef enum {
+    CONTOURPY_SERIAL = 1,
+    CONTOURPY_THREADED = 2,
+    CONTOURPY_MPL2014 = 3,
+    CONTOURPY_MPL2005 = 4   /* Ignores corner_mask. */
+} contourpy_algorithm;
+
+/* Values are the same as those of the LineType, FillType and ZInterp enums of the Python API. */
+typedef struct {
+    contourpy_algorithm algorithm;
+    bool corner_mask;
+    int line_type;
+    int fill_type;
+    bool quad_as_tri;
+    int z_interp;
+    ptrdiff_t x_chunk_size;  /* 0 for no chunking. */
+    ptrdiff_t y_chunk_size;
+    ptrdiff_t thread_count;  /* THREADED and MPL2005 only, 0 for the maximum. */
+} contourpy_options;
+
+/* Set options to the defaults of the serial algorithm. */
+void contourpy_options_init(contourpy_options* options);
+
+/* mask may be NULL.  options may be NULL to use the defaults. */
+contourpy_generator* contourpy_generator_create(
+    const double* x, const double* y, const double* z, const bool* mask, ptrdiff_t nx,
+    ptrdiff_t ny, const contourpy_options* options);
+
+/* Generator of an unstructured triangular mesh of n_points points with coordinates x and y, and
+ * a C-contiguous array triangles of shape (n_triangles, 3) of point indices.  z has n_points values
+ * and the optional mask has n_triangles values.  x, y and z are not copied.  The mesh is divided
+ * into chunk_count chunks, or one per thread if 0, which are reported as (1, chunk_count) chunks.
+ * Only CONTOURPY_SERIAL and CONTOURPY_THREADED are supported, and corner_mask, quad_as_tri and the
+ * chunk sizes of options are ignored.  Multiple fields are not supported. */
+contourpy_generator* contourpy_tri_generator_create(
+    const double* x, const double* y, ptrdiff_t n_points, const ptrdiff_t* triangles,
+    ptrdiff_t n_triangles, const double* z, const bool* mask, ptrdiff_t chunk_count,
+    const contourpy_options* options);
+
+void contourpy_generator_destroy(contourpy_generator* generator);
+
+/* Number of chunks (y_chunk_count, x_chunk_count) that the generator's domain is divided into. */
+int contourpy_generator_chunk_count(
+    const contourpy_generator* generator, ptrdiff_t* y_chunk_count, ptrdiff_t* x_chunk_count);
+
+contourpy_result* contourpy_lines(contourpy_generator* generator, double level);
+
+contourpy_result* contourpy_filled(
+    contourpy_generator* generator, double lower_level, double upper_level);
+
+/* Contour n_fields z arrays that share the x, y and mask of the generator, storing the result of
+ * each field in results which must have space for n_fields results.  Each z array has the same
+ * shape as the generator's z.  Not supported by the mpl2005 and mpl2014 algorithms.  Return 0 on
+ * success. */
+int contourpy_lines_fields(
+    contourpy_generator* generator, double level, const double* const* zs, size_t n_fields,
+    contourpy_result** results);
+
+int contourpy_filled_fields(
+    contourpy_generator* generator, double lower_level, double upper_level,
+    const double* const* zs, size_t n_fields, contourpy_result** results);
+
+/* Contour n_levels levels at once, storing the lines at each level or the filled contours between
+ * each pair of consecutive levels in results, which must have space for n_levels or n_levels-1
+ * results respectively.  Filled levels must be increasing.  Only supported by the mpl2005
+ * algorithm.  Return 0 on success. */
+int contourpy_lines_levels(
+    contourpy_generator* generator, const double* levels, size_t n_levels,
+    contourpy_result** results);
+
+int contourpy_filled_levels(
+    contourpy_generator* generator, const double* levels, size_t n_levels,
+    contourpy_result** results);
+
+void contourpy_result_destroy(contourpy_result* result);
+
+/* Number of lists (1 to 3), and number of arrays in each list. */
+int contourpy_result_list_count(const contourpy_result* result);
+size_t contourpy_result_array_count(const contourpy_result* result);
+
+/* Array index of a list, and its size in points (for points) or elements.  Return NULL if the
+ * array has a size of zero or the result does not contain arrays of that kind. */
+const double* contourpy_result_points(
+    const contourpy_result* result, size_t index, size_t* point_count);
+const uint8_t* contourpy_result_codes(
+    const contourpy_result* result, size_t index, size_t* count);
+const uint32_t* contourpy_result_offsets(
+    const contourpy_result* result, size_t index, size_t* count);
+const uint32_t* contourpy_result_outer_offsets(
+    const contourpy_result* result, size_t index, size_t* count);
+
+/* Message of the last error in the calling thread, or an empty string. */
+const char* contourpy_last_error(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONTOURPY_H */
@@ -3,22 +3,26 @@
 
 #include "common.h"
 
-// Conversion of C++ object to return to python.
+// Conversion of C++ objects into the arrays that are returned, writing to preallocated arrays of
+// the correct size.
 class Converter
 {
 public:
-    static CodeArray convert_codes(
-        count_t point_count, count_t cut_count, const offset_t* cut_start, offset_t subtract = 0);
+    static void convert_codes(
+        count_t point_count, count_t cut_count, const offset_t* cut_start, offset_t subtract,
+        uint8_t* codes);
 
-    static CodeArray convert_codes_check_closed(
-        count_t point_count, count_t cut_count, const offset_t* cut_start, const double* points);
+    static void convert_codes_check_closed(
+        count_t point_count, count_t cut_count, const offset_t* cut_start, const double* points,
+        uint8_t* codes);
 
-    static CodeArray convert_codes_check_closed_single(count_t point_count, const double* points);
+    static void convert_codes_check_closed_single(
+        count_t point_count, const double* points, uint8_t* codes);
 
-    static OffsetArray convert_offsets(
-        count_t offset_count, const offset_t* start, offset_t subtract);
+    static void convert_offsets(
+        count_t offset_count, const offset_t* start, offset_t subtract, offset_t* offsets);
 
-    static PointArray convert_points(count_t point_count, const double* start);
+    static void convert_points(count_t point_count, const double* start, double* points);
 
 private:
     static void check_max_offset(count_t max_offset);
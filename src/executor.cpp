@@ -0,0 +1,32 @@
+#include "executor.h"
+#include "thread_pool.h"
+#include <mutex>
+
+// The default executor is deliberately never deleted as it may hold Python objects that cannot be
+// released once the interpreter has been finalized.
+static std::mutex default_executor_mutex;
+static std::shared_ptr<Executor>* default_executor = nullptr;
+
+std::shared_ptr<Executor> Executor::get_default()
+{
+    {
+        std::lock_guard<std::mutex> guard(default_executor_mutex);
+        if (default_executor != nullptr && *default_executor)
+            return *default_executor;
+    }
+
+    // The shared thread pool is never deleted so it is not owned by the returned pointer.
+    return std::shared_ptr<Executor>(&ThreadPool::get_shared(), [](Executor*) {});
+}
+
+void Executor::set_default(std::shared_ptr<Executor> executor)
+{
+    {
+        std::lock_guard<std::mutex> guard(default_executor_mutex);
+        if (default_executor == nullptr)
+            default_executor = new std::shared_ptr<Executor>();
+        default_executor->swap(executor);
+    }
+
+    // Previous default executor, if any, is released here outside of the lock.
+}
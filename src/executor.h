@@ -0,0 +1,32 @@
+#ifndef CONTOURPY_EXECUTOR_H
+#define CONTOURPY_EXECUTOR_H
+
+#include "common.h"
+#include <functional>
+#include <memory>
+
+// Abstract interface for running the chunk tasks of a ThreadedContourGenerator on threads.  The
+// default implementation is the process-wide shared ThreadPool, but a host application can supply
+// its own so that contourpy runs on the host's threads rather than creating threads of its own.
+class Executor
+{
+public:
+    virtual ~Executor() = default;
+
+    // Submit a group of up to task_count copies of task to be run concurrently, one of which must
+    // be executed by the calling thread, and wait for the group to finish.  Each copy takes work
+    // items from a queue shared by the whole group until there are none left, so a single copy is
+    // sufficient to complete all of the work.  Hence an implementation may choose not to run
+    // copies that have not started by the time the calling thread's copy has finished, but must
+    // not return until all started copies have finished.  If any copy throws an exception then one
+    // of these exceptions should be rethrown.  The calling thread does not hold the GIL.
+    virtual void run(index_t task_count, const std::function<void()>& task) = 0;
+
+    // Executor used by all ThreadedContourGenerators.  If not set this is the shared ThreadPool.
+    static std::shared_ptr<Executor> get_default();
+
+    // Set the default executor, or reset it to the shared ThreadPool if executor is null.
+    static void set_default(std::shared_ptr<Executor> executor);
+};
+
+#endif // CONTOURPY_EXECUTOR_H
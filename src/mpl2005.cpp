@@ -1,72 +1,310 @@
+#include "executor.h"
 #include "mpl2005.h"
+#include "mpl_kind_code.h"
+#include "util.h"
+#include <algorithm>
 
 Mpl2005ContourGenerator::Mpl2005ContourGenerator(
-    const CoordinateArray& x, const CoordinateArray& y, const CoordinateArray& z,
-    const MaskArray& mask, index_t x_chunk_size, index_t y_chunk_size)
+    const double* x, const double* y, const double* z, const bool* mask, index_t nx, index_t ny,
+    LineType line_type, FillType fill_type, index_t x_chunk_size, index_t y_chunk_size,
+    index_t n_threads)
     : _x(x),
       _y(y),
       _z(z),
-      _site(cntr_new())
+      _nx(nx),
+      _ny(ny),
+      _line_type(line_type),
+      _fill_type(fill_type),
+      _x_chunk_size(0),
+      _y_chunk_size(0),
+      _nx_chunks(1),
+      _ny_chunks(1),
+      _n_threads(1),
+      _next_chunk(0),
+      _next_workspace(0)
 {
-    if (_x.ndim() != 2 || _y.ndim() != 2 || _z.ndim() != 2)
-        throw std::invalid_argument("x, y and z must all be 2D arrays");
-
-    auto nx = _z.shape(1);
-    auto ny = _z.shape(0);
-
-    if (_x.shape(1) != nx || _x.shape(0) != ny ||
-        _y.shape(1) != nx || _y.shape(0) != ny)
-        throw std::invalid_argument("x, y and z arrays must have the same shape");
-
     if (nx < 2 || ny < 2)
         throw std::invalid_argument("x, y and z must all be at least 2x2 arrays");
 
-    if (mask.ndim() != 0) {  // ndim == 0 if mask is not set, which is valid.
-        if (mask.ndim() != 2)
-            throw std::invalid_argument("mask array must be a 2D array");
+    if (!supports_line_type(line_type))
+        throw std::invalid_argument("Unsupported LineType");
 
-        if (mask.shape(1) != nx || mask.shape(0) != ny)
-            throw std::invalid_argument(
-                "If mask is set it must be a 2D array with the same shape as z");
-    }
+    if (!supports_fill_type(fill_type))
+        throw std::invalid_argument("Unsupported FillType");
 
     if (x_chunk_size < 0 || y_chunk_size < 0)
         throw std::invalid_argument("chunk_sizes cannot be negative");
 
-    const bool* mask_data = (mask.ndim() > 0 ? mask.data() : nullptr);
+    if (n_threads < 0)
+        throw std::invalid_argument("thread_count cannot be negative");
 
-    cntr_init(
-        _site, nx, ny, _x.data(), _y.data(), _z.data(), mask_data, x_chunk_size, y_chunk_size);
+    _x_chunk_size = (x_chunk_size > 0 && x_chunk_size < nx-1) ? x_chunk_size : nx-1;
+    _y_chunk_size = (y_chunk_size > 0 && y_chunk_size < ny-1) ? y_chunk_size : ny-1;
+    _nx_chunks = (nx - 2) / _x_chunk_size + 1;
+    _ny_chunks = (ny - 2) / _y_chunk_size + 1;
+    auto n_chunks = _nx_chunks*_ny_chunks;
+
+    index_t max_threads = std::max<index_t>(Util::get_max_threads(), 1);
+    n_threads = (n_threads == 0) ? max_threads : std::min(n_threads, max_threads);
+    _n_threads = std::min(n_threads, n_chunks);
+    _workspaces.resize(_n_threads);
+
+    // Zones are masked out if any of their points are masked, so a masked point on the boundary
+    // between chunks masks zones in both.
+    if (mask != nullptr) {
+        _chunk_regs.resize(n_chunks);
+        for (index_t chunk = 0; chunk < n_chunks; ++chunk) {
+            index_t i0 = (chunk % _nx_chunks)*_x_chunk_size;
+            index_t j0 = (chunk / _nx_chunks)*_y_chunk_size;
+            index_t imax = std::min(_x_chunk_size, nx-1-i0) + 1;
+            index_t jmax = std::min(_y_chunk_size, ny-1-j0) + 1;
+            cntr_mask_zones(imax, jmax, nx, mask + j0*nx + i0, _chunk_regs[chunk]);
+        }
+    }
 }
 
-Mpl2005ContourGenerator::~Mpl2005ContourGenerator()
+FillType Mpl2005ContourGenerator::default_fill_type()
 {
-    cntr_del(_site);
+    return FillType::OuterCode;
 }
 
-py::tuple Mpl2005ContourGenerator::filled(const double& lower_level, const double& upper_level)
+LineType Mpl2005ContourGenerator::default_line_type()
+{
+    return LineType::SeparateCode;
+}
+
+void Mpl2005ContourGenerator::filled(
+    const double& lower_level, const double& upper_level, Output& output)
 {
     if (lower_level > upper_level)
         throw std::invalid_argument("upper and lower levels are the wrong way round");
 
     double levels[2] = {lower_level, upper_level};
-    return cntr_trace(_site, levels, 2);
+    Output* outputs[1] = {&output};
+    march(levels, 2, true, outputs);
+}
+
+void Mpl2005ContourGenerator::filled_levels(
+    const double* levels, index_t n_levels, Output* const* outputs)
+{
+    for (index_t i = 1; i < n_levels; ++i) {
+        if (levels[i-1] > levels[i])
+            throw std::invalid_argument("levels must be increasing");
+    }
+
+    march(levels, n_levels, true, outputs);
+}
+
+std::pair<index_t, index_t> Mpl2005ContourGenerator::get_chunk_count() const
+{
+    return std::make_pair(_ny_chunks, _nx_chunks);
+}
+
+std::pair<index_t, index_t> Mpl2005ContourGenerator::get_chunk_size() const
+{
+    return std::make_pair(_y_chunk_size, _x_chunk_size);
+}
+
+FillType Mpl2005ContourGenerator::get_fill_type() const
+{
+    return _fill_type;
+}
+
+LineType Mpl2005ContourGenerator::get_line_type() const
+{
+    return _line_type;
+}
+
+index_t Mpl2005ContourGenerator::get_thread_count() const
+{
+    return _n_threads;
+}
+
+void Mpl2005ContourGenerator::lines(const double& level, Output& output)
+{
+    Output* outputs[1] = {&output};
+    march(&level, 1, false, outputs);
 }
 
-py::tuple Mpl2005ContourGenerator::get_chunk_count() const
+void Mpl2005ContourGenerator::lines_levels(
+    const double* levels, index_t n_levels, Output* const* outputs)
 {
-    long nx_chunks = (long)(ceil((_site->imax-1.0) / _site->i_chunk_size));
-    long ny_chunks = (long)(ceil((_site->jmax-1.0) / _site->j_chunk_size));
-    return py::make_tuple(ny_chunks, nx_chunks);
+    march(levels, n_levels, false, outputs);
 }
 
-py::tuple Mpl2005ContourGenerator::get_chunk_size() const
+void Mpl2005ContourGenerator::march(
+    const double* levels, index_t n_levels, bool filled, Output* const* outputs)
 {
-    return py::make_tuple(_site->j_chunk_size, _site->i_chunk_size);
+    // Workspaces are reused by each call, so calls are serialised.
+    auto lock = lock_call();
+
+    bool chunked = filled ? (_fill_type != FillType::OuterCode)
+                          : (_line_type != LineType::SeparateCode);
+    bool outer_offsets = filled && (_fill_type == FillType::ChunkCombinedCodeOffset ||
+                                    _fill_type == FillType::ChunkCombinedOffsetOffset);
+    auto n_chunks = _nx_chunks*_ny_chunks;
+    index_t n_outputs = filled ? std::max<index_t>(n_levels - 1, 0) : n_levels;
+    for (index_t i = 0; i < n_outputs; ++i)
+        outputs[i]->init(outer_offsets ? 3 : 2, chunked ? n_chunks : 0);
+
+    if (n_outputs == 0)
+        return;
+
+    if (_n_threads == 1) {
+        for (index_t chunk = 0; chunk < n_chunks; ++chunk)
+            march_chunk(chunk, levels, n_levels, filled, _workspaces[0], outputs);
+        return;
+    }
+
+    // Chunks are independent so each thread takes the next available chunk until there are none
+    // left, using its own workspace.
+    _next_chunk = 0;
+    _next_workspace = 0;
+    Executor::get_default()->run(_n_threads, [&]() {
+        Workspace* workspace;
+        {
+            std::lock_guard<std::mutex> guard(_chunk_mutex);
+            workspace = &_workspaces[_next_workspace++];
+        }
+
+        while (true) {
+            index_t chunk;
+            {
+                std::lock_guard<std::mutex> guard(_chunk_mutex);
+                if (_next_chunk < n_chunks)
+                    chunk = _next_chunk++;
+                else
+                    break;  // No more work to do.
+            }
+            march_chunk(chunk, levels, n_levels, filled, *workspace, outputs);
+        }
+    });
+}
+
+void Mpl2005ContourGenerator::march_chunk(
+    index_t chunk, const double* levels, index_t n_levels, bool filled, Workspace& workspace,
+    Output* const* outputs) const
+{
+    // Each chunk is traced as a separate window of the grid, with the chunk boundaries treated as
+    // mesh boundaries.
+    index_t i0 = (chunk % _nx_chunks)*_x_chunk_size;
+    index_t j0 = (chunk / _nx_chunks)*_y_chunk_size;
+    index_t imax = std::min(_x_chunk_size, _nx-1-i0) + 1;
+    index_t jmax = std::min(_y_chunk_size, _ny-1-j0) + 1;
+    index_t offset = j0*_nx + i0;
+    const char* reg = _chunk_regs.empty() ? nullptr : _chunk_regs[chunk].data();
+
+    // The site is initialised once and reused by all of the levels.
+    cntr_init(
+        &workspace.site, imax, jmax, _nx, _x + offset, _y + offset, _z + offset, reg);
+
+    index_t n_outputs = filled ? n_levels - 1 : n_levels;
+    for (index_t i = 0; i < n_outputs; ++i) {
+        double trace_levels[2] = {levels[i], filled ? levels[i+1] : 0.0};
+        cntr_trace(&workspace.site, trace_levels, filled ? 2 : 1, &workspace.parts);
+        write_chunk(chunk, filled, workspace.parts, *outputs[i]);
+    }
+}
+
+bool Mpl2005ContourGenerator::supports_fill_type(FillType fill_type)
+{
+    switch (fill_type) {
+        case FillType::OuterCode:
+        case FillType::ChunkCombinedCode:
+        case FillType::ChunkCombinedOffset:
+        case FillType::ChunkCombinedCodeOffset:
+        case FillType::ChunkCombinedOffsetOffset:
+            return true;
+        default:
+            return false;
+    }
 }
 
-py::tuple Mpl2005ContourGenerator::lines(const double& level)
+bool Mpl2005ContourGenerator::supports_line_type(LineType line_type)
 {
-    double levels[2] = {level, 0.0};
-    return cntr_trace(_site, levels, 1);
+    switch (line_type) {
+        case LineType::SeparateCode:
+        case LineType::ChunkCombinedCode:
+        case LineType::ChunkCombinedOffset:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void Mpl2005ContourGenerator::write_chunk(
+    index_t chunk, bool filled, const Cparts& parts, Output& output) const
+{
+    const auto& start = parts.start;
+    const auto& codes = parts.codes;
+    auto part_count = static_cast<index_t>(start.size()) - 1;
+    std::lock_guard<Output> lock(output);
+
+    if (filled ? (_fill_type == FillType::OuterCode) : (_line_type == LineType::SeparateCode)) {
+        // Each part as a separate pair of points and codes arrays.
+        for (index_t part = 0; part < part_count; ++part) {
+            auto n = start[part+1] - start[part];
+            std::copy(parts.xy.begin() + 2*start[part], parts.xy.begin() + 2*start[part+1],
+                      output.append_points(n));
+            std::copy(codes.begin() + start[part], codes.begin() + start[part+1],
+                      output.append_codes(n));
+        }
+        return;
+    }
+
+    // Parts combined into one set of arrays for the chunk.
+    count_t point_count = static_cast<count_t>(codes.size());
+    if (point_count == 0) {
+        output.set_empty(chunk);
+        return;
+    }
+
+    bool want_codes, want_outer_offsets, outer_offsets_into_points;
+    if (filled) {
+        want_codes = (_fill_type == FillType::ChunkCombinedCode ||
+                      _fill_type == FillType::ChunkCombinedCodeOffset);
+        outer_offsets_into_points = (_fill_type == FillType::ChunkCombinedCodeOffset);
+        want_outer_offsets = (outer_offsets_into_points ||
+                              _fill_type == FillType::ChunkCombinedOffsetOffset);
+    }
+    else {
+        want_codes = (_line_type == LineType::ChunkCombinedCode);
+        want_outer_offsets = outer_offsets_into_points = false;
+    }
+
+    std::copy(parts.xy.begin(), parts.xy.end(), output.set_points(chunk, point_count));
+
+    if (want_codes)
+        std::copy(codes.begin(), codes.end(), output.set_codes(chunk, point_count));
+    else {
+        // Each MOVETO starts a new line or polygon boundary.
+        auto loop_count = std::count(codes.begin(), codes.end(), MOVETO);
+        offset_t* offsets = output.set_offsets(chunk, loop_count + 1);
+        for (count_t point = 0; point < point_count; ++point) {
+            if (codes[point] == MOVETO)
+                *offsets++ = static_cast<offset_t>(point);
+        }
+        *offsets = static_cast<offset_t>(point_count);
+    }
+
+    if (want_outer_offsets) {
+        // Each non-empty part is an outer boundary followed by its holes.
+        index_t outer_count = 0;
+        for (index_t part = 0; part < part_count; ++part) {
+            if (start[part+1] > start[part])
+                ++outer_count;
+        }
+
+        offset_t* outer_offsets = output.set_outer_offsets(chunk, outer_count + 1);
+        offset_t offset = 0;
+        for (index_t part = 0; part < part_count; ++part) {
+            if (start[part+1] > start[part]) {
+                *outer_offsets++ = offset;
+                offset += static_cast<offset_t>(outer_offsets_into_points ?
+                    start[part+1] - start[part] :
+                    std::count(codes.begin() + start[part], codes.begin() + start[part+1], MOVETO));
+            }
+        }
+        *outer_offsets = offset;
+    }
 }
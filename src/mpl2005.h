@@ -2,27 +2,88 @@
 #define CONTOURPY_MPL_2005_H
 
 #include "contour_generator.h"
+#include "fill_type.h"
+#include "line_type.h"
 #include "mpl2005_original.h"
+#include "output.h"
+#include <mutex>
+#include <utility>
+#include <vector>
 
 class Mpl2005ContourGenerator : public ContourGenerator
 {
 public:
+    // x, y, z and mask (nullptr if no mask) are C-contiguous arrays of shape (ny, nx) that must
+    // outlive the generator.  line_type is SeparateCode or one of the ChunkCombined types, and
+    // fill_type is OuterCode or one of the ChunkCombined types.  Each chunk is traced separately,
+    // by up to n_threads threads (0 for the maximum).
     Mpl2005ContourGenerator(
-        const CoordinateArray& x, const CoordinateArray& y, const CoordinateArray& z,
-        const MaskArray& mask, index_t x_chunk_size, index_t y_chunk_size);
+        const double* x, const double* y, const double* z, const bool* mask, index_t nx,
+        index_t ny, LineType line_type, FillType fill_type, index_t x_chunk_size,
+        index_t y_chunk_size, index_t n_threads = 1);
 
-    ~Mpl2005ContourGenerator();
+    static FillType default_fill_type();
+    static LineType default_line_type();
 
-    py::tuple filled(const double& lower_level, const double& upper_level);
+    void filled(const double& lower_level, const double& upper_level, Output& output);
 
-    py::tuple get_chunk_count() const;  // Return (y_chunk_count, x_chunk_count)
-    py::tuple get_chunk_size() const;   // Return (y_chunk_size, x_chunk_size)
+    // Calculate filled contours between each pair of consecutive levels of an increasing sequence
+    // of n_levels levels, writing each to the corresponding one of the n_levels-1 outputs.  The
+    // levels are traced together chunk by chunk, so each chunk's site is initialised once and its
+    // window of the grid is reused by all of the levels whilst it is still in the CPU cache.
+    void filled_levels(const double* levels, index_t n_levels, Output* const* outputs);
 
-    py::tuple lines(const double& level);
+    std::pair<index_t, index_t> get_chunk_count() const;  // Return (y_chunk_count, x_chunk_count)
+    std::pair<index_t, index_t> get_chunk_size() const;   // Return (y_chunk_size, x_chunk_size)
+    FillType get_fill_type() const;
+    LineType get_line_type() const;
+    index_t get_thread_count() const;
+
+    void lines(const double& level, Output& output);
+
+    // Calculate contour lines at each of n_levels levels, writing each to the corresponding one of
+    // the n_levels outputs.  Traced together chunk by chunk in the same way as filled_levels().
+    void lines_levels(const double* levels, index_t n_levels, Output* const* outputs);
+
+    static bool supports_fill_type(FillType fill_type);
+    static bool supports_line_type(LineType line_type);
 
 private:
-    CoordinateArray _x, _y, _z;
-    Csite *_site;
+    // Per-thread state that is reused by each chunk and call.
+    struct Workspace
+    {
+        Csite site;
+        Cparts parts;
+    };
+
+    // Trace each chunk at each of n_levels levels if lines, or between each pair of consecutive
+    // levels if filled, writing to the corresponding outputs.
+    void march(const double* levels, index_t n_levels, bool filled, Output* const* outputs);
+
+    void march_chunk(
+        index_t chunk, const double* levels, index_t n_levels, bool filled, Workspace& workspace,
+        Output* const* outputs) const;
+
+    // Write the traced parts of a chunk to output, in the format of the fill_type if filled or the
+    // line_type if not.
+    void write_chunk(index_t chunk, bool filled, const Cparts& parts, Output& output) const;
+
+    const double* _x;
+    const double* _y;
+    const double* _z;
+    const index_t _nx, _ny;
+    const LineType _line_type;
+    const FillType _fill_type;
+    index_t _x_chunk_size, _y_chunk_size;
+    index_t _nx_chunks, _ny_chunks;
+    index_t _n_threads;
+    std::vector<std::vector<char>> _chunk_regs;  // Zone existence of each chunk if masked.
+    std::vector<Workspace> _workspaces;           // One per thread.
+
+    // Multithreading member variables.
+    index_t _next_chunk;       // Next available chunk for a thread to trace.
+    index_t _next_workspace;   // Next unused workspace.
+    std::mutex _chunk_mutex;   // Locks access to the variables above.
 };
 
 #endif // CONTOURPY_MPL_2005_H
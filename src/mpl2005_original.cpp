@@ -14,6 +14,9 @@
 
 #include "mpl2005_original.h"
 #include "mpl_kind_code.h"
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
 
 /* Note that all arrays in these routines are Fortran-style,
    in the sense that the "i" index varies fastest; the dimensions
@@ -170,7 +173,7 @@
 
 void print_Csite(Csite *Csite)
 {
-    Cdata *data = Csite->data;
+    const Cdata *data = Csite->data.data();
     int i, j, ij;
     int nd = Csite->imax * (Csite->jmax + 1) + 1;
     printf("zlevels: %8.2lg %8.2lg\n", Csite->zlevel[0], Csite->zlevel[1]);
@@ -247,6 +250,15 @@ enum {kind_zone, kind_edge1, kind_edge2,
 #define SADDLE_GT0 0x02
 #define SADDLE_GT1 0x04
 
+/* index in x, y and z of point ij of the mesh, which may be a window of a
+ * larger grid */
+static inline long
+grid_index (const Csite * site, long ij)
+{
+    long imax = site->imax;
+    return site->stride == imax ? ij : ij + (ij / imax) * (site->stride - imax);
+}
+
 /* ------------------------------------------------------------------------ */
 
 /* these actually mark points */
@@ -277,7 +289,7 @@ static void data_init (Csite * site);
 static int
 zone_crosser (Csite * site, int level, int pass2)
 {
-    Cdata * data = site->data;
+    Cdata * data = site->data.data();
     long edge = site->edge;
     long left = site->left;
     long n = site->n;
@@ -288,7 +300,7 @@ zone_crosser (Csite * site, int level, int pass2)
     long left0 = site->left0;
     int level0 = site->level0 == level;
     int two_levels = site->zlevel[1] > site->zlevel[0];
-    Saddle* saddle = site->saddle;
+    Saddle* saddle = site->saddle.data();
 
     const double *x = pass2 ? site->x : 0;
     const double *y = pass2 ? site->y : 0;
@@ -316,9 +328,10 @@ zone_crosser (Csite * site, int level, int pass2)
         if (pass2)
         {
             /* second pass actually computes and stores the point */
-            double zcp = (zlevel - z[p0]) / (z[p1] - z[p0]);
-            xcp[n] = zcp * (x[p1] - x[p0]) + x[p0];
-            ycp[n] = zcp * (y[p1] - y[p0]) + y[p0];
+            long g0 = grid_index (site, p0), g1 = grid_index (site, p1);
+            double zcp = (zlevel - z[g0]) / (z[g1] - z[g0]);
+            xcp[n] = zcp * (x[g1] - x[g0]) + x[g0];
+            ycp[n] = zcp * (y[g1] - y[g0]) + y[g0];
             kcp[n] = kind_zone;
             n_kind = n;
         }
@@ -385,7 +398,10 @@ zone_crosser (Csite * site, int level, int pass2)
                 {
                     double zcentre;
                     saddle[zone] = SADDLE_SET;
-                    zcentre = (z[p0] + z[p0+left] + z[p1] + z[p1+left])/4.0;
+                    zcentre = (z[grid_index (site, p0)] +
+                               z[grid_index (site, p0+left)] +
+                               z[grid_index (site, p1)] +
+                               z[grid_index (site, p1+left)])/4.0;
                     if (zcentre > site->zlevel[0])
                         saddle[zone] |=
                             (two_levels && zcentre > site->zlevel[1])
@@ -492,7 +508,7 @@ zone_crosser (Csite * site, int level, int pass2)
 static int
 edge_walker (Csite * site,  int pass2)
 {
-    Cdata * data = site->data;
+    Cdata * data = site->data.data();
     long edge = site->edge;
     long left = site->left;
     long n = site->n;
@@ -527,8 +543,9 @@ edge_walker (Csite * site,  int pass2)
             /* mark current boundary point */
             if (pass2)
             {
-                xcp[n] = x[p0];
-                ycp[n] = y[p0];
+                long g0 = grid_index (site, p0);
+                xcp[n] = x[g0];
+                ycp[n] = y[g0];
                 kcp[n] = kind_edge1;
                 n_kind = n;
             }
@@ -541,10 +558,11 @@ edge_walker (Csite * site,  int pass2)
              * so that it will be marked again by zone_crosser as it closes */
             if (pass2)
             {
+                long g0 = grid_index (site, p0), g1 = grid_index (site, p1);
                 double zcp = site->zlevel[(z0 != 0)];
-                zcp = (zcp - site->z[p0]) / (site->z[p1] - site->z[p0]);
-                xcp[n] = zcp * (x[p1] - x[p0]) + x[p0];
-                ycp[n] = zcp * (y[p1] - y[p0]) + y[p0];
+                zcp = (zcp - site->z[g0]) / (site->z[g1] - site->z[g0]);
+                xcp[n] = zcp * (x[g1] - x[g0]) + x[g0];
+                ycp[n] = zcp * (y[g1] - y[g0]) + y[g0];
                 kcp[n] = kind_edge2;
                 n_kind = n;
             }
@@ -656,7 +674,7 @@ edge_walker (Csite * site,  int pass2)
 static int
 slit_cutter (Csite * site, int up, int pass2)
 {
-    Cdata * data = site->data;
+    Cdata * data = site->data.data();
     long imax = site->imax;
     long n = site->n;
 
@@ -692,8 +710,8 @@ slit_cutter (Csite * site, int up, int pass2)
                 site->n = n;
                 return 2;
             }
-            xcp[n] = x[p1];
-            ycp[n] = y[p1];
+            xcp[n] = x[grid_index (site, p1)];
+            ycp[n] = y[grid_index (site, p1)];
             kcp[n] = kind_slit_up;
             n++;
             p1 += imax;
@@ -749,8 +767,8 @@ slit_cutter (Csite * site, int up, int pass2)
             }
             if (pass2)
             {
-                xcp[n] = x[p0];
-                ycp[n] = y[p0];
+                xcp[n] = x[grid_index (site, p0)];
+                ycp[n] = y[grid_index (site, p0)];
                 kcp[n] = kind_slit_down;
                 n++;
             }
@@ -776,7 +794,7 @@ slit_cutter (Csite * site, int up, int pass2)
 static long
 curve_tracer (Csite * site, int pass2)
 {
-    Cdata * data = site->data;
+    Cdata * data = site->data.data();
     long imax = site->imax;
     long edge0 = site->edge0;
     long left0 = site->left0;
@@ -965,20 +983,21 @@ curve_tracer (Csite * site, int pass2)
 static void
 data_init (Csite * site)
 {
-    Cdata * data = site->data;
+    Cdata * data = site->data.data();
     long imax = site->imax;
     long jmax = site->jmax;
     long ijmax = imax * jmax;
+    long stride = site->stride;
     const double *z = site->z;
     double zlev0 = site->zlevel[0];
     double zlev1 = site->zlevel[1];
     int two_levels = zlev1 > zlev0;
-    char *reg = site->reg;
+    const char *reg = site->reg;
     long count = 0;
     int started = 0;
     int ibndy, jbndy, i_was_chunk;
 
-    long ichunk, jchunk, i, j, ij;
+    long ichunk, jchunk, i, j, ij, zrow;
     long i_chunk_size = site->i_chunk_size;
     long j_chunk_size = site->j_chunk_size;
 
@@ -999,7 +1018,7 @@ data_init (Csite * site)
     else
         data[0] = 0;
     jchunk = 0;
-    for (j = ij = 0; j < jmax; j++)
+    for (j = ij = zrow = 0; j < jmax; j++, zrow += stride)
     {
         ichunk = i_was_chunk = 0;
         for (i = 0; i < imax; i++, ij++)
@@ -1022,8 +1041,13 @@ data_init (Csite * site)
             /* translate z values to 0, 1, 2 flags */
             if (ij < imax)
                 data[ij + 1] = 0;
-            if (ij < ijmax - 1 && z[ij + 1] > zlev0)
-                data[ij + 1] |= (two_levels && z[ij + 1] > zlev1) ? 2 : 1;
+            if (ij < ijmax - 1)
+            {
+                /* z of point ij + 1, the next in this row or the first in the next */
+                double znext = z[i < imax - 1 ? zrow + i + 1 : zrow + stride];
+                if (znext > zlev0)
+                    data[ij + 1] |= (two_levels && znext > zlev1) ? 2 : 1;
+            }
 
             /* apply edge boundary marks */
             ibndy = i == ichunk
@@ -1147,7 +1171,7 @@ data_init (Csite * site)
     if (!count)
         data[0] |= ALL_DONE;
     else
-        for (i = 0; i < ijmax; ++i) site->saddle[i] = 0;
+        std::fill(site->saddle.begin(), site->saddle.end(), 0);
 
     /* initialize site */
     site->edge0 = site->edge00 = site->edge = 0;
@@ -1179,12 +1203,13 @@ data_init (Csite * site)
    zones, not points.  All four zones sharing a bad
    point must be marked as not existing.
 */
-static void
-mask_zones (long iMax, long jMax, const bool *mask, char *reg)
+void
+cntr_mask_zones(long iMax, long jMax, long stride, const bool *mask, std::vector<char> &reg)
 {
     long i, j, ij;
     long nreg = iMax * jMax + iMax + 1;
 
+    reg.resize(nreg);
     for (ij = iMax+1; ij < iMax*jMax; ij++)
     {
         reg[ij] = 1;
@@ -1196,7 +1221,7 @@ mask_zones (long iMax, long jMax, const bool *mask, char *reg)
         for (i = 0; i < iMax; i++, ij++)
         {
             if (i == 0 || j == 0) reg[ij] = 0;
-            if (mask[ij])
+            if (mask[j*stride + i])
             {
                 reg[ij] = 0;
                 reg[ij + 1] = 0;
@@ -1211,40 +1236,20 @@ mask_zones (long iMax, long jMax, const bool *mask, char *reg)
     }
 }
 
-Csite *
-cntr_new()
-{
-    Csite *site = new Csite;
-    if (site == nullptr) return nullptr;
-    site->data = nullptr;
-    site->reg = nullptr;
-    site->saddle = nullptr;
-    site->xcp = nullptr;
-    site->ycp = nullptr;
-    site->kcp = nullptr;
-    site->x = nullptr;
-    site->y = nullptr;
-    site->z = nullptr;
-    return site;
-}
-
 void
-cntr_init(Csite *site, long iMax, long jMax, const double *x, const double *y,
-          const double *z, const bool *mask, long i_chunk_size, long j_chunk_size)
+cntr_init(Csite *site, long iMax, long jMax, long stride, const double *x, const double *y,
+          const double *z, const char *reg)
 {
     long ijmax = iMax * jMax;
     long nreg = iMax * jMax + iMax + 1;
 
     site->imax = iMax;
     site->jmax = jMax;
-    site->data = new Cdata[nreg];
-    site->saddle = new Saddle[ijmax];
-    if (mask != nullptr)
-    {
-        site->reg = new char[nreg];
-        mask_zones(iMax, jMax, mask, site->reg);
-    }
+    site->stride = stride;
     /* I don't think we need to initialize site->data. */
+    site->data.resize(nreg);
+    site->saddle.resize(ijmax);
+    site->reg = reg;
     site->x = x;
     site->y = y;
     site->z = z;
@@ -1252,30 +1257,17 @@ cntr_init(Csite *site, long iMax, long jMax, const double *x, const double *y,
     site->ycp = nullptr;
     site->kcp = nullptr;
 
-    /* Store correct chunk sizes for filled contours.  Chunking not used for
-       line contours. */
-    if (i_chunk_size <= 0 || i_chunk_size > iMax - 1)
-        i_chunk_size = iMax - 1;
-    site->i_chunk_size = i_chunk_size;
-
-    if (j_chunk_size <= 0 || j_chunk_size > jMax - 1)
-        j_chunk_size = jMax - 1;
-    site->j_chunk_size = j_chunk_size;
-}
-
-void cntr_del(Csite *site)
-{
-    delete [] site->saddle;
-    delete [] site->reg;
-    delete [] site->data;
-    delete site;
-    site = nullptr;
+    /* Chunks are traced as separate windows of the grid, so each mesh is a
+       single chunk. */
+    site->i_chunk_size = iMax - 1;
+    site->j_chunk_size = jMax - 1;
 }
 
 static int
-reorder(double *xpp, double *ypp, short *kpp, double *xy, unsigned char *c, int npts, int nlevels)
+reorder(Csite *site, double *xpp, double *ypp, short *kpp, double *xy, unsigned char *c, int npts,
+        int nlevels)
 {
-    std::vector<int> subp;
+    std::vector<int> &subp = site->seg_subpath;
     int isp, nsp;
     int iseg, nsegs;
     int isegplus;
@@ -1284,8 +1276,10 @@ reorder(double *xpp, double *ypp, short *kpp, double *xy, unsigned char *c, int
     int started;
     int maxnsegs = npts/2 + 1;
     /* allocate maximum possible size--gross overkill */
-    std::vector<int> i0(maxnsegs);
-    std::vector<int> i1(maxnsegs);
+    std::vector<int> &i0 = site->seg_start;
+    std::vector<int> &i1 = site->seg_end;
+    i0.resize(maxnsegs);
+    i1.resize(maxnsegs);
 
     /* Find the segments. */
     iseg = 0;
@@ -1317,8 +1311,7 @@ reorder(double *xpp, double *ypp, short *kpp, double *xy, unsigned char *c, int
 
     /* Find the subpaths as sets of connected segments. */
 
-    subp.resize(nsegs, false);
-    for (i=0; i<nsegs; i++) subp[i] = -1;
+    subp.assign(nsegs, -1);
 
     nsp = 0;
     for (iseg=0; iseg<nsegs; iseg++)
@@ -1390,61 +1383,43 @@ reorder(double *xpp, double *ypp, short *kpp, double *xy, unsigned char *c, int
     return k;
 }
 
-/* Build a list of XY 2-D arrays, shape (N,2), to which a list of path
-        code arrays is concatenated.
+/* Reorder the points of each part into parts, packed one after another.
 */
-static py::tuple
-build_cntr_list_v2(long *np, double *xp, double *yp, short *kp,
-                   int nparts, long ntotal, int nlevels)
+static void
+build_cntr_parts(Csite *site, long *np, double *xp, double *yp, short *kp,
+                 int nparts, long ntotal, int nlevels, Cparts *parts)
 {
     int i;
-    long k;
-    py::ssize_t dims[2];
-    py::ssize_t kdims[1];
+    long k, kout;
 
-    py::list all_verts(nparts);
-    py::list all_codes(nparts);
+    parts->xy.resize(2*ntotal);
+    parts->codes.resize(ntotal);
+    parts->start.assign(1, 0);
 
-    for (i=0, k=0; i < nparts; k+= np[i], i++)
+    for (i=0, k=0, kout=0; i < nparts; k+= np[i], i++)
     {
-        double *xpp = xp+k;
-        double *ypp = yp+k;
-        short *kpp = kp+k;
-        int n;
-
-        dims[0] = np[i];
-        dims[1] = 2;
-        kdims[0] = np[i];
-        PointArray xyv(dims);
-        CodeArray kv(kdims);
-
-        n = reorder(xpp, ypp, kpp, xyv.mutable_data(), kv.mutable_data(), np[i], nlevels);
+        int n = reorder(site, xp+k, yp+k, kp+k, parts->xy.data() + 2*kout,
+                        parts->codes.data() + kout, np[i], nlevels);
         if (n == -1)
         {
             throw std::runtime_error("Error reordering vertices");
         }
 
-        dims[0] = n;
-        xyv.resize(dims, false);
-        all_verts[i] = xyv;
-
-        kdims[0] = n;
-        kv.resize(kdims, false);
-        all_codes[i] = kv;
+        kout += n;
+        parts->start.push_back(kout);
     }
 
-    return py::make_tuple(all_verts, all_codes);
+    parts->xy.resize(2*kout);
+    parts->codes.resize(kout);
 }
 
 /* cntr_trace is called once per contour level or level pair.
-   If nlevels is 1, a set of contour lines will be returned; if nlevels
-   is 2, the set of polygons bounded by the levels will be returned.
-   If points is True, the lines will be returned as a list of list
-   of points; otherwise, as a list of tuples of vectors.
+   If nlevels is 1, a set of contour lines will be stored in parts; if
+   nlevels is 2, the set of polygons bounded by the levels will be stored.
 */
 
-py::tuple
-cntr_trace(Csite *site, double levels[], int nlevels)
+void
+cntr_trace(Csite *site, double levels[], int nlevels, Cparts *parts)
 {
     int iseg;
 
@@ -1480,15 +1455,15 @@ cntr_trace(Csite *site, double levels[], int nlevels)
             ntotal -= n;
         }
     }
-    std::vector<double> xp0(ntotal);
-    std::vector<double> yp0(ntotal);
-    std::vector<short> kp0(ntotal);
-    std::vector<long> nseg0(nparts);
+    site->xcp_buffer.resize(ntotal);
+    site->ycp_buffer.resize(ntotal);
+    site->kcp_buffer.resize(ntotal);
+    site->nseg_buffer.resize(nparts);
 
     /* second pass */
-    site->xcp = xp0.data();
-    site->ycp = yp0.data();
-    site->kcp = kp0.data();
+    site->xcp = site->xcp_buffer.data();
+    site->ycp = site->ycp_buffer.data();
+    site->kcp = site->kcp_buffer.data();
     iseg = 0;
     for (;;iseg++)
     {
@@ -1502,7 +1477,7 @@ cntr_trace(Csite *site, double levels[], int nlevels)
         if (n > 0)
         {
             /* could add array bounds checking */
-            nseg0[iseg] = n;
+            site->nseg_buffer[iseg] = n;
             site->xcp += n;
             site->ycp += n;
             site->kcp += n;
@@ -1519,6 +1494,7 @@ cntr_trace(Csite *site, double levels[], int nlevels)
     site->ycp = nullptr;
     site->kcp = nullptr;
 
-    return build_cntr_list_v2(
-        nseg0.data(), xp0.data(), yp0.data(), kp0.data(), nparts, ntotal, nlevels);
+    build_cntr_parts(site, site->nseg_buffer.data(), site->xcp_buffer.data(),
+                     site->ycp_buffer.data(), site->kcp_buffer.data(), nparts, ntotal, nlevels,
+                     parts);
 }
@@ -2,6 +2,7 @@
 #define CONTOURPY_MPL_2005_ORIGINAL_H
 
 #include "common.h"
+#include <vector>
 
 /* the data about edges, zones, and points -- boundary or not, exists
  * or not, z value 0, 1, or 2 -- is kept in a mesh sized data array */
@@ -21,13 +22,16 @@ struct Csite
                                  * or above the edge */
     long imax;                  /* imax for the mesh */
     long jmax;                  /* jmax for the mesh */
+    long stride;                /* distance between rows of x, y and z, which is more
+                                 * than imax if the mesh is a window of a larger grid */
     long n;                     /* number of points marked on this curve so far */
     long count;                 /* count of start markers visited */
     double zlevel[2];           /* contour levels, zlevel[1]<=zlevel[0]
                                  * signals single level case */
-    Saddle *saddle;             /* saddle zone information for the mesh */
-    char *reg;                  /* region array for the mesh (was int) */
-    Cdata *data;                /* added by EF */
+    std::vector<Saddle> saddle; /* saddle zone information for the mesh */
+    const char *reg;            /* region array for the mesh (was int), or nullptr
+                                 * if all zones exist */
+    std::vector<Cdata> data;    /* added by EF */
     long edge0, left0;          /* starting site on this curve for closure */
     int level0;                 /* starting level for closure */
     long edge00;                /* site needing START_ROW mark */
@@ -38,15 +42,36 @@ struct Csite
     short *kcp;                 /* kind of contour point */
 
     long i_chunk_size, j_chunk_size;
+
+    /* buffers reused by each call of cntr_trace, so that a site can trace
+     * many levels without reallocating */
+    std::vector<double> xcp_buffer, ycp_buffer;
+    std::vector<short> kcp_buffer;
+    std::vector<long> nseg_buffer;
+    std::vector<int> seg_start, seg_end, seg_subpath;
 };
 
-Csite *cntr_new();
+/* set the zone existence reg of a mesh of iMax by jMax points from the mask of
+ * its points, whose rows are stride apart */
+void cntr_mask_zones(long iMax, long jMax, long stride, const bool *mask, std::vector<char> &reg);
 
-void cntr_init(Csite *site, long iMax, long jMax, const double *x, const double *y,
-               const double *z, const bool *mask, long i_chunk_size, long j_chunk_size);
+/* prepare site to trace a mesh of iMax by jMax points whose rows are stride
+ * apart in x, y and z -- reg is from cntr_mask_zones, or nullptr if there is
+ * no mask, and all of these arrays must outlive the site's use of them.
+ * The buffers of the site are kept if it has been used before. */
+void cntr_init(Csite *site, long iMax, long jMax, long stride, const double *x, const double *y,
+               const double *z, const char *reg);
 
-void cntr_del(Csite *site);
+/* contours found by cntr_trace, stored contiguously in the order that they
+ * were traced -- part i has the (x, y) points xy[2*start[i]] onward and the
+ * kind codes codes[start[i]] onward, up to start[i+1] */
+struct Cparts
+{
+    std::vector<double> xy;
+    std::vector<unsigned char> codes;
+    std::vector<long> start;    /* one more than the number of parts */
+};
 
-py::tuple cntr_trace(Csite *site, double levels[], int nlevels);
+void cntr_trace(Csite *site, double levels[], int nlevels, Cparts *parts);
 
 #endif // CONTOURPY_MPL_2005_ORIGINAL_H
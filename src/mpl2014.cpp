@@ -8,6 +8,7 @@
 #include "mpl2014.h"
 #include "mpl_kind_code.h"
 #include <algorithm>
+#include <stdexcept>
 
 
 namespace mpl2014 {
@@ -169,99 +170,159 @@ std::ostream& operator<<(std::ostream& os, const XY& xy)
 
 
 
-ContourLine::ContourLine(bool is_hole)
-    : std::vector<XY>(),
-      _is_hole(is_hole),
-      _parent(0)
+Contour::Contour()
 {}
 
-void ContourLine::add_child(ContourLine* child)
+void Contour::clear()
+{
+    _points.clear();
+    _lines.clear();
+}
+
+index_t Contour::current_line() const
 {
-    assert(!_is_hole && "Cannot add_child to a hole");
-    assert(child != 0 && "Null child ContourLine");
-    _children.push_back(child);
+    assert(!_lines.empty() && "Contour has no current line");
+    return static_cast<index_t>(_lines.size()) - 1;
 }
 
-void ContourLine::clear_parent()
+void Contour::copy_line(index_t line, bool close, double*& points, uint8_t*& codes) const
 {
-    assert(is_hole() && "Cannot clear parent of non-hole");
-    assert(_parent != 0 && "Null parent ContourLine");
-    _parent = 0;
+    const XY* begin = line_begin(line);
+    const XY* end = line_end(line);
+    for (const XY* point = begin; point != end; ++point) {
+        *points++ = point->x;
+        *points++ = point->y;
+    }
+
+    if (close) {
+        *points++ = begin->x;
+        *points++ = begin->y;
+    }
+
+    if (codes != nullptr && begin != end) {
+        *codes++ = MOVETO;
+        count_t count = (end - begin) + (close ? 1 : 0);
+        std::fill(codes, codes + count - 1, LINETO);
+        codes += count - 1;
+
+        // Closed line loop has identical first and last (x, y) points.
+        if (close || (end - begin > 1 && *begin == *(end-1)))
+            *(codes-1) = CLOSEPOLY;
+    }
 }
 
-const ContourLine::Children& ContourLine::get_children() const
+void Contour::emplace_back(const double& x, const double& y)
 {
-    assert(!_is_hole && "Cannot get_children of a hole");
-    return _children;
+    assert(!_lines.empty() && "Contour has no current line");
+    _points.emplace_back(x, y);
 }
 
-const ContourLine* ContourLine::get_parent() const
+bool Contour::empty() const
 {
-    assert(_is_hole && "Cannot get_parent of a non-hole");
-    return _parent;
+    return line_size(current_line()) == 0;
 }
 
-ContourLine* ContourLine::get_parent()
+const XY& Contour::front() const
 {
-    assert(_is_hole && "Cannot get_parent of a non-hole");
-    return _parent;
+    assert(!empty() && "Current line is empty");
+    return _points[_lines.back().start];
 }
 
-bool ContourLine::is_hole() const
+index_t Contour::get_first_child(index_t line) const
 {
-    return _is_hole;
+    assert(!is_hole(line) && "Cannot get children of a hole");
+    return _lines[line].first_child;
 }
 
-void ContourLine::set_parent(ContourLine* parent)
+index_t Contour::get_next_sibling(index_t line) const
 {
-    assert(_is_hole && "Cannot set parent of a non-hole");
-    assert(parent != 0 && "Null parent ContourLine");
-    _parent = parent;
+    assert(is_hole(line) && "Cannot get next sibling of a non-hole");
+    return _lines[line].next_sibling;
 }
 
-void ContourLine::write() const
+index_t Contour::get_parent(index_t line) const
 {
-    std::cout << "ContourLine " << this << " of " << size() << " points:";
-    for (const_iterator it = begin(); it != end(); ++it)
-        std::cout << ' ' << *it;
-    if (is_hole())
-        std::cout << " hole, parent=" << get_parent();
-    else {
-        std::cout << " not hole";
-        if (!_children.empty()) {
-            std::cout << ", children=";
-            for (Children::const_iterator it = _children.begin();
-                 it != _children.end(); ++it)
-                std::cout << *it << ' ';
-        }
-    }
-    std::cout << std::endl;
+    assert(is_hole(line) && "Cannot get parent of a non-hole");
+    return _lines[line].parent;
 }
 
+bool Contour::is_hole(index_t line) const
+{
+    assert(line >= 0 && line < line_count() && "Line index out of bounds");
+    return _lines[line].parent != -1;
+}
 
+const XY* Contour::line_begin(index_t line) const
+{
+    assert(line >= 0 && line < line_count() && "Line index out of bounds");
+    return _points.data() + _lines[line].start;
+}
 
-Contour::Contour()
-{}
+index_t Contour::line_count() const
+{
+    return static_cast<index_t>(_lines.size());
+}
+
+const XY* Contour::line_end(index_t line) const
+{
+    assert(line >= 0 && line < line_count() && "Line index out of bounds");
+    return _points.data() + (line+1 < line_count() ? _lines[line+1].start : _points.size());
+}
+
+count_t Contour::line_size(index_t line) const
+{
+    return static_cast<count_t>(line_end(line) - line_begin(line));
+}
 
-Contour::~Contour()
+count_t Contour::point_count() const
 {
-    delete_contour_lines();
+    return _points.size();
 }
 
-void Contour::delete_contour_lines()
+void Contour::push_back(const XY& point)
 {
-    for (iterator line_it = begin(); line_it != end(); ++line_it) {
-        delete *line_it;
-        *line_it = 0;
+    assert(!_lines.empty() && "Contour has no current line");
+    _points.push_back(point);
+}
+
+index_t Contour::start_line(index_t parent)
+{
+    index_t line = line_count();
+    _lines.push_back({static_cast<count_t>(_points.size()), parent, -1, -1, -1});
+
+    if (parent != -1) {
+        assert(!is_hole(parent) && "Parent of a hole cannot be a hole");
+        Line& parent_line = _lines[parent];
+        if (parent_line.last_child == -1)
+            parent_line.first_child = line;
+        else
+            _lines[parent_line.last_child].next_sibling = line;
+        parent_line.last_child = line;
     }
-    std::vector<ContourLine*>::clear();
+
+    return line;
 }
 
 void Contour::write() const
 {
-    std::cout << "Contour of " << size() << " lines." << std::endl;
-    for (const_iterator it = begin(); it != end(); ++it)
-        (*it)->write();
+    std::cout << "Contour of " << line_count() << " lines." << std::endl;
+    for (index_t line = 0; line < line_count(); ++line) {
+        std::cout << "Line " << line << " of " << line_size(line) << " points:";
+        for (const XY* point = line_begin(line); point != line_end(line); ++point)
+            std::cout << ' ' << *point;
+        if (is_hole(line))
+            std::cout << " hole, parent=" << get_parent(line);
+        else {
+            std::cout << " not hole";
+            if (get_first_child(line) != -1) {
+                std::cout << ", children=";
+                for (index_t child = get_first_child(line); child != -1;
+                     child = get_next_sibling(child))
+                    std::cout << child << ' ';
+            }
+        }
+        std::cout << std::endl;
+    }
 }
 
 
@@ -277,16 +338,16 @@ ParentCache::ParentCache(index_t nx, index_t x_chunk_points, index_t y_chunk_poi
     assert(_x_chunk_points > 0 && _y_chunk_points > 0 && "Chunk sizes must be positive");
 }
 
-ContourLine* ParentCache::get_parent(index_t quad)
+index_t ParentCache::get_parent(index_t quad) const
 {
     index_t index = index_to_index(quad);
-    ContourLine* parent = _lines[index];
-    while (parent == 0) {
+    index_t parent = _lines[index];
+    while (parent == -1) {
         index -= _x_chunk_points;
         assert(index >= 0 && "Failed to find parent in chunk ParentCache");
         parent = _lines[index];
     }
-    assert(parent != 0 && "Failed to find parent in chunk ParentCache");
+    assert(parent != -1 && "Failed to find parent in chunk ParentCache");
     return parent;
 }
 
@@ -310,63 +371,62 @@ void ParentCache::set_chunk_starts(index_t istart, index_t jstart)
     _istart = istart;
     _jstart = jstart;
     if (_lines.empty())
-        _lines.resize(_x_chunk_points*_y_chunk_points, 0);
+        _lines.resize(_x_chunk_points*_y_chunk_points, -1);
     else
-        std::fill(_lines.begin(), _lines.end(), (ContourLine*)0);
+        std::fill(_lines.begin(), _lines.end(), -1);
 }
 
-void ParentCache::set_parent(index_t quad, ContourLine& contour_line)
+void ParentCache::set_parent(index_t quad, const Contour& contour)
 {
     assert(!_lines.empty() && "Accessing ParentCache before it has been initialised");
     index_t index = index_to_index(quad);
-    if (_lines[index] == 0)
-        _lines[index] = contour_line.is_hole() ? contour_line.get_parent() : &contour_line;
+    if (_lines[index] == -1) {
+        index_t line = contour.current_line();
+        _lines[index] = contour.is_hole(line) ? contour.get_parent(line) : line;
+    }
 }
 
 
 
 Mpl2014ContourGenerator::Mpl2014ContourGenerator(
-    const CoordinateArray& x, const CoordinateArray& y, const CoordinateArray& z,
-    const MaskArray& mask, bool corner_mask, index_t x_chunk_size, index_t y_chunk_size)
+    const double* x, const double* y, const double* z, const bool* mask, index_t nx,
+    index_t ny, bool corner_mask, LineType line_type, FillType fill_type, index_t x_chunk_size,
+    index_t y_chunk_size)
     : _x(x),
       _y(y),
       _z(z),
-      _nx(_z.ndim() > 1 ? _z.shape(1) : 0),
-      _ny(_z.ndim() > 0 ? _z.shape(0) : 0),
+      _nx(nx),
+      _ny(ny),
       _n(_nx*_ny),
       _corner_mask(corner_mask),
+      _line_type(line_type),
+      _fill_type(fill_type),
+      _lines_chunked(line_type != LineType::SeparateCode),
+      _filled_chunked(fill_type != FillType::OuterCode),
       _x_chunk_size(x_chunk_size > 0 ? std::min(x_chunk_size, _nx-1) : _nx-1),
       _y_chunk_size(y_chunk_size > 0 ? std::min(y_chunk_size, _ny-1) : _ny-1),
       _nxchunk(calc_chunk_count(_nx, _x_chunk_size)),
       _nychunk(calc_chunk_count(_ny, _y_chunk_size)),
       _chunk_count(_nxchunk*_nychunk),
-      _cache(new CacheItem[_n]),
+      _cache(nullptr),
       _parent_cache(_nx,
                     _x_chunk_size > 0 ? _x_chunk_size+1 : _nx,
                     _y_chunk_size > 0 ? _y_chunk_size+1 : _ny)
 {
-    if (_x.ndim() != 2 || _y.ndim() != 2 || _z.ndim() != 2)
-        throw std::invalid_argument("x, y and z must all be 2D arrays");
-
-    if (_x.shape(1) != _nx || _x.shape(0) != _ny ||
-        _y.shape(1) != _nx || _y.shape(0) != _ny)
-        throw std::invalid_argument("x, y and z arrays must have the same shape");
-
     if (_nx < 2 || _ny < 2)
         throw std::invalid_argument("x, y and z must all be at least 2x2 arrays");
 
-    if (mask.ndim() != 0) {  // ndim == 0 if mask is not set, which is valid.
-        if (mask.ndim() != 2)
-            throw std::invalid_argument("mask array must be a 2D array");
+    if (!supports_line_type(line_type))
+        throw std::invalid_argument("Unsupported LineType");
 
-        if (mask.shape(1) != _nx || mask.shape(0) != _ny)
-            throw std::invalid_argument(
-                "If mask is set it must be a 2D array with the same shape as z");
-    }
+    if (!supports_fill_type(fill_type))
+        throw std::invalid_argument("Unsupported FillType");
 
     if (x_chunk_size < 0 || y_chunk_size < 0)
         throw std::invalid_argument("chunk_size cannot be negative");
 
+    // Allocated after the checks so that it is not leaked if they throw.
+    _cache = new CacheItem[_n];
     init_cache_grid(mask);
 }
 
@@ -376,128 +436,66 @@ Mpl2014ContourGenerator::~Mpl2014ContourGenerator()
 }
 
 void Mpl2014ContourGenerator::append_contour_line_to_vertices_and_codes(
-    ContourLine& contour_line, py::list& vertices_list, py::list& codes_list) const
+    Contour& contour, Output& output) const
 {
-    // Convert ContourLine to Python equivalent, and clear it for reuse.
-    // This function is called once for each line generated in create_contour().
+    // Convert the single line of a Contour to output arrays, and clear it for
+    // reuse.  This function is called once for each line generated in lines().
     // A line is either a closed line loop (in which case the last point is
-    // identical to the first) or an open line strip.  Two NumPy arrays are
+    // identical to the first) or an open line strip.  Two arrays are
     // created for each line:
     //   vertices is a double array of shape (npoints, 2) containing the (x, y)
     //     coordinates of the points in the line
     //   codes is a uint8 array of shape (npoints,) containing the 'kind codes'
     //     which are defined in the Path class
-    // and they are appended to the Python lists vertices_list and codes_list
-    // respectively for return to the Python calling function.
-
-    py::ssize_t npoints = static_cast<py::ssize_t>(contour_line.size());
+    // and they are appended to the two lists of output respectively.
+    assert(contour.line_count() == 1 && "Contour should contain a single line");
 
-    py::ssize_t vertices_dims[2] = {npoints, 2};
-    PointArray vertices(vertices_dims);
-    double* vertices_ptr = vertices.mutable_data();
+    count_t npoints = contour.line_size(0);
+    double* vertices_ptr = output.append_points(npoints);
+    uint8_t* codes_ptr = output.append_codes(npoints);
+    contour.copy_line(0, false, vertices_ptr, codes_ptr);
 
-    py::ssize_t codes_dims[1] = {npoints};
-    CodeArray codes(codes_dims);
-    unsigned char* codes_ptr = codes.mutable_data();
-
-    for (ContourLine::const_iterator point = contour_line.begin();
-         point != contour_line.end(); ++point) {
-        *vertices_ptr++ = point->x;
-        *vertices_ptr++ = point->y;
-        *codes_ptr++ = (point == contour_line.begin() ? MOVETO : LINETO);
-    }
-
-    // Closed line loop has identical first and last (x, y) points.
-    if (contour_line.size() > 1 && contour_line.front() == contour_line.back())
-        *(codes_ptr-1) = CLOSEPOLY;
-
-    vertices_list.append(vertices);
-    codes_list.append(codes);
-
-    contour_line.clear();
+    contour.clear();
 }
 
 void Mpl2014ContourGenerator::append_contour_to_vertices_and_codes(
-    Contour& contour, py::list& vertices_list, py::list& codes_list) const
+    Contour& contour, Output& output) const
 {
-    // Convert Contour to Python equivalent, and clear it for reuse.
-    // This function is called once for each polygon generated in
-    // create_filled_contour().  A polygon consists of an outer line loop
-    // (called the parent) and zero or more inner line loops or holes (called
-    // the children).  Two NumPy arrays are created for each polygon:
+    // Convert Contour to output arrays, and clear it for reuse.
+    // This function is called once for each chunk of polygons generated in
+    // filled().  A polygon consists of an outer line loop (called the
+    // parent) and zero or more inner line loops or holes (called the
+    // children).  Two arrays are created for each polygon:
     //   vertices is a double array of shape (npoints, 2) containing the (x, y)
     //     coordinates of the points in the polygon (parent plus children)
     //   codes is a uint8 array of shape (npoints,) containing the 'kind codes'
     //     which are defined in the Path class
-    // and they are appended to the Python lists vertices_list and codes_list
-    // respectively for return to the Python calling function.
-
-    // Convert Contour to python equivalent, and clear it.
-    for (Contour::iterator line_it = contour.begin(); line_it != contour.end();
-         ++line_it) {
-        ContourLine& line = **line_it;
-        if (line.is_hole()) {
-            // If hole has already been converted to python its parent will be
-            // set to 0 and it can be deleted.
-            if (line.get_parent() != 0) {
-                delete *line_it;
-                *line_it = 0;
-            }
-        }
-        else {
-            // Non-holes are converted to python together with their child
-            // holes so that they are rendered correctly.
-            ContourLine::const_iterator point;
-            ContourLine::Children::const_iterator children_it;
-
-            const ContourLine::Children& children = line.get_children();
-            py::ssize_t npoints = static_cast<py::ssize_t>(line.size() + 1);
-            for (children_it = children.begin(); children_it != children.end(); ++children_it)
-                 npoints += static_cast<py::ssize_t>((*children_it)->size() + 1);
-
-            py::ssize_t vertices_dims[2] = {npoints, 2};
-            PointArray vertices(vertices_dims);
-            double* vertices_ptr = vertices.mutable_data();
-
-            py::ssize_t codes_dims[1] = {npoints};
-            CodeArray codes(codes_dims);
-            unsigned char* codes_ptr = codes.mutable_data();
-
-            for (point = line.begin(); point != line.end(); ++point) {
-                *vertices_ptr++ = point->x;
-                *vertices_ptr++ = point->y;
-                *codes_ptr++ = (point == line.begin() ? MOVETO : LINETO);
-            }
-            point = line.begin();
-            *vertices_ptr++ = point->x;
-            *vertices_ptr++ = point->y;
-            *codes_ptr++ = CLOSEPOLY;
-
-            for (children_it = children.begin(); children_it != children.end(); ++children_it) {
-                ContourLine& child = **children_it;
-                for (point = child.begin(); point != child.end(); ++point) {
-                    *vertices_ptr++ = point->x;
-                    *vertices_ptr++ = point->y;
-                    *codes_ptr++ = (point == child.begin() ? MOVETO : LINETO);
-                }
-                point = child.begin();
-                *vertices_ptr++ = point->x;
-                *vertices_ptr++ = point->y;
-                *codes_ptr++ = CLOSEPOLY;
-
-                child.clear_parent();  // To indicate it can be deleted.
-            }
-
-            vertices_list.append(vertices);
-            codes_list.append(codes);
-
-            delete *line_it;
-            *line_it = 0;
-        }
+    // and they are appended to the two lists of output respectively.
+
+    // Non-holes are converted to output together with their child holes so
+    // that they are rendered correctly.  Holes are skipped as they are output
+    // with their parents.
+    index_t line_count = contour.line_count();
+    for (index_t line = 0; line < line_count; ++line) {
+        if (contour.is_hole(line))
+            continue;
+
+        count_t npoints = contour.line_size(line) + 1;
+        for (index_t child = contour.get_first_child(line); child != -1;
+             child = contour.get_next_sibling(child))
+            npoints += contour.line_size(child) + 1;
+
+        double* vertices_ptr = output.append_points(npoints);
+        uint8_t* codes_ptr = output.append_codes(npoints);
+
+        // Parent followed by each of its children, each closed.
+        contour.copy_line(line, true, vertices_ptr, codes_ptr);
+        for (index_t child = contour.get_first_child(line); child != -1;
+             child = contour.get_next_sibling(child))
+            contour.copy_line(child, true, vertices_ptr, codes_ptr);
     }
 
-    // Delete remaining contour lines.
-    contour.delete_contour_lines();
+    contour.clear();
 }
 
 index_t Mpl2014ContourGenerator::calc_chunk_count(
@@ -518,27 +516,45 @@ index_t Mpl2014ContourGenerator::calc_chunk_count(
         return 1;
 }
 
+FillType Mpl2014ContourGenerator::default_fill_type()
+{
+    return FillType::OuterCode;
+}
+
+LineType Mpl2014ContourGenerator::default_line_type()
+{
+    return LineType::SeparateCode;
+}
+
 void Mpl2014ContourGenerator::edge_interp(
-    const QuadEdge& quad_edge, const double& level, ContourLine& contour_line)
+    const QuadEdge& quad_edge, const double& level, Contour& contour)
 {
     assert(quad_edge.quad >= 0 && quad_edge.quad < _n && "Quad index out of bounds");
     assert(quad_edge.edge != Edge_None && "Invalid edge");
     interp(get_edge_point_index(quad_edge, true),
            get_edge_point_index(quad_edge, false),
-           level, contour_line);
+           level, contour);
 }
 
-py::tuple Mpl2014ContourGenerator::filled(
-    const double& lower_level, const double& upper_level)
+void Mpl2014ContourGenerator::filled(
+    const double& lower_level, const double& upper_level, Output& output)
 {
     if (lower_level > upper_level)
         throw std::invalid_argument("upper and lower levels are the wrong way round");
 
+    auto lock = lock_call();
     init_cache_levels(lower_level, upper_level);
 
-    Contour contour;
+    if (_filled_chunked) {
+        bool outer_offsets = (_fill_type == FillType::ChunkCombinedCodeOffset ||
+                              _fill_type == FillType::ChunkCombinedOffsetOffset);
+        output.init(outer_offsets ? 3 : 2, _chunk_count);
+    }
+    else
+        output.init(2, 0);
+    std::lock_guard<Output> output_lock(output);
 
-    py::list vertices, codes;
+    _contour.clear();  // In case a previous call was interrupted by an exception.
 
     index_t ichunk, jchunk, istart, iend, jstart, jend;
     for (index_t ijchunk = 0; ijchunk < _chunk_count; ++ijchunk) {
@@ -549,7 +565,7 @@ py::tuple Mpl2014ContourGenerator::filled(
             index_t quad_end = iend + j*_nx;
             for (index_t quad = istart + j*_nx; quad < quad_end; ++quad) {
                 if (!EXISTS_NONE(quad))
-                    single_quad_filled(contour, quad, lower_level, upper_level);
+                    single_quad_filled(_contour, quad, lower_level, upper_level);
             }
         }
 
@@ -566,15 +582,16 @@ py::tuple Mpl2014ContourGenerator::filled(
                 _cache[quad] &= ~MASK_VISITED_W;
         }
 
-        // Create python objects to return for this chunk.
-        append_contour_to_vertices_and_codes(contour, vertices, codes);
+        // Create output arrays for this chunk.
+        if (_filled_chunked)
+            set_chunk_filled(ijchunk, _contour, output);
+        else
+            append_contour_to_vertices_and_codes(_contour, output);
     }
-
-    return py::make_tuple(vertices, codes);
 }
 
 unsigned int Mpl2014ContourGenerator::follow_boundary(
-    ContourLine& contour_line, QuadEdge& quad_edge, const double& lower_level,
+    Contour& contour, QuadEdge& quad_edge, const double& lower_level,
     const double& upper_level, unsigned int level_index, const QuadEdge& start_quad_edge)
 {
     assert(quad_edge.quad >= 0 && quad_edge.quad < _n && "Quad index out of bounds");
@@ -658,7 +675,7 @@ unsigned int Mpl2014ContourGenerator::follow_boundary(
 
         if (stop) {
             // Exiting boundary to enter interior.
-            edge_interp(quad_edge, level_index == 1 ? lower_level : upper_level, contour_line);
+            edge_interp(quad_edge, level_index == 1 ? lower_level : upper_level, contour);
             break;
         }
 
@@ -671,14 +688,14 @@ unsigned int Mpl2014ContourGenerator::follow_boundary(
             case Edge_S:
             case Edge_SE:
                 if (!EXISTS_SE_CORNER(quad))
-                    _parent_cache.set_parent(quad, contour_line);
+                    _parent_cache.set_parent(quad, contour);
                 break;
             case Edge_E:
             case Edge_NE:
             case Edge_N:
             case Edge_NW:
                 if (!EXISTS_SW_CORNER(quad))
-                    _parent_cache.set_parent(quad + 1, contour_line);
+                    _parent_cache.set_parent(quad + 1, contour);
                 break;
             default:
                 assert(0 && "Invalid edge");
@@ -686,7 +703,7 @@ unsigned int Mpl2014ContourGenerator::follow_boundary(
         }
 
         // Add point to contour.
-        get_point_xy(end_point, contour_line);
+        get_point_xy(end_point, contour);
 
         if (first_edge)
             first_edge = false;
@@ -696,7 +713,7 @@ unsigned int Mpl2014ContourGenerator::follow_boundary(
 }
 
 void Mpl2014ContourGenerator::follow_interior(
-    ContourLine& contour_line, QuadEdge& quad_edge, unsigned int level_index, const double& level,
+    Contour& contour, QuadEdge& quad_edge, unsigned int level_index, const double& level,
     bool want_initial_point, const QuadEdge* start_quad_edge, unsigned int start_level_index,
     bool set_parents)
 {
@@ -714,7 +731,7 @@ void Mpl2014ContourGenerator::follow_interior(
     Edge& edge = quad_edge.edge;
 
     if (want_initial_point)
-        edge_interp(quad_edge, level, contour_line);
+        edge_interp(quad_edge, level, contour);
 
     CacheItem visited_mask = (level_index == 1 ? MASK_VISITED_1 : MASK_VISITED_2);
     CacheItem saddle_mask = (level_index == 1 ? MASK_SADDLE_1 : MASK_SADDLE_2);
@@ -822,13 +839,13 @@ void Mpl2014ContourGenerator::follow_interior(
 
         if (set_parents) {
             if (edge == Edge_E)
-                _parent_cache.set_parent(quad+1, contour_line);
+                _parent_cache.set_parent(quad+1, contour);
             else if (edge == Edge_W)
-                _parent_cache.set_parent(quad, contour_line);
+                _parent_cache.set_parent(quad, contour);
         }
 
         // Add new point to contour line.
-        edge_interp(quad_edge, level, contour_line);
+        edge_interp(quad_edge, level, contour);
 
         // Stop if reached boundary.
         if (is_edge_a_boundary(quad_edge))
@@ -845,9 +862,9 @@ void Mpl2014ContourGenerator::follow_interior(
     }
 }
 
-py::tuple Mpl2014ContourGenerator::get_chunk_count() const
+std::pair<index_t, index_t> Mpl2014ContourGenerator::get_chunk_count() const
 {
-    return py::make_tuple(_nychunk, _nxchunk);
+    return std::make_pair(_nychunk, _nxchunk);
 }
 
 void Mpl2014ContourGenerator::get_chunk_limits(
@@ -863,9 +880,9 @@ void Mpl2014ContourGenerator::get_chunk_limits(
     jend = (jchunk == _nychunk-1 ? _ny : (jchunk+1)*_y_chunk_size);
 }
 
-py::tuple Mpl2014ContourGenerator::get_chunk_size() const
+std::pair<index_t, index_t> Mpl2014ContourGenerator::get_chunk_size() const
 {
-    return py::make_tuple(_y_chunk_size, _x_chunk_size);
+    return std::make_pair(_y_chunk_size, _x_chunk_size);
 }
 
 bool Mpl2014ContourGenerator::get_corner_mask() const
@@ -1022,29 +1039,39 @@ Edge Mpl2014ContourGenerator::get_exit_edge(const QuadEdge& quad_edge, Dir dir)
     }
 }
 
+FillType Mpl2014ContourGenerator::get_fill_type() const
+{
+    return _fill_type;
+}
+
+LineType Mpl2014ContourGenerator::get_line_type() const
+{
+    return _line_type;
+}
+
 const double& Mpl2014ContourGenerator::get_point_x(index_t point) const
 {
     assert(point >= 0 && point < _n && "Point index out of bounds.");
-    return _x.data()[point];
+    return _x[point];
 }
 
 const double& Mpl2014ContourGenerator::get_point_y(index_t point) const
 {
     assert(point >= 0 && point < _n && "Point index out of bounds.");
-    return _y.data()[point];
+    return _y[point];
 }
 
 void Mpl2014ContourGenerator::get_point_xy(
-    index_t point, ContourLine& contour_line) const
+    index_t point, Contour& contour) const
 {
     assert(point >= 0 && point < _n && "Point index out of bounds.");
-    contour_line.emplace_back(_x.data()[point], _y.data()[point]);
+    contour.emplace_back(_x[point], _y[point]);
 }
 
 const double& Mpl2014ContourGenerator::get_point_z(index_t point) const
 {
     assert(point >= 0 && point < _n && "Point index out of bounds.");
-    return _z.data()[point];
+    return _z[point];
 }
 
 Edge Mpl2014ContourGenerator::get_quad_start_edge(
@@ -1106,11 +1133,11 @@ Edge Mpl2014ContourGenerator::get_start_edge(index_t quad, unsigned int level_in
         return get_quad_start_edge(quad, level_index);
 }
 
-void Mpl2014ContourGenerator::init_cache_grid(const MaskArray& mask)
+void Mpl2014ContourGenerator::init_cache_grid(const bool* mask)
 {
     index_t i, j, quad;
 
-    if (mask.ndim() == 0) {
+    if (mask == nullptr) {
         // No mask, easy to calculate quad existence and boundaries together.
         quad = 0;
         for (j = 0; j < _ny; ++j) {
@@ -1129,7 +1156,7 @@ void Mpl2014ContourGenerator::init_cache_grid(const MaskArray& mask)
         }
     }
     else {
-        const bool* mask_ptr = mask.data();
+        const bool* mask_ptr = mask;
 
         // Have mask so use two stages.
         // Stage 1, determine if quads/corners exist.
@@ -1214,7 +1241,7 @@ void Mpl2014ContourGenerator::init_cache_levels(
                       : MASK_EXISTS_QUAD | MASK_BOUNDARY_S | MASK_BOUNDARY_W);
 
     if (two_levels) {
-        const double* z_ptr = _z.data();
+        const double* z_ptr = _z;
         for (index_t quad = 0; quad < _n; ++quad, ++z_ptr) {
             _cache[quad] &= keep_mask;
             if (*z_ptr > upper_level)
@@ -1224,7 +1251,7 @@ void Mpl2014ContourGenerator::init_cache_levels(
         }
     }
     else {
-        const double* z_ptr = _z.data();
+        const double* z_ptr = _z;
         for (index_t quad = 0; quad < _n; ++quad, ++z_ptr) {
             _cache[quad] &= keep_mask;
             if (*z_ptr > lower_level)
@@ -1234,13 +1261,13 @@ void Mpl2014ContourGenerator::init_cache_levels(
 }
 
 void Mpl2014ContourGenerator::interp(
-    index_t point1, index_t point2, const double& level, ContourLine& contour_line) const
+    index_t point1, index_t point2, const double& level, Contour& contour) const
 {
     assert(point1 >= 0 && point1 < _n && "Point index 1 out of bounds.");
     assert(point2 >= 0 && point2 < _n && "Point index 2 out of bounds.");
     assert(point1 != point2 && "Identical points");
     double fraction = (get_point_z(point2) - level) / (get_point_z(point2) - get_point_z(point1));
-    contour_line.emplace_back(
+    contour.emplace_back(
         get_point_x(point1)*fraction + get_point_x(point2)*(1.0 - fraction),
         get_point_y(point1)*fraction + get_point_y(point2)*(1.0 - fraction));
 }
@@ -1264,16 +1291,29 @@ bool Mpl2014ContourGenerator::is_edge_a_boundary(
     }
 }
 
-py::tuple Mpl2014ContourGenerator::lines(const double& level)
+void Mpl2014ContourGenerator::lines(const double& level, Output& output)
 {
+    auto lock = lock_call();
     init_cache_levels(level, level);
 
-    py::list vertices_list, codes_list;
+    output.init(2, _lines_chunked ? _chunk_count : 0);
+    std::lock_guard<Output> output_lock(output);
+
+    // If chunked, each line is kept in the Contour of the chunk that it
+    // starts in until all lines have been found.  Contours are cleared in case
+    // a previous call was interrupted by an exception.
+    _contour.clear();
+    if (_lines_chunked) {
+        _chunk_contours.resize(_chunk_count);
+        for (auto& contour : _chunk_contours)
+            contour.clear();
+    }
 
     // Lines that start and end on boundaries.
     index_t ichunk, jchunk, istart, iend, jstart, jend;
     for (index_t ijchunk = 0; ijchunk < _chunk_count; ++ijchunk) {
         get_chunk_limits(ijchunk, ichunk, jchunk, istart, iend, jstart, jend);
+        Contour& contour = _lines_chunked ? _chunk_contours[ijchunk] : _contour;
 
         for (index_t j = jstart; j < jend; ++j) {
             index_t quad_end = iend + j*_nx;
@@ -1281,42 +1321,42 @@ py::tuple Mpl2014ContourGenerator::lines(const double& level)
                 if (EXISTS_NONE(quad) || VISITED(quad,1)) continue;
 
                 if (BOUNDARY_S(quad) && Z_SW >= 1 && Z_SE < 1 &&
-                    start_line(vertices_list, codes_list, quad, Edge_S, level)) continue;
+                    start_line(contour, output, quad, Edge_S, level)) continue;
 
                 if (BOUNDARY_W(quad) && Z_NW >= 1 && Z_SW < 1 &&
-                    start_line(vertices_list, codes_list, quad, Edge_W, level)) continue;
+                    start_line(contour, output, quad, Edge_W, level)) continue;
 
                 if (BOUNDARY_N(quad) && Z_NE >= 1 && Z_NW < 1 &&
-                    start_line(vertices_list, codes_list, quad, Edge_N, level)) continue;
+                    start_line(contour, output, quad, Edge_N, level)) continue;
 
                 if (BOUNDARY_E(quad) && Z_SE >= 1 && Z_NE < 1 &&
-                    start_line(vertices_list, codes_list, quad, Edge_E, level)) continue;
+                    start_line(contour, output, quad, Edge_E, level)) continue;
 
                 if (_corner_mask) {
                     // Equates to NE boundary.
                     if (EXISTS_SW_CORNER(quad) && Z_SE >= 1 && Z_NW < 1 &&
-                        start_line(vertices_list, codes_list, quad, Edge_NE, level)) continue;
+                        start_line(contour, output, quad, Edge_NE, level)) continue;
 
                     // Equates to NW boundary.
                     if (EXISTS_SE_CORNER(quad) && Z_NE >= 1 && Z_SW < 1 &&
-                        start_line(vertices_list, codes_list, quad, Edge_NW, level)) continue;
+                        start_line(contour, output, quad, Edge_NW, level)) continue;
 
                     // Equates to SE boundary.
                     if (EXISTS_NW_CORNER(quad) && Z_SW >= 1 && Z_NE < 1 &&
-                        start_line(vertices_list, codes_list, quad, Edge_SE, level)) continue;
+                        start_line(contour, output, quad, Edge_SE, level)) continue;
 
                     // Equates to SW boundary.
                     if (EXISTS_NE_CORNER(quad) && Z_NW >= 1 && Z_SE < 1 &&
-                        start_line(vertices_list, codes_list, quad, Edge_SW, level)) continue;
+                        start_line(contour, output, quad, Edge_SW, level)) continue;
                 }
             }
         }
     }
 
     // Internal loops.
-    ContourLine contour_line(false);  // Reused for each contour line.
     for (index_t ijchunk = 0; ijchunk < _chunk_count; ++ijchunk) {
         get_chunk_limits(ijchunk, ichunk, jchunk, istart, iend, jstart, jend);
+        Contour& contour = _lines_chunked ? _chunk_contours[ijchunk] : _contour;
 
         for (index_t j = jstart; j < jend; ++j) {
             index_t quad_end = iend + j*_nx;
@@ -1335,11 +1375,13 @@ py::tuple Mpl2014ContourGenerator::lines(const double& level)
                 // sometimes need to ignore the first point and add it on the
                 // end instead.
                 bool ignore_first = (start_edge == Edge_N);
+                contour.start_line();
                 follow_interior(
-                    contour_line, quad_edge, 1, level, !ignore_first, &start_quad_edge, 1, false);
-                if (ignore_first && !contour_line.empty())
-                    contour_line.push_back(contour_line.front());
-                append_contour_line_to_vertices_and_codes(contour_line, vertices_list, codes_list);
+                    contour, quad_edge, 1, level, !ignore_first, &start_quad_edge, 1, false);
+                if (ignore_first && !contour.empty())
+                    contour.push_back(contour.front());
+                if (!_lines_chunked)
+                    append_contour_line_to_vertices_and_codes(contour, output);
 
                 // Repeat if saddle point but not visited.
                 if (SADDLE(quad,1) && !VISITED(quad,1))
@@ -1348,7 +1390,10 @@ py::tuple Mpl2014ContourGenerator::lines(const double& level)
         }
     }
 
-    return py::make_tuple(vertices_list, codes_list);
+    if (_lines_chunked) {
+        for (index_t ijchunk = 0; ijchunk < _chunk_count; ++ijchunk)
+            set_chunk_lines(ijchunk, _chunk_contours[ijchunk], output);
+    }
 }
 
 void Mpl2014ContourGenerator::move_to_next_boundary_edge(
@@ -1473,12 +1518,102 @@ void Mpl2014ContourGenerator::move_to_next_quad(QuadEdge& quad_edge) const
     }
 }
 
+void Mpl2014ContourGenerator::set_chunk_filled(
+    index_t chunk, Contour& contour, Output& output) const
+{
+    index_t line_count = contour.line_count();
+    if (line_count == 0) {
+        output.set_empty(chunk);
+        return;
+    }
+
+    // Each line is closed by repeating its first point.
+    count_t point_count = contour.point_count() + line_count;
+    index_t outer_count = 0;
+    for (index_t line = 0; line < line_count; ++line) {
+        if (!contour.is_hole(line))
+            ++outer_count;
+    }
+
+    bool want_codes = (_fill_type == FillType::ChunkCombinedCode ||
+                       _fill_type == FillType::ChunkCombinedCodeOffset);
+    bool outer_offsets_into_points = (_fill_type == FillType::ChunkCombinedCodeOffset);
+    bool want_outer_offsets = (outer_offsets_into_points ||
+                               _fill_type == FillType::ChunkCombinedOffsetOffset);
+
+    double* points = output.set_points(chunk, point_count);
+    uint8_t* codes = want_codes ? output.set_codes(chunk, point_count) : nullptr;
+    offset_t* offsets = want_codes ? nullptr : output.set_offsets(chunk, line_count + 1);
+    offset_t* outer_offsets =
+        want_outer_offsets ? output.set_outer_offsets(chunk, outer_count + 1) : nullptr;
+
+    // Each non-hole is followed by its child holes.
+    offset_t point = 0, loop = 0;
+    for (index_t line = 0; line < line_count; ++line) {
+        if (contour.is_hole(line))
+            continue;
+
+        if (outer_offsets != nullptr)
+            *outer_offsets++ = outer_offsets_into_points ? point : loop;
+
+        index_t polygon = line;
+        index_t child = contour.get_first_child(line);
+        while (polygon != -1) {
+            if (offsets != nullptr)
+                *offsets++ = point;
+            contour.copy_line(polygon, true, points, codes);
+            point += static_cast<offset_t>(contour.line_size(polygon) + 1);
+            ++loop;
+
+            polygon = child;
+            if (child != -1)
+                child = contour.get_next_sibling(child);
+        }
+    }
+
+    if (offsets != nullptr)
+        *offsets = point;
+    if (outer_offsets != nullptr)
+        *outer_offsets = outer_offsets_into_points ? point : loop;
+
+    contour.clear();
+}
+
+void Mpl2014ContourGenerator::set_chunk_lines(
+    index_t chunk, Contour& contour, Output& output) const
+{
+    index_t line_count = contour.line_count();
+    if (line_count == 0) {
+        output.set_empty(chunk);
+        return;
+    }
+
+    count_t point_count = contour.point_count();
+    double* points = output.set_points(chunk, point_count);
+    if (_line_type == LineType::ChunkCombinedCode) {
+        uint8_t* codes = output.set_codes(chunk, point_count);
+        for (index_t line = 0; line < line_count; ++line)
+            contour.copy_line(line, false, points, codes);
+    }
+    else {
+        uint8_t* codes = nullptr;
+        offset_t* offsets = output.set_offsets(chunk, line_count + 1);
+        for (index_t line = 0; line < line_count; ++line) {
+            *offsets++ = static_cast<offset_t>(contour.line_begin(line) - contour.line_begin(0));
+            contour.copy_line(line, false, points, codes);
+        }
+        *offsets = static_cast<offset_t>(point_count);
+    }
+
+    contour.clear();
+}
+
 void Mpl2014ContourGenerator::single_quad_filled(
     Contour& contour, index_t quad, const double& lower_level, const double& upper_level)
 {
     assert(quad >= 0 && quad < _n && "Quad index out of bounds");
 
-    // Order of checking is important here as can have different ContourLines
+    // Order of checking is important here as can have different contour lines
     // from both lower and upper levels in the same quad.  First check the S
     // edge, then move up the quad to the N edge checking as required.
 
@@ -1487,23 +1622,19 @@ void Mpl2014ContourGenerator::single_quad_filled(
 
         // Lower-level start from S boundary into interior.
         if (!VISITED_S(quad) && Z_SW >= 1 && Z_SE == 0)
-            contour.push_back(start_filled(
-                quad, Edge_S, 1, NotHole, Interior, lower_level, upper_level));
+            start_filled(contour, quad, Edge_S, 1, NotHole, Interior, lower_level, upper_level);
 
         // Upper-level start from S boundary into interior.
         if (!VISITED_S(quad) && Z_SW < 2 && Z_SE == 2)
-            contour.push_back(start_filled(
-                quad, Edge_S, 2, NotHole, Interior, lower_level, upper_level));
+            start_filled(contour, quad, Edge_S, 2, NotHole, Interior, lower_level, upper_level);
 
         // Lower-level start following S boundary from W to E.
         if (!VISITED_S(quad) && Z_SW <= 1 && Z_SE == 1)
-            contour.push_back(start_filled(
-                quad, Edge_S, 1, NotHole, Boundary, lower_level, upper_level));
+            start_filled(contour, quad, Edge_S, 1, NotHole, Boundary, lower_level, upper_level);
 
         // Upper-level start following S boundary from W to E.
         if (!VISITED_S(quad) && Z_SW == 2 && Z_SE == 1)
-            contour.push_back(start_filled(
-                quad, Edge_S, 2, NotHole, Boundary, lower_level, upper_level));
+            start_filled(contour, quad, Edge_S, 2, NotHole, Boundary, lower_level, upper_level);
     }
 
     // Possible starts from W boundary.
@@ -1511,23 +1642,19 @@ void Mpl2014ContourGenerator::single_quad_filled(
 
         // Lower-level start from W boundary into interior.
         if (!VISITED_W(quad) && Z_NW >= 1 && Z_SW == 0)
-            contour.push_back(start_filled(
-                quad, Edge_W, 1, NotHole, Interior, lower_level, upper_level));
+            start_filled(contour, quad, Edge_W, 1, NotHole, Interior, lower_level, upper_level);
 
         // Upper-level start from W boundary into interior.
         if (!VISITED_W(quad) && Z_NW < 2 && Z_SW == 2)
-            contour.push_back(start_filled(
-                quad, Edge_W, 2, NotHole, Interior, lower_level, upper_level));
+            start_filled(contour, quad, Edge_W, 2, NotHole, Interior, lower_level, upper_level);
 
         // Lower-level start following W boundary from N to S.
         if (!VISITED_W(quad) && Z_NW <= 1 && Z_SW == 1)
-            contour.push_back(start_filled(
-                quad, Edge_W, 1, NotHole, Boundary, lower_level, upper_level));
+            start_filled(contour, quad, Edge_W, 1, NotHole, Boundary, lower_level, upper_level);
 
         // Upper-level start following W boundary from N to S.
         if (!VISITED_W(quad) && Z_NW == 2 && Z_SW == 1)
-            contour.push_back(start_filled(
-                quad, Edge_W, 2, NotHole, Boundary, lower_level, upper_level));
+            start_filled(contour, quad, Edge_W, 2, NotHole, Boundary, lower_level, upper_level);
     }
 
     // Possible starts from NE boundary.
@@ -1535,77 +1662,64 @@ void Mpl2014ContourGenerator::single_quad_filled(
 
         // Lower-level start following NE boundary from SE to NW, hole.
         if (!VISITED_CORNER(quad) && Z_NW == 1 && Z_SE == 1)
-            contour.push_back(start_filled(
-                quad, Edge_NE, 1, Hole, Boundary, lower_level, upper_level));
+            start_filled(contour, quad, Edge_NE, 1, Hole, Boundary, lower_level, upper_level);
     }
     // Possible starts from SE boundary.
     else if (EXISTS_NW_CORNER(quad)) {  // i.e. BOUNDARY_SE
 
         // Lower-level start from N to SE.
         if (!VISITED(quad,1) && Z_NW == 0 && Z_SW == 0 && Z_NE >= 1)
-            contour.push_back(start_filled(
-                quad, Edge_N, 1, NotHole, Interior, lower_level, upper_level));
+            start_filled(contour, quad, Edge_N, 1, NotHole, Interior, lower_level, upper_level);
 
         // Upper-level start from SE to N, hole.
         if (!VISITED(quad,2) && Z_NW <  2 && Z_SW < 2 && Z_NE == 2)
-            contour.push_back(start_filled(
-                quad, Edge_SE, 2, Hole, Interior, lower_level, upper_level));
+            start_filled(contour, quad, Edge_SE, 2, Hole, Interior, lower_level, upper_level);
 
         // Upper-level start from N to SE.
         if (!VISITED(quad,2) && Z_NW == 2 && Z_SW == 2 && Z_NE < 2)
-            contour.push_back(start_filled(
-                quad, Edge_N, 2, NotHole, Interior, lower_level, upper_level));
+            start_filled(contour, quad, Edge_N, 2, NotHole, Interior, lower_level, upper_level);
 
         // Lower-level start from SE to N, hole.
         if (!VISITED(quad,1) && Z_NW >= 1 && Z_SW >= 1 && Z_NE == 0)
-            contour.push_back(start_filled(
-                quad, Edge_SE, 1, Hole, Interior, lower_level, upper_level));
+            start_filled(contour, quad, Edge_SE, 1, Hole, Interior, lower_level, upper_level);
     }
     // Possible starts from NW boundary.
     else if (EXISTS_SE_CORNER(quad)) {  // i.e. BOUNDARY_NW
 
         // Lower-level start from NW to E.
         if (!VISITED(quad,1) && Z_SW == 0 && Z_SE == 0 && Z_NE >= 1)
-            contour.push_back(start_filled(
-                quad, Edge_NW, 1, NotHole, Interior, lower_level, upper_level));
+            start_filled(contour, quad, Edge_NW, 1, NotHole, Interior, lower_level, upper_level);
 
         // Upper-level start from E to NW, hole.
         if (!VISITED(quad,2) && Z_SW < 2 && Z_SE < 2 && Z_NE == 2)
-            contour.push_back(start_filled(
-                quad, Edge_E, 2, Hole, Interior, lower_level, upper_level));
+            start_filled(contour, quad, Edge_E, 2, Hole, Interior, lower_level, upper_level);
 
         // Upper-level start from NW to E.
         if (!VISITED(quad,2) && Z_SW == 2 && Z_SE == 2 && Z_NE < 2)
-            contour.push_back(start_filled(
-                quad, Edge_NW, 2, NotHole, Interior, lower_level, upper_level));
+            start_filled(contour, quad, Edge_NW, 2, NotHole, Interior, lower_level, upper_level);
 
         // Lower-level start from E to NW, hole.
         if (!VISITED(quad,1) && Z_SW >= 1 && Z_SE >= 1 && Z_NE == 0)
-            contour.push_back(start_filled(
-                quad, Edge_E, 1, Hole, Interior, lower_level, upper_level));
+            start_filled(contour, quad, Edge_E, 1, Hole, Interior, lower_level, upper_level);
     }
     // Possible starts from SW boundary.
     else if (EXISTS_NE_CORNER(quad)) {  // i.e. BOUNDARY_SW
 
         // Lower-level start from SW boundary into interior.
         if (!VISITED_CORNER(quad) && Z_NW >= 1 && Z_SE == 0)
-            contour.push_back(start_filled(
-                quad, Edge_SW, 1, NotHole, Interior, lower_level, upper_level));
+            start_filled(contour, quad, Edge_SW, 1, NotHole, Interior, lower_level, upper_level);
 
         // Upper-level start from SW boundary into interior.
         if (!VISITED_CORNER(quad) && Z_NW < 2 && Z_SE == 2)
-            contour.push_back(start_filled(
-                quad, Edge_SW, 2, NotHole, Interior, lower_level, upper_level));
+            start_filled(contour, quad, Edge_SW, 2, NotHole, Interior, lower_level, upper_level);
 
         // Lower-level start following SW boundary from NW to SE.
         if (!VISITED_CORNER(quad) && Z_NW <= 1 && Z_SE == 1)
-            contour.push_back(start_filled(
-                quad, Edge_SW, 1, NotHole, Boundary, lower_level, upper_level));
+            start_filled(contour, quad, Edge_SW, 1, NotHole, Boundary, lower_level, upper_level);
 
         // Upper-level start following SW boundary from NW to SE.
         if (!VISITED_CORNER(quad) && Z_NW == 2 && Z_SE == 1)
-            contour.push_back(start_filled(
-                quad, Edge_SW, 2, NotHole, Boundary, lower_level, upper_level));
+            start_filled(contour, quad, Edge_SW, 2, NotHole, Boundary, lower_level, upper_level);
     }
 
     // A full (unmasked) quad can only have a start on the NE corner, i.e. from
@@ -1623,26 +1737,22 @@ void Mpl2014ContourGenerator::single_quad_filled(
         // Lower-level start from N to E.
         if (!VISITED(quad,1) && Z_NW == 0 && Z_SE == 0 && Z_NE >= 1 &&
             (!SADDLE(quad,1) || SADDLE_LEFT(quad,1)))
-            contour.push_back(start_filled(
-                quad, Edge_N, 1, NotHole, Interior, lower_level, upper_level));
+            start_filled(contour, quad, Edge_N, 1, NotHole, Interior, lower_level, upper_level);
 
         // Upper-level start from E to N, hole.
         if (!VISITED(quad,2) && Z_NW < 2 && Z_SE <  2 && Z_NE == 2 &&
             (!SADDLE(quad,2) || !SADDLE_LEFT(quad,2)))
-            contour.push_back(start_filled(
-                quad, Edge_E, 2, Hole, Interior, lower_level, upper_level));
+            start_filled(contour, quad, Edge_E, 2, Hole, Interior, lower_level, upper_level);
 
         // Upper-level start from N to E.
         if (!VISITED(quad,2) && Z_NW == 2 && Z_SE == 2 && Z_NE < 2 &&
             (!SADDLE(quad,2) || SADDLE_LEFT(quad,2)))
-            contour.push_back(start_filled(
-                quad, Edge_N, 2, NotHole, Interior, lower_level, upper_level));
+            start_filled(contour, quad, Edge_N, 2, NotHole, Interior, lower_level, upper_level);
 
         // Lower-level start from E to N, hole.
         if (!VISITED(quad,1) && Z_NW >= 1 && Z_SE >= 1 && Z_NE == 0 &&
             (!SADDLE(quad,1) || !SADDLE_LEFT(quad,1)))
-            contour.push_back(start_filled(
-                quad, Edge_E, 1, Hole, Interior, lower_level, upper_level));
+            start_filled(contour, quad, Edge_E, 1, Hole, Interior, lower_level, upper_level);
 
         // All possible contours passing through the interior of this quad
         // should have already been created, so assert this.
@@ -1657,27 +1767,21 @@ void Mpl2014ContourGenerator::single_quad_filled(
     // surrounding contour line.
     if (BOUNDARY_N(quad) && EXISTS_N_EDGE(quad) &&
         !VISITED_S(quad+_nx) && Z_NW == 1 && Z_NE == 1)
-        contour.push_back(start_filled(
-            quad, Edge_N, 1, Hole, Boundary, lower_level, upper_level));
+        start_filled(contour, quad, Edge_N, 1, Hole, Boundary, lower_level, upper_level);
 }
 
-ContourLine* Mpl2014ContourGenerator::start_filled(
-    index_t quad, Edge edge, unsigned int start_level_index, HoleOrNot hole_or_not,
-    BoundaryOrInterior boundary_or_interior, const double& lower_level, const double& upper_level)
+void Mpl2014ContourGenerator::start_filled(
+    Contour& contour, index_t quad, Edge edge, unsigned int start_level_index,
+    HoleOrNot hole_or_not, BoundaryOrInterior boundary_or_interior, const double& lower_level,
+    const double& upper_level)
 {
     assert(quad >= 0 && quad < _n && "Quad index out of bounds");
     assert(edge != Edge_None && "Invalid edge");
     assert((start_level_index == 1 || start_level_index == 2) &&
            "start level index must be 1 or 2");
 
-    ContourLine* contour_line = new ContourLine(hole_or_not == Hole);
-    if (hole_or_not == Hole) {
-        // Find and set parent ContourLine.
-        ContourLine* parent = _parent_cache.get_parent(quad + 1);
-        assert(parent != 0 && "Failed to find parent ContourLine");
-        contour_line->set_parent(parent);
-        parent->add_child(contour_line);
-    }
+    // If a hole, find its parent line.
+    contour.start_line(hole_or_not == Hole ? _parent_cache.get_parent(quad + 1) : -1);
 
     QuadEdge quad_edge(quad, edge);
     const QuadEdge start_quad_edge(quad_edge);
@@ -1690,12 +1794,12 @@ ContourLine* Mpl2014ContourGenerator::start_filled(
         if (boundary_or_interior == Interior) {
             double level = (level_index == 1 ? lower_level : upper_level);
             follow_interior(
-                *contour_line, quad_edge, level_index, level, false, &start_quad_edge,
+                contour, quad_edge, level_index, level, false, &start_quad_edge,
                 start_level_index, true);
         }
         else {
             level_index = follow_boundary(
-                *contour_line, quad_edge, lower_level, upper_level, level_index, start_quad_edge);
+                contour, quad_edge, lower_level, upper_level, level_index, start_quad_edge);
         }
 
         if (quad_edge == start_quad_edge && (boundary_or_interior == Boundary ||
@@ -1707,24 +1811,49 @@ ContourLine* Mpl2014ContourGenerator::start_filled(
         else
             boundary_or_interior = Boundary;
     }
-
-    return contour_line;
 }
 
 bool Mpl2014ContourGenerator::start_line(
-    py::list& vertices_list, py::list& codes_list, index_t quad, Edge edge, const double& level)
+    Contour& contour, Output& output, index_t quad, Edge edge, const double& level)
 {
     assert(is_edge_a_boundary(QuadEdge(quad, edge)) && "QuadEdge is not a boundary");
 
     QuadEdge quad_edge(quad, edge);
-    ContourLine contour_line(false);
-    follow_interior(contour_line, quad_edge, 1, level, true, 0, 1, false);
+    contour.start_line();
+    follow_interior(contour, quad_edge, 1, level, true, 0, 1, false);
 
-    append_contour_line_to_vertices_and_codes(contour_line, vertices_list, codes_list);
+    if (!_lines_chunked)
+        append_contour_line_to_vertices_and_codes(contour, output);
 
     return VISITED(quad,1);
 }
 
+bool Mpl2014ContourGenerator::supports_fill_type(FillType fill_type)
+{
+    switch (fill_type) {
+        case FillType::OuterCode:
+        case FillType::ChunkCombinedCode:
+        case FillType::ChunkCombinedOffset:
+        case FillType::ChunkCombinedCodeOffset:
+        case FillType::ChunkCombinedOffsetOffset:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool Mpl2014ContourGenerator::supports_line_type(LineType line_type)
+{
+    switch (line_type) {
+        case LineType::SeparateCode:
+        case LineType::ChunkCombinedCode:
+        case LineType::ChunkCombinedOffset:
+            return true;
+        default:
+            return false;
+    }
+}
+
 void Mpl2014ContourGenerator::write_cache(bool grid_only) const
 {
     std::cout << "-----------------------------------------------" << std::endl;
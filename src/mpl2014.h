@@ -143,8 +143,11 @@
 #define CONTOURPY_MPL_2014_H
 
 #include "contour_generator.h"
-#include <list>
+#include "fill_type.h"
+#include "line_type.h"
+#include "output.h"
 #include <iostream>
+#include <utility>
 #include <vector>
 
 
@@ -198,65 +201,81 @@ struct XY
     double x, y;
 };
 
-// A single line of a contour, which may be a closed line loop or an open line
-// strip.  Identical adjacent points are avoided using push_back().
-// A ContourLine is either a hole (points ordered clockwise) or it is not
-// (points ordered anticlockwise).  Each hole has a parent ContourLine that is
-// not a hole; each non-hole contains zero or more child holes.  A non-hole and
-// its child holes must be rendered together to obtain the correct results.
-class ContourLine : public std::vector<XY>
+// The contour lines of a single chunk, stored contiguously so that lines are
+// not allocated individually.  A line may be a closed line loop or an open
+// line strip.  Lines are started one at a time using start_line() and points
+// are only ever appended to the most recently started line, so the points of
+// each line are a contiguous range of a single array.  Lines are identified by
+// their index, and clear() keeps the allocated storage for reuse.
+// A line is either a hole (points ordered clockwise) or it is not (points
+// ordered anticlockwise).  Each hole has a parent line that is not a hole;
+// each non-hole contains zero or more child holes.  A non-hole and its child
+// holes must be rendered together to obtain the correct results.
+class Contour
 {
 public:
-    typedef std::list<ContourLine*> Children;
-
-    explicit ContourLine(bool is_hole);
-    void add_child(ContourLine* child);
-    void clear_parent();
-    const Children& get_children() const;
-    const ContourLine* get_parent() const;
-    ContourLine* get_parent();
-    bool is_hole() const;
-    void set_parent(ContourLine* parent);
+    Contour();
+    void clear();
+    index_t current_line() const;
+    void emplace_back(const double& x, const double& y);  // Append to current line.
+    bool empty() const;                                    // Is current line empty?
+    const XY& front() const;                               // Of current line.
+    index_t get_first_child(index_t line) const;           // -1 if no children.
+    index_t get_next_sibling(index_t line) const;          // -1 if last child.
+    index_t get_parent(index_t line) const;
+    bool is_hole(index_t line) const;
+    const XY* line_begin(index_t line) const;
+    index_t line_count() const;
+    const XY* line_end(index_t line) const;
+    count_t line_size(index_t line) const;
+    count_t point_count() const;                           // Of all lines.
+    void push_back(const XY& point);                       // Append to current line.
+
+    // Copy the points of a line to points, and its kind codes to codes if it
+    // is not nullptr, advancing both pointers.  If close is true the first
+    // point is repeated at the end, otherwise the line is only closed if its
+    // first and last points are identical.
+    void copy_line(index_t line, bool close, double*& points, uint8_t*& codes) const;
+
+    // Start a new line and return its index.  It is a hole of the specified
+    // parent line if parent is not -1.
+    index_t start_line(index_t parent = -1);
+
     void write() const;
 
 private:
-    bool _is_hole;
-    ContourLine* _parent;  // Only set if is_hole, not owned.
-    Children _children;    // Only set if !is_hole, not owned.
-};
-
+    struct Line
+    {
+        count_t start;                // Index of first point in _points.
+        index_t parent;               // Only set if a hole, otherwise -1.
+        index_t first_child, last_child, next_sibling;  // -1 if not set.
+    };
 
-// A Contour is a collection of zero or more ContourLines.
-class Contour : public std::vector<ContourLine*>
-{
-public:
-    Contour();
-    virtual ~Contour();
-    void delete_contour_lines();
-    void write() const;
+    std::vector<XY> _points;
+    std::vector<Line> _lines;
 };
 
 
-// Single chunk of ContourLine parents, indexed by quad.  As a chunk's filled
-// contours are created, the ParentCache is updated each time a ContourLine
-// passes through each quad.  When a new ContourLine is created, if it is a
-// hole its parent ContourLine is read from the ParentCache by looking at the
-// start quad, then each quad to the S in turn until a non-zero ContourLine is
-// found.
+// Single chunk of contour line parents, indexed by quad.  As a chunk's filled
+// contours are created, the ParentCache is updated each time a contour line
+// passes through each quad.  When a new contour line is created, if it is a
+// hole its parent line is read from the ParentCache by looking at the start
+// quad, then each quad to the S in turn until a line is found.  Lines are
+// identified by their index in the chunk's Contour.
 class ParentCache
 {
 public:
     ParentCache(index_t nx, index_t x_chunk_points, index_t y_chunk_points);
-    ContourLine* get_parent(index_t quad);
+    index_t get_parent(index_t quad) const;
     void set_chunk_starts(index_t istart, index_t jstart);
-    void set_parent(index_t quad, ContourLine& contour_line);
+    void set_parent(index_t quad, const Contour& contour);  // Of current line.
 
 private:
     index_t index_to_index(index_t quad) const;
 
     index_t _nx;
     index_t _x_chunk_points, _y_chunk_points;  // Number of points not quads.
-    std::vector<ContourLine*> _lines;       // Not owned.
+    std::vector<index_t> _lines;               // -1 if not set.
     index_t _istart, _jstart;
 };
 
@@ -266,32 +285,49 @@ class Mpl2014ContourGenerator : public ContourGenerator
 {
 public:
     // Constructor with optional mask.
-    //   x, y, z: double arrays of shape (ny,nx).
-    //   mask: boolean array, ether empty (if no mask), or of shape (ny,nx).
+    //   x, y, z: C-contiguous double arrays of shape (ny,nx) that must outlive
+    //     the generator.
+    //   mask: boolean array, either nullptr (if no mask), or of shape (ny,nx).
+    //   nx, ny: number of points in each direction.
     //   corner_mask: flag for different masking behaviour.
+    //   line_type: format of line contour output, SeparateCode or one of the
+    //     ChunkCombined types.
+    //   fill_type: format of filled contour output, OuterCode or one of the
+    //     ChunkCombined types.
     //   x_chunk_size: 0 for no chunking, or +ve integer for size of chunks that
     //     the x-direction is subdivided into.
     //   y_chunk_size: 0 for no chunking, or +ve integer for size of chunks that
     //     the y-direction is subdivided into.
     Mpl2014ContourGenerator(
-        const CoordinateArray& x, const CoordinateArray& y, const CoordinateArray& z,
-        const MaskArray& mask, bool corner_mask, index_t x_chunk_size, index_t y_chunk_size);
+        const double* x, const double* y, const double* z, const bool* mask, index_t nx,
+        index_t ny, bool corner_mask, LineType line_type, FillType fill_type,
+        index_t x_chunk_size, index_t y_chunk_size);
 
     // Destructor.
     ~Mpl2014ContourGenerator();
 
-    // Create and return polygons for a filled contour between the two
-    // specified levels.
-    py::tuple filled(const double& lower_level, const double& upper_level);
+    static FillType default_fill_type();
+    static LineType default_line_type();
 
-    py::tuple get_chunk_count() const;  // Return (y_chunk_count, x_chunk_count)
-    py::tuple get_chunk_size() const;   // Return (y_chunk_size, x_chunk_size)
+    // Create polygons for a filled contour between the two specified levels
+    // and write them to output in the format of the fill_type.
+    void filled(const double& lower_level, const double& upper_level, Output& output);
+
+    // Return (y_chunk_count, x_chunk_count)
+    std::pair<index_t, index_t> get_chunk_count() const;
+    // Return (y_chunk_size, x_chunk_size)
+    std::pair<index_t, index_t> get_chunk_size() const;
 
     bool get_corner_mask() const;
+    FillType get_fill_type() const;
+    LineType get_line_type() const;
+
+    // Create polygons for a line (i.e. non-filled) contour at the specified
+    // level and write them to output in the format of the line_type.
+    void lines(const double& level, Output& output);
 
-    // Create and return polygons for a line (i.e. non-filled) contour at the
-    // specified level.
-    py::tuple lines(const double& level);
+    static bool supports_fill_type(FillType fill_type);
+    static bool supports_line_type(LineType line_type);
 
 private:
     // Typedef for following either a boundary of the domain or the interior;
@@ -317,72 +353,69 @@ private:
         Hole
     } HoleOrNot;
 
-    // Append a C++ ContourLine to the end of two python lists.  Used for line
-    // contours where each ContourLine is converted to a separate numpy array
-    // of (x,y) points and a second numpy array of 'kinds' or 'codes'.
-    // Clears the ContourLine too.
-    void append_contour_line_to_vertices_and_codes(
-        ContourLine& contour_line, py::list& vertices_list, py::list& codes_list) const;
-
-    // Append a C++ Contour to the end of two python lists.  Used for filled
-    // contours where each non-hole ContourLine and its child holes are
-    // represented by a numpy array of (x,y) points and a second numpy array of
-    // 'kinds' or 'codes' that indicates where the points array is split into
+    // Append the single line of a C++ Contour to the end of the two lists of
+    // output.  Used for line contours where each line is converted to a
+    // separate array of (x,y) points and a second array of 'kinds' or 'codes'.
+    // Clears the Contour too.
+    void append_contour_line_to_vertices_and_codes(Contour& contour, Output& output) const;
+
+    // Append a C++ Contour to the end of the two lists of output.  Used for
+    // filled contours where each non-hole line and its child holes are
+    // represented by an array of (x,y) points and a second array of 'kinds'
+    // or 'codes' that indicates where the points array is split into
     // individual polygons.
-    // Clears the Contour too, freeing each ContourLine as soon as possible
-    // for minimum RAM usage.
-    void append_contour_to_vertices_and_codes(
-        Contour& contour, py::list& vertices_list, py::list& codes_list) const;
+    // Clears the Contour too, keeping its storage for reuse by the next chunk.
+    void append_contour_to_vertices_and_codes(Contour& contour, Output& output) const;
 
     // Return number of chunks that fit in the specified point_count.
     index_t calc_chunk_count(index_t point_count, index_t chunk_size) const;
 
     // Append the point on the specified QuadEdge that intersects the specified
-    // level to the specified ContourLine.
-    void edge_interp(const QuadEdge& quad_edge, const double& level, ContourLine& contour_line);
+    // level to the current line of the specified Contour.
+    void edge_interp(const QuadEdge& quad_edge, const double& level, Contour& contour);
 
-    // Follow a contour along a boundary, appending points to the ContourLine
+    // Follow a contour along a boundary, appending points to the contour line
     // as it progresses.  Only called for filled contours.  Stops when the
     // contour leaves the boundary to move into the interior of the domain, or
-    // when the start_quad_edge is reached in which case the ContourLine is a
+    // when the start_quad_edge is reached in which case the contour line is a
     // completed closed loop.  Always adds the end point of each boundary edge
-    // to the ContourLine, regardless of whether moving to another boundary
+    // to the contour line, regardless of whether moving to another boundary
     // edge or leaving the boundary into the interior.  Never adds the start
-    // point of the first boundary edge to the ContourLine.
-    //   contour_line: ContourLine to append points to.
+    // point of the first boundary edge to the contour line.
+    //   contour: Contour whose current line points are appended to.
     //   quad_edge: on entry the QuadEdge to start from, on exit the QuadEdge
     //     that is stopped on.
     //   lower_level: lower contour z-value.
     //   upper_level: upper contour z-value.
     //   level_index: level index started on (1 = lower, 2 = upper level).
-    //   start_quad_edge: QuadEdge that the ContourLine started from, which is
-    //     used to check if the ContourLine is finished.
+    //   start_quad_edge: QuadEdge that the contour line started from, which is
+    //     used to check if the contour line is finished.
     // Returns the end level_index.
     unsigned int follow_boundary(
-        ContourLine& contour_line, QuadEdge& quad_edge, const double& lower_level,
+        Contour& contour, QuadEdge& quad_edge, const double& lower_level,
         const double& upper_level, unsigned int level_index, const QuadEdge& start_quad_edge);
 
     // Follow a contour across the interior of the domain, appending points to
-    // the ContourLine as it progresses.  Called for both line and filled
+    // the contour line as it progresses.  Called for both line and filled
     // contours.  Stops when the contour reaches a boundary or, if the
     // start_quad_edge is specified, when quad_edge == start_quad_edge and
     // level_index == start_level_index.  Always adds the end point of each
-    // quad traversed to the ContourLine; only adds the start point of the
+    // quad traversed to the contour line; only adds the start point of the
     // first quad if want_initial_point flag is true.
-    //   contour_line: ContourLine to append points to.
+    //   contour: Contour whose current line points are appended to.
     //   quad_edge: on entry the QuadEdge to start from, on exit the QuadEdge
     //     that is stopped on.
     //   level_index: level index started on (1 = lower, 2 = upper level).
     //   level: contour z-value.
     //   want_initial_point: whether want to append the initial point to the
-    //     ContourLine or not.
-    //   start_quad_edge: the QuadEdge that the ContourLine started from to
-    //     check if the ContourLine is finished, or 0 if no check should occur.
-    //   start_level_index: the level_index that the ContourLine started from.
+    //     contour line or not.
+    //   start_quad_edge: the QuadEdge that the contour line started from to
+    //     check if the contour line is finished, or 0 if no check should occur.
+    //   start_level_index: the level_index that the contour line started from.
     //   set_parents: whether should set ParentCache as it progresses or not.
     //     This is true for filled contours, false for line contours.
     void follow_interior(
-        ContourLine& contour_line, QuadEdge& quad_edge, unsigned int level_index,
+        Contour& contour, QuadEdge& quad_edge, unsigned int level_index,
         const double& level, bool want_initial_point, const QuadEdge* start_quad_edge,
         unsigned int start_level_index, bool set_parents);
 
@@ -408,8 +441,8 @@ private:
     const double& get_point_y(index_t point) const;
 
     // Append the (x,y) coordinates of the specified point index to the
-    // specified ContourLine.
-    void get_point_xy(index_t point, ContourLine& contour_line) const;
+    // current line of the specified Contour.
+    void get_point_xy(index_t point, Contour& contour) const;
 
     // Return the z-value of the specified point index.
     const double& get_point_z(index_t point) const;
@@ -427,7 +460,7 @@ private:
     // Initialise the cache to contain grid information that is constant
     // across the lifetime of this object, i.e. does not vary between calls to
     // create_contour() and create_filled_contour().
-    void init_cache_grid(const MaskArray& mask);
+    void init_cache_grid(const bool* mask);
 
     // Initialise the cache with information that is specific to contouring the
     // specified two levels.  The levels are the same for contour lines,
@@ -435,9 +468,9 @@ private:
     void init_cache_levels(const double& lower_level, const double& upper_level);
 
     // Append the (x,y) point at which the level intersects the line connecting
-    // the two specified point indices to the specified ContourLine.
+    // the two specified point indices to the current line of the Contour.
     void interp(
-        index_t point1, index_t point2, const double& level, ContourLine& contour_line) const;
+        index_t point1, index_t point2, const double& level, Contour& contour) const;
 
     // Return true if the specified QuadEdge is a boundary, i.e. is either an
     // edge between a masked and non-masked quad/corner or is a chunk boundary.
@@ -457,32 +490,41 @@ private:
         Contour& contour, index_t quad, const double& lower_level, const double& upper_level);
 
     // Start and complete a filled contour line.
-    //   quad: index of quad to start ContourLine in.
-    //   edge: edge of quad to start ContourLine from.
-    //   start_level_index: the level_index that the ContourLine starts from.
-    //   hole_or_not: whether the ContourLine is a hole or not.
-    //   boundary_or_interior: whether the ContourLine starts on a boundary or
+    //   contour: Contour to append the new line to.
+    //   quad: index of quad to start contour line in.
+    //   edge: edge of quad to start contour line from.
+    //   start_level_index: the level_index that the contour line starts from.
+    //   hole_or_not: whether the contour line is a hole or not.
+    //   boundary_or_interior: whether the contour line starts on a boundary or
     //     the interior.
     //   lower_level: lower contour z-value.
     //   upper_level: upper contour z-value.
-    // Returns newly created ContourLine.
-    ContourLine* start_filled(
-        index_t quad, Edge edge, unsigned int start_level_index, HoleOrNot hole_or_not,
-        BoundaryOrInterior boundary_or_interior, const double& lower_level,
+    void start_filled(
+        Contour& contour, index_t quad, Edge edge, unsigned int start_level_index,
+        HoleOrNot hole_or_not, BoundaryOrInterior boundary_or_interior, const double& lower_level,
         const double& upper_level);
 
+    // Write the polygons of a Contour to the specified chunk of output in the
+    // format of a ChunkCombined fill_type, in the same order as
+    // append_contour_to_vertices_and_codes.  Clears the Contour too.
+    void set_chunk_filled(index_t chunk, Contour& contour, Output& output) const;
+
+    // Write the lines of a Contour to the specified chunk of output in the
+    // format of a ChunkCombined line_type.  Clears the Contour too.
+    void set_chunk_lines(index_t chunk, Contour& contour, Output& output) const;
+
     // Start and complete a line contour that both starts and end on a
     // boundary, traversing the interior of the domain.
-    //   vertices_list: Python list that the ContourLine should be appended to.
-    //   codes_list: Python list that the kind codes should be appended to.
-    //   quad: index of quad to start ContourLine in.
-    //   edge: boundary edge to start ContourLine from.
+    //   contour: Contour to append the line to.
+    //   output: Output that the line is written to, unless it is kept in the
+    //     Contour to be written per chunk.
+    //   quad: index of quad to start contour line in.
+    //   edge: boundary edge to start contour line from.
     //   level: contour z-value.
     // Returns true if the start quad does not need to be visited again, i.e.
     // VISITED(quad,1).
     bool start_line(
-        py::list& vertices_list, py::list& codes_list, index_t quad, Edge edge,
-        const double& level);
+        Contour& contour, Output& output, index_t quad, Edge edge, const double& level);
 
     // Debug function that writes the cache status to stdout.
     void write_cache(bool grid_only = false) const;
@@ -495,11 +537,17 @@ private:
 
     // Note that mask is not stored as once it has been used to initialise the
     // cache it is no longer needed.
-    CoordinateArray _x, _y, _z;
+    const double* _x;           // Not owned.
+    const double* _y;
+    const double* _z;
     index_t _nx, _ny;           // Number of points in each direction.
     index_t _n;                 // Total number of points (and hence quads).
 
     bool _corner_mask;
+    LineType _line_type;
+    FillType _fill_type;
+    bool _lines_chunked;        // Whether line_type is one of the ChunkCombined types.
+    bool _filled_chunked;       // Whether fill_type is one of the ChunkCombined types.
     index_t _x_chunk_size;      // Number of quads per chunk (not points).
     index_t _y_chunk_size;      //   Always > 0.
 
@@ -510,6 +558,8 @@ private:
     CacheItem* _cache;
 
     ParentCache _parent_cache; // On W quad sides.
+    Contour _contour;          // Reused by each call to lines() and filled().
+    std::vector<Contour> _chunk_contours;  // Lines of each chunk if _lines_chunked.
 };
 
 } // namespace mpl2014
@@ -0,0 +1,44 @@
+#ifndef CONTOURPY_OUTPUT_H
+#define CONTOURPY_OUTPUT_H
+
+#include "common.h"
+
+// Destination of the arrays calculated by a contour generator, so that the contouring algorithms
+// do not depend on how or where the results are stored.  A call of lines() or filled() returns up
+// to 3 lists of arrays: list 0 contains points, list 1 codes or offsets and list 2 outer offsets.
+// Arrays are either appended to the lists one at a time or set per chunk, depending on the
+// line or fill type.
+//
+// An Output is locked whilst arrays are being added so that it may be used by multiple threads.
+// It satisfies BasicLockable so that std::lock_guard<Output> can be used.  The append_* and set_*
+// functions must only be called whilst it is locked.  They return a pointer to the start of an
+// uninitialised array of the requested size for the caller to write to, which remains valid until
+// the Output is destroyed or init() is called again.
+class Output
+{
+public:
+    virtual ~Output() = default;
+
+    // Called once at the start of each call of lines() or filled().  list_len is the number of
+    // chunks if arrays are set per chunk, or 0 if they are appended.
+    virtual void init(unsigned int list_count, index_t list_len) = 0;
+
+    virtual void lock() = 0;
+    virtual void unlock() = 0;
+
+    // Append arrays to the end of list 0 (points, of shape (point_count, 2)) or list 1.
+    virtual double* append_points(count_t point_count) = 0;
+    virtual uint8_t* append_codes(count_t count) = 0;
+    virtual offset_t* append_offsets(count_t count) = 0;
+
+    // Set the arrays of a particular chunk.  Outer offsets are in list 2.
+    virtual double* set_points(index_t chunk, count_t point_count) = 0;
+    virtual uint8_t* set_codes(index_t chunk, count_t count) = 0;
+    virtual offset_t* set_offsets(index_t chunk, count_t count) = 0;
+    virtual offset_t* set_outer_offsets(index_t chunk, count_t count) = 0;
+
+    // Mark a chunk as containing no contours.
+    virtual void set_empty(index_t chunk) = 0;
+};
+
+#endif // CONTOURPY_OUTPUT_H
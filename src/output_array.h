@@ -4,11 +4,11 @@
 #include "common.h"
 #include <vector>
 
-// A reusable array that is output from C++ to Python.  Depending on the chosen line or fill type,
-// it can either be created as a NumPy array that will be directly returned to the Python caller,
-// or as a C++ vector that will be further manipulated (such as split up) before being converted to
-// NumPy array(s) for returning.  BaseContourGenerator's marching does not care which form it is as
-// it just writes values to either array using an incrementing pointer.
+// A reusable array that is output from a contour generator.  Depending on the chosen line or fill
+// type, it can either be an array of an Output that will be directly returned to the caller, or a
+// C++ vector that will be further manipulated (such as split up) before being converted to the
+// returned array(s).  BaseContourGenerator's marching does not care which form it is as it just
+// writes values to either array using an incrementing pointer.
 template <typename T>
 class OutputArray
 {
@@ -32,22 +32,11 @@ public:
         start = current = vector.data();
     }
 
-    py::array_t<T> create_python(count_t new_size)
+    void create_direct(T* data, count_t new_size)
     {
-        assert(new_size > 0);
+        assert(data != nullptr && new_size > 0);
         size = new_size;
-        py::array_t<T> py_array(size);
-        start = current = py_array.mutable_data();
-        return py_array;
-    }
-
-    py::array_t<T> create_python(count_t shape0, count_t shape1)
-    {
-        assert(shape0 > 0 && shape1 > 0);
-        size = shape0*shape1;
-        py::array_t<T> py_array({shape0, shape1});
-        start = current = py_array.mutable_data();
-        return py_array;
+        start = current = data;
     }
 
     // Non-copyable and non-moveable.
@@ -59,7 +48,7 @@ public:
 
     std::vector<T> vector;
     count_t size;
-    T* start;               // Start of array, whether C++ or Python.
+    T* start;               // Start of array, whether C++ vector or direct.
     T* current;             // Where to write next value to before incrementing.
 };
 
@@ -0,0 +1,25 @@
+#ifndef CONTOURPY_PYTHON_COMMON_H
+#define CONTOURPY_PYTHON_COMMON_H
+
+#include "common.h"
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+
+namespace py = pybind11;
+
+static_assert(sizeof(index_t) == sizeof(py::ssize_t), "index_t must be the same size as ssize_t");
+
+// Input numpy array classes.
+typedef py::array_t<double, py::array::c_style | py::array::forcecast> CoordinateArray;
+typedef py::array_t<bool,   py::array::c_style | py::array::forcecast> MaskArray;
+typedef py::array_t<index_t, py::array::c_style | py::array::forcecast> TriangleArray;
+
+// Grid cache of a contour generator, used to construct generators without recalculating it.
+typedef py::array_t<uint32_t, py::array::c_style> CacheArray;
+
+// Output numpy array classes.
+typedef py::array_t<double>   PointArray;
+typedef py::array_t<uint8_t>  CodeArray;
+typedef py::array_t<offset_t> OffsetArray;
+
+#endif // CONTOURPY_PYTHON_COMMON_H
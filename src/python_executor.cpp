@@ -0,0 +1,73 @@
+#include "python_executor.h"
+#include <exception>
+#include <vector>
+
+PythonExecutor::PythonExecutor(const py::object& executor)
+    : _executor(executor)
+{
+    if (!py::hasattr(_executor, "submit"))
+        throw std::invalid_argument("executor must have a submit method");
+}
+
+PythonExecutor::~PythonExecutor()
+{
+    // May be destroyed by a thread that does not hold the GIL.
+    py::gil_scoped_acquire gil;
+    _executor = py::object();
+}
+
+py::object PythonExecutor::get_python_executor() const
+{
+    return _executor;
+}
+
+void PythonExecutor::run(index_t task_count, const std::function<void()>& task)
+{
+    std::exception_ptr exception;
+    std::vector<py::object> futures;
+
+    if (task_count > 1) {
+        py::gil_scoped_acquire gil;
+
+        // The submitted function is called by a Python thread holding the GIL, which is not needed
+        // by the task except when it creates Python objects.
+        py::cpp_function function([&task]() {
+            py::gil_scoped_release release;
+            task();
+        });
+
+        futures.reserve(task_count - 1);
+        for (index_t i = 1; i < task_count; ++i)
+            futures.push_back(_executor.attr("submit")(function));
+    }
+
+    try {
+        task();
+    }
+    catch (...) {
+        exception = std::current_exception();
+    }
+
+    if (!futures.empty()) {
+        py::gil_scoped_acquire gil;
+
+        // Copies that have not started are no longer needed.  Cancelling them rather than waiting
+        // also avoids deadlock if all of the executor's threads are busy, e.g. if this thread is
+        // one of them.  Calling result() on started copies releases the GIL while waiting and
+        // raises any Python exception that the copy raised.
+        for (auto& future : futures) {
+            try {
+                if (!future.attr("cancel")().cast<bool>())
+                    future.attr("result")();
+            }
+            catch (...) {
+                if (!exception)
+                    exception = std::current_exception();
+            }
+        }
+        futures.clear();
+    }
+
+    if (exception)
+        std::rethrow_exception(exception);
+}
@@ -0,0 +1,25 @@
+#ifndef CONTOURPY_PYTHON_EXECUTOR_H
+#define CONTOURPY_PYTHON_EXECUTOR_H
+
+#include "executor.h"
+#include "python_common.h"
+
+// Executor that runs tasks using a Python object with the same interface as a
+// concurrent.futures.Executor, i.e. a submit(fn) method that returns a Future-like object with
+// cancel() and result() methods.
+class PythonExecutor : public Executor
+{
+public:
+    explicit PythonExecutor(const py::object& executor);
+
+    ~PythonExecutor();
+
+    py::object get_python_executor() const;
+
+    void run(index_t task_count, const std::function<void()>& task) override;
+
+private:
+    py::object _executor;
+};
+
+#endif // CONTOURPY_PYTHON_EXECUTOR_H
@@ -0,0 +1,249 @@
+#include "python_generator.h"
+#include <algorithm>
+#include <stdexcept>
+
+static py::dict perf_counts_to_python(const PerfCounts& counts)
+{
+    py::dict ret;
+    ret["cycles"] = counts.cycles;
+    ret["instructions"] = counts.instructions;
+    ret["cache_misses"] = counts.cache_misses;
+    ret["branch_misses"] = counts.branch_misses;
+    return ret;
+}
+
+py::object call_stats_to_python(const CallStats* stats)
+{
+    if (stats == nullptr)
+        return py::none();
+
+    count_t quads = 0, starts = 0, points = 0, lines = 0, holes = 0;
+    std::size_t bytes = 0;
+    index_t n_chunks = static_cast<index_t>(stats->chunks.size());
+    py::array_t<double> chunk_times(n_chunks);
+    auto chunk_time = chunk_times.mutable_data();
+    for (auto& chunk : stats->chunks) {
+        quads += chunk.quads;
+        starts += chunk.starts;
+        points += chunk.points;
+        lines += chunk.lines;
+        holes += chunk.holes;
+        bytes += chunk.bytes;
+        *chunk_time++ = chunk.init_time + chunk.trace_time + chunk.export_time;
+    }
+
+    py::dict ret;
+    ret["total_time"] = stats->total_time;
+    ret["init_time"] = stats->init_time;
+    ret["trace_time"] = stats->trace_time;
+    ret["export_time"] = stats->export_time;
+    ret["lock_wait_time"] = stats->lock_wait_time;
+    ret["chunk_times"] = chunk_times;
+    ret["quads_visited"] = quads;
+    ret["starts"] = starts;
+    ret["points"] = points;
+    ret["lines"] = lines;
+    ret["holes"] = holes;
+    ret["bytes_allocated"] = bytes;
+
+    if (stats->perf_counters) {
+        py::dict counters;
+        counters["init"] = perf_counts_to_python(stats->init_counts);
+        counters["trace"] = perf_counts_to_python(stats->trace_counts);
+        counters["export"] = perf_counts_to_python(stats->export_counts);
+        ret["counters"] = counters;
+    }
+    else
+        ret["counters"] = py::none();
+    return ret;
+}
+
+PythonGrid::PythonGrid(
+    const CoordinateArray& x, const CoordinateArray& y, const CoordinateArray& z,
+    const MaskArray& mask)
+    : _x(x),
+      _y(y),
+      _z(z),
+      _mask(mask)
+{
+    if (_x.ndim() != 2 || _y.ndim() != 2 || _z.ndim() != 2)
+        throw std::invalid_argument("x, y and z must all be 2D arrays");
+
+    if (_x.shape(1) != nx() || _x.shape(0) != ny() ||
+        _y.shape(1) != nx() || _y.shape(0) != ny())
+        throw std::invalid_argument("x, y and z arrays must have the same shape");
+
+    if (_mask.ndim() != 0) {  // ndim == 0 if mask is not set, which is valid.
+        if (_mask.ndim() != 2)
+            throw std::invalid_argument("mask array must be a 2D array");
+
+        if (_mask.shape(1) != nx() || _mask.shape(0) != ny())
+            throw std::invalid_argument(
+                "If mask is set it must be a 2D array with the same shape as z");
+    }
+}
+
+const uint32_t* PythonGrid::convert(const CacheArray& grid_cache)
+{
+    if (grid_cache.ndim() != 2 || grid_cache.shape(1) != nx() || grid_cache.shape(0) != ny())
+        throw std::invalid_argument("grid_cache must be a 2D array with the same shape as z");
+
+    _grid_cache = grid_cache;
+    return _grid_cache.data();
+}
+
+std::vector<const double*> PythonGrid::get_fields(const CoordinateArray& zs) const
+{
+    if (zs.ndim() != 3 || zs.shape(2) != nx() || zs.shape(1) != ny())
+        throw std::invalid_argument(
+            "z fields must be a 3D array of shape (n_fields, ny, nx) where (ny, nx) is the "
+            "shape of z");
+
+    auto n = nx()*ny();
+    std::vector<const double*> fields;
+    for (index_t field = 0; field < zs.shape(0); ++field)
+        fields.push_back(zs.data() + field*n);
+    return fields;
+}
+
+py::tuple PythonGrid::get_grid(const uint32_t* grid_cache) const
+{
+    index_t shape[2] = {ny(), nx()};
+    CacheArray grid_cache_copy(shape);
+    std::copy(grid_cache, grid_cache + nx()*ny(), grid_cache_copy.mutable_data());
+    return py::make_tuple(_x, _y, _z, grid_cache_copy);
+}
+
+py::object PythonGrid::get_mask() const
+{
+    if (_mask.ndim() == 0)
+        return py::none();
+    return _mask;
+}
+
+index_t PythonGrid::get_level_count(const CoordinateArray& levels)
+{
+    if (levels.ndim() != 1)
+        throw std::invalid_argument("levels must be a 1D array");
+
+    return static_cast<index_t>(levels.shape(0));
+}
+
+const bool* PythonGrid::mask() const
+{
+    return _mask.ndim() == 0 ? nullptr : _mask.data();
+}
+
+index_t PythonGrid::nx() const
+{
+    return _z.shape(1);
+}
+
+index_t PythonGrid::ny() const
+{
+    return _z.shape(0);
+}
+
+const double* PythonGrid::x() const
+{
+    return _x.data();
+}
+
+const double* PythonGrid::y() const
+{
+    return _y.data();
+}
+
+const double* PythonGrid::z() const
+{
+    return _z.data();
+}
+
+PythonTriMesh::PythonTriMesh(
+    const CoordinateArray& x, const CoordinateArray& y, const TriangleArray& triangles,
+    const CoordinateArray& z, const MaskArray& mask)
+    : _x(x),
+      _y(y),
+      _triangles(triangles),
+      _z(z),
+      _mask(mask)
+{
+    if (_x.ndim() != 1 || _y.ndim() != 1 || _z.ndim() != 1 ||
+        _x.shape(0) != point_count() || _y.shape(0) != point_count())
+        throw std::invalid_argument("x, y and z must all be 1D arrays of the same length");
+
+    if (_triangles.ndim() != 2 || _triangles.shape(1) != 3)
+        throw std::invalid_argument("triangles must be a 2D array of shape (n_triangles, 3)");
+
+    if (_mask.ndim() != 0) {  // ndim == 0 if mask is not set, which is valid.
+        if (_mask.ndim() != 1 || _mask.shape(0) != triangle_count())
+            throw std::invalid_argument(
+                "If mask is set it must be a 1D array with the same length as triangles");
+    }
+}
+
+const bool* PythonTriMesh::mask() const
+{
+    return _mask.ndim() == 0 ? nullptr : _mask.data();
+}
+
+index_t PythonTriMesh::point_count() const
+{
+    return _z.shape(0);
+}
+
+index_t PythonTriMesh::triangle_count() const
+{
+    return _triangles.shape(0);
+}
+
+const index_t* PythonTriMesh::triangles() const
+{
+    return _triangles.data();
+}
+
+const double* PythonTriMesh::x() const
+{
+    return _x.data();
+}
+
+const double* PythonTriMesh::y() const
+{
+    return _y.data();
+}
+
+const double* PythonTriMesh::z() const
+{
+    return _z.data();
+}
+
+PythonTriContourGenerator::PythonTriContourGenerator(
+    const CoordinateArray& x, const CoordinateArray& y, const TriangleArray& triangles,
+    const CoordinateArray& z, const MaskArray& mask, LineType line_type, FillType fill_type,
+    ZInterp z_interp, index_t n_chunks, index_t n_threads)
+    : PythonTriMesh(x, y, triangles, z, mask),
+      TriContourGenerator(
+          PythonTriMesh::x(), PythonTriMesh::y(), point_count(), PythonTriMesh::triangles(),
+          triangle_count(), PythonTriMesh::z(), PythonTriMesh::mask(), line_type, fill_type,
+          z_interp, n_chunks, n_threads)
+{}
+
+py::sequence PythonTriContourGenerator::filled(double lower_level, double upper_level)
+{
+    PythonOutput output;
+    {
+        py::gil_scoped_release release;
+        TriContourGenerator::filled(lower_level, upper_level, output);
+    }
+    return output.result();
+}
+
+py::sequence PythonTriContourGenerator::lines(double level)
+{
+    PythonOutput output;
+    {
+        py::gil_scoped_release release;
+        TriContourGenerator::lines(level, output);
+    }
+    return output.result();
+}
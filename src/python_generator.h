@@ -0,0 +1,262 @@
+// PythonGenerator class wraps a contour generator of the Python-free core library so that it can
+// be used from Python.  It owns the NumPy arrays that the core generator reads from, releases the
+// GIL whilst contouring and returns the results as NumPy arrays.  Python classes are declared as
+//     typedef PythonGenerator<Generator> PyGenerator;
+// and the constructor arguments are x, y, z and mask followed by the arguments of the Generator
+// constructor after the grid, with a CacheArray in place of a grid cache pointer.
+
+#ifndef CONTOURPY_PYTHON_GENERATOR_H
+#define CONTOURPY_PYTHON_GENERATOR_H
+
+#include "call_stats.h"
+#include "python_common.h"
+#include "python_output.h"
+#include "tri.h"
+#include "z_interp.h"
+#include <memory>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+// Return the stats of a call as a dict, or None if stats is nullptr.
+py::object call_stats_to_python(const CallStats* stats);
+
+// Arrays of a grid that are passed to a PythonGenerator, checked to be of the correct shapes.
+class PythonGrid
+{
+public:
+    PythonGrid(
+        const CoordinateArray& x, const CoordinateArray& y, const CoordinateArray& z,
+        const MaskArray& mask);
+
+    // Return pointers to the z arrays of a stack of fields of shape (n_fields, ny, nx).  Their
+    // values are checked by the Generator.
+    std::vector<const double*> get_fields(const CoordinateArray& zs) const;
+
+    // Return the number of levels in a 1D array of levels.
+    static index_t get_level_count(const CoordinateArray& levels);
+
+    // Return (x, y, z, grid_cache) where grid_cache is a copy of the specified grid cache.
+    py::tuple get_grid(const uint32_t* grid_cache) const;
+
+    // Return the mask array, or None if there is no mask.
+    py::object get_mask() const;
+
+protected:
+    const double* x() const;
+    const double* y() const;
+    const double* z() const;
+    const bool* mask() const;  // nullptr if no mask.
+    index_t nx() const;
+    index_t ny() const;
+
+    // Convert a constructor argument for the Generator.  A grid cache is checked and stored.
+    template <typename T>
+    T convert(T arg)
+    {
+        return arg;
+    }
+
+    const uint32_t* convert(const CacheArray& grid_cache);
+
+private:
+    const CoordinateArray _x, _y, _z;
+    const MaskArray _mask;
+    CacheArray _grid_cache;  // Only if supplied to constructor.
+};
+
+template <typename Generator>
+class PythonGenerator : private PythonGrid, public Generator
+{
+public:
+    template <typename... Args>
+    PythonGenerator(
+        const CoordinateArray& x, const CoordinateArray& y, const CoordinateArray& z,
+        const MaskArray& mask, Args... args)
+        : PythonGrid(x, y, z, mask),
+          Generator(PythonGrid::x(), PythonGrid::y(), PythonGrid::z(), PythonGrid::mask(),
+                    PythonGrid::nx(), PythonGrid::ny(), PythonGrid::convert(args)...)
+    {}
+
+    py::sequence filled(double lower_level, double upper_level)
+    {
+        PythonOutput output;
+        {
+            py::gil_scoped_release release;
+            Generator::filled(lower_level, upper_level, output);
+        }
+        return output.result();
+    }
+
+    // Return list of the filled contours of each of a stack of fields that share the grid.
+    py::list filled_fields(const CoordinateArray& zs, double lower_level, double upper_level)
+    {
+        auto fields = PythonGrid::get_fields(zs);
+        FieldOutputs outputs(fields.size());
+        {
+            py::gil_scoped_release release;
+            Generator::filled_fields(
+                lower_level, upper_level, fields.data(), static_cast<index_t>(fields.size()),
+                outputs.pointers.data());
+        }
+        return outputs.result();
+    }
+
+    // Return list of the filled contours between each pair of consecutive levels.
+    py::list filled_levels(const CoordinateArray& levels)
+    {
+        auto n_levels = PythonGrid::get_level_count(levels);
+        FieldOutputs outputs(static_cast<std::size_t>(n_levels > 1 ? n_levels - 1 : 0));
+        {
+            py::gil_scoped_release release;
+            Generator::filled_levels(levels.data(), n_levels, outputs.pointers.data());
+        }
+        return outputs.result();
+    }
+
+    py::tuple get_chunk_count() const  // Return (y_chunk_count, x_chunk_count)
+    {
+        return as_tuple(Generator::get_chunk_count());
+    }
+
+    py::tuple get_chunk_size() const  // Return (y_chunk_size, x_chunk_size)
+    {
+        return as_tuple(Generator::get_chunk_size());
+    }
+
+    // Return (x, y, z, grid_cache) arrays which, together with the other properties, are all that
+    // is needed to construct an identical generator.  grid_cache is a copy.
+    py::tuple get_grid() const
+    {
+        return PythonGrid::get_grid(Generator::get_grid_cache());
+    }
+
+    // Return the mask array, or None if there is no mask.
+    py::object get_mask() const
+    {
+        return PythonGrid::get_mask();
+    }
+
+    // Return dict of the stats of the most recent call that collected them, or None.
+    py::object get_last_call_stats() const
+    {
+        return call_stats_to_python(Generator::get_last_call_stats().get());
+    }
+
+    // Return the events of the most recent call that collected stats as a Chrome trace JSON
+    // string, or None.
+    py::object get_last_call_trace() const
+    {
+        auto stats = Generator::get_last_call_stats();
+        if (!stats)
+            return py::none();
+
+        std::ostringstream os;
+        stats->write_chrome_trace(os);
+        return py::str(os.str());
+    }
+
+    py::sequence lines(double level)
+    {
+        PythonOutput output;
+        {
+            py::gil_scoped_release release;
+            Generator::lines(level, output);
+        }
+        return output.result();
+    }
+
+    // Return list of the contour lines of each of a stack of fields that share the grid.
+    py::list lines_fields(const CoordinateArray& zs, double level)
+    {
+        auto fields = PythonGrid::get_fields(zs);
+        FieldOutputs outputs(fields.size());
+        {
+            py::gil_scoped_release release;
+            Generator::lines_fields(
+                level, fields.data(), static_cast<index_t>(fields.size()),
+                outputs.pointers.data());
+        }
+        return outputs.result();
+    }
+
+    // Return list of the contour lines at each level.
+    py::list lines_levels(const CoordinateArray& levels)
+    {
+        auto n_levels = PythonGrid::get_level_count(levels);
+        FieldOutputs outputs(static_cast<std::size_t>(n_levels));
+        {
+            py::gil_scoped_release release;
+            Generator::lines_levels(levels.data(), n_levels, outputs.pointers.data());
+        }
+        return outputs.result();
+    }
+
+private:
+    // PythonOutput of each field or level.
+    struct FieldOutputs
+    {
+        explicit FieldOutputs(std::size_t n_fields)
+        {
+            for (std::size_t field = 0; field < n_fields; ++field) {
+                outputs.emplace_back(new PythonOutput());
+                pointers.push_back(outputs.back().get());
+            }
+        }
+
+        py::list result() const
+        {
+            py::list ret;
+            for (auto& output : outputs)
+                ret.append(output->result());
+            return ret;
+        }
+
+        std::vector<std::unique_ptr<PythonOutput>> outputs;
+        std::vector<Output*> pointers;
+    };
+
+    static py::tuple as_tuple(const std::pair<index_t, index_t>& pair)
+    {
+        return py::make_tuple(pair.first, pair.second);
+    }
+};
+
+// Arrays of a triangular mesh that are passed to a PythonTriContourGenerator, checked to be of the
+// correct shapes.
+class PythonTriMesh
+{
+public:
+    PythonTriMesh(
+        const CoordinateArray& x, const CoordinateArray& y, const TriangleArray& triangles,
+        const CoordinateArray& z, const MaskArray& mask);
+
+protected:
+    const double* x() const;
+    const double* y() const;
+    const double* z() const;
+    const index_t* triangles() const;
+    const bool* mask() const;  // nullptr if no mask.
+    index_t point_count() const;
+    index_t triangle_count() const;
+
+private:
+    const CoordinateArray _x, _y;
+    const TriangleArray _triangles;
+    const CoordinateArray _z;
+    const MaskArray _mask;
+};
+
+class PythonTriContourGenerator : private PythonTriMesh, public TriContourGenerator
+{
+public:
+    PythonTriContourGenerator(
+        const CoordinateArray& x, const CoordinateArray& y, const TriangleArray& triangles,
+        const CoordinateArray& z, const MaskArray& mask, LineType line_type, FillType fill_type,
+        ZInterp z_interp, index_t n_chunks, index_t n_threads);
+
+    py::sequence filled(double lower_level, double upper_level);
+    py::sequence lines(double level);
+};
+
+#endif // CONTOURPY_PYTHON_GENERATOR_H
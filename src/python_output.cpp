@@ -0,0 +1,95 @@
+#include "python_output.h"
+
+template <typename T>
+T* PythonOutput::append(unsigned int list, count_t count)
+{
+    py::array_t<T> array(count);
+    _lists[list].append(array);
+    return array.mutable_data();
+}
+
+uint8_t* PythonOutput::append_codes(count_t count)
+{
+    return append<uint8_t>(1, count);
+}
+
+offset_t* PythonOutput::append_offsets(count_t count)
+{
+    return append<offset_t>(1, count);
+}
+
+double* PythonOutput::append_points(count_t point_count)
+{
+    PointArray points({point_count, count_t(2)});
+    _lists[0].append(points);
+    return points.mutable_data();
+}
+
+void PythonOutput::init(unsigned int list_count, index_t list_len)
+{
+    py::gil_scoped_acquire gil;
+    _lists.clear();
+    _lists.reserve(list_count);
+    for (decltype(list_count) i = 0; i < list_count; ++i)
+        _lists.emplace_back(list_len);
+}
+
+void PythonOutput::lock()
+{
+    _mutex.lock();
+    _gil.reset(new py::gil_scoped_acquire());
+}
+
+py::sequence PythonOutput::result() const
+{
+    if (_lists.size() == 1)
+        return _lists[0];
+    else if (_lists.size() == 2)
+        return py::make_tuple(_lists[0], _lists[1]);
+    else {
+        assert(_lists.size() == 3);
+        return py::make_tuple(_lists[0], _lists[1], _lists[2]);
+    }
+}
+
+template <typename T>
+T* PythonOutput::set(unsigned int list, index_t chunk, count_t count)
+{
+    py::array_t<T> array(count);
+    _lists[list][chunk] = array;
+    return array.mutable_data();
+}
+
+uint8_t* PythonOutput::set_codes(index_t chunk, count_t count)
+{
+    return set<uint8_t>(1, chunk, count);
+}
+
+void PythonOutput::set_empty(index_t chunk)
+{
+    for (auto& list : _lists)
+        list[chunk] = py::none();
+}
+
+offset_t* PythonOutput::set_offsets(index_t chunk, count_t count)
+{
+    return set<offset_t>(1, chunk, count);
+}
+
+offset_t* PythonOutput::set_outer_offsets(index_t chunk, count_t count)
+{
+    return set<offset_t>(2, chunk, count);
+}
+
+double* PythonOutput::set_points(index_t chunk, count_t point_count)
+{
+    PointArray points({point_count, count_t(2)});
+    _lists[0][chunk] = points;
+    return points.mutable_data();
+}
+
+void PythonOutput::unlock()
+{
+    _gil.reset();
+    _mutex.unlock();
+}
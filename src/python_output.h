@@ -0,0 +1,50 @@
+#ifndef CONTOURPY_PYTHON_OUTPUT_H
+#define CONTOURPY_PYTHON_OUTPUT_H
+
+#include "output.h"
+#include "python_common.h"
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Output that creates NumPy arrays in Python lists to return to the Python caller.  Contouring
+// runs with the GIL released, so lock() acquires it.  The mutex is locked before the GIL is
+// acquired so that threads waiting for their turn do not block the GIL.  An empty chunk is None.
+class PythonOutput : public Output
+{
+public:
+    PythonOutput() = default;
+
+    // Acquires the GIL as it is called whilst contouring.
+    void init(unsigned int list_count, index_t list_len) override;
+
+    void lock() override;
+    void unlock() override;
+
+    double* append_points(count_t point_count) override;
+    uint8_t* append_codes(count_t count) override;
+    offset_t* append_offsets(count_t count) override;
+
+    double* set_points(index_t chunk, count_t point_count) override;
+    uint8_t* set_codes(index_t chunk, count_t count) override;
+    offset_t* set_offsets(index_t chunk, count_t count) override;
+    offset_t* set_outer_offsets(index_t chunk, count_t count) override;
+
+    void set_empty(index_t chunk) override;
+
+    // Return a single list or a tuple of lists.  Must be called with the GIL held.
+    py::sequence result() const;
+
+private:
+    template <typename T>
+    T* append(unsigned int list, count_t count);
+
+    template <typename T>
+    T* set(unsigned int list, index_t chunk, count_t count);
+
+    std::vector<py::list> _lists;
+    std::mutex _mutex;
+    std::unique_ptr<py::gil_scoped_acquire> _gil;  // Only whilst locked.
+};
+
+#endif // CONTOURPY_PYTHON_OUTPUT_H
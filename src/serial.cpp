@@ -2,14 +2,18 @@
 #include "serial.h"
 
 SerialContourGenerator::SerialContourGenerator(
-    const CoordinateArray& x, const CoordinateArray& y, const CoordinateArray& z,
-    const MaskArray& mask, bool corner_mask, LineType line_type, FillType fill_type,
-    bool quad_as_tri, ZInterp z_interp, index_t x_chunk_size, index_t y_chunk_size)
-    : BaseContourGenerator(x, y, z, mask, corner_mask, line_type, fill_type, quad_as_tri, z_interp,
-                           x_chunk_size, y_chunk_size)
+    const double* x, const double* y, const double* z, const bool* mask, index_t nx,
+    index_t ny, bool corner_mask, LineType line_type, FillType fill_type, bool quad_as_tri,
+    ZInterp z_interp, index_t x_chunk_size, index_t y_chunk_size, const uint32_t* grid_cache)
+    : BaseContourGenerator(x, y, z, mask, nx, ny, corner_mask, line_type, fill_type, quad_as_tri,
+                           z_interp, x_chunk_size, y_chunk_size, grid_cache)
 {}
 
-void SerialContourGenerator::march(std::vector<py::list>& return_lists)
+SerialContourGenerator::SerialContourGenerator(const SerialContourGenerator* generator)
+    : BaseContourGenerator(generator)
+{}
+
+void SerialContourGenerator::march(Output& output)
 {
     // Stage 1: Initialise cache z-levels and starting locations for whole domain.
     init_cache_levels_and_starts();
@@ -19,7 +23,35 @@ void SerialContourGenerator::march(std::vector<py::list>& return_lists)
     ChunkLocal local;
     for (index_t chunk = 0; chunk < n_chunks; ++chunk) {
         get_chunk_limits(chunk, local);
-        march_chunk(local, return_lists);
+        march_chunk(local, output);
+        local.clear();
+    }
+}
+
+void SerialContourGenerator::march_fields(
+    const std::vector<SerialContourGenerator*>& fields, Output* const* outputs)
+{
+    auto n_chunks = get_n_chunks();
+    ChunkLocal local;
+
+    // Stage 1: Initialise cache z-levels and starting locations of each chunk for all fields.
+    for (index_t chunk = 0; chunk < n_chunks; ++chunk) {
+        get_chunk_limits(chunk, local);
+        for (auto field : fields)
+            field->init_cache_levels_and_starts(&local);
         local.clear();
     }
+
+    // Stage 2: Trace contours of each chunk for all fields.
+    for (index_t chunk = 0; chunk < n_chunks; ++chunk) {
+        for (std::size_t field = 0; field < fields.size(); ++field) {
+            get_chunk_limits(chunk, local);
+            fields[field]->march_chunk(local, *outputs[field]);
+            local.clear();
+        }
+    }
 }
+
+// Explicit instantiation so that the base class does not need to be instantiated by users of the
+// generator.
+template class BaseContourGenerator<SerialContourGenerator>;
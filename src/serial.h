@@ -6,28 +6,24 @@
 class SerialContourGenerator : public BaseContourGenerator<SerialContourGenerator>
 {
 public:
+    // If grid_cache is specified it is the grid cache of an identical generator, which is used
+    // rather than recalculating it.
     SerialContourGenerator(
-        const CoordinateArray& x, const CoordinateArray& y, const CoordinateArray& z,
-        const MaskArray& mask, bool corner_mask, LineType line_type, FillType fill_type,
-        bool quad_as_tri, ZInterp z_interp, index_t x_chunk_size, index_t y_chunk_size);
+        const double* x, const double* y, const double* z, const bool* mask, index_t nx,
+        index_t ny, bool corner_mask, LineType line_type, FillType fill_type, bool quad_as_tri,
+        ZInterp z_interp, index_t x_chunk_size, index_t y_chunk_size,
+        const uint32_t* grid_cache = nullptr);
 
 private:
     friend class BaseContourGenerator<SerialContourGenerator>;
 
-    // Dummy Lock class which is the single-threaded version of ThreadedContourGenerator::Lock and
-    // does not do anything, allowing base class code to use Lock objects for both serial and
-    // multithreaded code.
-    class Lock
-    {
-    public:
-        explicit Lock(SerialContourGenerator& contour_generator)
-        {}
+    // Construct a per-call context of generator.
+    explicit SerialContourGenerator(const SerialContourGenerator* generator);
 
-        void unlock()
-        {}
-    };
+    void march(Output& output);
 
-    void march(std::vector<py::list>& return_lists);
+    // March multiple fields, each in its own per-call context, chunk by chunk.
+    void march_fields(const std::vector<SerialContourGenerator*>& fields, Output* const* outputs);
 };
 
 #endif // CONTOURPY_SERIAL_H
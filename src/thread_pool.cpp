@@ -0,0 +1,122 @@
+#include "thread_pool.h"
+#include "util.h"
+#include <algorithm>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+ThreadPool::Group::Group(const std::function<void()>& task_, index_t unstarted_)
+    : task(task_),
+      unstarted(unstarted_),
+      running(0)
+{}
+
+ThreadPool::ThreadPool(index_t thread_count)
+#ifndef _WIN32
+    : _pid(getpid())
+#endif
+{
+    _threads.reserve(thread_count);
+    for (index_t i = 0; i < thread_count; ++i)
+        _threads.emplace_back(&ThreadPool::worker_function, this);
+}
+
+ThreadPool& ThreadPool::get_shared()
+{
+    // The pool is never deleted.  At process exit its worker threads are waiting for work and are
+    // terminated with the process, whereas joining them from a static destructor can deadlock on
+    // some platforms.
+    static std::mutex mutex;
+    static ThreadPool* pool = nullptr;
+
+    std::lock_guard<std::mutex> guard(mutex);
+
+#ifndef _WIN32
+    // A child process created by fork() has a copy of the pool but not its threads, so needs a new
+    // pool.  The old one is leaked as its mutex may have been locked at the time of the fork.
+    if (pool != nullptr && pool->_pid != getpid())
+        pool = nullptr;
+#endif
+
+    if (pool == nullptr) {
+        // The calling thread of run() also executes a task, so one fewer worker thread is needed.
+        pool = new ThreadPool(std::max<index_t>(Util::get_max_threads() - 1, 0));
+    }
+
+    return *pool;
+}
+
+index_t ThreadPool::get_thread_count() const
+{
+    return static_cast<index_t>(_threads.size());
+}
+
+void ThreadPool::run(index_t task_count, const std::function<void()>& task)
+{
+    Group group(task, _threads.empty() ? 0 : std::max<index_t>(task_count - 1, 0));
+
+    if (group.unstarted > 0) {
+        std::lock_guard<std::mutex> guard(_mutex);
+        _queue.push_back(&group);
+        if (group.unstarted == 1)
+            _work_available.notify_one();
+        else
+            _work_available.notify_all();
+    }
+
+    std::exception_ptr exception;
+    try {
+        task();
+    }
+    catch (...) {
+        exception = std::current_exception();
+    }
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (group.unstarted > 0) {
+        // All of the group's work has been taken so unstarted tasks are no longer needed.
+        _queue.erase(std::find(_queue.begin(), _queue.end(), &group));
+        group.unstarted = 0;
+    }
+    group.finished.wait(lock, [&group] { return group.running == 0; });
+
+    if (!exception)
+        exception = group.exception;
+    lock.unlock();
+
+    if (exception)
+        std::rethrow_exception(exception);
+}
+
+void ThreadPool::worker_function()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true) {
+        _work_available.wait(lock, [this] { return !_queue.empty(); });
+
+        // Take a task from the group at the front of the queue and, if it has more tasks, move it to
+        // the back so that other groups are served first.
+        auto group = _queue.front();
+        _queue.pop_front();
+        if (--group->unstarted > 0)
+            _queue.push_back(group);
+        ++group->running;
+        lock.unlock();
+
+        std::exception_ptr exception;
+        try {
+            group->task();
+        }
+        catch (...) {
+            exception = std::current_exception();
+        }
+
+        lock.lock();
+        if (exception && !group->exception)
+            group->exception = exception;
+        // Notify with the lock held as the group may be destroyed as soon as it is released.
+        if (--group->running == 0)
+            group->finished.notify_one();
+    }
+}
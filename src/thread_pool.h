@@ -0,0 +1,58 @@
+#ifndef CONTOURPY_THREAD_POOL_H
+#define CONTOURPY_THREAD_POOL_H
+
+#include "executor.h"
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Pool of worker threads shared by all ThreadedContourGenerators in a process, so that the total
+// number of threads is capped regardless of how many generators are contouring at the same time.
+// This is the default Executor.
+//
+// Idle worker threads take tasks from the front of a queue of groups and then move that group to
+// the back of the queue, so that concurrent calls share the worker threads fairly.
+class ThreadPool : public Executor
+{
+public:
+    // Process-wide shared thread pool, created on first use.
+    static ThreadPool& get_shared();
+
+    // Number of worker threads.  The thread calling run() also executes a task, so up to one more
+    // than this number of tasks from the same group can run concurrently.
+    index_t get_thread_count() const;
+
+    // Copies that have not been started by a worker thread by the time that the calling thread's
+    // copy has finished are not run at all.
+    void run(index_t task_count, const std::function<void()>& task) override;
+
+private:
+    // A single call to run().
+    struct Group
+    {
+        explicit Group(const std::function<void()>& task, index_t unstarted);
+
+        const std::function<void()>& task;
+        index_t unstarted;   // Number of tasks not yet started by a worker thread.
+        index_t running;     // Number of tasks being run by worker threads.
+        std::exception_ptr exception;
+        std::condition_variable finished;  // Notified when running drops to zero.
+    };
+
+    explicit ThreadPool(index_t thread_count);
+
+    void worker_function();
+
+    std::vector<std::thread> _threads;
+    std::deque<Group*> _queue;         // Groups with unstarted tasks in the order they are served.
+    std::mutex _mutex;                 // Locks access to _queue and the contents of all Groups.
+    std::condition_variable _work_available;
+#ifndef _WIN32
+    int _pid;                          // Process that created the pool.
+#endif
+};
+
+#endif // CONTOURPY_THREAD_POOL_H
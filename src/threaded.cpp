@@ -1,19 +1,25 @@
 #include "base_impl.h"
+#include "executor.h"
 #include "threaded.h"
 #include "util.h"
-#include <thread>
 
 ThreadedContourGenerator::ThreadedContourGenerator(
-    const CoordinateArray& x, const CoordinateArray& y, const CoordinateArray& z,
-    const MaskArray& mask, bool corner_mask, LineType line_type, FillType fill_type,
-    bool quad_as_tri, ZInterp z_interp, index_t x_chunk_size, index_t y_chunk_size,
-    index_t n_threads)
-    : BaseContourGenerator(x, y, z, mask, corner_mask, line_type, fill_type, quad_as_tri, z_interp,
-                           x_chunk_size, y_chunk_size),
+    const double* x, const double* y, const double* z, const bool* mask, index_t nx,
+    index_t ny, bool corner_mask, LineType line_type, FillType fill_type, bool quad_as_tri,
+    ZInterp z_interp, index_t x_chunk_size, index_t y_chunk_size, index_t n_threads,
+    const uint32_t* grid_cache)
+    : BaseContourGenerator(x, y, z, mask, nx, ny, corner_mask, line_type, fill_type, quad_as_tri,
+                           z_interp, x_chunk_size, y_chunk_size, grid_cache),
       _n_threads(limit_n_threads(n_threads, get_n_chunks())),
       _next_chunk(0)
 {}
 
+ThreadedContourGenerator::ThreadedContourGenerator(const ThreadedContourGenerator* generator)
+    : BaseContourGenerator(generator),
+      _n_threads(generator->_n_threads),
+      _next_chunk(0)
+{}
+
 index_t ThreadedContourGenerator::get_thread_count() const
 {
     return _n_threads;
@@ -28,45 +34,48 @@ index_t ThreadedContourGenerator::limit_n_threads(index_t n_threads, index_t n_c
         return std::min({max_threads, n_chunks, n_threads});
 }
 
-void ThreadedContourGenerator::march(std::vector<py::list>& return_lists)
+void ThreadedContourGenerator::march(Output& output)
+{
+    Output* outputs[] = {&output};
+    march_fields({this}, outputs);
+}
+
+void ThreadedContourGenerator::march_fields(
+    const std::vector<ThreadedContourGenerator*>& fields, Output* const* outputs)
 {
-    // Each thread executes thread_function() which has two stages:
+    // Contouring is performed in two stages:
     //   1) Initialise cache z-levels and starting locations
     //   2) Trace contours
-    // Each stage is performed on a chunk by chunk basis.  There is a barrier between the two stages
-    // to synchronise the threads so the cache setup is complete before being used by the trace.
-    _next_chunk = 0;      // Next available chunk index.
-    _finished_count = 0;  // Count of threads that have finished the cache init.
-
-    // Create (_n_threads-1) new worker threads.
-    std::vector<std::thread> threads;
-    threads.reserve(_n_threads);
-    for (index_t i = 0; i < _n_threads-1; ++i)
-        threads.emplace_back(
-            &ThreadedContourGenerator::thread_function, this, std::ref(return_lists));
-
-    thread_function(std::ref(return_lists));  // Main thread work.
-
-    for (auto& thread : threads)
-        thread.join();
-    assert(_next_chunk == 2*get_n_chunks());
-    threads.clear();
+    // Each stage is performed on a chunk by chunk basis by up to _n_threads copies of a task that
+    // are executed by this thread and the threads of the default Executor, which is the shared
+    // thread pool unless replaced by the host application.  The first stage must be complete
+    // before the second starts so that the cache setup is complete before being used by the trace.
+    // Each chunk task processes all of the fields so that the chunk's grid is reused by each field.
+    auto n_chunks = get_n_chunks();
+    _next_chunk = 0;  // Next available chunk index.
+    _chunk_owner.assign(n_chunks, std::thread::id());
+    _chunk_claimed.assign(n_chunks, false);
+    _steal_chunk = n_chunks - 1;
+
+    auto executor = Executor::get_default();
+
+    executor->run(_n_threads, [this, &fields]() { init_task(fields); });
+    assert(_next_chunk == n_chunks);
+
+    executor->run(_n_threads, [this, &fields, outputs]() { trace_task(fields, outputs); });
+    assert(_steal_chunk == -1);
 }
 
-void ThreadedContourGenerator::thread_function(std::vector<py::list>& return_lists)
+void ThreadedContourGenerator::init_task(const std::vector<ThreadedContourGenerator*>& fields)
 {
-    // Function that is executed by each of the threads.
-    // _next_chunk starts at zero and increases up to 2*_n_chunks.  A thread in need of work reads
-    // _next_chunk and incremements it, then processes that chunk.  For _next_chunk < _n_chunks this
-    // is stage 1 (init cache levels and starting locations) and for _next_chunk >= _n_chunks this
-    // is stage 2 (trace contours).  There is a synchronisation barrier between the two stages so
-    // that the cache initialisation is complete before being used by the contour trace.
+    // _next_chunk starts at zero and increases up to _n_chunks.  A thread in need of work reads
+    // _next_chunk and increments it, then processes that chunk.
 
     auto n_chunks = get_n_chunks();
+    auto thread_id = std::this_thread::get_id();
     index_t chunk;
     ChunkLocal local;
 
-    // Stage 1: Initialise cache z-levels and starting locations.
     while (true) {
         {
             std::lock_guard<std::mutex> guard(_chunk_mutex);
@@ -77,33 +86,58 @@ void ThreadedContourGenerator::thread_function(std::vector<py::list>& return_lis
         }
 
         get_chunk_limits(chunk, local);
-        init_cache_levels_and_starts(&local);
+        for (auto field : fields)
+            field->init_cache_levels_and_starts(&local);
         local.clear();
+        _chunk_owner[chunk] = thread_id;
     }
+}
 
-    {
-        // Implementation of multithreaded barrier.  Each thread increments the shared counter.
-        // Last thread to finish notifies the other threads that they can all continue.
-        std::unique_lock<std::mutex> lock(_chunk_mutex);
-        _finished_count++;
-        if (_finished_count == _n_threads)
-            _condition_variable.notify_all();
-        else
-            _condition_variable.wait(lock);
+void ThreadedContourGenerator::trace_task(
+    const std::vector<ThreadedContourGenerator*>& fields, Output* const* outputs)
+{
+    // Each thread first traces the chunks that it initialised in init_task() as their cache items
+    // are likely to still be in the CPU cache it is running on.  When it has run out of these it
+    // takes unclaimed chunks from other threads, starting at the highest chunk index and working
+    // downwards as the owning threads are working upwards.
+
+    auto n_chunks = get_n_chunks();
+    auto thread_id = std::this_thread::get_id();
+    index_t chunk;
+    ChunkLocal local;
+
+    std::vector<index_t> own_chunks;  // Chunks initialised by this thread, in increasing order.
+    for (chunk = 0; chunk < n_chunks; ++chunk) {
+        if (_chunk_owner[chunk] == thread_id)
+            own_chunks.push_back(chunk);
     }
 
-    // Stage 2: Trace contours.
+    auto own_it = own_chunks.cbegin();
     while (true) {
         {
             std::lock_guard<std::mutex> guard(_chunk_mutex);
-            if (_next_chunk < 2*n_chunks)
-                chunk = _next_chunk++ - n_chunks;
-            else
+            chunk = -1;
+            for (; chunk == -1 && own_it != own_chunks.cend(); ++own_it) {
+                if (!_chunk_claimed[*own_it])
+                    chunk = *own_it;
+            }
+            for (; chunk == -1 && _steal_chunk >= 0; --_steal_chunk) {
+                if (!_chunk_claimed[_steal_chunk])
+                    chunk = _steal_chunk;
+            }
+            if (chunk == -1)
                 break;  // No more work to do.
+            _chunk_claimed[chunk] = true;
         }
 
-        get_chunk_limits(chunk, local);
-        march_chunk(local, return_lists);
-        local.clear();
+        for (std::size_t field = 0; field < fields.size(); ++field) {
+            get_chunk_limits(chunk, local);
+            fields[field]->march_chunk(local, *outputs[field]);
+            local.clear();
+        }
     }
 }
+
+// Explicit instantiation so that the base class does not need to be instantiated by users of the
+// generator.
+template class BaseContourGenerator<ThreadedContourGenerator>;
@@ -2,48 +2,51 @@
 #define CONTOURPY_THREADED_H
 
 #include "base.h"
-#include <condition_variable>
 #include <mutex>
+#include <thread>
 
 class ThreadedContourGenerator : public BaseContourGenerator<ThreadedContourGenerator>
 {
 public:
+    // If grid_cache is specified it is the grid cache of an identical generator, which is used
+    // rather than recalculating it.
     ThreadedContourGenerator(
-        const CoordinateArray& x, const CoordinateArray& y, const CoordinateArray& z,
-        const MaskArray& mask, bool corner_mask, LineType line_type, FillType fill_type,
-        bool quad_as_tri, ZInterp z_interp, index_t x_chunk_size, index_t y_chunk_size,
-        index_t n_threads);
+        const double* x, const double* y, const double* z, const bool* mask, index_t nx,
+        index_t ny, bool corner_mask, LineType line_type, FillType fill_type, bool quad_as_tri,
+        ZInterp z_interp, index_t x_chunk_size, index_t y_chunk_size, index_t n_threads = 0,
+        const uint32_t* grid_cache = nullptr);
 
     index_t get_thread_count() const;
 
 private:
     friend class BaseContourGenerator<ThreadedContourGenerator>;
 
-    // Lock class is used to lock access to a single thread when creating/modifying Python objects.
-    // Automatically unlocks in destructor or when unlock() member function is called.
-    class Lock : public std::unique_lock<std::mutex>
-    {
-    public:
-        explicit Lock(ThreadedContourGenerator& contour_generator)
-            : std::unique_lock<std::mutex>(contour_generator._python_mutex)
-        {}
-    };
+    // Construct a per-call context of generator.
+    explicit ThreadedContourGenerator(const ThreadedContourGenerator* generator);
 
     static index_t limit_n_threads(index_t n_threads, index_t n_chunks);
 
-    void march(std::vector<py::list>& return_lists);
+    void march(Output& output);
 
-    void thread_function(std::vector<py::list>& return_lists);
+    // March multiple fields, each in its own per-call context, chunk by chunk.  march() is the
+    // special case of a single field contoured in this context.
+    void march_fields(
+        const std::vector<ThreadedContourGenerator*>& fields, Output* const* outputs);
+
+    // Tasks that are executed by each of the threads, one for each stage of march_fields().
+    void init_task(const std::vector<ThreadedContourGenerator*>& fields);
+    void trace_task(
+        const std::vector<ThreadedContourGenerator*>& fields, Output* const* outputs);
 
 
 
     // Multithreading member variables.
     index_t _n_threads;        // Number of threads used.
-    index_t _next_chunk;       // Next available chunk for thread to process.
-    index_t _finished_count;   // Count of threads that have finished the cache init.
-    std::mutex _chunk_mutex;   // Locks access to _next_chunk/_finished_count.
-    std::mutex _python_mutex;  // Locks access to Python objects.
-    std::condition_variable _condition_variable;  // Implements multithreaded barrier.
+    index_t _next_chunk;       // Next available chunk for thread to initialise.
+    std::vector<std::thread::id> _chunk_owner;  // Thread that initialised each chunk.
+    std::vector<bool> _chunk_claimed;  // Whether each chunk has been claimed for tracing.
+    index_t _steal_chunk;      // All chunks above this have been claimed for tracing.
+    std::mutex _chunk_mutex;   // Locks access to the chunk variables above.
 };
 
 #endif // CONTOURPY_THREADED_H
@@ -0,0 +1,940 @@
+#include "converter.h"
+#include "executor.h"
+#include "tri.h"
+#include "util.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+
+// CacheItem masks.  The z-levels of the 3 points of a triangle are stored in 2 bits each, with
+// values of 0 if z <= lower_level, 1 if lower_level < z <= upper_level and 2 if z > upper_level.
+// Contour lines only use values of 0 and 1.
+#define MASK_Z_LEVEL             (0x3)        // Of point 0, shifted by 2*index for points 1 and 2.
+#define MASK_EXISTS              (0x1 <<  6)  // Triangle is not masked.
+#define MASK_BOUNDARY_0          (0x1 <<  7)  // Edge 0 is on chunk boundary, shifted for 1 and 2.
+#define MASK_BOUNDARY_ANY        (0x7 <<  7)
+#define MASK_VISITED_LOWER       (0x1 << 10)  // Traced by lower level (or only level of lines).
+#define MASK_VISITED_UPPER       (0x1 << 11)  // Traced by upper level.
+#define MASK_VISITED_BOUNDARY_0  (0x1 << 12)  // Boundary edge 0 followed, shifted for 1 and 2.
+
+// Bits that are calculated once by init_cache_grid.
+#define MASK_GRID                (MASK_EXISTS | MASK_BOUNDARY_ANY)
+
+#define Z_LEVEL(item, index)     (((item) >> (2*(index))) & MASK_Z_LEVEL)
+#define BOUNDARY(item, edge)     ((item) & (MASK_BOUNDARY_0 << (edge)))
+
+
+TriContourGenerator::TriContourGenerator(
+    const double* x, const double* y, index_t n_points, const index_t* triangles,
+    index_t n_triangles, const double* z, const bool* mask, LineType line_type,
+    FillType fill_type, ZInterp z_interp, index_t n_chunks, index_t n_threads)
+    : _x(x),
+      _y(y),
+      _z(z),
+      _n_points(n_points),
+      _n_triangles(n_triangles),
+      _line_type(line_type),
+      _fill_type(fill_type),
+      _z_interp(z_interp),
+      _n_threads(1)
+{
+    if (_n_points < 3)
+        throw std::invalid_argument("There must be at least 3 points");
+
+    if (_n_triangles < 1)
+        throw std::invalid_argument("There must be at least 1 triangle");
+
+    if (!supports_line_type(line_type))
+        throw std::invalid_argument("Unsupported LineType");
+
+    if (!supports_fill_type(fill_type))
+        throw std::invalid_argument("Unsupported FillType");
+
+    if (n_chunks < 0)
+        throw std::invalid_argument("chunk_count cannot be negative");
+
+    if (n_threads < 0)
+        throw std::invalid_argument("thread_count cannot be negative");
+
+    for (index_t i = 0; i < 3*_n_triangles; ++i) {
+        if (triangles[i] < 0 || triangles[i] >= _n_points)
+            throw std::invalid_argument(
+                "triangles must contain indices in the range 0 to n_points-1");
+    }
+
+    index_t max_threads = std::max<index_t>(Util::get_max_threads(), 1);
+    n_threads = (n_threads == 0) ? max_threads : std::min(n_threads, max_threads);
+    if (n_chunks == 0)
+        n_chunks = n_threads;
+    n_chunks = std::min(n_chunks, _n_triangles);
+    _n_threads = std::min(n_threads, n_chunks);
+
+    auto order = calc_chunks(triangles, n_chunks);
+
+    // Copy triangles in chunk order, anticlockwise so that the interior of the mesh is on the left
+    // of each boundary edge and contours are consistently oriented.
+    _triangles.resize(3*_n_triangles);
+    for (index_t tri = 0; tri < _n_triangles; ++tri) {
+        auto from = triangles + 3*order[tri];
+        auto to = _triangles.data() + 3*tri;
+        to[0] = from[0];
+        to[1] = from[1];
+        to[2] = from[2];
+        auto cross = (_x[to[1]] - _x[to[0]])*(_y[to[2]] - _y[to[0]]) -
+                     (_y[to[1]] - _y[to[0]])*(_x[to[2]] - _x[to[0]]);
+        if (cross < 0.0)
+            std::swap(to[1], to[2]);
+    }
+
+    calc_neighbors();
+    init_cache_grid(mask, order);
+
+    if (_z_interp == ZInterp::Log) {
+        for (index_t tri = 0; tri < _n_triangles; ++tri) {
+            if (!(_cache[tri] & MASK_EXISTS))
+                continue;
+            for (int index = 0; index < 3; ++index) {
+                if (_z[get_triangle_point(tri, index)] <= 0.0)
+                    throw std::invalid_argument("z values must be positive if using ZInterp.Log");
+            }
+        }
+    }
+}
+
+std::unique_ptr<TriContourGenerator::Context> TriContourGenerator::acquire_context()
+{
+    {
+        std::lock_guard<std::mutex> guard(_contexts_mutex);
+        if (!_contexts.empty()) {
+            auto context = std::move(_contexts.back());
+            _contexts.pop_back();
+            return context;
+        }
+    }
+
+    std::unique_ptr<Context> context(new Context());
+    context->cache = _cache;
+    return context;
+}
+
+void TriContourGenerator::add_edge_point(
+    const Context& context, index_t tri, int edge, bool on_upper, ChunkLocal& local) const
+{
+    auto point0 = get_triangle_point(tri, edge);
+    auto point1 = get_triangle_point(tri, (edge+1) % 3);
+
+    // Neighboring triangles traverse a shared edge in opposite directions, so order the points to
+    // calculate identical coordinates for both.
+    if (point0 > point1)
+        std::swap(point0, point1);
+
+    auto level = on_upper ? context.upper_level : context.lower_level;
+    auto z0 = _z[point0];
+    auto z1 = _z[point1];
+    double frac;
+    switch (_z_interp) {
+        case ZInterp::Log:
+            frac = log(z1/level) / log(z1/z0);
+            break;
+        default:  // ZInterp::Linear
+            frac = (z1 - level) / (z1 - z0);
+            break;
+    }
+
+    local.points.push_back(_x[point0]*frac + _x[point1]*(1.0 - frac));
+    local.points.push_back(_y[point0]*frac + _y[point1]*(1.0 - frac));
+}
+
+void TriContourGenerator::add_point(index_t point, ChunkLocal& local) const
+{
+    local.points.push_back(_x[point]);
+    local.points.push_back(_y[point]);
+}
+
+std::vector<index_t> TriContourGenerator::calc_chunks(const index_t* triangles, index_t n_chunks)
+{
+    std::vector<index_t> order(_n_triangles);
+    std::iota(order.begin(), order.end(), 0);
+    _chunk_starts.assign(n_chunks + 1, _n_triangles);
+    _chunk_starts[0] = 0;
+    if (n_chunks == 1)
+        return order;
+
+    // Recursive coordinate bisection of the triangle centroids (which are not divided by 3 as
+    // only their relative positions matter), so that chunks are compact and have short
+    // boundaries.  Each part is split along its longer side in proportion to its chunk count.
+    std::vector<double> centroids(2*_n_triangles);
+    for (index_t tri = 0; tri < _n_triangles; ++tri) {
+        auto points = triangles + 3*tri;
+        centroids[2*tri] = _x[points[0]] + _x[points[1]] + _x[points[2]];
+        centroids[2*tri+1] = _y[points[0]] + _y[points[1]] + _y[points[2]];
+    }
+
+    struct Part
+    {
+        index_t start, end, chunk, n_chunks;
+    };
+
+    std::vector<Part> parts = {{0, _n_triangles, 0, n_chunks}};
+    while (!parts.empty()) {
+        auto part = parts.back();
+        parts.pop_back();
+
+        if (part.n_chunks == 1) {
+            _chunk_starts[part.chunk] = part.start;
+            continue;
+        }
+
+        double min[2] = {std::numeric_limits<double>::max(), std::numeric_limits<double>::max()};
+        double max[2] = {std::numeric_limits<double>::lowest(),
+                         std::numeric_limits<double>::lowest()};
+        for (index_t i = part.start; i < part.end; ++i) {
+            for (int axis = 0; axis < 2; ++axis) {
+                auto value = centroids[2*order[i] + axis];
+                min[axis] = std::min(min[axis], value);
+                max[axis] = std::max(max[axis], value);
+            }
+        }
+        int axis = (max[0] - min[0] >= max[1] - min[1]) ? 0 : 1;
+
+        index_t left_chunks = part.n_chunks / 2;
+        index_t middle = part.start + (part.end - part.start)*left_chunks / part.n_chunks;
+        std::nth_element(
+            order.begin() + part.start, order.begin() + middle, order.begin() + part.end,
+            [&centroids, axis](index_t a, index_t b) {
+                return centroids[2*a + axis] < centroids[2*b + axis];
+            });
+
+        parts.push_back({part.start, middle, part.chunk, left_chunks});
+        parts.push_back({middle, part.end, part.chunk + left_chunks, part.n_chunks - left_chunks});
+    }
+
+    // Keep the original order within each chunk as meshes are often ordered for locality.
+    for (index_t chunk = 0; chunk < n_chunks; ++chunk)
+        std::sort(order.begin() + _chunk_starts[chunk], order.begin() + _chunk_starts[chunk+1]);
+
+    return order;
+}
+
+void TriContourGenerator::calc_neighbors()
+{
+    // Group edges by their lower point index using a counting sort, then sort each group by the
+    // higher point index so that an edge shared by two triangles appears twice in succession.
+    // Edges shared by more than two triangles, or by two triangles that traverse it in the same
+    // direction, are treated as boundaries.
+    std::vector<index_t> group_starts(_n_points + 1, 0);
+    for (index_t tri_edge = 0; tri_edge < 3*_n_triangles; ++tri_edge) {
+        auto start = _triangles[tri_edge];
+        auto end = _triangles[tri_edge - tri_edge % 3 + (tri_edge + 1) % 3];
+        ++group_starts[std::min(start, end) + 1];
+    }
+    std::partial_sum(group_starts.begin(), group_starts.end(), group_starts.begin());
+
+    struct Edge
+    {
+        index_t higher, tri_edge;
+    };
+
+    std::vector<Edge> edges(3*_n_triangles);
+    {
+        std::vector<index_t> next(group_starts.begin(), group_starts.end() - 1);
+        for (index_t tri_edge = 0; tri_edge < 3*_n_triangles; ++tri_edge) {
+            auto start = _triangles[tri_edge];
+            auto end = _triangles[tri_edge - tri_edge % 3 + (tri_edge + 1) % 3];
+            edges[next[std::min(start, end)]++] = {std::max(start, end), tri_edge};
+        }
+    }
+
+    _neighbors.assign(3*_n_triangles, -1);
+    for (index_t point = 0; point < _n_points; ++point) {
+        auto group_end = edges.begin() + group_starts[point+1];
+        std::sort(edges.begin() + group_starts[point], group_end,
+                  [](const Edge& a, const Edge& b) {return a.higher < b.higher;});
+
+        for (auto it = edges.begin() + group_starts[point]; it != group_end; ) {
+            auto it_next = it + 1;
+            while (it_next != group_end && it_next->higher == it->higher)
+                ++it_next;
+
+            if (it_next - it == 2) {
+                auto a = it->tri_edge;
+                auto b = (it+1)->tri_edge;
+                if (_triangles[a] != _triangles[b]) {  // Start points differ.
+                    _neighbors[a] = b;
+                    _neighbors[b] = a;
+                }
+            }
+            it = it_next;
+        }
+    }
+}
+
+void TriContourGenerator::ChunkLocal::clear()
+{
+    points.clear();
+    line_offsets.clear();
+}
+
+void TriContourGenerator::close_line(ChunkLocal& local) const
+{
+    auto start = 2*local.line_offsets.back();
+    local.points.push_back(local.points[start]);
+    local.points.push_back(local.points[start+1]);
+}
+
+FillType TriContourGenerator::default_fill_type()
+{
+    return FillType::OuterOffset;
+}
+
+LineType TriContourGenerator::default_line_type()
+{
+    return LineType::Separate;
+}
+
+void TriContourGenerator::export_filled(index_t chunk, ChunkLocal& local, Output& output) const
+{
+    auto line_count = local.line_offsets.size() - 1;
+    auto point_count = local.line_offsets.back();
+
+    if (_fill_type == FillType::ChunkCombinedCode || _fill_type == FillType::ChunkCombinedOffset) {
+        std::lock_guard<Output> lock(output);
+
+        Converter::convert_points(
+            point_count, local.points.data(), output.set_points(chunk, point_count));
+        if (_fill_type == FillType::ChunkCombinedCode)
+            Converter::convert_codes(
+                point_count, line_count + 1, local.line_offsets.data(), 0,
+                output.set_codes(chunk, point_count));
+        else
+            Converter::convert_offsets(
+                line_count + 1, local.line_offsets.data(), 0,
+                output.set_offsets(chunk, line_count + 1));
+        return;
+    }
+
+    // Polygons have the filled region on their left so outers are anticlockwise and holes are
+    // clockwise.  Each hole belongs to the smallest outer that contains its first point.
+    std::vector<double> areas(line_count);
+    for (decltype(line_count) i = 0; i < line_count; ++i) {
+        auto points = local.points.data() + 2*local.line_offsets[i];
+        auto n = local.line_offsets[i+1] - local.line_offsets[i] - 1;
+        double area = 0.0;
+        for (decltype(n) j = 0; j < n; ++j)
+            area += points[2*j]*points[2*j+3] - points[2*j+2]*points[2*j+1];
+        areas[i] = 0.5*area;
+    }
+
+    std::vector<std::size_t> outers;
+    std::vector<std::vector<std::size_t>> holes(line_count);  // Holes of each outer.
+    for (decltype(line_count) i = 0; i < line_count; ++i) {
+        if (areas[i] >= 0.0)
+            outers.push_back(i);
+    }
+
+    for (decltype(line_count) i = 0; i < line_count; ++i) {
+        if (areas[i] >= 0.0)
+            continue;
+
+        auto x = local.points[2*local.line_offsets[i]];
+        auto y = local.points[2*local.line_offsets[i]+1];
+        auto parent = outers.empty() ? i : outers.front();  // Fallback should not be needed.
+        auto parent_area = std::numeric_limits<double>::max();
+        for (auto outer : outers) {
+            if (areas[outer] >= parent_area)
+                continue;
+
+            // Crossing number test of whether (x, y) is inside outer.
+            auto points = local.points.data() + 2*local.line_offsets[outer];
+            auto n = local.line_offsets[outer+1] - local.line_offsets[outer] - 1;
+            bool inside = false;
+            for (decltype(n) j = 0; j < n; ++j) {
+                auto x0 = points[2*j], y0 = points[2*j+1];
+                auto x1 = points[2*j+2], y1 = points[2*j+3];
+                if ((y0 > y) != (y1 > y) && x < x0 + (y - y0)*(x1 - x0)/(y1 - y0))
+                    inside = !inside;
+            }
+            if (inside) {
+                parent = outer;
+                parent_area = areas[outer];
+            }
+        }
+        if (parent != i)
+            holes[parent].push_back(i);
+    }
+
+    // Reorder lines so that each outer is followed by its holes.
+    ChunkLocal ordered;
+    ordered.points.reserve(local.points.size());
+    ordered.line_offsets.reserve(local.line_offsets.size());
+    std::vector<offset_t> outer_offsets;  // Into ordered lines.
+    outer_offsets.reserve(outers.size() + 1);
+    for (auto outer : outers) {
+        outer_offsets.push_back(static_cast<offset_t>(ordered.line_offsets.size()));
+        holes[outer].insert(holes[outer].begin(), outer);
+        for (auto line : holes[outer]) {
+            ordered.line_offsets.push_back(static_cast<offset_t>(ordered.points.size() / 2));
+            ordered.points.insert(
+                ordered.points.end(), local.points.begin() + 2*local.line_offsets[line],
+                local.points.begin() + 2*local.line_offsets[line+1]);
+        }
+    }
+    auto ordered_count = ordered.line_offsets.size();
+    auto ordered_point_count = static_cast<offset_t>(ordered.points.size() / 2);
+    ordered.line_offsets.push_back(ordered_point_count);
+    outer_offsets.push_back(static_cast<offset_t>(ordered_count));
+
+    std::lock_guard<Output> lock(output);
+
+    switch (_fill_type) {
+        case FillType::OuterCode:
+        case FillType::OuterOffset:
+            for (std::size_t i = 0; i < outers.size(); ++i) {
+                auto outer_start = outer_offsets[i];
+                auto outer_end = outer_offsets[i+1];
+                auto point_start = ordered.line_offsets[outer_start];
+                auto count = ordered.line_offsets[outer_end] - point_start;
+
+                Converter::convert_points(
+                    count, ordered.points.data() + 2*point_start, output.append_points(count));
+
+                auto cut_count = outer_end - outer_start + 1;
+                if (_fill_type == FillType::OuterCode)
+                    Converter::convert_codes(
+                        count, cut_count, ordered.line_offsets.data() + outer_start, point_start,
+                        output.append_codes(count));
+                else
+                    Converter::convert_offsets(
+                        cut_count, ordered.line_offsets.data() + outer_start, point_start,
+                        output.append_offsets(cut_count));
+            }
+            break;
+        case FillType::ChunkCombinedCodeOffset:
+            Converter::convert_points(
+                ordered_point_count, ordered.points.data(),
+                output.set_points(chunk, ordered_point_count));
+            Converter::convert_codes(
+                ordered_point_count, ordered_count + 1, ordered.line_offsets.data(), 0,
+                output.set_codes(chunk, ordered_point_count));
+            // Outer offsets into points.
+            for (auto& offset : outer_offsets)
+                offset = ordered.line_offsets[offset];
+            Converter::convert_offsets(
+                outer_offsets.size(), outer_offsets.data(), 0,
+                output.set_outer_offsets(chunk, outer_offsets.size()));
+            break;
+        default:  // FillType::ChunkCombinedOffsetOffset
+            Converter::convert_points(
+                ordered_point_count, ordered.points.data(),
+                output.set_points(chunk, ordered_point_count));
+            Converter::convert_offsets(
+                ordered_count + 1, ordered.line_offsets.data(), 0,
+                output.set_offsets(chunk, ordered_count + 1));
+            Converter::convert_offsets(
+                outer_offsets.size(), outer_offsets.data(), 0,
+                output.set_outer_offsets(chunk, outer_offsets.size()));
+            break;
+    }
+}
+
+void TriContourGenerator::export_lines(index_t chunk, ChunkLocal& local, Output& output) const
+{
+    auto line_count = local.line_offsets.size() - 1;
+    auto point_count = local.line_offsets.back();
+
+    std::lock_guard<Output> lock(output);
+
+    switch (_line_type) {
+        case LineType::Separate:
+        case LineType::SeparateCode:
+            for (decltype(line_count) i = 0; i < line_count; ++i) {
+                auto point_start = local.line_offsets[i];
+                auto count = local.line_offsets[i+1] - point_start;
+                auto points = local.points.data() + 2*point_start;
+
+                Converter::convert_points(count, points, output.append_points(count));
+                if (_line_type == LineType::SeparateCode)
+                    Converter::convert_codes_check_closed_single(
+                        count, points, output.append_codes(count));
+            }
+            break;
+        case LineType::ChunkCombinedCode:
+            Converter::convert_points(
+                point_count, local.points.data(), output.set_points(chunk, point_count));
+            Converter::convert_codes_check_closed(
+                point_count, line_count + 1, local.line_offsets.data(), local.points.data(),
+                output.set_codes(chunk, point_count));
+            break;
+        case LineType::ChunkCombinedOffset:
+            Converter::convert_points(
+                point_count, local.points.data(), output.set_points(chunk, point_count));
+            Converter::convert_offsets(
+                line_count + 1, local.line_offsets.data(), 0,
+                output.set_offsets(chunk, line_count + 1));
+            break;
+    }
+}
+
+void TriContourGenerator::filled(double lower_level, double upper_level, Output& output)
+{
+    if (lower_level > upper_level)
+        throw std::invalid_argument("upper and lower levels are the wrong way round");
+
+    auto context = acquire_context();
+    context->filled = true;
+    context->lower_level = lower_level;
+    context->upper_level = upper_level;
+    march(*context, output);
+    release_context(std::move(context));
+}
+
+void TriContourGenerator::find_boundary_lines(
+    Context& context, index_t chunk, ChunkLocal& local) const
+{
+    // A line starts on each boundary edge that goes from above the level to below it.
+    for (auto tri = _chunk_starts[chunk]; tri < _chunk_starts[chunk+1]; ++tri) {
+        auto item = context.cache[tri];
+        if (!(item & MASK_BOUNDARY_ANY))
+            continue;
+
+        for (int edge = 0; edge < 3; ++edge) {
+            if (BOUNDARY(item, edge) &&
+                Z_LEVEL(item, edge) == 1 && Z_LEVEL(item, (edge+1) % 3) == 0) {
+                local.line_offsets.push_back(static_cast<offset_t>(local.points.size() / 2));
+                auto line_tri = tri;
+                auto line_edge = edge;
+                follow_interior(context, line_tri, line_edge, true, false, local);
+            }
+        }
+    }
+}
+
+void TriContourGenerator::find_boundary_lines_filled(
+    Context& context, index_t chunk, ChunkLocal& local) const
+{
+    // A polygon starts on each boundary edge that increases through the upper level or decreases
+    // through the lower level that has not already been followed.  It alternates between
+    // following contours through the interior and following the boundary until it returns to
+    // where it started.
+    for (auto tri = _chunk_starts[chunk]; tri < _chunk_starts[chunk+1]; ++tri) {
+        if (!(context.cache[tri] & MASK_BOUNDARY_ANY))
+            continue;
+
+        for (int edge = 0; edge < 3; ++edge) {
+            auto item = context.cache[tri];
+            if (!BOUNDARY(item, edge) || (item & (MASK_VISITED_BOUNDARY_0 << edge)))
+                continue;
+
+            auto z_start = Z_LEVEL(item, edge);
+            auto z_end = Z_LEVEL(item, (edge+1) % 3);
+            bool increase_upper = (z_start < 2 && z_end == 2);
+            bool decrease_lower = (z_start > 0 && z_end == 0);
+            if (!increase_upper && !decrease_lower)
+                continue;
+
+            local.line_offsets.push_back(static_cast<offset_t>(local.points.size() / 2));
+            auto line_tri = tri;
+            auto line_edge = edge;
+            bool on_upper = increase_upper;
+            do {
+                follow_interior(context, line_tri, line_edge, true, on_upper, local);
+                on_upper = follow_boundary(context, line_tri, line_edge, on_upper, local);
+            } while (line_tri != tri || line_edge != edge);
+            close_line(local);
+        }
+    }
+
+    // Boundary loops that have not been followed either have a z-level that changes, in which
+    // case they have already been contoured, or lie wholly above, below or between the levels.
+    for (auto tri = _chunk_starts[chunk]; tri < _chunk_starts[chunk+1]; ++tri) {
+        if (!(context.cache[tri] & MASK_BOUNDARY_ANY))
+            continue;
+
+        for (int edge = 0; edge < 3; ++edge) {
+            auto item = context.cache[tri];
+            if (!BOUNDARY(item, edge) || (item & (MASK_VISITED_BOUNDARY_0 << edge)))
+                continue;
+
+            auto point_start = local.points.size();
+            bool between = true;
+            auto loop_tri = tri;
+            auto loop_edge = edge;
+            do {
+                context.cache[loop_tri] |= MASK_VISITED_BOUNDARY_0 << loop_edge;
+                between = between && Z_LEVEL(context.cache[loop_tri], loop_edge) == 1;
+                if (between)
+                    add_point(get_triangle_point(loop_tri, loop_edge), local);
+                move_to_next_boundary_edge(context, loop_tri, loop_edge);
+            } while (loop_tri != tri || loop_edge != edge);
+
+            if (between) {
+                local.line_offsets.push_back(static_cast<offset_t>(point_start / 2));
+                close_line(local);
+            }
+            else
+                local.points.resize(point_start);
+        }
+    }
+}
+
+void TriContourGenerator::find_interior_lines(
+    Context& context, index_t chunk, bool on_upper, ChunkLocal& local) const
+{
+    // Contours that do not touch a boundary are closed loops that start at any triangle that they
+    // pass through that has not already been visited.
+    auto visited = on_upper ? MASK_VISITED_UPPER : MASK_VISITED_LOWER;
+    for (auto tri = _chunk_starts[chunk]; tri < _chunk_starts[chunk+1]; ++tri) {
+        auto& item = context.cache[tri];
+        if (!(item & MASK_EXISTS) || (item & visited))
+            continue;
+
+        item |= visited;
+        auto edge = get_exit_edge(context, tri, on_upper);
+        if (edge == -1)
+            continue;
+
+        assert(!BOUNDARY(item, edge) && "Interior loop reaches boundary");
+        local.line_offsets.push_back(static_cast<offset_t>(local.points.size() / 2));
+        auto next = _neighbors[3*tri + edge];
+        auto line_tri = next / 3;
+        auto line_edge = static_cast<int>(next % 3);
+        follow_interior(context, line_tri, line_edge, false, on_upper, local);
+        close_line(local);
+    }
+}
+
+bool TriContourGenerator::follow_boundary(
+    Context& context, index_t& tri, int& edge, bool on_upper, ChunkLocal& local) const
+{
+    bool stop = false;
+    bool first_edge = true;
+    unsigned int z_start, z_end = 0;
+    while (!stop) {
+        auto& item = context.cache[tri];
+        assert(!(item & (MASK_VISITED_BOUNDARY_0 << edge)) && "Boundary already visited");
+        item |= MASK_VISITED_BOUNDARY_0 << edge;
+
+        z_start = first_edge ? Z_LEVEL(item, edge) : z_end;
+        z_end = Z_LEVEL(item, (edge+1) % 3);
+
+        // Stop where a contour leaves the boundary, excluding the one that has just arrived on the
+        // first edge.
+        if (z_end > z_start) {  // z increasing.
+            if (!(!on_upper && first_edge) && z_start == 0 && z_end > 0) {
+                stop = true;
+                on_upper = false;
+            }
+            else if (z_start < 2 && z_end == 2) {
+                stop = true;
+                on_upper = true;
+            }
+        }
+        else if (z_end < z_start) {  // z decreasing.
+            if (!(on_upper && first_edge) && z_start == 2 && z_end < 2) {
+                stop = true;
+                on_upper = true;
+            }
+            else if (z_start > 0 && z_end == 0) {
+                stop = true;
+                on_upper = false;
+            }
+        }
+
+        first_edge = false;
+
+        if (!stop) {
+            move_to_next_boundary_edge(context, tri, edge);
+            add_point(get_triangle_point(tri, edge), local);
+        }
+    }
+
+    return on_upper;
+}
+
+void TriContourGenerator::follow_interior(
+    Context& context, index_t& tri, int& edge, bool end_on_boundary, bool on_upper,
+    ChunkLocal& local) const
+{
+    auto visited = on_upper ? MASK_VISITED_UPPER : MASK_VISITED_LOWER;
+
+    add_edge_point(context, tri, edge, on_upper, local);
+
+    while (true) {
+        auto& item = context.cache[tri];
+        if (!end_on_boundary && (item & visited))
+            break;  // Back to start of closed loop.
+
+        edge = get_exit_edge(context, tri, on_upper);
+        assert(edge >= 0 && edge < 3 && "Invalid exit edge");
+        item |= visited;
+
+        add_edge_point(context, tri, edge, on_upper, local);
+
+        if (BOUNDARY(item, edge)) {
+            assert(end_on_boundary && "Interior loop reaches boundary");
+            break;
+        }
+
+        auto next = _neighbors[3*tri + edge];
+        tri = next / 3;
+        edge = static_cast<int>(next % 3);
+    }
+}
+
+index_t TriContourGenerator::get_chunk_count() const
+{
+    return static_cast<index_t>(_chunk_starts.size()) - 1;
+}
+
+int TriContourGenerator::get_exit_edge(const Context& context, index_t tri, bool on_upper) const
+{
+    // Bit i of config is set if point i is above the level, the contour leaves with the points
+    // above the level on its left.
+    auto item = context.cache[tri];
+    unsigned int config;
+    if (on_upper)
+        config = 7 - ((Z_LEVEL(item, 0) == 2) |
+                      (Z_LEVEL(item, 1) == 2) << 1 |
+                      (Z_LEVEL(item, 2) == 2) << 2);
+    else
+        config = (Z_LEVEL(item, 0) > 0) |
+                 (Z_LEVEL(item, 1) > 0) << 1 |
+                 (Z_LEVEL(item, 2) > 0) << 2;
+
+    switch (config) {
+        case 1: return 2;
+        case 2: return 0;
+        case 3: return 2;
+        case 4: return 1;
+        case 5: return 1;
+        case 6: return 0;
+        default: return -1;  // 0 or 7.
+    }
+}
+
+FillType TriContourGenerator::get_fill_type() const
+{
+    return _fill_type;
+}
+
+LineType TriContourGenerator::get_line_type() const
+{
+    return _line_type;
+}
+
+index_t TriContourGenerator::get_point_count() const
+{
+    return _n_points;
+}
+
+index_t TriContourGenerator::get_thread_count() const
+{
+    return _n_threads;
+}
+
+index_t TriContourGenerator::get_triangle_count() const
+{
+    return _n_triangles;
+}
+
+index_t TriContourGenerator::get_triangle_point(index_t tri, int edge) const
+{
+    return _triangles[3*tri + edge];
+}
+
+ZInterp TriContourGenerator::get_z_interp() const
+{
+    return _z_interp;
+}
+
+void TriContourGenerator::init_cache_grid(const bool* mask, const std::vector<index_t>& order)
+{
+    _cache.assign(_n_triangles, 0);
+    for (index_t tri = 0; tri < _n_triangles; ++tri) {
+        if (mask == nullptr || !mask[order[tri]])
+            _cache[tri] = MASK_EXISTS;
+    }
+
+    // An edge is a boundary if there is no neighbor across it, or the neighbor is masked or in a
+    // different chunk.
+    for (index_t chunk = 0; chunk < get_chunk_count(); ++chunk) {
+        auto start = _chunk_starts[chunk];
+        auto end = _chunk_starts[chunk+1];
+        for (auto tri = start; tri < end; ++tri) {
+            if (!(_cache[tri] & MASK_EXISTS))
+                continue;
+
+            for (int edge = 0; edge < 3; ++edge) {
+                auto next = _neighbors[3*tri + edge];
+                auto next_tri = next / 3;
+                if (next < 0 || !(_cache[next_tri] & MASK_EXISTS) || next_tri < start ||
+                    next_tri >= end)
+                    _cache[tri] |= MASK_BOUNDARY_0 << edge;
+            }
+        }
+    }
+}
+
+void TriContourGenerator::init_cache_levels(Context& context, index_t chunk) const
+{
+    for (auto tri = _chunk_starts[chunk]; tri < _chunk_starts[chunk+1]; ++tri) {
+        auto& item = context.cache[tri];
+        item &= MASK_GRID;
+        if (!(item & MASK_EXISTS))
+            continue;
+
+        auto points = _triangles.data() + 3*tri;
+        item |= z_to_zlevel(context, _z[points[0]]) |
+                z_to_zlevel(context, _z[points[1]]) << 2 |
+                z_to_zlevel(context, _z[points[2]]) << 4;
+    }
+}
+
+void TriContourGenerator::init_output(const Context& context, Output& output) const
+{
+    unsigned int list_count;
+    bool chunked;
+    if (context.filled) {
+        list_count = (_fill_type == FillType::ChunkCombinedCodeOffset ||
+                      _fill_type == FillType::ChunkCombinedOffsetOffset) ? 3 : 2;
+        chunked = !(_fill_type == FillType::OuterCode || _fill_type == FillType::OuterOffset);
+    }
+    else {
+        list_count = (_line_type == LineType::Separate) ? 1 : 2;
+        chunked = !(_line_type == LineType::Separate || _line_type == LineType::SeparateCode);
+    }
+
+    output.init(list_count, chunked ? get_chunk_count() : 0);
+}
+
+void TriContourGenerator::lines(double level, Output& output)
+{
+    auto context = acquire_context();
+    context->filled = false;
+    context->lower_level = context->upper_level = level;
+    march(*context, output);
+    release_context(std::move(context));
+}
+
+void TriContourGenerator::march(Context& context, Output& output)
+{
+    init_output(context, output);
+
+    auto n_chunks = get_chunk_count();
+    if (_n_threads == 1) {
+        ChunkLocal local;
+        for (index_t chunk = 0; chunk < n_chunks; ++chunk)
+            march_chunk(context, chunk, local, output);
+        return;
+    }
+
+    // Chunks are independent as all of the z-levels that a chunk uses are stored in the cache
+    // items of its own triangles, so each thread initialises and traces one chunk at a time.
+    context.next_chunk = 0;
+    Executor::get_default()->run(_n_threads, [this, &context, &output, n_chunks]() {
+        ChunkLocal local;
+        while (true) {
+            index_t chunk;
+            {
+                std::lock_guard<std::mutex> guard(context.chunk_mutex);
+                if (context.next_chunk < n_chunks)
+                    chunk = context.next_chunk++;
+                else
+                    break;  // No more work to do.
+            }
+            march_chunk(context, chunk, local, output);
+        }
+    });
+}
+
+void TriContourGenerator::march_chunk(
+    Context& context, index_t chunk, ChunkLocal& local, Output& output) const
+{
+    // Stage 1: Initialise cache z-levels.
+    init_cache_levels(context, chunk);
+
+    // Stage 2: Trace contours.
+    local.clear();
+    if (context.filled) {
+        find_boundary_lines_filled(context, chunk, local);
+        find_interior_lines(context, chunk, false, local);
+        find_interior_lines(context, chunk, true, local);
+    }
+    else {
+        find_boundary_lines(context, chunk, local);
+        find_interior_lines(context, chunk, false, local);
+    }
+
+    if (local.line_offsets.empty()) {
+        bool chunked = context.filled ?
+            !(_fill_type == FillType::OuterCode || _fill_type == FillType::OuterOffset) :
+            !(_line_type == LineType::Separate || _line_type == LineType::SeparateCode);
+        if (chunked) {
+            std::lock_guard<Output> lock(output);
+            output.set_empty(chunk);
+        }
+        return;
+    }
+
+    local.line_offsets.push_back(static_cast<offset_t>(local.points.size() / 2));
+    if (context.filled)
+        export_filled(chunk, local, output);
+    else
+        export_lines(chunk, local, output);
+}
+
+void TriContourGenerator::move_to_next_boundary_edge(
+    const Context& context, index_t& tri, int& edge) const
+{
+    // Rotate anticlockwise about the end point of the current edge, crossing interior edges,
+    // until a boundary edge that starts at that point is found.
+    edge = (edge + 1) % 3;
+    while (!BOUNDARY(context.cache[tri], edge)) {
+        auto next = _neighbors[3*tri + edge];
+        tri = next / 3;
+        edge = static_cast<int>((next % 3 + 1) % 3);
+    }
+}
+
+void TriContourGenerator::release_context(std::unique_ptr<Context> context)
+{
+    std::lock_guard<std::mutex> guard(_contexts_mutex);
+    _contexts.push_back(std::move(context));
+}
+
+bool TriContourGenerator::supports_fill_type(FillType fill_type)
+{
+    switch (fill_type) {
+        case FillType::OuterCode:
+        case FillType::OuterOffset:
+        case FillType::ChunkCombinedCode:
+        case FillType::ChunkCombinedOffset:
+        case FillType::ChunkCombinedCodeOffset:
+        case FillType::ChunkCombinedOffsetOffset:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool TriContourGenerator::supports_line_type(LineType line_type)
+{
+    switch (line_type) {
+        case LineType::Separate:
+        case LineType::SeparateCode:
+        case LineType::ChunkCombinedCode:
+        case LineType::ChunkCombinedOffset:
+            return true;
+        default:
+            return false;
+    }
+}
+
+unsigned int TriContourGenerator::z_to_zlevel(const Context& context, double z_value) const
+{
+    return (context.filled && z_value > context.upper_level) ? 2 :
+        (z_value > context.lower_level ? 1 : 0);
+}
@@ -0,0 +1,155 @@
+// TriContourGenerator class calculates contours of z values on the points of an unstructured
+// triangular mesh.  The tracing algorithm is that of Matplotlib's tricontour, but it follows the
+// design of the quad generators.  The grid-invariant properties of each triangle are precalculated
+// in a bit-packed cache, and each call initialises the z-levels of each chunk before tracing it.
+// Chunks are partitions of triangles that are spatially compact, and contour lines are divided at
+// chunk boundaries so that chunks may be traced independently by multiple threads.  Results are in
+// the same formats as the quad generators.
+
+#ifndef CONTOURPY_TRI_H
+#define CONTOURPY_TRI_H
+
+#include "contour_generator.h"
+#include "fill_type.h"
+#include "line_type.h"
+#include "output.h"
+#include "z_interp.h"
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+class TriContourGenerator : public ContourGenerator
+{
+public:
+    // x, y and z are arrays of n_points, triangles is a C-contiguous array of shape
+    // (n_triangles, 3) of indices into the points and the optional mask is an array of n_triangles.
+    // x, y and z must outlive the generator, triangles and mask are copied.  n_chunks is the number
+    // of chunks, or 0 for one chunk per thread.  n_threads is the number of threads, or 0 for the
+    // maximum.
+    TriContourGenerator(
+        const double* x, const double* y, index_t n_points, const index_t* triangles,
+        index_t n_triangles, const double* z, const bool* mask, LineType line_type,
+        FillType fill_type, ZInterp z_interp, index_t n_chunks = 1, index_t n_threads = 1);
+
+    static FillType default_fill_type();
+    static LineType default_line_type();
+
+    // Calculate contours and write them to output.
+    void filled(double lower_level, double upper_level, Output& output);
+    void lines(double level, Output& output);
+
+    index_t get_chunk_count() const;
+    FillType get_fill_type() const;
+    LineType get_line_type() const;
+    index_t get_point_count() const;
+    index_t get_thread_count() const;
+    index_t get_triangle_count() const;
+    ZInterp get_z_interp() const;
+
+    static bool supports_fill_type(FillType fill_type);
+    static bool supports_line_type(LineType line_type);
+
+private:
+    typedef uint16_t CacheItem;
+
+    // Per-call state, so that multiple calls on the same generator may run concurrently.
+    struct Context
+    {
+        std::vector<CacheItem> cache;  // Grid-invariant bits plus z-levels and visited flags.
+        bool filled;
+        double lower_level, upper_level;
+        index_t next_chunk;            // Next chunk for a thread to march.
+        std::mutex chunk_mutex;        // Locks access to next_chunk.
+    };
+
+    // Contour lines or polygons of a single chunk.
+    struct ChunkLocal
+    {
+        void clear();
+
+        std::vector<double> points;          // Interleaved x and y.
+        std::vector<offset_t> line_offsets;  // Start of each line in points, plus the end.
+    };
+
+    std::unique_ptr<Context> acquire_context();
+
+    void add_point(index_t point, ChunkLocal& local) const;
+
+    // Add point where contour crosses edge of tri.
+    void add_edge_point(
+        const Context& context, index_t tri, int edge, bool on_upper, ChunkLocal& local) const;
+
+    // Assign each triangle to one of n_chunks chunks.  Returns the original index of each
+    // triangle after renumbering them so that those in the same chunk are contiguous.
+    std::vector<index_t> calc_chunks(const index_t* triangles, index_t n_chunks);
+
+    void calc_neighbors();
+
+    void close_line(ChunkLocal& local) const;
+
+    void export_filled(index_t chunk, ChunkLocal& local, Output& output) const;
+    void export_lines(index_t chunk, ChunkLocal& local, Output& output) const;
+
+    // Trace contours that start on boundaries, and boundaries that lie wholly between the levels.
+    void find_boundary_lines(Context& context, index_t chunk, ChunkLocal& local) const;
+    void find_boundary_lines_filled(Context& context, index_t chunk, ChunkLocal& local) const;
+
+    void find_interior_lines(
+        Context& context, index_t chunk, bool on_upper, ChunkLocal& local) const;
+
+    // Follow boundary of chunk from the end of the contour line that reached it at tri and edge
+    // until another contour line starts, returning whether that is on the upper level.
+    bool follow_boundary(
+        Context& context, index_t& tri, int& edge, bool on_upper, ChunkLocal& local) const;
+
+    // Follow contour through interior of chunk starting at edge of tri.  Stops when it reaches a
+    // boundary if end_on_boundary, otherwise when it returns to a visited triangle.
+    void follow_interior(
+        Context& context, index_t& tri, int& edge, bool end_on_boundary, bool on_upper,
+        ChunkLocal& local) const;
+
+    // Edge by which a contour leaves tri, or -1 if it does not pass through it.
+    int get_exit_edge(const Context& context, index_t tri, bool on_upper) const;
+
+    index_t get_triangle_point(index_t tri, int edge) const;
+
+    void init_cache_grid(const bool* mask, const std::vector<index_t>& order);
+    void init_cache_levels(Context& context, index_t chunk) const;
+
+    void init_output(const Context& context, Output& output) const;
+
+    void march(Context& context, Output& output);
+    void march_chunk(Context& context, index_t chunk, ChunkLocal& local, Output& output) const;
+
+    // Move to the next boundary edge of the chunk around the end point of the current one.
+    void move_to_next_boundary_edge(const Context& context, index_t& tri, int& edge) const;
+
+    void release_context(std::unique_ptr<Context> context);
+
+    unsigned int z_to_zlevel(const Context& context, double z_value) const;
+
+
+    const double* _x;                   // Not owned.
+    const double* _y;
+    const double* _z;
+    const index_t _n_points;
+    const index_t _n_triangles;
+    const LineType _line_type;
+    const FillType _fill_type;
+    const ZInterp _z_interp;
+
+    std::vector<index_t> _triangles;    // 3 points of each triangle, anticlockwise.
+    std::vector<index_t> _neighbors;    // 3*tri + edge of neighbor across each edge, or -1.
+    std::vector<index_t> _chunk_starts; // First triangle of each chunk, plus n_triangles.
+    index_t _n_threads;
+
+    // Grid-invariant bits of each triangle, copied into the cache of each per-call Context.
+    std::vector<CacheItem> _cache;
+
+    // Per-call contexts that are not currently in use.
+    std::vector<std::unique_ptr<Context>> _contexts;
+    std::mutex _contexts_mutex;
+};
+
+#endif // CONTOURPY_TRI_H
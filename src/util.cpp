@@ -1,7 +1,61 @@
 #include "util.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
 #include <thread>
 
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+#define CONTOURPY_HUGE_PAGES 1
+static constexpr std::size_t huge_page_size = 2*1024*1024;
+#endif
+
+static std::atomic<bool> use_huge_pages(true);
+
+void* Util::allocate_large(std::size_t size)
+{
+    void* ptr = nullptr;
+
+#ifdef CONTOURPY_HUGE_PAGES
+    if (size >= huge_page_size && use_huge_pages.load(std::memory_order_relaxed)) {
+        // Round up to a whole number of huge pages so that the end of the array can use one too.
+        size = (size + huge_page_size - 1) & ~(huge_page_size - 1);
+        if (posix_memalign(&ptr, huge_page_size, size) != 0)
+            throw std::bad_alloc();
+
+        // Only advisory, if transparent huge pages are disabled this does nothing.
+        madvise(ptr, size, MADV_HUGEPAGE);
+        return ptr;
+    }
+#endif
+
+    if (size > 0) {
+        ptr = std::malloc(size);
+        if (ptr == nullptr)
+            throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void Util::free_large(void* ptr)
+{
+    std::free(ptr);
+}
+
+bool Util::get_huge_pages()
+{
+    return use_huge_pages.load(std::memory_order_relaxed);
+}
+
 index_t Util::get_max_threads()
 {
     return static_cast<index_t>(std::thread::hardware_concurrency());
 }
+
+void Util::set_huge_pages(bool huge_pages)
+{
+    use_huge_pages.store(huge_pages, std::memory_order_relaxed);
+}
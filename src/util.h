@@ -6,7 +6,20 @@
 class Util
 {
 public:
+    // Allocate memory for a large array such as the cache, throwing std::bad_alloc on failure.
+    // Where supported, allocations big enough to benefit are aligned to and advised to use
+    // transparent huge pages to reduce TLB misses, unless disabled using set_huge_pages.  Must be
+    // freed using free_large.
+    static void* allocate_large(std::size_t size);
+
+    static void free_large(void* ptr);
+
+    // Whether allocate_large uses huge pages, defaults to true.  Only affects later allocations.
+    static bool get_huge_pages();
+
     static index_t get_max_threads();
+
+    static void set_huge_pages(bool huge_pages);
 };
 
 #endif // CONTOURPY_UTIL_H
@@ -1,9 +1,10 @@
-#include "base_impl.h"
 #include "contour_generator.h"
 #include "fill_type.h"
 #include "line_type.h"
 #include "mpl2005.h"
 #include "mpl2014.h"
+#include "python_executor.h"
+#include "python_generator.h"
 #include "serial.h"
 #include "threaded.h"
 #include "util.h"
@@ -12,10 +13,48 @@
 #define STRINGIFY(x) #x
 #define MACRO_STRINGIFY(x) STRINGIFY(x)
 
-static LineType mpl20xx_line_type = LineType::SeparateCode;
-static FillType mpl20xx_fill_type = FillType::OuterCode;
+typedef PythonGenerator<Mpl2005ContourGenerator> PyMpl2005ContourGenerator;
+typedef PythonGenerator<mpl2014::Mpl2014ContourGenerator> PyMpl2014ContourGenerator;
+typedef PythonGenerator<SerialContourGenerator> PySerialContourGenerator;
+typedef PythonGenerator<ThreadedContourGenerator> PyThreadedContourGenerator;
 
-PYBIND11_MODULE(_contourpy, m) {
+// Call func(args...) on a background thread, returning a concurrent.futures.Future.
+template <typename... Args>
+static py::object submit_async(const py::object& func, Args... args)
+{
+    return py::module_::import("contourpy.async_util").attr("submit_async")(func, args...);
+}
+
+// Pickled state of a serial or threaded contour generator.  Includes the grid cache so that it
+// does not have to be recalculated when unpickled, and the mask and stats options.
+template <typename T>
+static py::tuple get_pickle_state(const T& cont_gen, index_t thread_count)
+{
+    return py::make_tuple(
+        cont_gen.get_grid(), cont_gen.get_chunk_size(), cont_gen.get_corner_mask(),
+        cont_gen.get_line_type(), cont_gen.get_fill_type(), cont_gen.get_quad_as_tri(),
+        cont_gen.get_z_interp(), thread_count, cont_gen.get_mask(), cont_gen.get_collect_stats(),
+        cont_gen.get_perf_counters());
+}
+
+static void check_pickle_state(const py::tuple& state)
+{
+    if (state.size() != 11)
+        throw std::runtime_error("Invalid pickled contour generator state");
+}
+
+// Set the options of an unpickled contour generator that are not constructor arguments.
+template <typename T>
+static void set_pickle_options(T* cont_gen, const py::tuple& state)
+{
+    cont_gen->set_collect_stats(state[9].cast<bool>());
+    cont_gen->set_perf_counters(state[10].cast<bool>());
+}
+
+// Declare that the module does not rely on the GIL, so that free-threaded Python does not
+// re-enable it on import.  Python objects are only ever created with the thread attached to the
+// interpreter, and calls of the mpl20xx generators, which are not reentrant, are serialised.
+PYBIND11_MODULE(_contourpy, m, py::mod_gil_not_used()) {
     m.doc() =
         "C++11 extension module wrapped using `pybind11`_.\n\n"
         ".. note::\n"
@@ -60,12 +99,45 @@ PYBIND11_MODULE(_contourpy, m) {
         .value("Log", ZInterp::Log)
         .export_values();
 
+    m.def("get_huge_pages", &Util::get_huge_pages,
+        "Return whether the caches of ContourGenerators created from now on are allocated using "
+        "transparent huge pages, see :func:`~contourpy.set_huge_pages`.");
+
     m.def("max_threads", &Util::get_max_threads,
         "Return the maximum number of threads, obtained from "
         "``std::thread::hardware_concurrency()``.\n\n"
         "This is the number of threads used by a multithreaded ContourGenerator if the kwarg "
         "``threads=0`` is passed to :func:`~contourpy.contour_generator`.");
 
+    m.def("set_executor",
+        [](const py::object& executor) {
+            if (executor.is_none())
+                Executor::set_default(nullptr);
+            else
+                Executor::set_default(std::make_shared<PythonExecutor>(executor));
+        },
+        py::arg("executor"),
+        "Set the executor used by all multithreaded ContourGenerators to run their chunk tasks.\n\n"
+        "Args:\n"
+        "    executor (concurrent.futures.Executor or None): Object with a ``submit(fn)`` method "
+        "that returns a future with ``cancel()`` and ``result()`` methods, such as a "
+        "``concurrent.futures.ThreadPoolExecutor``. If ``None`` the internal thread pool that is "
+        "shared by all multithreaded ContourGenerators is used, which is the default.\n\n"
+        "The thread that calls :meth:`~contourpy.ContourGenerator.lines` or "
+        ":meth:`~contourpy.ContourGenerator.filled` also runs one of the chunk tasks, and tasks "
+        "that have not started by the time it has finished are cancelled.");
+
+    m.def("set_huge_pages", &Util::set_huge_pages, py::arg("huge_pages"),
+        "Set whether the caches of ContourGenerators created from now on are allocated using "
+        "transparent huge pages.\n\n"
+        "Args:\n"
+        "    huge_pages (bool): If ``True``, which is the default, caches of 2 MB or more are "
+        "aligned to a huge page boundary and the kernel is advised to back them with transparent "
+        "huge pages, reducing TLB misses for large grids. If ``False`` they are allocated using "
+        "``malloc``.\n\n"
+        "This only has an effect on Linux, and only if transparent huge pages are enabled in "
+        "``madvise`` or ``always`` mode. It does not affect existing ContourGenerators.");
+
     py::class_<ContourGenerator>(m, "ContourGenerator",
         "Abstract base class for contour generator classes, defining the interface that they all "
         "implement.")
@@ -84,6 +156,19 @@ PYBIND11_MODULE(_contourpy, m) {
             "Return:\n"
             "    Filled contour polygons as one or more sequences of numpy arrays. The exact "
             "format is determined by the ``fill_type`` used by the ``ContourGenerator``.")
+        .def("filled_async",
+            [](const py::object& self, double lower_level, double upper_level) {
+                return submit_async(self.attr("filled"), lower_level, upper_level);
+            },
+            py::arg("lower_level"), py::arg("upper_level"),
+            "Start calculating filled contours between two levels on a background thread.\n\n"
+            "Args:\n"
+            "    lower_level (float): Lower z-level of the filled contours.\n"
+            "    upper_level (float): Upper z-level of the filled contours.\n\n"
+            "Return:\n"
+            "    ``concurrent.futures.Future`` whose result is the same as that returned by "
+            ":meth:`~contourpy.ContourGenerator.filled`. It can be awaited in ``asyncio`` code "
+            "using ``asyncio.wrap_future``.")
         .def("lines", [](double level) {return py::make_tuple();},
             "Calculate and return contour lines at a particular level.\n\n"
             "Args:\n"
@@ -92,6 +177,18 @@ PYBIND11_MODULE(_contourpy, m) {
             "    Contour lines (open line strips and closed line loops) as one or more sequences "
             "of numpy arrays. The exact format is determined by the ``line_type`` used by the "
             "``ContourGenerator``.")
+        .def("lines_async",
+            [](const py::object& self, double level) {
+                return submit_async(self.attr("lines"), level);
+            },
+            py::arg("level"),
+            "Start calculating contour lines at a particular level on a background thread.\n\n"
+            "Args:\n"
+            "    level (float): z-level to calculate contours at.\n\n"
+            "Return:\n"
+            "    ``concurrent.futures.Future`` whose result is the same as that returned by "
+            ":meth:`~contourpy.ContourGenerator.lines`. It can be awaited in ``asyncio`` code "
+            "using ``asyncio.wrap_future``.")
         .def_property_readonly(
             "chunk_count", [](py::object /* self */) {return py::make_tuple(1, 1);},
             "Return tuple of (y, x) chunk counts.")
@@ -142,12 +239,13 @@ PYBIND11_MODULE(_contourpy, m) {
             "Return whether this algorithm supports ``z_interp`` values other than "
             "``ZInterp.Linear`` which all support.");
 
-    py::class_<Mpl2005ContourGenerator, ContourGenerator>(m, "Mpl2005ContourGenerator",
+    py::class_<PyMpl2005ContourGenerator, ContourGenerator>(m, "Mpl2005ContourGenerator",
         "ContourGenerator corresponding to ``name=\"mpl2005\"``.\n\n"
         "This is the original 2005 Matplotlib algorithm. "
-        "Does not support any of ``corner_mask``, ``quad_as_tri``, ``threads`` or ``z_interp``. "
-        "Only supports ``line_type=LineType.SeparateCode`` and ``fill_type=FillType.OuterCode``. "
-        "Only supports chunking for filled contours, not contour lines.\n\n"
+        "Supports ``threads``, does not support ``corner_mask``, ``quad_as_tri`` or ``z_interp``. "
+        "Supports ``line_type`` of ``LineType.SeparateCode`` and the ``ChunkCombined`` types, and "
+        "``fill_type`` of ``FillType.OuterCode`` and the ``ChunkCombined`` types. "
+        "Each chunk is traced independently so contour lines are split at chunk boundaries.\n\n"
         ".. warning::\n"
         "   This algorithm is in ``contourpy`` for historic comparison. No new features or bug "
         "fixes will be added to it, except for security-related bug fixes.")
@@ -155,6 +253,9 @@ PYBIND11_MODULE(_contourpy, m) {
                       const CoordinateArray&,
                       const CoordinateArray&,
                       const MaskArray&,
+                      LineType,
+                      FillType,
+                      index_t,
                       index_t,
                       index_t>(),
              py::arg("x"),
@@ -162,37 +263,60 @@ PYBIND11_MODULE(_contourpy, m) {
              py::arg("z"),
              py::arg("mask"),
              py::kw_only(),
+             py::arg("line_type") = LineType::SeparateCode,
+             py::arg("fill_type") = FillType::OuterCode,
              py::arg("x_chunk_size") = 0,
-             py::arg("y_chunk_size") = 0)
-        .def("create_contour", &Mpl2005ContourGenerator::lines,
+             py::arg("y_chunk_size") = 0,
+             py::arg("thread_count") = 0)
+        .def("create_contour", &PyMpl2005ContourGenerator::lines,
             "Synonym for :func:`~contourpy.Mpl2005ContourGenerator.lines` to provide backward "
             "compatibility with Matplotlib.")
-        .def("create_filled_contour", &Mpl2005ContourGenerator::filled,
+        .def("create_filled_contour", &PyMpl2005ContourGenerator::filled,
             "Synonym for :func:`~contourpy.Mpl2005ContourGenerator.filled` to provide backward "
             "compatibility with Matplotlib.")
-        .def("filled", &Mpl2005ContourGenerator::filled)
-        .def("lines", &Mpl2005ContourGenerator::lines)
-        .def_property_readonly("chunk_count", &Mpl2005ContourGenerator::get_chunk_count)
-        .def_property_readonly("chunk_size", &Mpl2005ContourGenerator::get_chunk_size)
-        .def_property_readonly("fill_type", [](py::object /* self */) {return mpl20xx_fill_type;})
-        .def_property_readonly("line_type", [](py::object /* self */) {return mpl20xx_line_type;})
-        .def_property_readonly_static(
-            "default_fill_type", [](py::object /* self */) {return mpl20xx_fill_type;})
-        .def_property_readonly_static(
-            "default_line_type", [](py::object /* self */) {return mpl20xx_line_type;})
-        .def_static(
-            "supports_fill_type", [](FillType fill_type) {return fill_type == mpl20xx_fill_type;})
-        .def_static(
-            "supports_line_type", [](LineType line_type) {return line_type == mpl20xx_line_type;});
+        .def("filled", &PyMpl2005ContourGenerator::filled)
+        .def("lines", &PyMpl2005ContourGenerator::lines)
+        .def("multi_filled", &PyMpl2005ContourGenerator::filled_levels,
+            py::arg("levels"),
+            "Calculate and return filled contours between each pair of consecutive levels.\n\n"
+            "The levels are contoured together chunk by chunk, which is faster than calling "
+            ":func:`~contourpy.Mpl2005ContourGenerator.filled` for each pair of levels.\n\n"
+            "Args:\n"
+            "    levels (array-like of floats): Increasing z-levels, at least 2 of them.\n\n"
+            "Return:\n"
+            "    List containing the filled contours between each pair of consecutive levels, "
+            "in the format determined by the ``fill_type``.")
+        .def("multi_lines", &PyMpl2005ContourGenerator::lines_levels,
+            py::arg("levels"),
+            "Calculate and return contour lines at each of a sequence of levels.\n\n"
+            "The levels are contoured together chunk by chunk, which is faster than calling "
+            ":func:`~contourpy.Mpl2005ContourGenerator.lines` for each level.\n\n"
+            "Args:\n"
+            "    levels (array-like of floats): z-levels to calculate contours at.\n\n"
+            "Return:\n"
+            "    List containing the contour lines at each level, in the format determined by "
+            "the ``line_type``.")
+        .def_property_readonly("chunk_count", &PyMpl2005ContourGenerator::get_chunk_count)
+        .def_property_readonly("chunk_size", &PyMpl2005ContourGenerator::get_chunk_size)
+        .def_property_readonly("fill_type", &PyMpl2005ContourGenerator::get_fill_type)
+        .def_property_readonly("line_type", &PyMpl2005ContourGenerator::get_line_type)
+        .def_property_readonly("thread_count", &PyMpl2005ContourGenerator::get_thread_count)
+        .def_property_readonly_static("default_fill_type", [](py::object /* self */) {
+            return PyMpl2005ContourGenerator::default_fill_type();})
+        .def_property_readonly_static("default_line_type", [](py::object /* self */) {
+            return PyMpl2005ContourGenerator::default_line_type();})
+        .def_static("supports_fill_type", &PyMpl2005ContourGenerator::supports_fill_type)
+        .def_static("supports_line_type", &PyMpl2005ContourGenerator::supports_line_type)
+        .def_static("supports_threads", []() {return true;});
 
-    py::class_<mpl2014::Mpl2014ContourGenerator, ContourGenerator>(m, "Mpl2014ContourGenerator",
+    py::class_<PyMpl2014ContourGenerator, ContourGenerator>(m, "Mpl2014ContourGenerator",
         "ContourGenerator corresponding to ``name=\"mpl2014\"``.\n\n"
         "This is the 2014 Matplotlib algorithm, a replacement of the original 2005 algorithm that "
         "added ``corner_mask`` and made the code more maintainable. "
         "Only supports ``corner_mask``, does not support ``quad_as_tri``, ``threads`` or "
         "``z_interp``. \n"
-        "Only supports ``line_type=LineType.SeparateCode`` and "
-        "``fill_type=FillType.OuterCode``.\n\n"
+        "Supports ``line_type`` of ``LineType.SeparateCode`` and the ``ChunkCombined`` types, and "
+        "``fill_type`` of ``FillType.OuterCode`` and the ``ChunkCombined`` types.\n\n"
         ".. warning::\n"
         "   This algorithm is in ``contourpy`` for historic comparison. No new features or bug "
         "fixes will be added to it, except for security-related bug fixes.")
@@ -201,6 +325,8 @@ PYBIND11_MODULE(_contourpy, m) {
                       const CoordinateArray&,
                       const MaskArray&,
                       bool,
+                      LineType,
+                      FillType,
                       index_t,
                       index_t>(),
              py::arg("x"),
@@ -209,32 +335,32 @@ PYBIND11_MODULE(_contourpy, m) {
              py::arg("mask"),
              py::kw_only(),
              py::arg("corner_mask"),
+             py::arg("line_type") = LineType::SeparateCode,
+             py::arg("fill_type") = FillType::OuterCode,
              py::arg("x_chunk_size") = 0,
              py::arg("y_chunk_size") = 0)
-        .def("create_contour", &mpl2014::Mpl2014ContourGenerator::lines,
+        .def("create_contour", &PyMpl2014ContourGenerator::lines,
             "Synonym for :func:`~contourpy.Mpl2014ContourGenerator.lines` to provide backward "
             "compatibility with Matplotlib.")
-        .def("create_filled_contour", &mpl2014::Mpl2014ContourGenerator::filled,
+        .def("create_filled_contour", &PyMpl2014ContourGenerator::filled,
             "Synonym for :func:`~contourpy.Mpl2014ContourGenerator.filled` to provide backward "
             "compatibility with Matplotlib.")
-        .def("filled", &mpl2014::Mpl2014ContourGenerator::filled)
-        .def("lines", &mpl2014::Mpl2014ContourGenerator::lines)
-        .def_property_readonly("chunk_count", &mpl2014::Mpl2014ContourGenerator::get_chunk_count)
-        .def_property_readonly("chunk_size", &mpl2014::Mpl2014ContourGenerator::get_chunk_size)
-        .def_property_readonly("corner_mask", &mpl2014::Mpl2014ContourGenerator::get_corner_mask)
-        .def_property_readonly("fill_type", [](py::object /* self */) {return mpl20xx_fill_type;})
-        .def_property_readonly("line_type", [](py::object /* self */) {return mpl20xx_line_type;})
-        .def_property_readonly_static(
-            "default_fill_type", [](py::object /* self */) {return mpl20xx_fill_type;})
-        .def_property_readonly_static(
-            "default_line_type", [](py::object /* self */) {return mpl20xx_line_type;})
+        .def("filled", &PyMpl2014ContourGenerator::filled)
+        .def("lines", &PyMpl2014ContourGenerator::lines)
+        .def_property_readonly("chunk_count", &PyMpl2014ContourGenerator::get_chunk_count)
+        .def_property_readonly("chunk_size", &PyMpl2014ContourGenerator::get_chunk_size)
+        .def_property_readonly("corner_mask", &PyMpl2014ContourGenerator::get_corner_mask)
+        .def_property_readonly("fill_type", &PyMpl2014ContourGenerator::get_fill_type)
+        .def_property_readonly("line_type", &PyMpl2014ContourGenerator::get_line_type)
+        .def_property_readonly_static("default_fill_type", [](py::object /* self */) {
+            return PyMpl2014ContourGenerator::default_fill_type();})
+        .def_property_readonly_static("default_line_type", [](py::object /* self */) {
+            return PyMpl2014ContourGenerator::default_line_type();})
         .def_static("supports_corner_mask", []() {return true;})
-        .def_static(
-            "supports_fill_type", [](FillType fill_type) {return fill_type == mpl20xx_fill_type;})
-        .def_static(
-            "supports_line_type", [](LineType line_type) {return line_type == mpl20xx_line_type;});
+        .def_static("supports_fill_type", &PyMpl2014ContourGenerator::supports_fill_type)
+        .def_static("supports_line_type", &PyMpl2014ContourGenerator::supports_line_type);
 
-    py::class_<SerialContourGenerator, ContourGenerator>(m, "SerialContourGenerator",
+    py::class_<PySerialContourGenerator, ContourGenerator>(m, "SerialContourGenerator",
         "ContourGenerator corresponding to ``name=\"serial\"``, the default algorithm for "
         "``contourpy``.\n\n"
         "Supports ``corner_mask``, ``quad_as_tri`` and ``z_interp`` but not ``threads``. "
@@ -262,29 +388,90 @@ PYBIND11_MODULE(_contourpy, m) {
              py::arg("z_interp"),
              py::arg("x_chunk_size") = 0,
              py::arg("y_chunk_size") = 0)
-        .def("_write_cache", &SerialContourGenerator::write_cache)
-        .def("create_contour", &SerialContourGenerator::lines)
-        .def("create_filled_contour", &SerialContourGenerator::filled)
-        .def("filled", &SerialContourGenerator::filled)
-        .def("lines", &SerialContourGenerator::lines)
-        .def_property_readonly("chunk_count", &SerialContourGenerator::get_chunk_count)
-        .def_property_readonly("chunk_size", &SerialContourGenerator::get_chunk_size)
-        .def_property_readonly("corner_mask", &SerialContourGenerator::get_corner_mask)
-        .def_property_readonly("fill_type", &SerialContourGenerator::get_fill_type)
-        .def_property_readonly("line_type", &SerialContourGenerator::get_line_type)
-        .def_property_readonly("quad_as_tri", &SerialContourGenerator::get_quad_as_tri)
-        .def_property_readonly("z_interp", &SerialContourGenerator::get_z_interp)
+        .def(py::init<const CoordinateArray&,
+                      const CoordinateArray&,
+                      const CoordinateArray&,
+                      const MaskArray&,
+                      bool,
+                      LineType,
+                      FillType,
+                      bool,
+                      ZInterp,
+                      index_t,
+                      index_t,
+                      const CacheArray&>(),
+             py::arg("x"),
+             py::arg("y"),
+             py::arg("z"),
+             py::arg("mask"),
+             py::kw_only(),
+             py::arg("corner_mask"),
+             py::arg("line_type"),
+             py::arg("fill_type"),
+             py::arg("quad_as_tri"),
+             py::arg("z_interp"),
+             py::arg("x_chunk_size") = 0,
+             py::arg("y_chunk_size") = 0,
+             py::arg("grid_cache"))
+        .def(py::pickle(
+            [](const PySerialContourGenerator& self) {return get_pickle_state(self, 1);},
+            [](const py::tuple& state) {
+                check_pickle_state(state);
+                auto grid = state[0].cast<py::tuple>();
+                auto chunk_size = state[1].cast<py::tuple>();
+                std::unique_ptr<PySerialContourGenerator> cont_gen(new PySerialContourGenerator(
+                    grid[0].cast<CoordinateArray>(), grid[1].cast<CoordinateArray>(),
+                    grid[2].cast<CoordinateArray>(), state[8].cast<MaskArray>(),
+                    state[2].cast<bool>(), state[3].cast<LineType>(), state[4].cast<FillType>(),
+                    state[5].cast<bool>(), state[6].cast<ZInterp>(),
+                    chunk_size[1].cast<index_t>(), chunk_size[0].cast<index_t>(),
+                    grid[3].cast<CacheArray>()));
+                set_pickle_options(cont_gen.get(), state);
+                return cont_gen.release();
+            }))
+        .def("_filled_fields", &PySerialContourGenerator::filled_fields)
+        .def("_get_grid", &PySerialContourGenerator::get_grid)
+        .def("_get_mask", &PySerialContourGenerator::get_mask)
+        .def("_lines_fields", &PySerialContourGenerator::lines_fields)
+        .def("_write_cache", &PySerialContourGenerator::write_cache)
+        .def("create_contour", &PySerialContourGenerator::lines)
+        .def("create_filled_contour", &PySerialContourGenerator::filled)
+        .def("filled", &PySerialContourGenerator::filled)
+        .def("get_last_call_stats", &PySerialContourGenerator::get_last_call_stats,
+            "Return the stats of the most recent call that collected them, or ``None``.\n\n"
+            "Stats are only collected whilst :attr:`collect_stats` is ``True``, see "
+            ":ref:`call_stats`.")
+        .def("get_last_call_trace", &PySerialContourGenerator::get_last_call_trace,
+            "Return the timeline of the most recent call that collected stats as a Chrome trace "
+            "JSON string, or ``None``.\n\n"
+            "The string can be written to a file and opened in Perfetto, see :ref:`call_stats`.")
+        .def("lines", &PySerialContourGenerator::lines)
+        .def_property_readonly("chunk_count", &PySerialContourGenerator::get_chunk_count)
+        .def_property_readonly("chunk_size", &PySerialContourGenerator::get_chunk_size)
+        .def_property("collect_stats", &PySerialContourGenerator::get_collect_stats,
+            &PySerialContourGenerator::set_collect_stats,
+            "Whether calls collect timings and counts for :meth:`get_last_call_stats`, default "
+            "``False``.")
+        .def_property_readonly("corner_mask", &PySerialContourGenerator::get_corner_mask)
+        .def_property_readonly("fill_type", &PySerialContourGenerator::get_fill_type)
+        .def_property_readonly("line_type", &PySerialContourGenerator::get_line_type)
+        .def_property("perf_counters", &PySerialContourGenerator::get_perf_counters,
+            &PySerialContourGenerator::set_perf_counters,
+            "Whether calls that collect stats also collect hardware performance counters, "
+            "default ``False``. Only available on Linux.")
+        .def_property_readonly("quad_as_tri", &PySerialContourGenerator::get_quad_as_tri)
+        .def_property_readonly("z_interp", &PySerialContourGenerator::get_z_interp)
         .def_property_readonly_static("default_fill_type", [](py::object /* self */) {
-            return SerialContourGenerator::default_fill_type();})
+            return PySerialContourGenerator::default_fill_type();})
         .def_property_readonly_static("default_line_type", [](py::object /* self */) {
-            return SerialContourGenerator::default_line_type();})
+            return PySerialContourGenerator::default_line_type();})
         .def_static("supports_corner_mask", []() {return true;})
-        .def_static("supports_fill_type", &SerialContourGenerator::supports_fill_type)
-        .def_static("supports_line_type", &SerialContourGenerator::supports_line_type)
+        .def_static("supports_fill_type", &PySerialContourGenerator::supports_fill_type)
+        .def_static("supports_line_type", &PySerialContourGenerator::supports_line_type)
         .def_static("supports_quad_as_tri", []() {return true;})
         .def_static("supports_z_interp", []() {return true;});
 
-    py::class_<ThreadedContourGenerator, ContourGenerator>(m, "ThreadedContourGenerator",
+    py::class_<PyThreadedContourGenerator, ContourGenerator>(m, "ThreadedContourGenerator",
         "ContourGenerator corresponding to ``name=\"threaded\"``, the multithreaded version of "
         ":class:`~contourpy._contourpy.SerialContourGenerator`.\n\n"
         "Supports ``corner_mask``, ``quad_as_tri`` and ``z_interp`` and ``threads``. "
@@ -314,31 +501,142 @@ PYBIND11_MODULE(_contourpy, m) {
              py::arg("x_chunk_size") = 0,
              py::arg("y_chunk_size") = 0,
              py::arg("thread_count") = 0)
-        .def("_write_cache", &ThreadedContourGenerator::write_cache)
-        .def("create_contour", &ThreadedContourGenerator::lines,
+        .def(py::init<const CoordinateArray&,
+                      const CoordinateArray&,
+                      const CoordinateArray&,
+                      const MaskArray&,
+                      bool,
+                      LineType,
+                      FillType,
+                      bool,
+                      ZInterp,
+                      index_t,
+                      index_t,
+                      index_t,
+                      const CacheArray&>(),
+             py::arg("x"),
+             py::arg("y"),
+             py::arg("z"),
+             py::arg("mask"),
+             py::kw_only(),
+             py::arg("corner_mask"),
+             py::arg("line_type"),
+             py::arg("fill_type"),
+             py::arg("quad_as_tri"),
+             py::arg("z_interp"),
+             py::arg("x_chunk_size") = 0,
+             py::arg("y_chunk_size") = 0,
+             py::arg("thread_count") = 0,
+             py::arg("grid_cache"))
+        .def(py::pickle(
+            [](const PyThreadedContourGenerator& self) {
+                return get_pickle_state(self, self.get_thread_count());
+            },
+            [](const py::tuple& state) {
+                check_pickle_state(state);
+                auto grid = state[0].cast<py::tuple>();
+                auto chunk_size = state[1].cast<py::tuple>();
+                std::unique_ptr<PyThreadedContourGenerator> cont_gen(
+                    new PyThreadedContourGenerator(
+                        grid[0].cast<CoordinateArray>(), grid[1].cast<CoordinateArray>(),
+                        grid[2].cast<CoordinateArray>(), state[8].cast<MaskArray>(),
+                        state[2].cast<bool>(), state[3].cast<LineType>(),
+                        state[4].cast<FillType>(), state[5].cast<bool>(), state[6].cast<ZInterp>(),
+                        chunk_size[1].cast<index_t>(), chunk_size[0].cast<index_t>(),
+                        state[7].cast<index_t>(), grid[3].cast<CacheArray>()));
+                set_pickle_options(cont_gen.get(), state);
+                return cont_gen.release();
+            }))
+        .def("_filled_fields", &PyThreadedContourGenerator::filled_fields)
+        .def("_get_grid", &PyThreadedContourGenerator::get_grid)
+        .def("_get_mask", &PyThreadedContourGenerator::get_mask)
+        .def("_lines_fields", &PyThreadedContourGenerator::lines_fields)
+        .def("_write_cache", &PyThreadedContourGenerator::write_cache)
+        .def("create_contour", &PyThreadedContourGenerator::lines,
             "Synonym for :func:`~contourpy.ThreadedContourGenerator.lines` to provide backward "
             "compatibility with Matplotlib.")
-        .def("create_filled_contour", &ThreadedContourGenerator::filled,
+        .def("create_filled_contour", &PyThreadedContourGenerator::filled,
             "Synonym for :func:`~contourpy.ThreadedContourGenerator.filled` to provide backward "
             "compatibility with Matplotlib.")
-        .def("filled", &ThreadedContourGenerator::filled)
-        .def("lines", &ThreadedContourGenerator::lines)
-        .def_property_readonly("chunk_count", &ThreadedContourGenerator::get_chunk_count)
-        .def_property_readonly("chunk_size", &ThreadedContourGenerator::get_chunk_size)
-        .def_property_readonly("corner_mask", &ThreadedContourGenerator::get_corner_mask)
-        .def_property_readonly("fill_type", &ThreadedContourGenerator::get_fill_type)
-        .def_property_readonly("line_type", &ThreadedContourGenerator::get_line_type)
-        .def_property_readonly("quad_as_tri", &ThreadedContourGenerator::get_quad_as_tri)
-        .def_property_readonly("thread_count", &ThreadedContourGenerator::get_thread_count)
-        .def_property_readonly("z_interp", &ThreadedContourGenerator::get_z_interp)
+        .def("filled", &PyThreadedContourGenerator::filled)
+        .def("get_last_call_stats", &PyThreadedContourGenerator::get_last_call_stats,
+            "Return the stats of the most recent call that collected them, or ``None``.\n\n"
+            "Stats are only collected whilst :attr:`collect_stats` is ``True``, see "
+            ":ref:`call_stats`.")
+        .def("get_last_call_trace", &PyThreadedContourGenerator::get_last_call_trace,
+            "Return the timeline of the most recent call that collected stats as a Chrome trace "
+            "JSON string, or ``None``.\n\n"
+            "The string can be written to a file and opened in Perfetto, see :ref:`call_stats`.")
+        .def("lines", &PyThreadedContourGenerator::lines)
+        .def_property_readonly("chunk_count", &PyThreadedContourGenerator::get_chunk_count)
+        .def_property_readonly("chunk_size", &PyThreadedContourGenerator::get_chunk_size)
+        .def_property("collect_stats", &PyThreadedContourGenerator::get_collect_stats,
+            &PyThreadedContourGenerator::set_collect_stats,
+            "Whether calls collect timings and counts for :meth:`get_last_call_stats`, default "
+            "``False``.")
+        .def_property_readonly("corner_mask", &PyThreadedContourGenerator::get_corner_mask)
+        .def_property_readonly("fill_type", &PyThreadedContourGenerator::get_fill_type)
+        .def_property_readonly("line_type", &PyThreadedContourGenerator::get_line_type)
+        .def_property("perf_counters", &PyThreadedContourGenerator::get_perf_counters,
+            &PyThreadedContourGenerator::set_perf_counters,
+            "Whether calls that collect stats also collect hardware performance counters, "
+            "default ``False``. Only available on Linux.")
+        .def_property_readonly("quad_as_tri", &PyThreadedContourGenerator::get_quad_as_tri)
+        .def_property_readonly("thread_count", &PyThreadedContourGenerator::get_thread_count)
+        .def_property_readonly("z_interp", &PyThreadedContourGenerator::get_z_interp)
         .def_property_readonly_static("default_fill_type", [](py::object /* self */) {
-            return ThreadedContourGenerator::default_fill_type();})
+            return PyThreadedContourGenerator::default_fill_type();})
         .def_property_readonly_static("default_line_type", [](py::object /* self */) {
-            return ThreadedContourGenerator::default_line_type();})
+            return PyThreadedContourGenerator::default_line_type();})
         .def_static("supports_corner_mask", []() {return true;})
-        .def_static("supports_fill_type", &ThreadedContourGenerator::supports_fill_type)
-        .def_static("supports_line_type", &ThreadedContourGenerator::supports_line_type)
+        .def_static("supports_fill_type", &PyThreadedContourGenerator::supports_fill_type)
+        .def_static("supports_line_type", &PyThreadedContourGenerator::supports_line_type)
         .def_static("supports_quad_as_tri", []() {return true;})
         .def_static("supports_threads", []() {return true;})
         .def_static("supports_z_interp", []() {return true;});
+
+    py::class_<PythonTriContourGenerator>(m, "TriContourGenerator",
+        "Contour generator of an unstructured triangular mesh, created using "
+        ":func:`~contourpy.tri_contour_generator`.\n\n"
+        "The mesh is divided into spatially compact chunks of triangles that may be contoured by "
+        "multiple threads. Supports ``z_interp`` and all options for ``line_type`` and "
+        "``fill_type``.")
+        .def(py::init<const CoordinateArray&,
+                      const CoordinateArray&,
+                      const TriangleArray&,
+                      const CoordinateArray&,
+                      const MaskArray&,
+                      LineType,
+                      FillType,
+                      ZInterp,
+                      index_t,
+                      index_t>(),
+             py::arg("x"),
+             py::arg("y"),
+             py::arg("triangles"),
+             py::arg("z"),
+             py::arg("mask"),
+             py::kw_only(),
+             py::arg("line_type"),
+             py::arg("fill_type"),
+             py::arg("z_interp"),
+             py::arg("chunk_count") = 1,
+             py::arg("thread_count") = 1)
+        .def("filled", &PythonTriContourGenerator::filled,
+            "Calculate and return filled contours between two levels.")
+        .def("lines", &PythonTriContourGenerator::lines,
+            "Calculate and return contour lines at a particular level.")
+        .def_property_readonly("chunk_count", &PythonTriContourGenerator::get_chunk_count)
+        .def_property_readonly("fill_type", &PythonTriContourGenerator::get_fill_type)
+        .def_property_readonly("line_type", &PythonTriContourGenerator::get_line_type)
+        .def_property_readonly("point_count", &PythonTriContourGenerator::get_point_count)
+        .def_property_readonly("thread_count", &PythonTriContourGenerator::get_thread_count)
+        .def_property_readonly("triangle_count", &PythonTriContourGenerator::get_triangle_count)
+        .def_property_readonly("z_interp", &PythonTriContourGenerator::get_z_interp)
+        .def_property_readonly_static("default_fill_type", [](py::object /* self */) {
+            return PythonTriContourGenerator::default_fill_type();})
+        .def_property_readonly_static("default_line_type", [](py::object /* self */) {
+            return PythonTriContourGenerator::default_line_type();})
+        .def_static("supports_fill_type", &PythonTriContourGenerator::supports_fill_type)
+        .def_static("supports_line_type", &PythonTriContourGenerator::supports_line_type);
 }
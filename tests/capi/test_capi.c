@@ -0,0 +1,553 @@
+/* Tests of the C API of the contourpy core library, run using ctest. */
+
+#include "contourpy.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#define NX 31
+#define NY 23
+#define N_FIELDS 3
+
+static int failures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            ++failures; \
+        } \
+    } while (0)
+
+static double x[NY*NX], y[NY*NX], z[NY*NX];
+static double fields[N_FIELDS][NY*NX];
+static bool mask[NY*NX];
+static ptrdiff_t triangles[2*(NY-1)*(NX-1)*3];
+static bool tri_mask[2*(NY-1)*(NX-1)];
+
+static void init_grid(void)
+{
+    int i, j;
+    for (j = 0; j < NY; ++j) {
+        for (i = 0; i < NX; ++i) {
+            x[j*NX + i] = i;
+            y[j*NX + i] = j;
+            z[j*NX + i] = sin(0.3*i)*cos(0.4*j);
+            mask[j*NX + i] = (i == 7 && j == 5);
+            fields[0][j*NX + i] = z[j*NX + i];
+            fields[1][j*NX + i] = 0.5*z[j*NX + i] + 0.1;
+            fields[2][j*NX + i] = cos(0.2*i + 0.1*j);
+        }
+    }
+
+    /* Two triangles per quad, alternating the diagonal. */
+    for (j = 0; j < NY-1; ++j) {
+        for (i = 0; i < NX-1; ++i) {
+            ptrdiff_t sw = j*NX + i, se = sw + 1, nw = sw + NX, ne = nw + 1;
+            ptrdiff_t* tri = &triangles[6*(j*(NX-1) + i)];
+            if ((i + j) % 2 == 0) {
+                tri[0] = sw; tri[1] = se; tri[2] = ne;
+                tri[3] = sw; tri[4] = ne; tri[5] = nw;
+            }
+            else {
+                tri[0] = sw; tri[1] = se; tri[2] = nw;
+                tri[3] = se; tri[4] = ne; tri[5] = nw;
+            }
+            tri_mask[2*(j*(NX-1) + i)] = (i == 7 && j == 5);
+        }
+    }
+}
+
+/* Total number of points of all arrays of a result. */
+static size_t total_points(const contourpy_result* result)
+{
+    size_t total = 0, count, i;
+    for (i = 0; i < contourpy_result_array_count(result); ++i) {
+        contourpy_result_points(result, i, &count);
+        total += count;
+    }
+    return total;
+}
+
+/* Return total number of points of contour lines. */
+static size_t test_lines(contourpy_algorithm algorithm, int line_type)
+{
+    contourpy_options options;
+    contourpy_generator* generator;
+    contourpy_result* result;
+    size_t i, point_count, count, total;
+
+    contourpy_options_init(&options);
+    options.algorithm = algorithm;
+    options.line_type = line_type;
+    if (algorithm == CONTOURPY_MPL2005 || algorithm == CONTOURPY_MPL2014)
+        options.fill_type = 201;
+    options.x_chunk_size = 10;
+    options.y_chunk_size = 8;
+    options.thread_count = 2;
+    generator = contourpy_generator_create(x, y, z, mask, NX, NY, &options);
+    CHECK(generator != NULL);
+    if (generator == NULL)
+        return 0;
+
+    result = contourpy_lines(generator, 0.25);
+    CHECK(result != NULL);
+    CHECK(contourpy_result_list_count(result) == (line_type == 101 ? 1 : 2));
+    total = total_points(result);
+
+    for (i = 0; i < contourpy_result_array_count(result); ++i) {
+        const double* points = contourpy_result_points(result, i, &point_count);
+        const uint32_t* offsets = contourpy_result_offsets(result, i, &count);
+        if (line_type == 104 && points != NULL) {
+            CHECK(offsets != NULL && offsets[0] == 0 && offsets[count-1] == point_count);
+        }
+        else
+            CHECK(offsets == NULL && count == 0);
+    }
+
+    CHECK(contourpy_result_points(result, contourpy_result_array_count(result), &count) == NULL);
+    CHECK(strstr(contourpy_last_error(), "out of range") != NULL);
+
+    contourpy_result_destroy(result);
+    contourpy_generator_destroy(generator);
+    return total;
+}
+
+/* Return total number of points of filled contours. */
+static size_t test_filled(contourpy_algorithm algorithm, int fill_type)
+{
+    contourpy_options options;
+    contourpy_generator* generator;
+    contourpy_result* result;
+    ptrdiff_t ny_chunks, nx_chunks;
+    size_t i, point_count, count, total;
+
+    contourpy_options_init(&options);
+    options.algorithm = algorithm;
+    options.fill_type = fill_type;
+    if (algorithm == CONTOURPY_MPL2005 || algorithm == CONTOURPY_MPL2014)
+        options.line_type = 102;
+    options.x_chunk_size = 10;
+    options.y_chunk_size = 8;
+    generator = contourpy_generator_create(x, y, z, mask, NX, NY, &options);
+    CHECK(generator != NULL);
+    if (generator == NULL)
+        return 0;
+
+    CHECK(contourpy_generator_chunk_count(generator, &ny_chunks, &nx_chunks) == 0);
+    CHECK(ny_chunks == 3 && nx_chunks == 3);
+
+    result = contourpy_filled(generator, -0.2, 0.4);
+    CHECK(result != NULL);
+    CHECK(contourpy_result_list_count(result) == (fill_type >= 205 ? 3 : 2));
+    if (fill_type >= 203)
+        CHECK(contourpy_result_array_count(result) == (size_t)(ny_chunks*nx_chunks));
+    total = total_points(result);
+
+    for (i = 0; i < contourpy_result_array_count(result); ++i) {
+        const double* points = contourpy_result_points(result, i, &point_count);
+        const uint8_t* codes = contourpy_result_codes(result, i, &count);
+        const uint32_t* offsets;
+        if (points == NULL)
+            continue;
+        CHECK(point_count > 0);
+        if (fill_type == 201 || fill_type == 203 || fill_type == 205)
+            CHECK(codes != NULL && count == point_count && codes[0] == 1 &&
+                  codes[count-1] == 79);
+        else {
+            offsets = contourpy_result_offsets(result, i, &count);
+            CHECK(offsets != NULL && offsets[0] == 0);
+        }
+        if (fill_type >= 205) {
+            offsets = contourpy_result_outer_offsets(result, i, &count);
+            CHECK(offsets != NULL && count >= 2 && offsets[0] == 0);
+        }
+    }
+
+    contourpy_result_destroy(result);
+    contourpy_generator_destroy(generator);
+    return total;
+}
+
+/* Whether two results contain identical arrays. */
+static int same_results(const contourpy_result* a, const contourpy_result* b)
+{
+    size_t i, count_a, count_b;
+    const void *array_a, *array_b;
+
+    if (contourpy_result_list_count(a) != contourpy_result_list_count(b) ||
+        contourpy_result_array_count(a) != contourpy_result_array_count(b))
+        return 0;
+
+#define SAME_ARRAYS(func, size) \
+    array_a = func(a, i, &count_a); \
+    array_b = func(b, i, &count_b); \
+    if (count_a != count_b || (count_a > 0 && memcmp(array_a, array_b, count_a*(size)) != 0)) \
+        return 0;
+
+    for (i = 0; i < contourpy_result_array_count(a); ++i) {
+        SAME_ARRAYS(contourpy_result_points, 2*sizeof(double))
+        SAME_ARRAYS(contourpy_result_codes, sizeof(uint8_t))
+        SAME_ARRAYS(contourpy_result_offsets, sizeof(uint32_t))
+        SAME_ARRAYS(contourpy_result_outer_offsets, sizeof(uint32_t))
+    }
+#undef SAME_ARRAYS
+    return 1;
+}
+
+/* Arrays of the separate line and fill types of multithreaded generators are in the order that
+ * the threads finish their chunks, so only the numbers of arrays and points of those are compared. */
+static int same_contents(const contourpy_result* a, const contourpy_result* b, int unordered)
+{
+    if (!unordered)
+        return same_results(a, b);
+    return contourpy_result_list_count(a) == contourpy_result_list_count(b) &&
+           contourpy_result_array_count(a) == contourpy_result_array_count(b) &&
+           total_points(a) == total_points(b);
+}
+
+/* Contouring multiple fields at once gives the same results as contouring them separately. */
+static void test_fields(contourpy_algorithm algorithm, int line_type, int fill_type)
+{
+    const double* zs[N_FIELDS];
+    contourpy_options options;
+    contourpy_generator *generator, *separate;
+    contourpy_result *lines[N_FIELDS], *filled[N_FIELDS], *result;
+    int field, threaded = (algorithm == CONTOURPY_THREADED);
+
+    contourpy_options_init(&options);
+    options.algorithm = algorithm;
+    options.line_type = line_type;
+    options.fill_type = fill_type;
+    options.x_chunk_size = 10;
+    options.y_chunk_size = 8;
+    options.thread_count = 2;
+    generator = contourpy_generator_create(x, y, z, mask, NX, NY, &options);
+    CHECK(generator != NULL);
+    if (generator == NULL)
+        return;
+
+    for (field = 0; field < N_FIELDS; ++field)
+        zs[field] = fields[field];
+    CHECK(contourpy_lines_fields(generator, 0.25, zs, N_FIELDS, lines) == 0);
+    CHECK(contourpy_filled_fields(generator, -0.2, 0.4, zs, N_FIELDS, filled) == 0);
+
+    for (field = 0; field < N_FIELDS; ++field) {
+        separate = contourpy_generator_create(x, y, zs[field], mask, NX, NY, &options);
+
+        result = contourpy_lines(separate, 0.25);
+        CHECK(same_contents(lines[field], result, threaded && line_type <= 102));
+        contourpy_result_destroy(result);
+        contourpy_result_destroy(lines[field]);
+
+        result = contourpy_filled(separate, -0.2, 0.4);
+        CHECK(same_contents(filled[field], result, threaded && fill_type <= 202));
+        contourpy_result_destroy(result);
+        contourpy_result_destroy(filled[field]);
+
+        contourpy_generator_destroy(separate);
+    }
+
+    /* The generator's own z is unaffected. */
+    result = contourpy_lines(generator, 0.25);
+    CHECK(result != NULL && total_points(result) > 0);
+    contourpy_result_destroy(result);
+
+    CHECK(contourpy_filled_fields(generator, 0.4, -0.2, zs, N_FIELDS, filled) == -1);
+    CHECK(strstr(contourpy_last_error(), "wrong way round") != NULL);
+
+    contourpy_generator_destroy(generator);
+}
+
+/* Fields are checked to be positive where not masked if using ZInterp.Log, as is z. */
+static void test_fields_log(contourpy_algorithm algorithm)
+{
+    static double positive[NY*NX], invalid[NY*NX];
+    const double* zs[2] = {positive, invalid};
+    contourpy_options options;
+    contourpy_generator* generator;
+    contourpy_result* results[2];
+    int i;
+
+    for (i = 0; i < NY*NX; ++i)
+        positive[i] = invalid[i] = z[i] + 2.0;
+    positive[5*NX + 7] = 0.0;  /* Masked. */
+    invalid[3*NX + 4] = 0.0;
+
+    contourpy_options_init(&options);
+    options.algorithm = algorithm;
+    options.z_interp = 2;
+    generator = contourpy_generator_create(x, y, positive, mask, NX, NY, &options);
+    CHECK(generator != NULL);
+    if (generator == NULL)
+        return;
+
+    CHECK(contourpy_lines_fields(generator, 2.0, zs, 1, results) == 0);
+    contourpy_result_destroy(results[0]);
+
+    CHECK(contourpy_lines_fields(generator, 2.0, zs, 2, results) == -1);
+    CHECK(strstr(contourpy_last_error(), "must be positive if using ZInterp.Log") != NULL);
+    CHECK(contourpy_filled_fields(generator, 1.5, 2.5, zs, 2, results) == -1);
+    CHECK(strstr(contourpy_last_error(), "must be positive if using ZInterp.Log") != NULL);
+
+    contourpy_generator_destroy(generator);
+}
+
+/* Sum of signed areas of filled polygons, which are anticlockwise and holes clockwise. */
+static double filled_area(const contourpy_result* result)
+{
+    double area = 0.0;
+    size_t i, j, k, point_count, count;
+    for (i = 0; i < contourpy_result_array_count(result); ++i) {
+        const double* points = contourpy_result_points(result, i, &point_count);
+        const uint32_t* offsets = contourpy_result_offsets(result, i, &count);
+        for (j = 0; j + 1 < count; ++j)
+            for (k = offsets[j]; k + 1 < offsets[j+1]; ++k)
+                area += 0.5*(points[2*k]*points[2*k+3] - points[2*k+2]*points[2*k+1]);
+    }
+    return area;
+}
+
+static void test_tri(int line_type, int fill_type)
+{
+    const ptrdiff_t n_triangles = 2*(NY-1)*(NX-1);
+    contourpy_options options;
+    contourpy_generator *serial, *threaded, *single;
+    contourpy_result *a, *b;
+    ptrdiff_t ny_chunks, nx_chunks;
+
+    contourpy_options_init(&options);
+    options.line_type = line_type;
+    options.fill_type = fill_type;
+    serial = contourpy_tri_generator_create(
+        x, y, NX*NY, triangles, n_triangles, z, tri_mask, 4, &options);
+    single = contourpy_tri_generator_create(
+        x, y, NX*NY, triangles, n_triangles, z, tri_mask, 1, &options);
+    options.algorithm = CONTOURPY_THREADED;
+    options.thread_count = 2;
+    threaded = contourpy_tri_generator_create(
+        x, y, NX*NY, triangles, n_triangles, z, tri_mask, 4, &options);
+    CHECK(serial != NULL && single != NULL && threaded != NULL);
+    if (serial == NULL || single == NULL || threaded == NULL)
+        return;
+
+    CHECK(contourpy_generator_chunk_count(threaded, &ny_chunks, &nx_chunks) == 0);
+    CHECK(ny_chunks == 1 && nx_chunks == 4);
+
+    /* Chunks are the same whether they are traced by one thread or more. */
+    a = contourpy_lines(serial, 0.25);
+    b = contourpy_lines(threaded, 0.25);
+    CHECK(a != NULL && total_points(a) > 0 && same_contents(a, b, line_type <= 102));
+    contourpy_result_destroy(a);
+    contourpy_result_destroy(b);
+
+    a = contourpy_filled(serial, -0.2, 0.4);
+    b = contourpy_filled(threaded, -0.2, 0.4);
+    CHECK(a != NULL && total_points(a) > 0 && same_contents(a, b, fill_type <= 202));
+    contourpy_result_destroy(a);
+    contourpy_result_destroy(b);
+
+    /* Filled area does not depend on chunking, and between levels that enclose all of z it is
+     * the area of the unmasked triangles. */
+    if (fill_type == 202 || fill_type == 204) {
+        a = contourpy_filled(serial, -0.2, 0.4);
+        b = contourpy_filled(single, -0.2, 0.4);
+        CHECK(fabs(filled_area(a) - filled_area(b)) < 1e-9);
+        contourpy_result_destroy(a);
+        contourpy_result_destroy(b);
+
+        a = contourpy_filled(threaded, -2.0, 2.0);
+        CHECK(fabs(filled_area(a) - ((NX-1)*(NY-1) - 0.5)) < 1e-9);
+        contourpy_result_destroy(a);
+    }
+
+    contourpy_generator_destroy(serial);
+    contourpy_generator_destroy(single);
+    contourpy_generator_destroy(threaded);
+}
+
+static void test_mpl2005_threads(int line_type, int fill_type)
+{
+    contourpy_options options;
+    contourpy_generator *single, *threaded;
+    contourpy_result *a, *b;
+
+    contourpy_options_init(&options);
+    options.algorithm = CONTOURPY_MPL2005;
+    options.line_type = line_type;
+    options.fill_type = fill_type;
+    options.x_chunk_size = 10;
+    options.y_chunk_size = 8;
+    options.thread_count = 1;
+    single = contourpy_generator_create(x, y, z, mask, NX, NY, &options);
+    options.thread_count = 2;
+    threaded = contourpy_generator_create(x, y, z, mask, NX, NY, &options);
+    CHECK(single != NULL && threaded != NULL);
+    if (single == NULL || threaded == NULL)
+        return;
+
+    /* Chunks are traced independently so the results do not depend on the number of threads. */
+    a = contourpy_lines(single, 0.25);
+    b = contourpy_lines(threaded, 0.25);
+    CHECK(a != NULL && total_points(a) > 0 && same_results(a, b));
+    contourpy_result_destroy(a);
+    contourpy_result_destroy(b);
+
+    a = contourpy_filled(single, -0.2, 0.4);
+    b = contourpy_filled(threaded, -0.2, 0.4);
+    CHECK(a != NULL && total_points(a) > 0 && same_results(a, b));
+    contourpy_result_destroy(a);
+    contourpy_result_destroy(b);
+
+    contourpy_generator_destroy(single);
+    contourpy_generator_destroy(threaded);
+}
+
+static void test_mpl2005_levels(int line_type, int fill_type)
+{
+    double levels[4] = {-0.2, 0.1, 0.25, 0.4};
+    contourpy_options options;
+    contourpy_generator* generator;
+    contourpy_result *results[4], *expected;
+    int i;
+
+    contourpy_options_init(&options);
+    options.algorithm = CONTOURPY_MPL2005;
+    options.line_type = line_type;
+    options.fill_type = fill_type;
+    options.x_chunk_size = 10;
+    options.y_chunk_size = 8;
+    options.thread_count = 2;
+    generator = contourpy_generator_create(x, y, z, mask, NX, NY, &options);
+    CHECK(generator != NULL);
+    if (generator == NULL)
+        return;
+
+    /* Same results as contouring each level separately. */
+    CHECK(contourpy_lines_levels(generator, levels, 4, results) == 0);
+    for (i = 0; i < 4; ++i) {
+        expected = contourpy_lines(generator, levels[i]);
+        CHECK(same_results(results[i], expected));
+        contourpy_result_destroy(expected);
+        contourpy_result_destroy(results[i]);
+    }
+
+    CHECK(contourpy_filled_levels(generator, levels, 4, results) == 0);
+    for (i = 0; i < 3; ++i) {
+        expected = contourpy_filled(generator, levels[i], levels[i+1]);
+        CHECK(total_points(expected) > 0 && same_results(results[i], expected));
+        contourpy_result_destroy(expected);
+        contourpy_result_destroy(results[i]);
+    }
+
+    levels[3] = 0.0;
+    CHECK(contourpy_filled_levels(generator, levels, 4, results) == -1);
+    CHECK(strcmp(contourpy_last_error(), "levels must be increasing") == 0);
+
+    contourpy_generator_destroy(generator);
+}
+
+static void test_errors(void)
+{
+    const double* zs[1] = {z};
+    contourpy_options options;
+    contourpy_generator* generator;
+    contourpy_result* result;
+
+    CHECK(contourpy_generator_create(x, y, z, NULL, 1, NY, NULL) == NULL);
+    CHECK(strstr(contourpy_last_error(), "at least 2x2") != NULL);
+
+    contourpy_options_init(&options);
+    options.algorithm = CONTOURPY_MPL2014;
+    CHECK(contourpy_generator_create(x, y, z, NULL, NX, NY, &options) == NULL);
+    CHECK(strcmp(contourpy_last_error(), "Unsupported LineType") == 0);
+
+    contourpy_options_init(&options);
+    options.line_type = 999;
+    CHECK(contourpy_generator_create(x, y, z, NULL, NX, NY, &options) == NULL);
+    CHECK(strcmp(contourpy_last_error(), "Unsupported LineType") == 0);
+
+    CHECK(contourpy_lines(NULL, 0.0) == NULL);
+    CHECK(strcmp(contourpy_last_error(), "generator is NULL") == 0);
+
+    contourpy_options_init(&options);
+    options.algorithm = CONTOURPY_MPL2014;
+    options.line_type = 102;
+    options.fill_type = 201;
+    generator = contourpy_generator_create(x, y, z, NULL, NX, NY, &options);
+    CHECK(contourpy_lines_fields(generator, 0.0, zs, 1, &result) == -1);
+    CHECK(strstr(contourpy_last_error(), "does not support multiple fields") != NULL);
+    CHECK(contourpy_lines_levels(generator, zs[0], 1, &result) == -1);
+    CHECK(strstr(contourpy_last_error(), "does not support multiple levels") != NULL);
+    contourpy_generator_destroy(generator);
+
+    CHECK(contourpy_tri_generator_create(
+        x, y, NX*NY, triangles, 2*(NY-1)*(NX-1), z, NULL, 1, &options) == NULL);
+    CHECK(strstr(contourpy_last_error(), "Unsupported algorithm") != NULL);
+
+    triangles[1] = NX*NY;
+    CHECK(contourpy_tri_generator_create(
+        x, y, NX*NY, triangles, 2*(NY-1)*(NX-1), z, NULL, 1, NULL) == NULL);
+    CHECK(strstr(contourpy_last_error(), "in the range") != NULL);
+    triangles[1] = 1;
+}
+
+int main(void)
+{
+    contourpy_algorithm mpl20xx[2] = {CONTOURPY_MPL2005, CONTOURPY_MPL2014};
+    size_t expected_total;
+    int line_type, fill_type, i;
+
+    init_grid();
+
+    /* All line types contain the same points. */
+    expected_total = test_lines(CONTOURPY_SERIAL, 101);
+    CHECK(expected_total > 0);
+    for (line_type = 101; line_type <= 104; ++line_type) {
+        CHECK(test_lines(CONTOURPY_SERIAL, line_type) == expected_total);
+        CHECK(test_lines(CONTOURPY_THREADED, line_type) == expected_total);
+    }
+
+    for (fill_type = 201; fill_type <= 206; ++fill_type) {
+        test_filled(CONTOURPY_SERIAL, fill_type);
+        test_filled(CONTOURPY_THREADED, fill_type);
+    }
+
+    /* The ChunkCombined types of the mpl20xx algorithms contain the same points as their
+     * separate types. */
+    for (i = 0; i < 2; ++i) {
+        expected_total = test_lines(mpl20xx[i], 102);
+        CHECK(expected_total > 0);
+        for (line_type = 103; line_type <= 104; ++line_type)
+            CHECK(test_lines(mpl20xx[i], line_type) == expected_total);
+
+        expected_total = test_filled(mpl20xx[i], 201);
+        CHECK(expected_total > 0);
+        for (fill_type = 203; fill_type <= 206; ++fill_type)
+            CHECK(test_filled(mpl20xx[i], fill_type) == expected_total);
+    }
+
+    for (fill_type = 203; fill_type <= 206; ++fill_type) {
+        test_mpl2005_threads(fill_type <= 204 ? 103 : 104, fill_type);
+        test_mpl2005_levels(fill_type <= 204 ? 103 : 104, fill_type);
+    }
+
+    for (line_type = 101, fill_type = 201; fill_type <= 206; ++fill_type) {
+        test_fields(CONTOURPY_SERIAL, line_type, fill_type);
+        test_fields(CONTOURPY_THREADED, line_type, fill_type);
+        line_type = (line_type == 104) ? 101 : line_type + 1;
+    }
+    test_fields_log(CONTOURPY_SERIAL);
+    test_fields_log(CONTOURPY_THREADED);
+
+    for (line_type = 101, fill_type = 201; fill_type <= 206; ++fill_type) {
+        test_tri(line_type, fill_type);
+        line_type = (line_type == 104) ? 101 : line_type + 1;
+    }
+
+    test_errors();
+
+    if (failures > 0)
+        fprintf(stderr, "%d checks failed\n", failures);
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,149 @@
+from time import perf_counter
+
+import numpy as np
+import pytest
+
+from contourpy import FillType, LineType, contour_generator
+from contourpy.band import banded_filled, banded_lines
+from contourpy.util.data import random, simple
+
+from .util_test import (
+    canonical_filled, canonical_lines, filled_area, line_segments, offsets_from_codes,
+)
+
+
+@pytest.mark.parametrize("name", ["serial", "mpl2014"])
+@pytest.mark.parametrize("band_size", [1, 7, 100])
+@pytest.mark.parametrize("corner_mask", [False, True])
+def test_banded_lines(name, band_size, corner_mask):
+    x, y, z = random((43, 37), mask_fraction=0.05)
+    levels = [0.2, 0.5, 0.8]
+    cont_gen = contour_generator(x, y, z, name=name, corner_mask=corner_mask,
+                                 line_type=LineType.SeparateCode)
+    result = banded_lines(z, levels, x=x, y=y, band_size=band_size, name=name,
+                          corner_mask=corner_mask)
+    assert len(result) == len(levels)
+    for lines, level in zip(result, levels):
+        assert canonical_lines(lines) == canonical_lines(cont_gen.lines(level)[0])
+
+
+@pytest.mark.parametrize("name", ["serial", "mpl2014"])
+@pytest.mark.parametrize("band_size", [1, 7, 100])
+@pytest.mark.parametrize("corner_mask", [False, True])
+def test_banded_filled(name, band_size, corner_mask):
+    x, y, z = random((43, 37), mask_fraction=0.05)
+    levels = [0.2, 0.5, 0.8]
+    cont_gen = contour_generator(x, y, z, name=name, corner_mask=corner_mask,
+                                 fill_type=FillType.OuterCode)
+    result = banded_filled(z, levels, x=x, y=y, band_size=band_size, name=name,
+                           corner_mask=corner_mask)
+    assert len(result) == len(levels) - 1
+    for (points, offsets), lower, upper in zip(result, levels[:-1], levels[1:]):
+        expected_points, expected_codes = cont_gen.filled(lower, upper)
+        assert canonical_filled(points, offsets) == \
+            canonical_filled(expected_points, offsets_from_codes(expected_codes))
+
+
+def test_banded_lines_through_grid_point():
+    # A line crosses the shared rows at a grid point that is exactly at the level, where the lines
+    # of a band are joined through a zero-length line of the next band.
+    z = np.array([[2, 1, 1, 0], [0, 0, 0, 0], [0, 2, 1, 2], [1, 1, 2, 2]], dtype=np.float64)
+    cont_gen = contour_generator(z=z, line_type=LineType.Separate)
+    lines = banded_lines(z, [1.0], band_size=1, line_type=LineType.Separate)[0]
+    expected = cont_gen.lines(1.0)
+    assert len(lines) == len(expected) == 2
+    assert line_segments(lines) == line_segments(expected)
+
+
+@pytest.mark.parametrize("band_size", [1, 2, 5])
+@pytest.mark.parametrize("seed", [1, 2, 3])
+def test_banded_integer_z(band_size, seed):
+    # Integer z and levels give contours through grid points and zero-area polygons.  At points on
+    # the boundary of the grid lines may be joined differently, so compare their segments.
+    z = np.random.default_rng(seed).integers(0, 4, (17, 13)).astype(np.float64)
+    cont_gen = contour_generator(z=z, line_type=LineType.Separate, fill_type=FillType.OuterOffset)
+    for level in [1.0, 2.0]:
+        lines = banded_lines(z, [level], band_size=band_size, line_type=LineType.Separate)[0]
+        assert line_segments(lines) == line_segments(cont_gen.lines(level))
+    levels = [0.5, 1.0, 2.0, 3.0]
+    result = banded_filled(z, levels, band_size=band_size)
+    for (points, offsets), lower, upper in zip(result, levels[:-1], levels[1:]):
+        expected = filled_area(*cont_gen.filled(lower, upper))
+        assert expected > 0.0
+        assert filled_area(points, offsets) == pytest.approx(expected)
+
+
+def test_banded_empty_bands():
+    # Bands without any contours.
+    z = np.zeros((11, 5))
+    z[7:] = 1.0
+    cont_gen = contour_generator(z=z, line_type=LineType.Separate, fill_type=FillType.OuterOffset)
+    lines = banded_lines(z, [0.5], band_size=2)[0]
+    assert line_segments(lines) == line_segments(cont_gen.lines(0.5))
+    points, offsets = banded_filled(z, [0.5, 2.0], band_size=2)[0]
+    assert filled_area(points, offsets) == pytest.approx(filled_area(*cont_gen.filled(0.5, 2.0)))
+    assert banded_filled(z, [2.0, 3.0], band_size=2)[0] == ([], [])
+
+
+def test_banded_scaling():
+    # Time taken grows with the number of grid points rather than with its square, as only the
+    # contours that cross the rows shared by bands are stitched together.
+    def best_time(n):
+        _, _, z = random((n, n), seed=2)
+        times = []
+        for _ in range(3):
+            start = perf_counter()
+            banded_lines(z, [0.5], band_size=50)
+            banded_filled(z, [0.3, 0.6], band_size=50)
+            times.append(perf_counter() - start)
+        return min(times)
+
+    # 16 times the grid points.
+    assert best_time(600) < 50*best_time(150)
+
+
+def test_banded_memmap_and_callable(tmp_path):
+    _, _, z = simple((50, 30))
+    ny, nx = z.shape
+    filename = tmp_path / "z.f8"
+    z.tofile(filename)
+    memmap = np.memmap(filename, dtype=np.float64, mode="r", shape=z.shape)
+
+    calls = []
+
+    def read_rows(start, stop):
+        calls.append((start, stop))
+        return z[start:stop]
+
+    x = np.linspace(-1.0, 1.0, nx)
+    y = np.linspace(0.0, 2.0, ny)
+    cont_gen = contour_generator(x, y, z, fill_type=FillType.OuterCode,
+                                 line_type=LineType.SeparateCode)
+    for z_arg, shape in ((memmap, None), (read_rows, z.shape)):
+        lines = banded_lines(z_arg, [0.5], x=x, y=y, shape=shape, band_size=10,
+                             line_type=LineType.SeparateCode)[0]
+        expected = cont_gen.lines(0.5)
+        assert canonical_lines(lines[0]) == canonical_lines(expected[0])
+        assert sorted(map(tuple, lines[1])) == sorted(map(tuple, expected[1]))
+
+        points, codes = banded_filled(z_arg, [0.0, 0.5], x=x, y=y, shape=shape, band_size=10,
+                                      fill_type=FillType.OuterCode)[0]
+        expected = cont_gen.filled(0.0, 0.5)
+        assert canonical_filled(points, offsets_from_codes(codes)) == \
+            canonical_filled(expected[0], offsets_from_codes(expected[1]))
+
+    assert calls == [(0, 11), (10, 21), (20, 31), (30, 41), (40, 50)]*2
+
+
+def test_banded_invalid():
+    z = np.zeros((3, 4))
+    with pytest.raises(ValueError, match="shape must be specified if z is a callable"):
+        banded_lines(lambda start, stop: z[start:stop], [0.5])
+    with pytest.raises(ValueError, match="band_size must be a positive integer"):
+        banded_lines(z, [0.5], band_size=0)
+    with pytest.raises(ValueError, match="chunk_size cannot be used with bands"):
+        banded_filled(z, [0.0, 0.5], chunk_size=2)
+    with pytest.raises(ValueError, match="banded_lines does not support line_type"):
+        banded_lines(z, [0.5], line_type=LineType.ChunkCombinedOffset)
+    with pytest.raises(ValueError, match="banded_filled does not support fill_type"):
+        banded_filled(z, [0.0, 0.5], fill_type=FillType.ChunkCombinedCode)
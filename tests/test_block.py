@@ -0,0 +1,135 @@
+import pickle
+
+import numpy as np
+import pytest
+
+from contourpy import FillType, LineType, contour_generator
+from contourpy.block import (
+    block_filled, block_lines, block_slices, merge_filled, merge_lines,
+)
+from contourpy.stitch import _format_filled, stitch_filled
+from contourpy.util.data import random
+
+from .util_test import (
+    canonical_filled, canonical_lines, filled_area, line_segments, offsets_from_codes,
+)
+
+
+@pytest.mark.parametrize("chunk_count", [1, 2, (3, 5)])
+@pytest.mark.parametrize("corner_mask", [False, True])
+def test_block_lines(chunk_count, corner_mask):
+    x, y, z = random((43, 37), mask_fraction=0.05)
+    levels = [0.2, 0.5, 0.8]
+    blocks = [block_lines(z[s], levels, x=x[s], y=y[s], offset=offset, corner_mask=corner_mask)
+              for offset, s in block_slices(z.shape, chunk_count=chunk_count)]
+    # Block results are sent between processes in distributed execution.
+    blocks = pickle.loads(pickle.dumps(blocks))
+
+    cont_gen = contour_generator(x, y, z, corner_mask=corner_mask,
+                                 line_type=LineType.SeparateCode)
+    result = merge_lines(blocks, line_type=LineType.SeparateCode)
+    assert len(result) == len(levels)
+    for (lines, codes), level in zip(result, levels):
+        assert len(codes) == len(lines)
+        assert canonical_lines(lines) == canonical_lines(cont_gen.lines(level)[0])
+
+
+@pytest.mark.parametrize("chunk_count", [1, 2, (3, 5)])
+@pytest.mark.parametrize("corner_mask", [False, True])
+def test_block_filled(chunk_count, corner_mask):
+    x, y, z = random((43, 37), mask_fraction=0.05)
+    levels = [0.2, 0.5, 0.8]
+    blocks = [block_filled(z[s], levels, x=x[s], y=y[s], offset=offset, corner_mask=corner_mask)
+              for offset, s in block_slices(z.shape, chunk_count=chunk_count)]
+
+    cont_gen = contour_generator(x, y, z, corner_mask=corner_mask, fill_type=FillType.OuterCode)
+    result = merge_filled(blocks)
+    assert len(result) == len(levels) - 1
+    for (points, offsets), lower, upper in zip(result, levels[:-1], levels[1:]):
+        expected_points, expected_codes = cont_gen.filled(lower, upper)
+        assert canonical_filled(points, offsets) == \
+            canonical_filled(expected_points, offsets_from_codes(expected_codes))
+
+
+def test_stitch_filled_without_seam_points():
+    # Points on the shared boundaries are found by comparing all points of the outer boundaries.
+    x, y, z = random((43, 37), mask_fraction=0.05)
+    blocks = [block_filled(z[s], [0.2, 0.5], x=x[s], y=y[s], offset=offset)
+              for offset, s in block_slices(z.shape, chunk_count=(3, 5))]
+    points, offsets = _format_filled(
+        stitch_filled([block.contours[0] for block in blocks]), FillType.OuterOffset)
+    expected = contour_generator(x, y, z, fill_type=FillType.OuterOffset).filled(0.2, 0.5)
+    assert canonical_filled(points, offsets) == canonical_filled(*expected)
+
+
+@pytest.mark.parametrize("transpose", [False, True])
+def test_block_lines_through_grid_point(transpose):
+    # A line crosses the shared rows or columns at a grid point that is exactly at the level, where
+    # the lines of a block are joined through a zero-length line of the next block.
+    z = np.array([[2, 1, 1, 0], [0, 0, 0, 0], [0, 2, 1, 2], [1, 1, 2, 2]], dtype=np.float64)
+    chunk_size = (1, 3)
+    if transpose:
+        z = z.T
+        chunk_size = (3, 1)
+    blocks = [block_lines(z[s], [1.0], offset=offset)
+              for offset, s in block_slices(z.shape, chunk_size=chunk_size)]
+    lines = merge_lines(blocks)[0]
+    expected = contour_generator(z=z, line_type=LineType.Separate).lines(1.0)
+    assert len(lines) == len(expected) == 2
+    assert line_segments(lines) == line_segments(expected)
+
+
+@pytest.mark.parametrize("chunk_count", [2, (3, 5), (16, 12)])
+@pytest.mark.parametrize("seed", [1, 2, 3])
+def test_block_integer_z(chunk_count, seed):
+    # Integer z and levels give contours through grid points and zero-area polygons.  At points on
+    # the boundary of the grid lines may be joined differently, so compare their segments.
+    z = np.random.default_rng(seed).integers(0, 4, (17, 13)).astype(np.float64)
+    slices = block_slices(z.shape, chunk_count=chunk_count)
+    cont_gen = contour_generator(z=z, line_type=LineType.Separate, fill_type=FillType.OuterOffset)
+    blocks = [block_lines(z[s], [1.0, 2.0], offset=offset) for offset, s in slices]
+    for lines, level in zip(merge_lines(blocks), [1.0, 2.0]):
+        assert line_segments(lines) == line_segments(cont_gen.lines(level))
+    levels = [0.5, 1.0, 2.0, 3.0]
+    blocks = [block_filled(z[s], levels, offset=offset) for offset, s in slices]
+    for (points, offsets), lower, upper in zip(merge_filled(blocks), levels[:-1], levels[1:]):
+        expected = filled_area(*cont_gen.filled(lower, upper))
+        assert expected > 0.0
+        assert filled_area(points, offsets) == pytest.approx(expected)
+
+
+def test_block_slices():
+    slices = block_slices((5, 8), chunk_size=(2, 3))
+    assert [offset for offset, _ in slices] == [
+        (0, 0), (0, 3), (0, 6), (2, 0), (2, 3), (2, 6)]
+    assert slices[4][1] == (slice(2, 5), slice(3, 7))
+    assert slices[5][1] == (slice(2, 5), slice(6, 8))
+    assert block_slices((5, 8)) == [((0, 0), (slice(0, 5), slice(0, 8)))]
+
+
+def test_block_crossings():
+    # Single line crossing the boundary between two blocks along column 2.
+    z = np.array([[0.0, 0.0, 0.0, 0.0, 0.0], [1.0, 1.0, 1.0, 1.0, 1.0]])
+    west, east = [block_lines(z[s], [0.5], offset=offset)
+                  for offset, s in block_slices(z.shape, chunk_size=(1, 2))]
+    assert west.offset == (0, 0)
+    assert east.offset == (0, 2)
+    assert west.shape == east.shape == (2, 3)
+    # Columns are line, start/end, row/column and row/column index.
+    np.testing.assert_array_equal(west.crossings[0], [[0, 0, 1, 0], [0, 1, 1, 2]])
+    np.testing.assert_array_equal(east.crossings[0], [[0, 0, 1, 2], [0, 1, 1, 4]])
+
+    lines = merge_lines([west, east])[0]
+    assert len(lines) == 1
+    np.testing.assert_allclose(lines[0], [[0.0, 0.5], [1.0, 0.5], [2.0, 0.5], [3.0, 0.5],
+                                          [4.0, 0.5]])
+
+
+def test_block_invalid():
+    z = np.zeros((3, 4))
+    with pytest.raises(ValueError, match="chunk_count cannot be used with blocks"):
+        block_lines(z, [0.5], chunk_count=2)
+    with pytest.raises(ValueError, match="All blocks must have been contoured at the same levels"):
+        merge_lines([block_lines(z, [0.5]), block_lines(z, [0.6])])
+    with pytest.raises(ValueError, match="merge_filled does not support fill_type"):
+        merge_filled([], fill_type=FillType.ChunkCombinedOffset)
@@ -257,8 +257,8 @@ def test_quad_as_tri(xyz_3x3_as_lists, name):
 
 @pytest.mark.parametrize("chunk_size", [0, 1, 2])
 @pytest.mark.parametrize("thread_count", [0, 1, 2])
-def test_thread_count(xyz_7x5_as_arrays, chunk_size, thread_count):
-    name = "threaded"
+@pytest.mark.parametrize("name", ["mpl2005", "threaded"])
+def test_thread_count(xyz_7x5_as_arrays, name, chunk_size, thread_count):
     x, y, z = xyz_7x5_as_arrays
     cont_gen = contourpy.contour_generator(
         x, y, z, name=name, chunk_size=chunk_size, thread_count=thread_count)
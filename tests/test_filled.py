@@ -411,6 +411,22 @@ def test_return_by_fill_type(two_outers_one_hole, name, fill_type):
             assert_array_equal(outer_offsets, [0, 2, 3])
 
 
+@pytest.mark.parametrize("name", util_test.all_names())
+def test_filled_async(name):
+    x, y, z = random((30, 40), mask_fraction=0.05)
+    cont_gen = contour_generator(x, y, z, name=name, fill_type=FillType.OuterCode)
+    levels = [0.2, 0.5, 0.8]
+
+    futures = [cont_gen.filled_async(lower, upper) for lower, upper in zip(levels[:-1], levels[1:])]
+    for lower, upper, future in zip(levels[:-1], levels[1:], futures):
+        points, codes = future.result()
+        expected_points, expected_codes = cont_gen.filled(lower, upper)
+        assert len(points) == len(expected_points)
+        for i in range(len(points)):
+            assert_array_equal(points[i], expected_points[i])
+            assert_array_equal(codes[i], expected_codes[i])
+
+
 @pytest.mark.parametrize("name, fill_type", util_test.all_names_and_fill_types())
 @pytest.mark.parametrize("corner_mask", [None, False, True])
 def test_filled_random_big(name, fill_type, corner_mask):
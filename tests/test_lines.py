@@ -1,3 +1,5 @@
+import asyncio
+
 import numpy as np
 from numpy.testing import assert_allclose, assert_array_equal
 import pytest
@@ -317,9 +319,6 @@ def test_lines_random_no_corner_mask_chunk(name, line_type):
 
     from .image_comparison import compare_images
 
-    if name in ("mpl2005"):
-        pytest.skip()  # mpl2005 does not support chunks for lines.
-
     x, y, z = random((30, 40), mask_fraction=0.05)
     cont_gen = contour_generator(
         x, y, z, name=name, line_type=line_type, corner_mask=False, chunk_size=2)
@@ -427,6 +426,28 @@ def test_return_by_line_type(one_loop_one_strip, name, line_type):
         assert_array_equal(offsets, [0, 5, 7])
 
 
+@pytest.mark.parametrize("name", util_test.all_names())
+def test_lines_async(name):
+    x, y, z = random((30, 40), mask_fraction=0.05)
+    cont_gen = contour_generator(x, y, z, name=name, line_type=LineType.SeparateCode)
+    levels = [0.2, 0.5, 0.8]
+
+    futures = [cont_gen.lines_async(level) for level in levels]
+    for level, future in zip(levels, futures):
+        points, codes = future.result()
+        expected_points, expected_codes = cont_gen.lines(level)
+        assert len(points) == len(expected_points)
+        for i in range(len(points)):
+            assert_array_equal(points[i], expected_points[i])
+            assert_array_equal(codes[i], expected_codes[i])
+
+    async def lines_in_event_loop(level):
+        return await asyncio.wrap_future(cont_gen.lines_async(level))
+
+    points, _ = asyncio.run(lines_in_event_loop(0.5))
+    assert len(points) == len(cont_gen.lines(0.5)[0])
+
+
 @pytest.mark.parametrize("name, line_type", util_test.all_names_and_line_types())
 @pytest.mark.parametrize("corner_mask", [None, False, True])
 def test_lines_random_big(name, line_type, corner_mask):
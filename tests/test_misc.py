@@ -1,6 +1,18 @@
+from concurrent.futures import ThreadPoolExecutor
+import json
+import sys
+import sysconfig
+
 import numpy as np
+import pytest
 
-from contourpy import _remove_z_mask, max_threads
+from contourpy import (
+    FillType, LineType, SerialContourGenerator, ThreadedContourGenerator, _remove_z_mask,
+    contour_generator, get_huge_pages, max_threads, set_executor, set_huge_pages,
+)
+import contourpy.cost
+from contourpy.cost import choose_algorithm, estimate_points
+from contourpy.util.data import random, simple
 
 
 def test_max_threads():
@@ -9,6 +21,276 @@ def test_max_threads():
     assert n > 1
 
 
+def test_set_executor():
+    x, y, z = random((100, 100), seed=2213)
+    cont_gen = contour_generator(
+        x, y, z, name="threaded", fill_type=FillType.ChunkCombinedOffset, chunk_count=4,
+        thread_count=3)
+    expected = cont_gen.filled(0.3, 0.6)
+
+    with ThreadPoolExecutor(max_workers=2) as executor:
+        set_executor(executor)
+        try:
+            filled = cont_gen.filled(0.3, 0.6)
+        finally:
+            set_executor(None)
+
+    for i in range(2):
+        assert len(filled[i]) == len(expected[i])
+        for array, expected_array in zip(filled[i], expected[i]):
+            np.testing.assert_array_equal(array, expected_array)
+
+    with pytest.raises(ValueError, match="executor must have a submit method"):
+        set_executor(123)
+
+
+@pytest.mark.parametrize("name", ["serial", "threaded"])
+def test_set_huge_pages(name):
+    # Cache of 1000x1000 grid is large enough to use huge pages if they are enabled.
+    x, y, z = random((1000, 1000), seed=2477)
+    assert get_huge_pages()
+    expected = contour_generator(x, y, z, name=name).filled(0.4, 0.6)
+
+    set_huge_pages(False)
+    try:
+        assert not get_huge_pages()
+        filled = contour_generator(x, y, z, name=name).filled(0.4, 0.6)
+    finally:
+        set_huge_pages(True)
+    assert get_huge_pages()
+
+    for array, expected_array in zip(filled, expected):
+        np.testing.assert_array_equal(array, expected_array)
+
+
+@pytest.mark.parametrize("name", ["serial", "threaded"])
+def test_concurrent_calls(name):
+    # Concurrent calls on the same generator use separate per-call contexts.
+    x, y, z = random((200, 200), seed=1859)
+    cont_gen = contour_generator(
+        x, y, z, name=name, line_type=LineType.ChunkCombinedOffset, chunk_count=3)
+    levels = np.linspace(0.1, 0.9, 9)
+    expected = [cont_gen.lines(level) for level in levels]
+
+    with ThreadPoolExecutor(max_workers=4) as executor:
+        results = list(executor.map(cont_gen.lines, np.tile(levels, 4)))
+
+    for i, lines in enumerate(results):
+        for array_list, expected_array_list in zip(lines, expected[i % len(levels)]):
+            for array, expected_array in zip(array_list, expected_array_list):
+                np.testing.assert_array_equal(array, expected_array)
+
+
+@pytest.mark.parametrize("name", ["mpl2005", "mpl2014", "serial", "threaded"])
+def test_concurrent_generators(name):
+    # Different generators used from different Python threads, and concurrent calls on the same
+    # generator, which for mpl20xx are serialised.
+    x, y, z = random((100, 100), seed=2187)
+    cont_gens = [contour_generator(x, y, z*(i+1), name=name) for i in range(3)]
+    levels = np.linspace(0.1, 0.9, 9)
+    expected = [[cont_gen.lines(level) for level in levels] for cont_gen in cont_gens]
+
+    def contour_all_levels(cont_gen):
+        return [cont_gen.lines(level) for level in levels]
+
+    with ThreadPoolExecutor(max_workers=4) as executor:
+        results = list(executor.map(contour_all_levels, cont_gens*2))
+
+    for i, result in enumerate(results):
+        for lines, expected_lines in zip(result, expected[i % len(cont_gens)]):
+            for array_list, expected_array_list in zip(lines, expected_lines):
+                for array, expected_array in zip(array_list, expected_array_list):
+                    np.testing.assert_array_equal(array, expected_array)
+
+
+def test_mpl2005_threads():
+    # Chunks are traced independently so the number of threads does not change the results.
+    x, y, z = random((100, 100), mask_fraction=0.05, seed=2005)
+    kwargs = dict(
+        name="mpl2005", line_type=LineType.ChunkCombinedOffset,
+        fill_type=FillType.ChunkCombinedOffsetOffset, chunk_count=4)
+    cont_gen = contour_generator(x, y, z, thread_count=1, **kwargs)
+    cont_gen_threaded = contour_generator(x, y, z, thread_count=2, **kwargs)
+    assert cont_gen_threaded.thread_count == min(2, max_threads())
+
+    for expected, result in [
+        (cont_gen.lines(0.5), cont_gen_threaded.lines(0.5)),
+        (cont_gen.filled(0.3, 0.6), cont_gen_threaded.filled(0.3, 0.6)),
+    ]:
+        for array_list, expected_array_list in zip(result, expected):
+            for array, expected_array in zip(array_list, expected_array_list):
+                np.testing.assert_array_equal(array, expected_array)
+
+
+@pytest.mark.parametrize("name", ["serial", "threaded"])
+def test_call_stats(name):
+    x, y, z = random((100, 100), mask_fraction=0.05, seed=2070)
+    cont_gen = contour_generator(
+        x, y, z, name=name, fill_type=FillType.OuterCode, chunk_count=(2, 3))
+    assert cont_gen.collect_stats is False
+    cont_gen.filled(0.3, 0.6)
+    assert cont_gen.get_last_call_stats() is None
+
+    cont_gen.collect_stats = True
+    points, codes = cont_gen.filled(0.3, 0.6)
+    stats = cont_gen.get_last_call_stats()
+    assert stats["points"] == sum(len(p) for p in points)
+    assert stats["lines"] == sum(np.count_nonzero(c == 1) for c in codes)
+    assert stats["lines"] <= stats["starts"]
+    assert stats["holes"] > 0
+    assert stats["quads_visited"] > 0
+    assert stats["bytes_allocated"] > 16*stats["points"]
+    assert stats["chunk_times"].shape == (6,)
+    assert np.all(stats["chunk_times"] > 0.0)
+    for key in ["init_time", "trace_time", "export_time", "lock_wait_time"]:
+        assert 0.0 <= stats[key] <= stats["total_time"]
+
+    trace = json.loads(cont_gen.get_last_call_trace())
+    events = [event for event in trace["traceEvents"] if event["ph"] == "X"]
+    assert events[0]["name"] == "call"
+    for event_name in ["init", "trace", "export"]:
+        chunks = sorted(e["args"]["chunk"] for e in events if e["name"] == event_name)
+        # Stage 1 of serial is for the whole domain rather than chunk by chunk.
+        assert chunks == ([-1] if event_name == "init" and name == "serial" else list(range(6)))
+
+    # Stats of the last call that collected them are kept.
+    cont_gen.collect_stats = False
+    cont_gen.lines(0.5)
+    assert cont_gen.get_last_call_stats()["points"] == stats["points"]
+
+
+@pytest.mark.parametrize("name", ["serial", "threaded"])
+def test_perf_counters(name):
+    x, y, z = random((100, 100), seed=2072)
+    cont_gen = contour_generator(x, y, z, name=name, chunk_count=2)
+    cont_gen.collect_stats = True
+    cont_gen.lines(0.5)
+    assert cont_gen.get_last_call_stats()["counters"] is None
+
+    try:
+        cont_gen.perf_counters = True
+    except RuntimeError as e:
+        pytest.skip(str(e))
+    assert cont_gen.perf_counters is True
+
+    cont_gen.lines(0.5)
+    counters = cont_gen.get_last_call_stats()["counters"]
+    assert sorted(counters) == ["export", "init", "trace"]
+    for stage in ["init", "trace"]:
+        assert counters[stage]["cycles"] > 0
+        assert counters[stage]["instructions"] > 0
+        assert counters[stage]["cache_misses"] >= 0
+        assert counters[stage]["branch_misses"] >= 0
+
+
+@pytest.mark.parametrize("name", ["serial", "threaded"])
+def test_auto_tune(name, tmp_path, monkeypatch):
+    cache_path = tmp_path / "tune.json"
+    monkeypatch.setenv("CONTOURPY_TUNE_CACHE", str(cache_path))
+    x, y, z = random((60, 80), mask_fraction=0.05, seed=2073)
+
+    cont_gen = contour_generator(x, y, z, name=name, auto_tune=True)
+    with open(cache_path) as f:
+        cache = json.load(f)
+    assert len(cache) == 1
+    key, value = next(iter(cache.items()))
+    assert "60x80" in key
+    assert value[2] == cont_gen.thread_count
+    expected = contour_generator(x, y, z, name=name, chunk_size=tuple(value[:2]))
+    assert cont_gen.chunk_size == expected.chunk_size
+
+    # Later generators use the cached choice without repeating the trials.
+    cache[key] = [10, 20, 1]
+    with open(cache_path, "w") as f:
+        json.dump(cache, f)
+    cont_gen = contour_generator(x, y, z, name=name, auto_tune=True)
+    assert cont_gen.chunk_size == (10, 20)
+    assert cont_gen.thread_count == 1
+
+    # Different options are tuned separately.
+    contour_generator(x, y, z, name=name, auto_tune=True, corner_mask=False)
+    with open(cache_path) as f:
+        assert len(json.load(f)) == 2
+
+    with pytest.raises(ValueError, match="cannot be set if auto_tune=True"):
+        contour_generator(x, y, z, name=name, auto_tune=True, chunk_count=2)
+
+
+@pytest.mark.parametrize("thread_count", [0, 4])
+def test_auto_tune_tiny_grid(thread_count, tmp_path, monkeypatch):
+    # Grid with fewer quads than the requested threads.
+    monkeypatch.setenv("CONTOURPY_TUNE_CACHE", str(tmp_path / "tune.json"))
+    z = np.arange(6.0).reshape(2, 3)
+    cont_gen = contour_generator(z=z, name="threaded", auto_tune=True, thread_count=thread_count)
+    assert cont_gen.thread_count <= 2
+    assert cont_gen.chunk_count[0] == 1
+
+
+def test_name_auto(tmp_path, monkeypatch):
+    # Few quads with smooth contours are quickest without threads.
+    x, y, z = simple((30, 40))
+    cont_gen = contour_generator(x, y, z, name="auto", thread_count=4)
+    assert type(cont_gen) is SerialContourGenerator
+    assert cont_gen.chunk_count == (1, 1)
+
+    if max_threads() < 2:
+        pytest.skip("requires 2 or more threads")
+
+    # A cost model in which threads are free and fully efficient always chooses them.
+    cost_model = tmp_path / "cost_model.json"
+    with open(cost_model, "w") as f:
+        json.dump(dict(thread=0.0, efficiency=1.0), f)
+    monkeypatch.setenv("CONTOURPY_COST_MODEL", str(cost_model))
+    cont_gen = contour_generator(x, y, z, name="auto", thread_count=2)
+    assert type(cont_gen) is ThreadedContourGenerator
+    assert cont_gen.thread_count == 2
+    chunk_count = cont_gen.chunk_count
+    assert chunk_count[0]*chunk_count[1] >= 2
+
+    # A specified chunk layout is kept.
+    cont_gen = contour_generator(x, y, z, name="auto", thread_count=2, chunk_size=5)
+    assert cont_gen.chunk_size == (5, 5)
+
+
+@pytest.mark.parametrize("dataset", ["simple", "random"])
+@pytest.mark.parametrize("n, expected", [(40, "serial"), (1000, "threaded")])
+def test_choose_algorithm(dataset, n, expected, monkeypatch):
+    # Clear-cut cases using the shipped cost model on a machine with 8 threads.
+    monkeypatch.delenv("CONTOURPY_COST_MODEL", raising=False)
+    monkeypatch.setattr(contourpy.cost, "max_threads", lambda: 8)
+    _, _, z = simple((n, n)) if dataset == "simple" else random((n, n))
+
+    name, y_chunk_size, x_chunk_size, thread_count = choose_algorithm(z, None)
+    assert name == expected
+    if expected == "serial":
+        assert (y_chunk_size, x_chunk_size, thread_count) == (0, 0, 1)
+    else:
+        assert thread_count == 8
+        assert 0 < y_chunk_size < n-1 and 0 < x_chunk_size < n-1
+
+    # Limiting to a single thread always chooses serial.
+    assert choose_algorithm(z, None, thread_count=1)[0] == "serial"
+
+
+@pytest.mark.parametrize("dataset", ["simple", "random"])
+def test_estimate_points(dataset):
+    x, y, z = simple((300, 400)) if dataset == "simple" else random((300, 400))
+    level_count = 5
+    expected = np.mean([
+        len(points) for level in np.linspace(z.min(), z.max(), level_count + 2)[1:-1]
+        for points in contour_generator(x, y, z, line_type=LineType.ChunkCombinedOffset).lines(
+            level)[0]])
+    estimate = estimate_points(z, None, level_count)
+    assert 0.7*expected < estimate < 1.3*expected
+
+
+@pytest.mark.skipif(
+    not sysconfig.get_config_var("Py_GIL_DISABLED"), reason="requires free-threaded Python")
+def test_gil_disabled():
+    # Importing contourpy must not re-enable the GIL on free-threaded Python.
+    assert not sys._is_gil_enabled()
+
+
 def test_remove_z_mask():
     zlist = [[1.0, 2.0], [3.0, 4.0]]
 
@@ -0,0 +1,153 @@
+import numpy as np
+import pytest
+
+from contourpy import FillType, LineType, ZInterp, contour_generator
+from contourpy.multi import multi_contour_generator
+from contourpy.util.data import random
+
+from . import util_test
+
+
+def assert_equal_recursive(result, expected):
+    if isinstance(expected, (list, tuple)):
+        assert len(result) == len(expected)
+        for r, e in zip(result, expected):
+            assert_equal_recursive(r, e)
+    else:
+        np.testing.assert_array_equal(result, expected)
+
+
+def sort_separate(result):
+    # Arrays of the separate line and fill types are in the order that threads finish their chunks,
+    # so are sorted by their points before comparison.
+    if isinstance(result, list):
+        return sorted(result, key=lambda points: points.tobytes())
+    order = sorted(range(len(result[0])), key=lambda i: result[0][i].tobytes())
+    return tuple([arrays[i] for i in order] for arrays in result)
+
+
+def random_fields(shape, n_fields, mask_fraction):
+    x, y, z = random(shape, mask_fraction=mask_fraction)
+    rng = np.random.default_rng(2187)
+    zs = np.ma.stack([z] + [np.ma.array(rng.random(shape), mask=np.ma.getmask(z))
+                            for _ in range(n_fields-1)])
+    return x, y, zs
+
+
+@pytest.mark.parametrize("name, thread_count", [("serial", 1), ("threaded", 2)])
+@pytest.mark.parametrize("line_type", LineType.__members__.values())
+@pytest.mark.parametrize("corner_mask", [False, True])
+def test_multi_lines(name, thread_count, line_type, corner_mask):
+    x, y, zs = random_fields((30, 40), 4, 0.05)
+    kwargs = dict(name=name, line_type=line_type, corner_mask=corner_mask, chunk_size=(7, 9),
+                  thread_count=thread_count)
+    multi = multi_contour_generator(x, y, zs, **kwargs)
+    assert multi.field_count == 4
+    assert multi.contour_generator.line_type == line_type
+
+    unordered = thread_count > 1 and line_type in (LineType.Separate, LineType.SeparateCode)
+    for level in (0.2, 0.5):
+        result = multi.lines(level)
+        assert len(result) == 4
+        for field, z in enumerate(zs):
+            expected = contour_generator(x, y, z, **kwargs).lines(level)
+            if unordered:
+                result[field], expected = sort_separate(result[field]), sort_separate(expected)
+            assert_equal_recursive(result[field], expected)
+
+
+@pytest.mark.parametrize("name, thread_count", [("serial", 1), ("threaded", 2)])
+@pytest.mark.parametrize("fill_type", FillType.__members__.values())
+@pytest.mark.parametrize("quad_as_tri", [False, True])
+def test_multi_filled(name, thread_count, fill_type, quad_as_tri):
+    x, y, zs = random_fields((30, 40), 3, 0.05)
+    kwargs = dict(name=name, fill_type=fill_type, quad_as_tri=quad_as_tri, chunk_size=(7, 9),
+                  thread_count=thread_count)
+    multi = multi_contour_generator(x, y, zs, **kwargs)
+
+    unordered = thread_count > 1 and fill_type in (FillType.OuterCode, FillType.OuterOffset)
+    result = multi.filled(0.3, 0.6)
+    assert len(result) == 3
+    for field, z in enumerate(zs):
+        expected = contour_generator(x, y, z, **kwargs).filled(0.3, 0.6)
+        if unordered:
+            result[field], expected = sort_separate(result[field]), sort_separate(expected)
+        assert_equal_recursive(result[field], expected)
+
+
+@pytest.mark.parametrize(
+    "line_type", [t for name, t in util_test.all_names_and_line_types() if name == "mpl2005"])
+@pytest.mark.parametrize("thread_count", [1, 2])
+def test_mpl2005_multi_lines(line_type, thread_count):
+    x, y, z = random((30, 40), mask_fraction=0.05)
+    cont_gen = contour_generator(
+        x, y, z, name="mpl2005", line_type=line_type, chunk_size=(7, 9),
+        thread_count=thread_count)
+    levels = np.linspace(0.1, 0.9, 5)
+
+    result = cont_gen.multi_lines(levels)
+    assert len(result) == len(levels)
+    for lines, level in zip(result, levels):
+        expected = cont_gen.lines(level)
+        if thread_count > 1 and line_type == LineType.SeparateCode:
+            lines, expected = sort_separate(lines), sort_separate(expected)
+        assert_equal_recursive(lines, expected)
+
+
+@pytest.mark.parametrize(
+    "fill_type", [t for name, t in util_test.all_names_and_fill_types() if name == "mpl2005"])
+@pytest.mark.parametrize("thread_count", [1, 2])
+def test_mpl2005_multi_filled(fill_type, thread_count):
+    x, y, z = random((30, 40), mask_fraction=0.05)
+    cont_gen = contour_generator(
+        x, y, z, name="mpl2005", fill_type=fill_type, chunk_size=(7, 9),
+        thread_count=thread_count)
+    levels = np.linspace(0.1, 0.9, 5)
+
+    result = cont_gen.multi_filled(levels)
+    assert len(result) == len(levels) - 1
+    for filled, lower_level, upper_level in zip(result, levels[:-1], levels[1:]):
+        expected = cont_gen.filled(lower_level, upper_level)
+        if thread_count > 1 and fill_type == FillType.OuterCode:
+            filled, expected = sort_separate(filled), sort_separate(expected)
+        assert_equal_recursive(filled, expected)
+
+    assert cont_gen.multi_filled([0.5]) == []
+    with pytest.raises(ValueError, match="levels must be increasing"):
+        cont_gen.multi_filled([0.5, 0.4])
+    with pytest.raises(ValueError, match="levels must be a 1D array"):
+        cont_gen.multi_lines([[0.5]])
+
+
+def test_multi_combined_mask():
+    # A point that is invalid in any field is masked out in all of them.
+    x, y, zs = random_fields((10, 12), 2, 0.0)
+    zs = np.ma.getdata(zs).copy()
+    zs[1, 4, 5] = np.nan
+    multi = multi_contour_generator(x, y, zs)
+    expected = contour_generator(x, y, np.ma.array(zs[0], mask=np.isnan(zs[1]))).lines(0.5)
+    assert_equal_recursive(multi.lines(0.5)[0], expected)
+
+
+def test_multi_log():
+    x, y, zs = random_fields((10, 12), 2, 0.0)
+    zs = np.ma.getdata(zs) + 0.1
+    multi = multi_contour_generator(x, y, zs, z_interp=ZInterp.Log)
+    assert len(multi.lines(0.5)) == 2
+
+    zs[1, 3, 3] = -1.0
+    multi = multi_contour_generator(x, y, zs, z_interp=ZInterp.Log)
+    with pytest.raises(ValueError, match="z values must be positive if using ZInterp.Log"):
+        multi.lines(0.5)
+
+
+def test_multi_errors():
+    x, y, zs = random_fields((10, 12), 2, 0.0)
+    with pytest.raises(ValueError, match="mpl2014 contour generator does not support multiple"):
+        multi_contour_generator(x, y, zs, name="mpl2014")
+    with pytest.raises(TypeError, match="Input z must be 3D, not 2D"):
+        multi_contour_generator(x, y, zs[0])
+    with pytest.raises(ValueError, match="Input z must contain at least one field"):
+        multi_contour_generator(x, y, zs[:0])
+    with pytest.raises(ValueError, match="upper and lower levels are the wrong way round"):
+        multi_contour_generator(x, y, zs).filled(0.6, 0.3)
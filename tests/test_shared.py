@@ -0,0 +1,153 @@
+import pickle
+import sys
+
+import numpy as np
+import pytest
+
+from contourpy import (
+    FillType, LineType, ZInterp, attach_generator, contour_generator, load_generator,
+    save_generator, share_generator,
+)
+from contourpy.util.data import random
+
+requires_shared_memory = pytest.mark.skipif(
+    sys.version_info < (3, 8), reason="multiprocessing.shared_memory requires Python 3.8")
+
+
+def assert_equal_recursive(result, expected):
+    if isinstance(expected, (list, tuple)):
+        assert len(result) == len(expected)
+        for r, e in zip(result, expected):
+            assert_equal_recursive(r, e)
+    else:
+        np.testing.assert_array_equal(result, expected)
+
+
+def create_generator(name, thread_count, corner_mask):
+    x, y, z = random((30, 40), mask_fraction=0.05)
+    cont_gen = contour_generator(
+        x, y, z, name=name, corner_mask=corner_mask, line_type=LineType.ChunkCombinedCode,
+        fill_type=FillType.ChunkCombinedCodeOffset, chunk_size=(7, 9), quad_as_tri=True,
+        z_interp=ZInterp.Linear, thread_count=thread_count)
+    cont_gen.collect_stats = True
+    return cont_gen
+
+
+def assert_identical_generators(cont_gen, expected):
+    assert type(cont_gen) is type(expected)
+    for prop in ("chunk_count", "chunk_size", "collect_stats", "corner_mask", "fill_type",
+                 "line_type", "perf_counters", "quad_as_tri", "thread_count", "z_interp"):
+        assert getattr(cont_gen, prop) == getattr(expected, prop)
+    assert expected._get_mask() is not None
+    np.testing.assert_array_equal(cont_gen._get_mask(), expected._get_mask())
+
+    for level in (0.2, 0.5, 0.8):
+        assert_equal_recursive(cont_gen.lines(level), expected.lines(level))
+    assert_equal_recursive(cont_gen.filled(0.3, 0.6), expected.filled(0.3, 0.6))
+
+
+@pytest.mark.parametrize("name, thread_count", [("serial", 1), ("threaded", 2)])
+@pytest.mark.parametrize("corner_mask", [False, True])
+def test_pickle(name, thread_count, corner_mask):
+    cont_gen = create_generator(name, thread_count, corner_mask)
+    unpickled = pickle.loads(pickle.dumps(cont_gen))
+    assert_identical_generators(unpickled, cont_gen)
+
+
+@pytest.mark.parametrize("name, thread_count", [("serial", 1), ("threaded", 2)])
+@pytest.mark.parametrize("mmap", [False, True])
+def test_save_load(name, thread_count, mmap, tmp_path):
+    cont_gen = create_generator(name, thread_count, True)
+    filename = tmp_path / "cont_gen.bin"
+    save_generator(cont_gen, filename)
+    loaded = load_generator(filename, mmap=mmap)
+    assert_identical_generators(loaded, cont_gen)
+
+
+@requires_shared_memory
+@pytest.mark.parametrize("name, thread_count", [("serial", 1), ("threaded", 2)])
+@pytest.mark.parametrize("corner_mask", [False, True])
+def test_share_attach(name, thread_count, corner_mask):
+    cont_gen = create_generator(name, thread_count, corner_mask)
+    shm = share_generator(cont_gen)
+    try:
+        attached, attached_shm = attach_generator(shm.name)
+        assert_identical_generators(attached, cont_gen)
+        del attached
+        attached_shm.close()
+    finally:
+        shm.close()
+        shm.unlink()
+
+
+@requires_shared_memory
+@pytest.mark.parametrize("name", ["mpl2005", "mpl2014"])
+def test_share_unsupported(name, tmp_path):
+    cont_gen = contour_generator(z=[[0, 1], [2, 3]], name=name)
+    with pytest.raises(TypeError, match="Cannot share contour generator of type"):
+        share_generator(cont_gen)
+    with pytest.raises(TypeError, match="Cannot save contour generator of type"):
+        save_generator(cont_gen, tmp_path / "cont_gen.bin")
+
+
+@pytest.mark.parametrize("name, thread_count", [("serial", 1), ("threaded", 2)])
+def test_save_load_without_mask(name, thread_count, tmp_path):
+    _, _, z = random((30, 40))
+    cont_gen = contour_generator(z=z, name=name, thread_count=thread_count)
+    filename = tmp_path / "cont_gen.bin"
+    save_generator(cont_gen, filename)
+    for loaded in (load_generator(filename), pickle.loads(pickle.dumps(cont_gen))):
+        assert loaded._get_mask() is None
+        assert loaded.collect_stats is False
+        assert_equal_recursive(loaded.filled(0.3, 0.6), cont_gen.filled(0.3, 0.6))
+
+
+def test_load_invalid(tmp_path):
+    filename = tmp_path / "invalid.bin"
+    filename.write_bytes(bytes(1000))
+    with pytest.raises(ValueError, match="does not contain a contour generator"):
+        load_generator(filename)
+    filename.write_bytes(bytes(10))
+    with pytest.raises(ValueError, match="does not contain a contour generator"):
+        load_generator(filename)
+
+
+@pytest.mark.parametrize("mmap", [False, True])
+def test_load_corrupt(mmap, tmp_path):
+    cont_gen = create_generator("serial", 1, True)
+    filename = tmp_path / "cont_gen.bin"
+    save_generator(cont_gen, filename)
+    data = bytearray(filename.read_bytes())
+
+    # Truncated file.
+    filename.write_bytes(data[:-1])
+    with pytest.raises(ValueError, match="too short for a contour generator of shape"):
+        load_generator(filename, mmap=mmap)
+
+    # Invalid header.
+    corrupt = bytearray(data)
+    corrupt[8*3:8*4] = (-1).to_bytes(8, "little", signed=True)
+    filename.write_bytes(corrupt)
+    with pytest.raises(ValueError, match="invalid contour generator header"):
+        load_generator(filename, mmap=mmap)
+
+    # Grid cache with the N boundary bit of quad (1, 1) toggled.
+    ny, nx = 30, 40
+    cache_offset = 8*16 + 3*8*ny*nx + 4*(nx+1)
+    corrupt = bytearray(data)
+    corrupt[cache_offset] ^= 0x20
+    filename.write_bytes(corrupt)
+    with pytest.raises(ValueError, match=r"grid_cache is not consistent .* at point \(1, 1\)"):
+        load_generator(filename, mmap=mmap)
+
+
+def test_grid_cache_shape():
+    cont_gen = contour_generator(z=np.zeros((3, 4)))
+    x, y, z, grid_cache = cont_gen._get_grid()
+    assert grid_cache.shape == (3, 4)
+    assert grid_cache.dtype == np.uint32
+    with pytest.raises(ValueError, match="grid_cache must be a 2D array with the same shape as z"):
+        type(cont_gen)(
+            x, y, z, None, corner_mask=False, line_type=cont_gen.line_type,
+            fill_type=cont_gen.fill_type, quad_as_tri=False, z_interp=cont_gen.z_interp,
+            grid_cache=grid_cache[:, :3].copy())
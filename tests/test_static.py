@@ -100,7 +100,7 @@ def test_supports_threads(class_name):
     cls = get_class_from_name(class_name)
     supports = cls.supports_threads()
     assert isinstance(supports, bool)
-    expect = class_name == "ThreadedContourGenerator"
+    expect = class_name in ("Mpl2005ContourGenerator", "ThreadedContourGenerator")
     assert supports == expect
 
 
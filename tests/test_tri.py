@@ -0,0 +1,182 @@
+import numpy as np
+import pytest
+
+from contourpy import FillType, LineType, TriContourGenerator, ZInterp
+from contourpy.tri import tri_contour_generator
+
+
+def random_mesh(n_points, seed=2187):
+    # Points of a regular grid with random offsets, split into 2 triangles per quad.
+    rng = np.random.default_rng(seed)
+    n = int(np.sqrt(n_points))
+    x, y = np.meshgrid(np.arange(n, dtype=np.float64), np.arange(n, dtype=np.float64))
+    x = (x + 0.3*rng.random(x.shape)).ravel()
+    y = (y + 0.3*rng.random(y.shape)).ravel()
+    sw = (np.arange(n-1)[np.newaxis, :] + n*np.arange(n-1)[:, np.newaxis]).ravel()
+    triangles = np.concatenate([
+        np.stack([sw, sw+1, sw+n+1], axis=1), np.stack([sw, sw+n+1, sw+n], axis=1)])
+    z = np.sin(0.5*x)*np.cos(0.4*y) + 0.1*rng.random(x.shape)
+    return x, y, triangles, z
+
+
+def polygon_area(points):
+    x, y = points[:, 0], points[:, 1]
+    return 0.5*np.sum(x[:-1]*y[1:] - x[1:]*y[:-1])
+
+
+def filled_area(filled):
+    # Sum of signed areas of FillType.OuterOffset polygons.
+    area = 0.0
+    for points, offsets in zip(*filled):
+        for start, end in zip(offsets[:-1], offsets[1:]):
+            area += polygon_area(points[start:end])
+    return area
+
+
+def sorted_lines(lines):
+    # Lines in a repeatable order, as threads append separate lines in any order.
+    return sorted(lines, key=lambda line: (len(line), tuple(line[0])))
+
+
+def triangle_area(x, y, triangles):
+    p0, p1, p2 = triangles.T
+    return 0.5*np.abs((x[p1] - x[p0])*(y[p2] - y[p0]) - (y[p1] - y[p0])*(x[p2] - x[p0]))
+
+
+@pytest.mark.parametrize("line_type", LineType.__members__.values())
+@pytest.mark.parametrize("chunk_count, thread_count", [(1, 1), (5, 1), (5, 2)])
+def test_tri_lines(line_type, chunk_count, thread_count):
+    x, y, triangles, z = random_mesh(400)
+    cont_gen = tri_contour_generator(
+        x, y, triangles, z, line_type=line_type, chunk_count=chunk_count,
+        thread_count=thread_count)
+    assert isinstance(cont_gen, TriContourGenerator)
+    assert cont_gen.line_type == line_type
+    assert cont_gen.chunk_count == chunk_count
+    assert cont_gen.thread_count == thread_count
+    assert cont_gen.point_count == len(x)
+    assert cont_gen.triangle_count == len(triangles)
+
+    reference = tri_contour_generator(x, y, triangles, z, chunk_count=chunk_count)
+    expected = reference.lines(0.3)
+    assert len(expected) > 0
+    result = cont_gen.lines(0.3)
+    if line_type in (LineType.Separate, LineType.SeparateCode):
+        if line_type == LineType.SeparateCode:
+            result = result[0]
+        assert len(result) == len(expected)
+        for r, e in zip(sorted_lines(result), sorted_lines(expected)):
+            np.testing.assert_array_equal(r, e)
+    else:
+        assert len(result[0]) == chunk_count
+        points = [p for p in result[0] if p is not None]
+        np.testing.assert_array_equal(np.concatenate(points), np.concatenate(expected))
+
+
+@pytest.mark.parametrize("fill_type", FillType.__members__.values())
+@pytest.mark.parametrize("chunk_count, thread_count", [(1, 1), (5, 1), (5, 2)])
+def test_tri_filled(fill_type, chunk_count, thread_count):
+    x, y, triangles, z = random_mesh(400)
+    cont_gen = tri_contour_generator(
+        x, y, triangles, z, fill_type=fill_type, chunk_count=chunk_count,
+        thread_count=thread_count)
+    assert cont_gen.fill_type == fill_type
+
+    result = cont_gen.filled(-0.2, 0.4)
+    if fill_type == FillType.OuterOffset:
+        # Each outer is anticlockwise and followed by its clockwise holes.
+        assert len(result[0]) > 0
+        for points, offsets in zip(*result):
+            areas = [polygon_area(points[start:end])
+                     for start, end in zip(offsets[:-1], offsets[1:])]
+            assert areas[0] > 0.0
+            assert all(area < 0.0 for area in areas[1:])
+    elif fill_type != FillType.OuterCode:
+        assert len(result[0]) == chunk_count
+
+    # Total area does not depend on chunking.
+    reference = tri_contour_generator(x, y, triangles, z, chunk_count=1)
+    expected = filled_area(reference.filled(-0.2, 0.4))
+    by_chunk = tri_contour_generator(x, y, triangles, z, chunk_count=chunk_count)
+    assert filled_area(by_chunk.filled(-0.2, 0.4)) == pytest.approx(expected, abs=1e-10)
+
+
+@pytest.mark.parametrize("chunk_count", [1, 7])
+def test_tri_filled_all(chunk_count):
+    # Levels that enclose all of z fill every unmasked triangle.
+    x, y, triangles, z = random_mesh(225)
+    mask = np.zeros(len(triangles), dtype=bool)
+    mask[[3, 50, 51, 52, 100]] = True
+    cont_gen = tri_contour_generator(x, y, triangles, z, mask=mask, chunk_count=chunk_count)
+    expected = triangle_area(x, y, triangles[~mask]).sum()
+    assert filled_area(cont_gen.filled(-2.0, 2.0)) == pytest.approx(expected, abs=1e-10)
+
+
+def test_tri_masked_z():
+    x, y, triangles, z = random_mesh(225)
+    z = np.ma.array(z)
+    z[20] = np.ma.masked
+    z[40] = np.nan
+    cont_gen = tri_contour_generator(x, y, triangles, z)
+    masked = np.isin(triangles, [20, 40]).any(axis=1)
+    expected = triangle_area(x, y, triangles[~masked]).sum()
+    assert filled_area(cont_gen.filled(-2.0, 2.0)) == pytest.approx(expected, abs=1e-10)
+
+
+def test_tri_z_interp():
+    x, y, triangles, z = random_mesh(225)
+    z = np.exp(z)
+    linear = tri_contour_generator(x, y, triangles, z)
+    log = tri_contour_generator(x, y, triangles, z, z_interp=ZInterp.Log)
+    assert log.z_interp == ZInterp.Log
+    for r, e in zip(log.lines(1.0), linear.lines(1.0)):
+        assert r.shape == e.shape
+    with pytest.raises(ValueError, match="z values must be positive if using ZInterp.Log"):
+        tri_contour_generator(x, y, triangles, z - 2.0, z_interp="Log")
+
+
+@pytest.mark.needs_mpl
+def test_tri_matplotlib():
+    from matplotlib._tri import TriContourGenerator as MplTriContourGenerator
+    from matplotlib.tri import Triangulation
+
+    rng = np.random.default_rng(2187)
+    x, y = rng.random(300), rng.random(300)
+    z = np.sin(6*x)*np.cos(5*y)
+    triangulation = Triangulation(x, y)
+    mask = rng.random(len(triangulation.triangles)) < 0.1
+    triangulation.set_mask(mask)
+    mpl = MplTriContourGenerator(triangulation.get_cpp_triangulation(), z)
+    cont_gen = tri_contour_generator(x, y, triangulation.triangles, z, mask=mask)
+
+    expected, _ = mpl.create_contour(0.3)
+    result = cont_gen.lines(0.3)
+    assert len(result) == len(expected)
+    np.testing.assert_allclose(
+        np.unique(np.round(np.concatenate(result), 10), axis=0),
+        np.unique(np.round(np.concatenate(expected), 10), axis=0))
+
+    verts, codes = mpl.create_filled_contour(-0.2, 0.4)
+    expected = 0.0
+    for points, kinds in zip(verts, codes):
+        starts = np.append(np.flatnonzero(kinds == 1), len(kinds))
+        for start, end in zip(starts[:-1], starts[1:]):
+            expected += polygon_area(points[start:end])
+    assert filled_area(cont_gen.filled(-0.2, 0.4)) == pytest.approx(expected, abs=1e-10)
+
+
+def test_tri_errors():
+    x, y, triangles, z = random_mesh(16)
+    with pytest.raises(TypeError, match="Input z must be 1D"):
+        tri_contour_generator(x, y, triangles, z.reshape(4, 4))
+    with pytest.raises(TypeError, match="triangles must have shape"):
+        tri_contour_generator(x, y, triangles.ravel(), z)
+    with pytest.raises(ValueError, match="triangles must contain indices in the range 0 to 15"):
+        tri_contour_generator(x, y, triangles + 1, z)
+    with pytest.raises(ValueError, match="If mask is set it must be a 1D array"):
+        tri_contour_generator(x, y, triangles, z, mask=[True])
+    with pytest.raises(ValueError, match="chunk_count cannot be negative"):
+        tri_contour_generator(x, y, triangles, z, chunk_count=-1)
+    cont_gen = tri_contour_generator(x, y, triangles, z)
+    with pytest.raises(ValueError, match="upper and lower levels are the wrong way round"):
+        cont_gen.filled(1.0, 0.0)
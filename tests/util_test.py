@@ -26,7 +26,15 @@ def all_names(exclude=None):
 def all_names_and_fill_types():
     return [
         ("mpl2005", FillType.OuterCode),
+        ("mpl2005", FillType.ChunkCombinedCode),
+        ("mpl2005", FillType.ChunkCombinedOffset),
+        ("mpl2005", FillType.ChunkCombinedCodeOffset),
+        ("mpl2005", FillType.ChunkCombinedOffsetOffset),
         ("mpl2014", FillType.OuterCode),
+        ("mpl2014", FillType.ChunkCombinedCode),
+        ("mpl2014", FillType.ChunkCombinedOffset),
+        ("mpl2014", FillType.ChunkCombinedCodeOffset),
+        ("mpl2014", FillType.ChunkCombinedOffsetOffset),
         ("serial", FillType.OuterCode),
         ("serial", FillType.OuterOffset),
         ("serial", FillType.ChunkCombinedCode),
@@ -45,7 +53,11 @@ def all_names_and_fill_types():
 def all_names_and_line_types():
     return [
         ("mpl2005", LineType.SeparateCode),
+        ("mpl2005", LineType.ChunkCombinedCode),
+        ("mpl2005", LineType.ChunkCombinedOffset),
         ("mpl2014", LineType.SeparateCode),
+        ("mpl2014", LineType.ChunkCombinedCode),
+        ("mpl2014", LineType.ChunkCombinedOffset),
         ("serial", LineType.Separate),
         ("serial", LineType.SeparateCode),
         ("serial", LineType.ChunkCombinedCode),
@@ -236,3 +248,48 @@ def assert_lines(lines, line_type):
                 assert_offset_array(offset, npoints)
     else:
         raise RuntimeError(f"Unexpected line_type {line_type}")
+
+
+def canonical_ring(ring):
+    # Tuple of rounded points that does not depend on the start point of a closed ring.
+    ring = [tuple(point) for point in np.round(ring, 9)]
+    if len(ring) > 2 and ring[0] == ring[-1]:
+        ring = ring[:-1]
+        start = ring.index(min(ring))
+        ring = ring[start:] + ring[:start]
+    return tuple(ring)
+
+
+def canonical_lines(lines):
+    return sorted(canonical_ring(line) for line in lines)
+
+
+def offsets_from_codes(codes):
+    return [np.append(np.flatnonzero(c == 1), len(c)) for c in codes]
+
+
+def canonical_filled(points, offsets):
+    polygons = []
+    for polygon_points, polygon_offsets in zip(points, offsets):
+        rings = [canonical_ring(ring) for ring in np.split(polygon_points, polygon_offsets[1:-1])]
+        polygons.append((rings[0], sorted(rings[1:])))
+    return sorted(polygons)
+
+
+def filled_area(points, offsets):
+    # Total signed area of filled polygons, which does not depend on how they are split.
+    area = 0.0
+    for polygon_points, polygon_offsets in zip(points, offsets):
+        for ring in np.split(polygon_points, polygon_offsets[1:-1]):
+            x, y = ring[:, 0], ring[:, 1]
+            area += 0.5*np.sum(x[:-1]*y[1:] - x[1:]*y[:-1])
+    return area
+
+
+def line_segments(lines):
+    # Sorted undirected segments of non-zero length, which do not depend on how lines are joined.
+    segments = []
+    for line in lines:
+        line = [tuple(point) for point in np.round(line, 9)]
+        segments += [tuple(sorted(pair)) for pair in zip(line[:-1], line[1:]) if pair[0] != pair[1]]
+    return sorted(segments)